@@ -29,6 +29,20 @@
  * @date 23 June 2011
  *	- Creation date.
  *
+ * @date 18 October 2026
+ *	- Menu-driven unit strings are compiled as each term is added.  Invalid
+ *	  terms and mismatched dimensions are reported immediately.
+ *	- Added Bulk Input page.  Values pasted from the clipboard are converted on
+ *	  a worker thread and displayed in a virtualized list.
+ *	- Conversion errors are reported from error codes.  The manual page no
+ *	  longer writes to the console, and bulk rows which convert to a value
+ *	  out of range are marked.
+ *	- Unit-string entry boxes suggest units and prefixes from a UnitSearch
+ *	  index as they are typed.
+ *	- Units are looked up in a UnitSnapshots registry holding the site units
+ *	  of the file named by UNITCONVERT_UNITS, which File->Reload Site Units
+ *	  loads again.
+ *
  *
  *
  *
@@ -73,6 +87,9 @@ using namespace std;
 #include <sigc++/retype_return.h>
 #include <glib.h>
 #include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
@@ -83,6 +100,16 @@ using namespace std;
 #include <gtkmm.h>
 #include <omp.h>
 #include <UnitConvert.h>
+#include "UnitPlan.h"
+#include "UnitSearch.h"
+#include "UnitSnapshots.h"
+
+
+/** @brief Number of rows shown at once in the bulk-conversion result list */
+#define BULK_VISIBLE_ROWS 20
+
+/** @brief Number of suggestions shown while a unit string is typed */
+#define SEARCH_SUGGESTIONS 12
 
 /**
  * @brief This class defines the GUI used with the Laminography Reconstruction
@@ -171,6 +198,16 @@ protected:
 	void showreference();
 
 
+	/**
+	 * @brief Load the site units again and rebuild the unit suggestions.
+	 * @pre GUIUnitConvert object exists.
+	 * @post Registry replaced if the site units file is valid.  Result shown
+	 * 			in the status bar, or in a message if the file is invalid.
+	 * @return None.
+	 */
+	void on_mnu_reload_units_activate();
+
+
 	/**
 	 * @brief Close the Help->Reference dialog box.
 	 * @pre GUIUnitConvert object exists.
@@ -235,6 +272,109 @@ protected:
 	virtual void on_btn_manual_convert_clicked();
 
 
+	/**
+	 * @brief Read values from the clipboard and convert them.
+	 * @pre GUIUnitConvert object exists.
+	 * @post Clipboard contents requested.  Conversion starts when they arrive.
+	 * @return None.
+	 */
+	virtual void on_btn_bulk_paste_clicked();
+
+
+	/**
+	 * @brief Receive text from the clipboard and start the bulk conversion.
+	 * @pre GUIUnitConvert object exists.
+	 * @param text Text retrieved from the clipboard.
+	 * @post Conversion started on the worker thread.
+	 * @return None.
+	 */
+	virtual void on_bulk_clipboard_received(const Glib::ustring &text);
+
+
+	/**
+	 * @brief Convert the previously-pasted values using the current units.
+	 * @pre GUIUnitConvert object exists.
+	 * @post Conversion started on the worker thread.
+	 * @return None.
+	 */
+	virtual void on_btn_bulk_convert_clicked();
+
+
+	/**
+	 * @brief Remove all pasted values.
+	 * @pre GUIUnitConvert object exists.
+	 * @post Pasted values and results cleared.
+	 * @return None.
+	 */
+	virtual void on_btn_bulk_clear_clicked();
+
+
+	/**
+	 * @brief Show the rows of the bulk results at the scrollbar position.
+	 * @pre GUIUnitConvert object exists.
+	 * @post Visible rows of the result list refilled.
+	 * @return None.
+	 */
+	virtual void on_scr_bulk_results_changed();
+
+
+	/**
+	 * @brief Move the bulk-result scrollbar in response to the mouse wheel.
+	 * @pre GUIUnitConvert object exists.
+	 * @param event Scroll event.
+	 * @post Scrollbar position updated.
+	 * @return Boolean value indicating that the event was handled.
+	 */
+	virtual bool on_tv_bulk_results_scroll(GdkEventScroll *event);
+
+
+	/**
+	 * @brief Refill the suggestions for a unit-string entry box with the
+	 * 			units and prefixes matching the term being typed.
+	 * @pre GUIUnitConvert object exists.
+	 * @param entry Entry box whose text changed.
+	 * @param model List-model of the entry's completion.
+	 * @post Suggestions refilled.
+	 * @return None.
+	 */
+	virtual void on_units_entry_changed(Gtk::Entry *entry, Glib::RefPtr<Gtk::ListStore> model);
+
+
+	/**
+	 * @brief Complete the term being typed with the selected suggestion.
+	 * @pre GUIUnitConvert object exists.
+	 * @param iter Selected row of the completion list-model.
+	 * @param entry Entry box being completed.
+	 * @post Entry text updated.
+	 * @return Boolean value indicating that the selection was handled.
+	 */
+	virtual bool on_units_completion_selected(const Gtk::TreeModel::iterator &iter,
+			Gtk::Entry *entry);
+
+
+	/**
+	 * @brief Accept every suggestion.  The list-model only ever holds the
+	 * 			results of the search for the current text.
+	 * @pre GUIUnitConvert object exists.
+	 * @param key Text typed.
+	 * @param iter Row of the completion list-model.
+	 * @post No changes to object.
+	 * @return True.
+	 */
+	bool on_units_completion_match(const Glib::ustring &key,
+			const Gtk::TreeModel::const_iterator &iter);
+
+
+	/**
+	 * @brief Display the results of the bulk conversion.  Called on the GUI
+	 * 			thread when the worker thread finishes.
+	 * @pre GUIUnitConvert object exists.
+	 * @post Worker thread joined and results displayed.
+	 * @return None.
+	 */
+	virtual void on_bulk_convert_done();
+
+
 	/** @brief XML interface file for GUI */
 	Glib::RefPtr<Gtk::Builder> xml_interface;
 
@@ -291,6 +431,15 @@ protected:
 	/** @brief Button to close the message dialog box */
 	Gtk::Button *btn_dlg_msg;
 
+	/** @brief Button to read values from the clipboard and convert them */
+	Gtk::Button *btn_bulk_paste;
+
+	/** @brief Button to convert the pasted values using the current units */
+	Gtk::Button *btn_bulk_convert;
+
+	/** @brief Button to remove all pasted values */
+	Gtk::Button *btn_bulk_clear;
+
 
 
 	// ===================================================================
@@ -315,6 +464,12 @@ protected:
 	/** @brief Value to be converted using the manually-entered input strings */
 	Gtk::Entry *txt_manual_input;
 
+	/** @brief Entry box for the unit string of the pasted values */
+	Gtk::Entry *txt_bulk_input_units;
+
+	/** @brief Entry box for the unit string of the converted values */
+	Gtk::Entry *txt_bulk_output_units;
+
 
 
 
@@ -361,6 +516,9 @@ protected:
 	/** @brief Body of message to be displayed in the message dialog box */
 	Gtk::Label *lbl_dlg_msg_body;
 
+	/** @brief Number of values pasted and converted on the Bulk Input page */
+	Gtk::Label *lbl_bulk_status;
+
 
 
 
@@ -386,6 +544,9 @@ protected:
 	/** @brief File->Quit menu item */
 	Gtk::MenuItem *mnu_quit;
 
+	/** @brief File->Reload Site Units menu item */
+	Gtk::MenuItem *mnu_reload_units;
+
 	/** @brief Help->About menu item */
 	Gtk::MenuItem *mnu_help_about;
 
@@ -400,6 +561,27 @@ protected:
 
 
 
+	// ===================================================================
+	// ================ TREE VIEWS
+	/** @brief List of pasted values and their converted values */
+	Gtk::TreeView *tv_bulk_results;
+
+
+
+	// ===================================================================
+	// ================ SCROLLBARS
+	/** @brief Scrollbar selecting the rows shown in tv_bulk_results */
+	Gtk::VScrollbar *scr_bulk_results;
+
+
+
+	// ===================================================================
+	// ================ STATUS BAR
+	/** @brief Status bar at the bottom of the main window */
+	Gtk::Statusbar *sts_main;
+
+
+
 	// ===================================================================
 	// ================ TREE MODEL
 	/** @brief Tree-model for SI units */
@@ -432,11 +614,95 @@ protected:
 	ModelColumns ModelColumnsUnit;
 
 
+	/**
+	 * @brief Define the model for the columns displayed in the bulk-result list.
+	 */
+	class ModelColumnsBulk : public Gtk::TreeModel::ColumnRecord
+	{
+	public:
+
+		ModelColumnsBulk()
+		{ add(m_col_row); add(m_col_input); add(m_col_output); }
+
+		Gtk::TreeModelColumn<Glib::ustring> m_col_row;
+		Gtk::TreeModelColumn<Glib::ustring> m_col_input;
+		Gtk::TreeModelColumn<Glib::ustring> m_col_output;
+	};
+
+	/** @brief Column model for the bulk-result list */
+	ModelColumnsBulk ModelColumnsBulkResults;
+
+
+	/**
+	 * @brief Define the model for the columns of unit-string suggestions.
+	 */
+	class ModelColumnsSearch : public Gtk::TreeModel::ColumnRecord
+	{
+	public:
+
+		ModelColumnsSearch()
+		{ add(m_col_name); add(m_col_entry); }
+
+		Gtk::TreeModelColumn<Glib::ustring> m_col_name;
+		Gtk::TreeModelColumn<int> m_col_entry;
+	};
+
+	/** @brief Column model for unit-string suggestions */
+	ModelColumnsSearch ModelColumnsSearchResults;
+
+	/** @brief List-model for the bulk-result list.  Only the visible rows are
+	 * stored in the model; they are refilled as the list is scrolled. */
+	Glib::RefPtr<Gtk::ListStore> ListModelBulk;
+
+
 
 
 private:
 	// ===================================================================
 	// ================ VARIABLES
+	/** @brief Units and SI prefixes available to the unit-string compiler,
+	 * including the site units.  Replaced when the site units are reloaded. */
+	UnitSnapshots unitsnapshots;
+
+	/** @brief Index of units and prefixes used to suggest completions */
+	UnitSearch unitsearch;
+
+	/** @brief Results of the most recent search for suggestions */
+	std::vector<UnitSearchResult> searchresults;
+
+	/** @brief Compiled form of the menu-driven input unit string */
+	CompiledUnits menuinputunits;
+
+	/** @brief Compiled form of the menu-driven output unit string */
+	CompiledUnits menuoutputunits;
+
+	/** @brief Text pasted from the clipboard, handed to the worker thread */
+	std::string bulktext;
+
+	/** @brief Values pasted on the Bulk Input page */
+	std::vector<double> bulkinput;
+
+	/** @brief Converted values on the Bulk Input page */
+	std::vector<double> bulkoutput;
+
+	/** @brief Number of pasted values which could not be read */
+	size_t bulkinvalid;
+
+	/** @brief Conversion applied by the worker thread */
+	UnitPlan<double> bulkplan;
+
+	/** @brief Rows whose input or converted value is not a finite number */
+	UnitErrorBitmap bulkerrors;
+
+	/** @brief Indicator that the worker thread owns the bulk variables */
+	bool bulkrunning;
+
+	/** @brief Worker thread performing the bulk conversion */
+	Glib::Thread *bulkthread;
+
+	/** @brief Notifies the GUI thread that the worker thread has finished */
+	Glib::Dispatcher bulkdone;
+
 
 	// ===================================================================
 	// ================ FUNCTIONS
@@ -449,6 +715,81 @@ private:
 	void Reset();
 
 
+	/**
+	 * @brief Show a message in the message dialog box.
+	 * @pre GUIUnitConvert object exists.
+	 * @param title Title of the message.
+	 * @param msg Body of the message.
+	 * @post Dialog box shown.
+	 * @return None.
+	 */
+	void ShowMessage(const std::string &title, const std::string &msg);
+
+
+	/**
+	 * @brief Report in the status bar whether the dimensions of the
+	 * 			menu-driven input and output units match.
+	 * @pre GUIUnitConvert object exists.
+	 * @post Status bar updated.
+	 * @return None.
+	 */
+	void CheckMenuDimensions();
+
+
+	/**
+	 * @brief Build the bulk conversion from the unit strings on the Bulk
+	 * 			Input page and start the worker thread.
+	 * @pre GUIUnitConvert object exists and no bulk conversion is running.
+	 * @post Worker thread started if the unit strings are valid.
+	 * @return None.
+	 */
+	void StartBulkConversion();
+
+
+	/**
+	 * @brief Worker-thread body.  Reads any pasted text into 'bulkinput',
+	 * 			converts all values into 'bulkoutput', and notifies the GUI
+	 * 			thread.
+	 * @pre bulkrunning is true.
+	 * @post bulkinput and bulkoutput updated.
+	 * @return None.
+	 */
+	void BulkConvertThread();
+
+
+	/**
+	 * @brief Refill the bulk-result list-model with the rows at the current
+	 * 			scrollbar position.
+	 * @pre GUIUnitConvert object exists.
+	 * @post List-model holds at most BULK_VISIBLE_ROWS rows.
+	 * @return None.
+	 */
+	void FillBulkResults();
+
+
+	/**
+	 * @brief Attach unit-string suggestions to an entry box.
+	 * @pre GUIUnitConvert object exists and unitsearch has been built.
+	 * @param entry Entry box for a unit string.
+	 * @post Entry box has a completion backed by unitsearch.
+	 * @return None.
+	 */
+	void AttachCompletion(Gtk::Entry *entry);
+
+
+	/**
+	 * @brief Read all numbers from a block of text.  Numbers may be separated
+	 * 			by whitespace, commas, or semicolons.  Text which cannot be read
+	 * 			as a number is stored as NaN so that row numbers are preserved.
+	 * @pre None.
+	 * @param text Text to be read.
+	 * @param vals Reference to the vector to contain the numbers.
+	 * @post vals contains one entry per item of text.
+	 * @return Number of items which could not be read.
+	 */
+	static size_t ParseBulkValues(const std::string &text, std::vector<double> &vals);
+
+
 
 };
 
@@ -474,6 +815,40 @@ void GUIUnitConvert::Reset()
 	cbo_menu_input_unit->set_active(0);
 	cbo_menu_output_si->set_active(0);
 	cbo_menu_output_unit->set_active(0);
+	menuinputunits.Clear();
+	menuoutputunits.Clear();
+	sts_main->pop();
+	txt_bulk_input_units->set_text("");
+	txt_bulk_output_units->set_text("");
+}
+
+
+void GUIUnitConvert::ShowMessage(const std::string &title, const std::string &msg)
+{
+	lbl_dlg_msg_title->set_text(title);
+	lbl_dlg_msg_body->set_text(msg);
+	if(dlg_msg){
+		dlg_msg->run();
+	}
+}
+
+
+void GUIUnitConvert::CheckMenuDimensions()
+{
+	sts_main->pop();
+	if(menuinputunits.NumTerms() == 0 || menuoutputunits.NumTerms() == 0){
+		return;
+	}
+
+	if(menuinputunits.SameDimension(menuoutputunits)){
+		sts_main->push("Units: " +
+				UnitRegistry::DimensionString(menuinputunits.Dimensions()));
+	} else {
+		sts_main->push("Dimension mismatch: input is " +
+				UnitRegistry::DimensionString(menuinputunits.Dimensions()) +
+				", output is " +
+				UnitRegistry::DimensionString(menuoutputunits.Dimensions()));
+	}
 }
 
 
@@ -494,7 +869,10 @@ GUIUnitConvert::GUIUnitConvert()
 // DESTRUCTOR
 GUIUnitConvert::~GUIUnitConvert()
 {
-	// NOTHING.
+	// WAIT FOR ANY BULK CONVERSION TO FINISH
+	if(bulkrunning && bulkthread){
+		bulkthread->join();
+	}
 }
 
 // DIALOG BOX SHOW/HIDE FUNCTIONS
@@ -515,7 +893,10 @@ void GUIUnitConvert::on_dlg_about_close(int response)
 // WINDOW CREATION & WIDGET SIGNAL CONNECTION TO FUNCTIONS
 GUIUnitConvert::GUIUnitConvert(BaseObjectType* cobject,
 		const Glib::RefPtr<Gtk::Builder>& refGlade) : Gtk::Window(cobject),
-													  xml_interface(refGlade)
+													  xml_interface(refGlade),
+													  bulkinvalid(0),
+													  bulkrunning(false),
+													  bulkthread(0)
 {
 	/*
 	 * CONSTRUCT THE GRAPHICAL INTERFACE.  DEFAULT VALUES ARE SET AND WIDGET
@@ -538,11 +919,15 @@ GUIUnitConvert::GUIUnitConvert(BaseObjectType* cobject,
 	xml_interface->get_widget("btn_manual_clear",btn_manual_clear);
 	xml_interface->get_widget("btn_manual_convert",btn_manual_convert);
 	xml_interface->get_widget("btn_dlg_msg",btn_dlg_msg);
+	xml_interface->get_widget("btn_bulk_paste",btn_bulk_paste);
+	xml_interface->get_widget("btn_bulk_convert",btn_bulk_convert);
+	xml_interface->get_widget("btn_bulk_clear",btn_bulk_clear);
 
 
 	// ---- MENU ITEMS
 	xml_interface->get_widget("mnu_help_about",mnu_help_about);
 	xml_interface->get_widget("mnu_quit",mnu_quit);
+	xml_interface->get_widget("mnu_reload_units",mnu_reload_units);
 	xml_interface->get_widget("mnu_help_reference",mnu_help_reference);
 
 
@@ -566,6 +951,8 @@ GUIUnitConvert::GUIUnitConvert(BaseObjectType* cobject,
 	xml_interface->get_widget("txt_manual_input",txt_manual_input);
 	xml_interface->get_widget("txt_manual_input_units",txt_manual_input_units);
 	xml_interface->get_widget("txt_manual_output_units",txt_manual_output_units);
+	xml_interface->get_widget("txt_bulk_input_units",txt_bulk_input_units);
+	xml_interface->get_widget("txt_bulk_output_units",txt_bulk_output_units);
 
 
 	// ---- LABELS
@@ -575,6 +962,15 @@ GUIUnitConvert::GUIUnitConvert(BaseObjectType* cobject,
 	xml_interface->get_widget("lbl_manual_output",lbl_manual_output);
 	xml_interface->get_widget("lbl_dlg_msg_title",lbl_dlg_msg_title);
 	xml_interface->get_widget("lbl_dlg_msg_body",lbl_dlg_msg_body);
+	xml_interface->get_widget("lbl_bulk_status",lbl_bulk_status);
+
+
+	// ---- TREE VIEWS
+	xml_interface->get_widget("tv_bulk_results",tv_bulk_results);
+
+
+	// ---- SCROLLBARS
+	xml_interface->get_widget("scr_bulk_results",scr_bulk_results);
 
 
 	// ---- FILE CHOOSER BUTTONS
@@ -583,6 +979,10 @@ GUIUnitConvert::GUIUnitConvert(BaseObjectType* cobject,
 	// ---- PROGRESS BAR
 
 
+	// ---- STATUS BAR
+	xml_interface->get_widget("sts_main",sts_main);
+
+
 
 	// CALLBACK FUNCTIONS
 	// ---- DIALOG BOXES
@@ -609,12 +1009,20 @@ GUIUnitConvert::GUIUnitConvert(BaseObjectType* cobject,
 		(sigc::mem_fun(*this, &GUIUnitConvert::Reset));
 	btn_manual_convert->signal_clicked().connect
 		(sigc::mem_fun(*this, &GUIUnitConvert::on_btn_manual_convert_clicked));
+	btn_bulk_paste->signal_clicked().connect
+		(sigc::mem_fun(*this, &GUIUnitConvert::on_btn_bulk_paste_clicked));
+	btn_bulk_convert->signal_clicked().connect
+		(sigc::mem_fun(*this, &GUIUnitConvert::on_btn_bulk_convert_clicked));
+	btn_bulk_clear->signal_clicked().connect
+		(sigc::mem_fun(*this, &GUIUnitConvert::on_btn_bulk_clear_clicked));
 
 
 
 	// ---- MENU ITEMS
 	mnu_quit->signal_activate().connect
 		(sigc::mem_fun(*this, &GUIUnitConvert::hide));
+	mnu_reload_units->signal_activate().connect
+		(sigc::mem_fun(*this, &GUIUnitConvert::on_mnu_reload_units_activate));
 	mnu_help_about->signal_activate().connect
 		(sigc::mem_fun(*this, &GUIUnitConvert::showabout));
 	mnu_help_reference->signal_activate().connect
@@ -632,6 +1040,63 @@ GUIUnitConvert::GUIUnitConvert(BaseObjectType* cobject,
 	// ---- COMBO BOXES
 
 
+	// ---- TREE VIEWS & SCROLLBARS
+	tv_bulk_results->add_events(Gdk::SCROLL_MASK);
+	tv_bulk_results->signal_scroll_event().connect
+		(sigc::mem_fun(*this, &GUIUnitConvert::on_tv_bulk_results_scroll), false);
+	scr_bulk_results->signal_value_changed().connect
+		(sigc::mem_fun(*this, &GUIUnitConvert::on_scr_bulk_results_changed));
+
+
+	// ---- WORKER THREADS
+	bulkdone.connect(sigc::mem_fun(*this, &GUIUnitConvert::on_bulk_convert_done));
+
+
+
+	/*
+	 * LOAD THE SITE UNITS, THEN SUGGEST UNITS AND PREFIXES IN THE UNIT-STRING
+	 * ENTRY BOXES.  AN INVALID SITE UNITS FILE LEAVES THE BUILT-IN UNITS.
+	 */
+	if(!unitsnapshots.Load(SiteUnitsFile())){
+		sts_main->push("Site units not loaded: " + unitsnapshots.Error());
+	}
+	{
+		UnitSnapshots::Reader reader(unitsnapshots);
+		unitsearch.Build(reader.Registry());
+	}
+	AttachCompletion(txt_manual_input_units);
+	AttachCompletion(txt_manual_output_units);
+	AttachCompletion(txt_bulk_input_units);
+	AttachCompletion(txt_bulk_output_units);
+
+
+
+	/*
+	 * PREPARE BULK-RESULT LIST.  THE LIST-MODEL ONLY EVER HOLDS THE ROWS
+	 * CURRENTLY ON SCREEN.  THE SCROLLBAR SELECTS WHICH ROWS THOSE ARE, SO THE
+	 * MEMORY USED BY THE WIDGETS DOES NOT DEPEND ON THE NUMBER OF VALUES.
+	 */
+	ListModelBulk = Gtk::ListStore::create(ModelColumnsBulkResults);
+	tv_bulk_results->set_model(ListModelBulk);
+	tv_bulk_results->append_column("Row", ModelColumnsBulkResults.m_col_row);
+	tv_bulk_results->append_column("Input", ModelColumnsBulkResults.m_col_input);
+	tv_bulk_results->append_column("Output", ModelColumnsBulkResults.m_col_output);
+	for(int i=0; i<3; i++){
+		Gtk::TreeViewColumn *col = tv_bulk_results->get_column(i);
+		col->set_sizing(Gtk::TREE_VIEW_COLUMN_FIXED);
+		col->set_fixed_width(i == 0 ? 100 : 220);
+	}
+	tv_bulk_results->set_fixed_height_mode(true);
+
+	Gtk::Adjustment *adj = scr_bulk_results->get_adjustment();
+	adj->set_lower(0.0);
+	adj->set_upper(0.0);
+	adj->set_step_increment(1.0);
+	adj->set_page_increment(BULK_VISIBLE_ROWS);
+	adj->set_page_size(BULK_VISIBLE_ROWS);
+	adj->set_value(0.0);
+
+
 
 	/*
 	 * POPULATE COMBO BOXES
@@ -992,25 +1457,28 @@ void GUIUnitConvert::on_btn_menu_input_add_clicked()
 	}
 
 	power = txt_menu_input_power->get_text();
+	int ipower = 0;
+	if(!from_string<int>(ipower, power, std::dec)){
+		ShowMessage("Invalid Power", "The power '" + power + "' is not an integer.");
+		return;
+	}
 
 
 	/*
-	 * CHECK CURRENT "SAVED" UNITS
-	 */
-	std::string currentinputunits;
-	currentinputunits = lbl_menu_input_units->get_text();
-
-
-	/*
-	 * ADD VALUES FROM BOXES TO CURRENT UNIT LABEL AND UPDATE LABEL ON THE GUI
+	 * FOLD THE TERM INTO THE COMPILED INPUT UNITS AND UPDATE LABEL ON THE GUI
 	 */
-	if(currentinputunits == "[-]"){
-		currentinputunits = "";
-	} else {
-		currentinputunits += "|";
+	UnitErrorCode err = UNIT_OK;
+	{
+		UnitSnapshots::Reader reader(unitsnapshots);
+		err = menuinputunits.AddTerm(reader.Registry(),si,unit,ipower);
+	}
+	if(err != UNIT_OK){
+		ShowMessage("Invalid Unit", "The term '" + si + ":" + unit + ":" + power +
+				"' could not be read: " + UnitErrorString(err) + ".");
+		return;
 	}
-	currentinputunits += si + ":" + unit + ":" + power;
-	lbl_menu_input_units->set_text(currentinputunits);
+	lbl_menu_input_units->set_text(menuinputunits.Text());
+	CheckMenuDimensions();
 }
 
 
@@ -1022,6 +1490,8 @@ void GUIUnitConvert::on_btn_menu_input_clear_clicked()
 	txt_menu_input_power->set_text("1");
 	cbo_menu_input_si->set_active(0);
 	cbo_menu_input_unit->set_active(0);
+	menuinputunits.Clear();
+	CheckMenuDimensions();
 }
 
 
@@ -1032,6 +1502,8 @@ void GUIUnitConvert::on_btn_menu_output_clear_clicked()
 	txt_menu_output_power->set_text("1");
 	cbo_menu_output_si->set_active(0);
 	cbo_menu_output_unit->set_active(0);
+	menuoutputunits.Clear();
+	CheckMenuDimensions();
 }
 
 
@@ -1064,33 +1536,33 @@ void GUIUnitConvert::on_btn_menu_output_add_clicked()
 	}
 
 	power = txt_menu_output_power->get_text();
+	int ipower = 0;
+	if(!from_string<int>(ipower, power, std::dec)){
+		ShowMessage("Invalid Power", "The power '" + power + "' is not an integer.");
+		return;
+	}
 
 
 	/*
-	 * CHECK CURRENT "SAVED" UNITS
-	 */
-	std::string currentoutputunits;
-
-	currentoutputunits = lbl_menu_output_units->get_text();
-
-
-	/*
-	 * ADD VALUES FROM BOXES TO CURRENT UNIT LABEL AND UPDATE LABEL ON THE GUI
+	 * FOLD THE TERM INTO THE COMPILED OUTPUT UNITS AND UPDATE LABEL ON THE GUI
 	 */
-	if(currentoutputunits == "[-]"){
-		currentoutputunits = "";
-	} else {
-		currentoutputunits += "|";
+	UnitErrorCode err = UNIT_OK;
+	{
+		UnitSnapshots::Reader reader(unitsnapshots);
+		err = menuoutputunits.AddTerm(reader.Registry(),si,unit,ipower);
+	}
+	if(err != UNIT_OK){
+		ShowMessage("Invalid Unit", "The term '" + si + ":" + unit + ":" + power +
+				"' could not be read: " + UnitErrorString(err) + ".");
+		return;
 	}
-	currentoutputunits += si + ":" + unit + ":" + power;
-	lbl_menu_output_units->set_text(currentoutputunits);
+	lbl_menu_output_units->set_text(menuoutputunits.Text());
+	CheckMenuDimensions();
 }
 
 
 void GUIUnitConvert::on_btn_menu_convert_clicked()
 {
-	UnitConvert<double> uc;
-
 	/*
 	 * GET VALUE TO BE CONVERTED
 	 */
@@ -1105,17 +1577,21 @@ void GUIUnitConvert::on_btn_menu_convert_clicked()
 	}
 
 	/*
-	 * CHECK SPECIFIED INPUT AND OUTPUT UNITS
+	 * BUILD CONVERSION FROM THE COMPILED INPUT AND OUTPUT UNITS.  NO UNIT
+	 * STRINGS ARE PARSED HERE.
 	 */
-	std::string currentinputunits;
-	std::string currentoutputunits;
-	currentinputunits = lbl_menu_input_units->get_text();
-	currentoutputunits = lbl_menu_output_units->get_text();
-	if(currentinputunits == "[-]"){
-		currentinputunits = "x.x.0";
+	UnitPlan<double> plan;
+	UnitErrorCode err = plan.Build(menuinputunits,menuoutputunits);
+	if(err == UNIT_ERR_DIMENSION_MISMATCH){
+		ShowMessage("Dimension Mismatch", "Input units (" +
+				UnitRegistry::DimensionString(menuinputunits.Dimensions()) +
+				") cannot be converted to output units (" +
+				UnitRegistry::DimensionString(menuoutputunits.Dimensions()) + ").");
+		return;
 	}
-	if(currentoutputunits == "[-]"){
-		currentoutputunits = "z.z.0";
+	if(err != UNIT_OK){
+		ShowMessage("Invalid Conversion", UnitErrorString(err));
+		return;
 	}
 
 
@@ -1123,11 +1599,7 @@ void GUIUnitConvert::on_btn_menu_convert_clicked()
 	 * PERFORM CONVERSION
 	 */
 	double valout = 0.0e0;
-	valout = uc.ConvertUnits(val,currentinputunits,currentoutputunits);
-	/*
-	printf("%g [%s] = %g [%s]\n",val,currentinputunits.c_str(),valout,
-			currentoutputunits.c_str());
-	*/
+	valout = plan.Convert(val);
 
 	/*
 	 * PLACE RESULT INTO GUI
@@ -1141,8 +1613,6 @@ void GUIUnitConvert::on_btn_menu_convert_clicked()
 
 void GUIUnitConvert::on_btn_manual_convert_clicked()
 {
-	UnitConvert<double> uc;
-
 	/*
 	 * GET VALUE TO BE CONVERTED
 	 */
@@ -1166,14 +1636,18 @@ void GUIUnitConvert::on_btn_manual_convert_clicked()
 
 
 	/*
-	 * PERFORM CONVERSION
-	 */
-	double valout = 0.0e0;
-	valout = uc.ConvertUnits(val,currentinputunits,currentoutputunits);
-	/*
-	printf("%g [%s] = %g [%s]\n",val,currentinputunits.c_str(),valout,
-			currentoutputunits.c_str());
+	 * PERFORM CONVERSION.  ERRORS ARE REPORTED IN THE OUTPUT LABEL RATHER THAN
+	 * ON THE CONSOLE.
 	 */
+	UnitSnapshots::Reader reader(unitsnapshots);
+	UnitResult<double> result = ConvertValue<double>(reader.Registry(),val,
+			currentinputunits,currentoutputunits);
+	if(!result.Ok()){
+		lbl_manual_output->set_text(std::string("Error: ") +
+				UnitErrorString(result.Error()));
+		return;
+	}
+	double valout = result.Value();
 
 	/*
 	 * PLACE RESULT INTO GUI
@@ -1185,6 +1659,332 @@ void GUIUnitConvert::on_btn_manual_convert_clicked()
 }
 
 
+void GUIUnitConvert::on_btn_bulk_paste_clicked()
+{
+	if(bulkrunning){
+		return;
+	}
+
+	Glib::RefPtr<Gtk::Clipboard> clipboard = Gtk::Clipboard::get();
+	clipboard->request_text
+		(sigc::mem_fun(*this, &GUIUnitConvert::on_bulk_clipboard_received));
+}
+
+
+void GUIUnitConvert::on_bulk_clipboard_received(const Glib::ustring &text)
+{
+	if(bulkrunning){
+		return;
+	}
+
+	bulktext = text.raw();
+	if(bulktext.empty()){
+		ShowMessage("Bulk Input", "The clipboard does not contain any text.");
+		return;
+	}
+	StartBulkConversion();
+}
+
+
+void GUIUnitConvert::on_btn_bulk_convert_clicked()
+{
+	if(bulkrunning || bulkinput.empty()){
+		return;
+	}
+	bulktext.clear();
+	StartBulkConversion();
+}
+
+
+void GUIUnitConvert::on_btn_bulk_clear_clicked()
+{
+	if(bulkrunning){
+		return;
+	}
+
+	/*
+	 * SWAP WITH EMPTY VECTORS TO RELEASE THE MEMORY
+	 */
+	std::vector<double>().swap(bulkinput);
+	std::vector<double>().swap(bulkoutput);
+	bulkerrors.Reset(0);
+	bulkinvalid = 0;
+	lbl_bulk_status->set_text("No values");
+	scr_bulk_results->get_adjustment()->set_upper(0.0);
+	scr_bulk_results->set_value(0.0);
+	FillBulkResults();
+}
+
+
+void GUIUnitConvert::on_scr_bulk_results_changed()
+{
+	FillBulkResults();
+}
+
+
+bool GUIUnitConvert::on_tv_bulk_results_scroll(GdkEventScroll *event)
+{
+	Gtk::Adjustment *adj = scr_bulk_results->get_adjustment();
+	double step = 3.0*adj->get_step_increment();
+	double val = adj->get_value();
+
+	if(event->direction == GDK_SCROLL_UP){
+		val -= step;
+	} else if(event->direction == GDK_SCROLL_DOWN){
+		val += step;
+	} else {
+		return false;
+	}
+
+	val = std::max(adj->get_lower(),
+			std::min(val,adj->get_upper() - adj->get_page_size()));
+	adj->set_value(val);
+	return true;
+}
+
+
+void GUIUnitConvert::on_units_entry_changed(Gtk::Entry *entry, Glib::RefPtr<Gtk::ListStore> model)
+{
+	std::string query;
+	int kinds = 0;
+	UnitSearch::CompletionQuery(entry->get_text(),query,kinds);
+	model->clear();
+	if(kinds == 0 || query.empty()){
+		return;
+	}
+
+	unitsearch.Search(query,kinds,SEARCH_SUGGESTIONS,searchresults);
+	for(size_t i=0; i<searchresults.size(); i++){
+		const UnitSearchEntry &found = unitsearch.Entry(searchresults[i].entry);
+		Gtk::TreeModel::Row row = *(model->append());
+		row[ModelColumnsSearchResults.m_col_name] = found.symbol + " (" +
+				found.description + ")";
+		row[ModelColumnsSearchResults.m_col_entry] = (int)searchresults[i].entry;
+	}
+}
+
+
+bool GUIUnitConvert::on_units_completion_selected(const Gtk::TreeModel::iterator &iter,
+		Gtk::Entry *entry)
+{
+	int idx = (*iter)[ModelColumnsSearchResults.m_col_entry];
+	entry->set_text(unitsearch.Complete(entry->get_text(),(size_t)idx));
+	entry->set_position(-1);
+	return true;
+}
+
+
+bool GUIUnitConvert::on_units_completion_match(const Glib::ustring &/*key*/,
+		const Gtk::TreeModel::const_iterator &/*iter*/)
+{
+	/* THE MODEL ONLY HOLDS THE RESULTS OF THE CURRENT SEARCH, SO EVERY ROW MATCHES */
+	return true;
+}
+
+
+void GUIUnitConvert::on_bulk_convert_done()
+{
+	bulkthread->join();
+	bulkthread = 0;
+	bulkrunning = false;
+
+	btn_bulk_paste->set_sensitive(true);
+	btn_bulk_convert->set_sensitive(true);
+	btn_bulk_clear->set_sensitive(true);
+
+	std::stringstream sstmp;
+	sstmp << bulkinput.size() << " values converted";
+	if(bulkinvalid > 0){
+		sstmp << " (" << bulkinvalid << " could not be read)";
+	}
+	size_t nfailed = bulkerrors.Count() - bulkinvalid;
+	if(nfailed > 0){
+		sstmp << " (" << nfailed << " out of range)";
+	}
+	lbl_bulk_status->set_text(sstmp.str());
+
+	scr_bulk_results->get_adjustment()->set_upper((double)bulkoutput.size());
+	scr_bulk_results->set_value(0.0);
+	FillBulkResults();
+}
+
+
+void GUIUnitConvert::StartBulkConversion()
+{
+	/*
+	 * COMPILE THE UNIT STRINGS ON THE GUI THREAD SO THAT ERRORS ARE REPORTED
+	 * BEFORE ANY WORK IS HANDED TO THE WORKER THREAD
+	 */
+	CompiledUnits unitsin;
+	CompiledUnits unitsout;
+	std::string currentinputunits = txt_bulk_input_units->get_text();
+	std::string currentoutputunits = txt_bulk_output_units->get_text();
+	UnitErrorCode err = UNIT_OK;
+	UnitErrorCode errout = UNIT_OK;
+	{
+		UnitSnapshots::Reader reader(unitsnapshots);
+		err = unitsin.Compile(reader.Registry(),currentinputunits);
+		errout = unitsout.Compile(reader.Registry(),currentoutputunits);
+	}
+	if(err != UNIT_OK){
+		ShowMessage("Invalid Unit", "The input unit string '" + currentinputunits +
+				"' could not be read: " + UnitErrorString(err) + ".");
+		return;
+	}
+	err = errout;
+	if(err != UNIT_OK){
+		ShowMessage("Invalid Unit", "The output unit string '" + currentoutputunits +
+				"' could not be read: " + UnitErrorString(err) + ".");
+		return;
+	}
+	err = bulkplan.Build(unitsin,unitsout);
+	if(err == UNIT_ERR_DIMENSION_MISMATCH){
+		ShowMessage("Dimension Mismatch", "Input units (" +
+				UnitRegistry::DimensionString(unitsin.Dimensions()) +
+				") cannot be converted to output units (" +
+				UnitRegistry::DimensionString(unitsout.Dimensions()) + ").");
+		return;
+	}
+	if(err != UNIT_OK){
+		ShowMessage("Invalid Conversion", UnitErrorString(err));
+		return;
+	}
+
+
+	/*
+	 * HAND THE BULK VARIABLES TO THE WORKER THREAD.  THEY ARE NOT TOUCHED BY
+	 * THE GUI THREAD UNTIL on_bulk_convert_done() IS CALLED.
+	 */
+	bulkrunning = true;
+	btn_bulk_paste->set_sensitive(false);
+	btn_bulk_convert->set_sensitive(false);
+	btn_bulk_clear->set_sensitive(false);
+	lbl_bulk_status->set_text("Converting...");
+	scr_bulk_results->get_adjustment()->set_upper(0.0);
+	scr_bulk_results->set_value(0.0);
+	FillBulkResults();
+
+	bulkthread = Glib::Thread::create
+		(sigc::mem_fun(*this, &GUIUnitConvert::BulkConvertThread), true);
+}
+
+
+void GUIUnitConvert::BulkConvertThread()
+{
+	if(!bulktext.empty()){
+		bulkinvalid = ParseBulkValues(bulktext,bulkinput);
+		std::string().swap(bulktext);
+	}
+
+	bulkoutput.resize(bulkinput.size());
+	if(!bulkinput.empty()){
+		bulkplan.Convert(&bulkinput[0],&bulkoutput[0],bulkinput.size(),bulkerrors);
+	} else {
+		bulkerrors.Reset(0);
+	}
+
+	bulkdone.emit();
+}
+
+
+void GUIUnitConvert::FillBulkResults()
+{
+	ListModelBulk->clear();
+	if(bulkrunning){
+		return;
+	}
+
+	size_t first = (size_t)scr_bulk_results->get_value();
+	size_t last = std::min(first + BULK_VISIBLE_ROWS, bulkoutput.size());
+	std::stringstream sstmp;
+	sstmp << std::setprecision(10);
+	for(size_t i=first; i<last; i++){
+		Gtk::TreeModel::Row row = *(ListModelBulk->append());
+
+		sstmp.str(""); sstmp << i+1;
+		row[ModelColumnsBulkResults.m_col_row] = sstmp.str();
+
+		if(bulkinput[i] != bulkinput[i]){
+			row[ModelColumnsBulkResults.m_col_input] = "(not a number)";
+			row[ModelColumnsBulkResults.m_col_output] = "";
+			continue;
+		}
+		sstmp.str(""); sstmp << bulkinput[i];
+		row[ModelColumnsBulkResults.m_col_input] = sstmp.str();
+		if(bulkerrors.Test(i)){
+			row[ModelColumnsBulkResults.m_col_output] = "(out of range)";
+			continue;
+		}
+		sstmp.str(""); sstmp << bulkoutput[i];
+		row[ModelColumnsBulkResults.m_col_output] = sstmp.str();
+	}
+}
+
+
+void GUIUnitConvert::AttachCompletion(Gtk::Entry *entry)
+{
+	/*
+	 * EACH ENTRY BOX HAS ITS OWN LIST-MODEL, REFILLED FROM THE INDEX AS THE
+	 * TEXT CHANGES.  THE COMPLETION'S OWN MATCHING IS DISABLED.
+	 */
+	Glib::RefPtr<Gtk::ListStore> model = Gtk::ListStore::create(ModelColumnsSearchResults);
+	Glib::RefPtr<Gtk::EntryCompletion> completion = Gtk::EntryCompletion::create();
+	completion->set_model(model);
+	completion->set_text_column(ModelColumnsSearchResults.m_col_name);
+	completion->set_minimum_key_length(1);
+	completion->set_match_func
+		(sigc::mem_fun(*this, &GUIUnitConvert::on_units_completion_match));
+	completion->signal_match_selected().connect
+		(sigc::bind(sigc::mem_fun(*this, &GUIUnitConvert::on_units_completion_selected),
+		entry), false);
+	entry->signal_changed().connect
+		(sigc::bind(sigc::mem_fun(*this, &GUIUnitConvert::on_units_entry_changed),
+		entry, model), false);
+	entry->set_completion(completion);
+}
+
+
+size_t GUIUnitConvert::ParseBulkValues(const std::string &text, std::vector<double> &vals)
+{
+	const char *p = text.c_str();
+	const char *pend = p + text.size();
+	size_t ninvalid = 0;
+
+	vals.clear();
+	while(p < pend){
+		/*
+		 * SKIP SEPARATORS
+		 */
+		if(*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' || *p == ',' ||
+				*p == ';'){
+			p++;
+			continue;
+		}
+
+
+		/*
+		 * READ NUMBER.  ANYTHING ELSE UP TO THE NEXT SEPARATOR IS RECORDED AS NaN.
+		 */
+		char *end = 0;
+		double val = strtod(p,&end);
+		if(end == p || (end < pend && *end != ' ' && *end != '\t' && *end != '\n' &&
+				*end != '\r' && *end != ',' && *end != ';')){
+			while(p < pend && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r' &&
+					*p != ',' && *p != ';'){
+				p++;
+			}
+			vals.push_back(std::numeric_limits<double>::quiet_NaN());
+			ninvalid++;
+			continue;
+		}
+		vals.push_back(val);
+		p = end;
+	}
+
+	return ninvalid;
+}
+
+
 void GUIUnitConvert::showreference()
 {
 	std::string title("Reference");
@@ -1192,15 +1992,38 @@ void GUIUnitConvert::showreference()
 
 	UnitConvert<float> uc;
 	msg = uc.PrintUnits();
+	{
+		UnitSnapshots::Reader reader(unitsnapshots);
+		const UnitRegistry &reg = reader.Registry();
+		if(reg.NumUnits() > reg.NumBuiltinUnits()){
+			msg += "\nSite units (" + SiteUnitsFile() + ")\n" +
+					reg.PrintUnits(reg.NumBuiltinUnits());
+		}
+	}
 
-	// SET LABELS
-	lbl_dlg_msg_title->set_text(title);
-	lbl_dlg_msg_body->set_text(msg);
+	ShowMessage(title,msg);
+}
 
-	// RUN DIALOG
-	if(dlg_msg){
-		dlg_msg->run();
+
+void GUIUnitConvert::on_mnu_reload_units_activate()
+{
+	/*
+	 * THE REGISTRY IS ONLY READ ON THIS THREAD, AND NO GUARD IS HELD HERE, SO
+	 * THE PREVIOUS REGISTRY IS FREED AS SOON AS THE NEW ONE IS PUBLISHED
+	 */
+	std::string filename = SiteUnitsFile();
+	if(!unitsnapshots.Load(filename)){
+		ShowMessage("Site Units Not Reloaded", unitsnapshots.Error() +
+				"\n\nThe previous units remain in use.");
+		return;
+	}
+	{
+		UnitSnapshots::Reader reader(unitsnapshots);
+		unitsearch.Build(reader.Registry());
 	}
+	sts_main->pop();
+	sts_main->push(filename.empty() ? "Built-in units loaded (UNITCONVERT_UNITS not set)" :
+			"Site units reloaded from " + filename);
 }
 
 
@@ -0,0 +1,436 @@
+/**
+ * @file Quantity.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Compile-time unit safety for numerical code.  A Quantity<T, Dim, Scale>
+ * holds a single value of type T.  Its dimension (Dim) and the factor from its
+ * units to the coherent SI unit (Scale) are template parameters, so a
+ * Quantity occupies exactly sizeof(T) and carries no run-time unit
+ * information.
+ *
+ * 	-	Adding, subtracting, or comparing quantities of different dimensions
+ * 		does not compile.
+ * 	-	Multiplying and dividing quantities composes the dimensions and the
+ * 		scales at compile time; the values are multiplied as they are.
+ * 	-	Converting to other units of the same dimension multiplies by the
+ * 		ratio of the scales, which is a compile-time constant.  Converting
+ * 		between types with equal scales (e.g. N*m and J) multiplies by 1 and
+ * 		is removed by the compiler.
+ *
+ * With optimization enabled, code using Quantity compiles to the same
+ * instructions as the equivalent code using T directly.  The script
+ * check/quantity.sh compares the disassembly of kernels written both ways and
+ * checks that a set of dimension mistakes fail to compile.
+ *
+ * Units are taken from the registry's definitions: QUANTITY_UNITS lists, for
+ * each unit type Q_<name>, the unit string, the factor, and the dimension
+ * exponents.  UnitVerify::CheckQuantities() compiles each unit string with the
+ * registry and checks that the factor and dimension agree, so the two cannot
+ * drift apart.  Units with an offset (degrees C and F) are not provided, since
+ * a product of such values has no meaning; temperatures are in kelvins.
+ *
+ * Example:
+ *
+ * 		QuantityOf<Q_lbf> force(150.0);
+ * 		QuantityOf<Q_in> side(2.0);
+ * 		QuantityOf<Q_kPa> pressure = force/(side*side);
+ * 		double p = pressure.Value();	// 258.55...
+ *
+ * This file does not depend on the rest of the library and may be included in
+ * any number of translation units.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- Added check/quantity.sh.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef Quantity_
+#define Quantity_
+
+#include <type_traits>
+
+
+/**
+ * @brief Exponents of the base dimensions (length, mass, time, temperature,
+ * 			amount, angle, and charge), in the order used by UnitRegistry.
+ */
+template <int L, int M, int T, int K, int N, int A, int Q>
+struct Dimension {
+	static constexpr int exponents[7] = {L, M, T, K, N, A, Q};
+};
+
+
+/**
+ * @brief Dimension of a product or quotient.
+ */
+template <class D1, class D2>
+struct DimensionProduct;
+
+template <int L1, int M1, int T1, int K1, int N1, int A1, int Q1,
+		int L2, int M2, int T2, int K2, int N2, int A2, int Q2>
+struct DimensionProduct< Dimension<L1,M1,T1,K1,N1,A1,Q1>, Dimension<L2,M2,T2,K2,N2,A2,Q2> > {
+	typedef Dimension<L1+L2,M1+M2,T1+T2,K1+K2,N1+N2,A1+A2,Q1+Q2> type;
+};
+
+template <class D1, class D2>
+struct DimensionQuotient;
+
+template <int L1, int M1, int T1, int K1, int N1, int A1, int Q1,
+		int L2, int M2, int T2, int K2, int N2, int A2, int Q2>
+struct DimensionQuotient< Dimension<L1,M1,T1,K1,N1,A1,Q1>, Dimension<L2,M2,T2,K2,N2,A2,Q2> > {
+	typedef Dimension<L1-L2,M1-M2,T1-T2,K1-K2,N1-N2,A1-A2,Q1-Q2> type;
+};
+
+/** @brief Dimension of a pure number */
+typedef Dimension<0,0,0,0,0,0,0> Dimensionless;
+
+
+/**
+ * @brief Scales: types with a constexpr factor to the coherent SI unit.
+ */
+struct ScaleOne {
+	static constexpr double factor = 1.0;
+};
+
+template <class S1, class S2>
+struct ScaleProduct {
+	static constexpr double factor = S1::factor*S2::factor;
+};
+
+template <class S1, class S2>
+struct ScaleQuotient {
+	static constexpr double factor = S1::factor/S2::factor;
+};
+
+
+/**
+ * @brief Factor converting a value with scale From to scale To.
+ */
+template <class From, class To, class T>
+struct ScaleRatio {
+	static constexpr T value = (T)(From::factor/To::factor);
+};
+
+
+
+/**
+ * @brief Value with a compile-time dimension and scale.
+ */
+template <class T, class D, class S>
+class Quantity {
+
+public:
+	typedef T value_type;
+	typedef D dimension;
+	typedef S scale;
+
+
+	/**
+	 * @brief Constructor.
+	 * @pre None.
+	 * @param val Value in the units of this type.
+	 * @post Quantity object exists.
+	 * @return None.
+	 */
+	constexpr Quantity() : value((T)0) {}
+	constexpr explicit Quantity(T val) : value(val) {}
+
+
+	/**
+	 * @brief Convert from other units of the same dimension.  Quantities of a
+	 * 			different dimension do not convert.
+	 * @pre None.
+	 * @param q Quantity to be converted.
+	 * @post Quantity object exists.
+	 * @return None.
+	 */
+	template <class S2>
+	constexpr Quantity(const Quantity<T,D,S2> &q) : value(q.Value()*ScaleRatio<S2,S,T>::value) {}
+
+
+	/**
+	 * @brief Value in the units of this type.
+	 * @pre Quantity object exists.
+	 * @post No changes to object.
+	 * @return Value.
+	 */
+	constexpr T Value() const { return value; }
+
+
+	/**
+	 * @brief Value in other units of the same dimension (e.g. q.In<Q_ft>()).
+	 * @pre Quantity object exists.
+	 * @post No changes to object.
+	 * @return Value.
+	 */
+	template <class U>
+	constexpr T In() const
+	{
+		static_assert(std::is_same<typename U::dimension,D>::value,"dimensions differ");
+		return value*ScaleRatio<S,U,T>::value;
+	}
+
+
+	/**
+	 * @brief Compound assignment.  Quantities added or subtracted are first
+	 * 			converted to the units of this type.
+	 */
+	Quantity& operator+=(const Quantity &q) { value += q.value; return *this; }
+	Quantity& operator-=(const Quantity &q) { value -= q.value; return *this; }
+	Quantity& operator*=(T k) { value *= k; return *this; }
+	Quantity& operator/=(T k) { value /= k; return *this; }
+
+
+
+protected:
+	/** @brief Value in the units of this type */
+	T value;
+
+};
+
+
+/** @brief Quantity in the units of a unit type, e.g. QuantityOf<Q_psi> */
+template <class U, class T = double>
+using QuantityOf = Quantity<T, typename U::dimension, U>;
+
+
+
+// ==== OPERATORS ==============================================================
+
+template <class T, class D, class S1, class S2>
+constexpr Quantity<T,D,S1> operator+(const Quantity<T,D,S1> &a, const Quantity<T,D,S2> &b)
+{
+	return Quantity<T,D,S1>(a.Value() + Quantity<T,D,S1>(b).Value());
+}
+
+
+template <class T, class D, class S1, class S2>
+constexpr Quantity<T,D,S1> operator-(const Quantity<T,D,S1> &a, const Quantity<T,D,S2> &b)
+{
+	return Quantity<T,D,S1>(a.Value() - Quantity<T,D,S1>(b).Value());
+}
+
+
+template <class T, class D, class S>
+constexpr Quantity<T,D,S> operator-(const Quantity<T,D,S> &a)
+{
+	return Quantity<T,D,S>(-a.Value());
+}
+
+
+template <class T, class D1, class S1, class D2, class S2>
+constexpr Quantity<T, typename DimensionProduct<D1,D2>::type, ScaleProduct<S1,S2> >
+operator*(const Quantity<T,D1,S1> &a, const Quantity<T,D2,S2> &b)
+{
+	return Quantity<T, typename DimensionProduct<D1,D2>::type, ScaleProduct<S1,S2> >(
+			a.Value()*b.Value());
+}
+
+
+template <class T, class D1, class S1, class D2, class S2>
+constexpr Quantity<T, typename DimensionQuotient<D1,D2>::type, ScaleQuotient<S1,S2> >
+operator/(const Quantity<T,D1,S1> &a, const Quantity<T,D2,S2> &b)
+{
+	return Quantity<T, typename DimensionQuotient<D1,D2>::type, ScaleQuotient<S1,S2> >(
+			a.Value()/b.Value());
+}
+
+
+template <class T, class D, class S>
+constexpr Quantity<T,D,S> operator*(const Quantity<T,D,S> &a, T k)
+{
+	return Quantity<T,D,S>(a.Value()*k);
+}
+
+
+template <class T, class D, class S>
+constexpr Quantity<T,D,S> operator*(T k, const Quantity<T,D,S> &a)
+{
+	return Quantity<T,D,S>(k*a.Value());
+}
+
+
+template <class T, class D, class S>
+constexpr Quantity<T,D,S> operator/(const Quantity<T,D,S> &a, T k)
+{
+	return Quantity<T,D,S>(a.Value()/k);
+}
+
+
+template <class T, class D, class S>
+constexpr Quantity<T, typename DimensionQuotient<Dimensionless,D>::type, ScaleQuotient<ScaleOne,S> >
+operator/(T k, const Quantity<T,D,S> &a)
+{
+	return Quantity<T, typename DimensionQuotient<Dimensionless,D>::type,
+			ScaleQuotient<ScaleOne,S> >(k/a.Value());
+}
+
+
+template <class T, class D, class S1, class S2>
+constexpr bool operator==(const Quantity<T,D,S1> &a, const Quantity<T,D,S2> &b)
+{
+	return a.Value() == Quantity<T,D,S1>(b).Value();
+}
+
+
+template <class T, class D, class S1, class S2>
+constexpr bool operator!=(const Quantity<T,D,S1> &a, const Quantity<T,D,S2> &b)
+{
+	return !(a == b);
+}
+
+
+template <class T, class D, class S1, class S2>
+constexpr bool operator<(const Quantity<T,D,S1> &a, const Quantity<T,D,S2> &b)
+{
+	return a.Value() < Quantity<T,D,S1>(b).Value();
+}
+
+
+template <class T, class D, class S1, class S2>
+constexpr bool operator>(const Quantity<T,D,S1> &a, const Quantity<T,D,S2> &b)
+{
+	return Quantity<T,D,S1>(b).Value() < a.Value();
+}
+
+
+template <class T, class D, class S1, class S2>
+constexpr bool operator<=(const Quantity<T,D,S1> &a, const Quantity<T,D,S2> &b)
+{
+	return !(b > a);
+}
+
+
+template <class T, class D, class S1, class S2>
+constexpr bool operator>=(const Quantity<T,D,S1> &a, const Quantity<T,D,S2> &b)
+{
+	return !(a < b);
+}
+
+
+
+// ==== UNITS ==================================================================
+
+/*
+ * X(name, unit string, factor to SI, L, M, T, K, N, A, Q).  FACTORS MATCH THE
+ * DEFINITIONS IN UnitRegistry.h; UnitVerify::CheckQuantities() CHECKS THEM.
+ */
+#define QUANTITY_UNITS(X) \
+	X(one,    "",               1.0,                    0, 0, 0, 0, 0, 0, 0) \
+	/* ---- LENGTH */ \
+	X(m,      "-:m:1",          1.0,                    1, 0, 0, 0, 0, 0, 0) \
+	X(km,     "k:m:1",          1.0e3,                  1, 0, 0, 0, 0, 0, 0) \
+	X(cm,     "c:m:1",          1.0e-2,                 1, 0, 0, 0, 0, 0, 0) \
+	X(mm,     "m:m:1",          1.0e-3,                 1, 0, 0, 0, 0, 0, 0) \
+	X(in,     "-:in:1",         0.0254,                 1, 0, 0, 0, 0, 0, 0) \
+	X(ft,     "-:ft:1",         0.3048,                 1, 0, 0, 0, 0, 0, 0) \
+	X(mile,   "-:mile:1",       1609.344,               1, 0, 0, 0, 0, 0, 0) \
+	X(nmi,    "-:nmi:1",        1852.0,                 1, 0, 0, 0, 0, 0, 0) \
+	/* ---- AREA AND VOLUME */ \
+	X(acre,   "-:acre:1",       4046.8564224,           2, 0, 0, 0, 0, 0, 0) \
+	X(ha,     "-:ha:1",         1.0e4,                  2, 0, 0, 0, 0, 0, 0) \
+	X(L,      "-:L:1",          1.0e-3,                 3, 0, 0, 0, 0, 0, 0) \
+	X(gal,    "-:gal:1",        3.785411784e-3,         3, 0, 0, 0, 0, 0, 0) \
+	/* ---- MASS */ \
+	X(kg,     "k:g:1",          1.0,                    0, 1, 0, 0, 0, 0, 0) \
+	X(g,      "-:g:1",          1.0e-3,                 0, 1, 0, 0, 0, 0, 0) \
+	X(lbm,    "-:lbm:1",        0.45359237,             0, 1, 0, 0, 0, 0, 0) \
+	X(slug,   "-:slug:1",       14.593902937206364,     0, 1, 0, 0, 0, 0, 0) \
+	/* ---- TIME */ \
+	X(sec,    "-:sec:1",        1.0,                    0, 0, 1, 0, 0, 0, 0) \
+	X(ms,     "m:sec:1",        1.0e-3,                 0, 0, 1, 0, 0, 0, 0) \
+	X(min,    "-:min:1",        60.0,                   0, 0, 1, 0, 0, 0, 0) \
+	X(hr,     "-:hr:1",         3600.0,                 0, 0, 1, 0, 0, 0, 0) \
+	X(day,    "-:day:1",        86400.0,                0, 0, 1, 0, 0, 0, 0) \
+	/* ---- ACCELERATION */ \
+	X(gee,    "-:gee:1",        9.80665,                1, 0,-2, 0, 0, 0, 0) \
+	/* ---- FORCE */ \
+	X(N,      "-:N:1",          1.0,                    1, 1,-2, 0, 0, 0, 0) \
+	X(kN,     "k:N:1",          1.0e3,                  1, 1,-2, 0, 0, 0, 0) \
+	X(dyn,    "-:dyn:1",        1.0e-5,                 1, 1,-2, 0, 0, 0, 0) \
+	X(lbf,    "-:lbf:1",        4.4482216152605,        1, 1,-2, 0, 0, 0, 0) \
+	/* ---- PRESSURE */ \
+	X(Pa,     "-:Pa:1",         1.0,                   -1, 1,-2, 0, 0, 0, 0) \
+	X(kPa,    "k:Pa:1",         1.0e3,                 -1, 1,-2, 0, 0, 0, 0) \
+	X(MPa,    "M:Pa:1",         1.0e6,                 -1, 1,-2, 0, 0, 0, 0) \
+	X(bar,    "-:bar:1",        1.0e5,                 -1, 1,-2, 0, 0, 0, 0) \
+	X(atm,    "-:atm:1",        101325.0,              -1, 1,-2, 0, 0, 0, 0) \
+	X(psi,    "-:psi:1",        6894.7572931683613,    -1, 1,-2, 0, 0, 0, 0) \
+	X(ksi,    "-:ksi:1",        6894757.2931683613,    -1, 1,-2, 0, 0, 0, 0) \
+	/* ---- ENERGY */ \
+	X(J,      "-:J:1",          1.0,                    2, 1,-2, 0, 0, 0, 0) \
+	X(kJ,     "k:J:1",          1.0e3,                  2, 1,-2, 0, 0, 0, 0) \
+	X(BTU,    "-:BTU:1",        1055.05585262,          2, 1,-2, 0, 0, 0, 0) \
+	X(cal,    "-:cal:1",        4.184,                  2, 1,-2, 0, 0, 0, 0) \
+	X(eV,     "-:eV:1",         1.602176634e-19,        2, 1,-2, 0, 0, 0, 0) \
+	X(ft_lbf, "-:ft_lbf:1",     1.3558179483314004,     2, 1,-2, 0, 0, 0, 0) \
+	/* ---- POWER */ \
+	X(W,      "-:W:1",          1.0,                    2, 1,-3, 0, 0, 0, 0) \
+	X(kW,     "k:W:1",          1.0e3,                  2, 1,-3, 0, 0, 0, 0) \
+	X(hp,     "-:hp:1",         745.69987158227022,     2, 1,-3, 0, 0, 0, 0) \
+	/* ---- OTHER */ \
+	X(K,      "-:K:1",          1.0,                    0, 0, 0, 1, 0, 0, 0) \
+	X(mol,    "-:mol:1",        1.0,                    0, 0, 0, 0, 1, 0, 0) \
+	X(radian, "-:radian:1",     1.0,                    0, 0, 0, 0, 0, 1, 0) \
+	X(deg,    "-:deg:1",        3.14159265358979323846/180.0, 0, 0, 0, 0, 0, 1, 0)
+
+
+/*
+ * EACH UNIT IS A SCALE CARRYING ITS DIMENSION AND UNIT STRING
+ */
+#define QUANTITY_DEFINE_UNIT(name, str, f, L, M, T, K, N, A, Q) \
+	struct Q_##name { \
+		typedef Dimension<L,M,T,K,N,A,Q> dimension; \
+		static constexpr double factor = f; \
+		static constexpr const char *units = str; \
+	};
+
+QUANTITY_UNITS(QUANTITY_DEFINE_UNIT)
+
+#undef QUANTITY_DEFINE_UNIT
+
+
+#endif /* Quantity_ */
@@ -0,0 +1,380 @@
+/**
+ * @file QuantityColumn.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Column of values sharing one set of units.  The values are held in one
+ * contiguous array and the units as a 16-bit ID interned in the registry, so
+ * a column of 100 million doubles occupies 800 MB plus a few bytes, rather
+ * than the several GB taken by storing a unit string beside every value.
+ *
+ * ConvertTo() rewrites the values in place with a single UnitPlan, which runs
+ * with OpenMP threads for large columns; the conversion is bound by memory
+ * bandwidth.  Converting to the units the column already has does nothing.
+ *
+ * Columns refer to the registry in which their units are interned, so all
+ * columns exchanged between parts of a program should share one registry.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef QuantityColumn_
+#define QuantityColumn_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "UnitCanonical.h"
+
+
+/**
+ * @brief Contiguous values with one interned unit ID.
+ */
+template <class T>
+class QuantityColumn {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre Registry exists and outlives this object.
+	 * @param reg Registry in which the units are interned.
+	 * @param n Number of values, initialized to 0.
+	 * @post QuantityColumn object exists, dimensionless until SetUnits() is
+	 * 			called.
+	 * @return None.
+	 */
+	QuantityColumn(UnitRegistry &reg, size_t n = 0);
+
+
+	/**
+	 * @brief Set the units of the values without converting them.
+	 * @pre QuantityColumn object exists.
+	 * @param units Unit string.
+	 * @post Units set if valid.
+	 * @return UNIT_OK or the reason the units are invalid (UNIT_ERR_TOO_MANY_TERMS
+	 * 			if every unit ID is in use).
+	 */
+	UnitErrorCode SetUnits(const std::string &units);
+
+
+	/**
+	 * @brief Convert the values in place.
+	 * @pre QuantityColumn object exists.
+	 * @param units Unit string to which the values are converted.
+	 * @post Values and units changed if the conversion is valid; otherwise no
+	 * 			change.
+	 * @return UNIT_OK or the reason the conversion is invalid.
+	 */
+	UnitErrorCode ConvertTo(const std::string &units);
+
+
+	/**
+	 * @brief Convert the values in place, recording non-finite results.
+	 * @pre QuantityColumn object exists.
+	 * @param units Unit string to which the values are converted.
+	 * @param errors Reference to the bitmap to contain the failed rows.
+	 * @post Values and units changed if the conversion is valid; otherwise no
+	 * 			change.
+	 * @return UNIT_OK or the reason the conversion is invalid.
+	 */
+	UnitErrorCode ConvertTo(const std::string &units, UnitErrorBitmap &errors);
+
+
+	/**
+	 * @brief Interned ID of the units.
+	 * @pre QuantityColumn object exists.
+	 * @post No changes to object.
+	 * @return Unit ID.
+	 */
+	uint16_t UnitID() const;
+
+
+	/**
+	 * @brief Unit string of the values.
+	 * @pre QuantityColumn object exists.
+	 * @post No changes to object.
+	 * @return Reference to the unit string.
+	 */
+	const std::string& Units() const;
+
+
+	/**
+	 * @brief Number of values.
+	 * @pre QuantityColumn object exists.
+	 * @post No changes to object.
+	 * @return Number of values.
+	 */
+	size_t Size() const;
+
+
+	/**
+	 * @brief Change the number of values.  New values are 0.
+	 * @pre QuantityColumn object exists.
+	 * @param n Number of values.
+	 * @post Size changed.
+	 * @return None.
+	 */
+	void Resize(size_t n);
+
+
+	/**
+	 * @brief Reserve space for values.
+	 * @pre QuantityColumn object exists.
+	 * @param n Number of values.
+	 * @post Capacity at least n.
+	 * @return None.
+	 */
+	void Reserve(size_t n);
+
+
+	/**
+	 * @brief Append a value in the units of the column.
+	 * @pre QuantityColumn object exists.
+	 * @param val Value.
+	 * @post Value appended.
+	 * @return None.
+	 */
+	void Append(T val);
+
+
+	/**
+	 * @brief Access the values.
+	 * @pre QuantityColumn object exists.
+	 * @post No changes to object.
+	 * @return Pointer to the first value.
+	 */
+	T* Data();
+	const T* Data() const;
+
+
+	/**
+	 * @brief Access one value.
+	 * @pre QuantityColumn object exists and idx < Size().
+	 * @param idx Position of the value.
+	 * @post No changes to object.
+	 * @return Reference to the value.
+	 */
+	T& operator[](size_t idx);
+	const T& operator[](size_t idx) const;
+
+
+
+protected:
+	/** @brief Registry in which the units are interned */
+	UnitRegistry *registry;
+
+	/** @brief Values */
+	std::vector<T> values;
+
+	/** @brief Interned ID of the units */
+	uint16_t unitid;
+
+
+	/**
+	 * @brief Build the plan from the current units to the given units.
+	 * @param units Output unit string.
+	 * @param plan Reference to contain the plan.
+	 * @param id Reference to contain the interned ID of the output units.
+	 * @return UNIT_OK or the reason the conversion is invalid.
+	 */
+	UnitErrorCode Prepare(const std::string &units, UnitPlan<T> &plan, uint16_t &id);
+
+};
+
+
+
+// ==== PUBLIC FUNCTIONS =======================================================
+
+template <class T>
+QuantityColumn<T>::QuantityColumn(UnitRegistry &reg, size_t n) : registry(&reg),
+		values(n,(T)0)
+{
+	unitid = registry->InternUnits("");
+}
+
+
+template <class T>
+UnitErrorCode QuantityColumn<T>::SetUnits(const std::string &units)
+{
+	CompiledUnits check;
+	UnitErrorCode err = check.Compile(*registry,units);
+	if(err != UNIT_OK){
+		return err;
+	}
+	uint16_t id = registry->InternUnits(units);
+	if(id == UNIT_NO_ID){
+		return UNIT_ERR_TOO_MANY_TERMS;
+	}
+	unitid = id;
+	return UNIT_OK;
+}
+
+
+template <class T>
+UnitErrorCode QuantityColumn<T>::ConvertTo(const std::string &units)
+{
+	UnitPlan<T> plan;
+	uint16_t id = UNIT_NO_ID;
+	UnitErrorCode err = Prepare(units,plan,id);
+	if(err != UNIT_OK || id == unitid){
+		return err;
+	}
+	plan.Convert(values.data(),values.data(),values.size());
+	unitid = id;
+	return UNIT_OK;
+}
+
+
+template <class T>
+UnitErrorCode QuantityColumn<T>::ConvertTo(const std::string &units, UnitErrorBitmap &errors)
+{
+	UnitPlan<T> plan;
+	uint16_t id = UNIT_NO_ID;
+	UnitErrorCode err = Prepare(units,plan,id);
+	if(err != UNIT_OK){
+		return err;
+	}
+	if(id == unitid){
+		errors.Reset(values.size());
+		errors.MarkNonFinite(values.data(),0,values.size());
+		return UNIT_OK;
+	}
+	plan.Convert(values.data(),values.data(),values.size(),errors);
+	unitid = id;
+	return UNIT_OK;
+}
+
+
+template <class T>
+uint16_t QuantityColumn<T>::UnitID() const
+{
+	return unitid;
+}
+
+
+template <class T>
+const std::string& QuantityColumn<T>::Units() const
+{
+	return registry->InternedUnits(unitid);
+}
+
+
+template <class T>
+size_t QuantityColumn<T>::Size() const
+{
+	return values.size();
+}
+
+
+template <class T>
+void QuantityColumn<T>::Resize(size_t n)
+{
+	values.resize(n,(T)0);
+}
+
+
+template <class T>
+void QuantityColumn<T>::Reserve(size_t n)
+{
+	values.reserve(n);
+}
+
+
+template <class T>
+void QuantityColumn<T>::Append(T val)
+{
+	values.push_back(val);
+}
+
+
+template <class T>
+T* QuantityColumn<T>::Data()
+{
+	return values.data();
+}
+
+
+template <class T>
+const T* QuantityColumn<T>::Data() const
+{
+	return values.data();
+}
+
+
+template <class T>
+T& QuantityColumn<T>::operator[](size_t idx)
+{
+	return values[idx];
+}
+
+
+template <class T>
+const T& QuantityColumn<T>::operator[](size_t idx) const
+{
+	return values[idx];
+}
+
+
+
+// ==== PROTECTED FUNCTIONS ====================================================
+
+template <class T>
+UnitErrorCode QuantityColumn<T>::Prepare(const std::string &units, UnitPlan<T> &plan,
+		uint16_t &id)
+{
+	UnitResult< UnitPlan<T> > result = UnitPlan<T>::Create(*registry,
+			registry->InternedUnits(unitid),units);
+	if(!result.Ok()){
+		return result.Error();
+	}
+	id = registry->InternUnits(units);
+	if(id == UNIT_NO_ID){
+		return UNIT_ERR_TOO_MANY_TERMS;
+	}
+	plan = result.Value();
+	return UNIT_OK;
+}
+
+
+#endif /* QuantityColumn_ */
@@ -0,0 +1,410 @@
+/**
+ * @file UnitArrow.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Unit conversion of columns in Apache Arrow IPC data.  The input (file or
+ * stream format) is memory-mapped, and each selected float64 or float32
+ * column is converted directly from the mapped values buffer into a new
+ * buffer.  All other columns, and the validity bitmaps of converted columns,
+ * are passed to the writer without being copied.  The output is written in
+ * the IPC file format.
+ *
+ * The units of a column are read from the "unit" key of its field metadata,
+ * e.g. "k:m:1|-:sec:-1".  The output field carries the same metadata with the
+ * unit replaced by the output unit string.  Columns are selected by name:
+ *
+ * 	UnitArrow arrow(reg);
+ * 	arrow.AddColumn("speed","-:mile:1|-:hr:-1");
+ * 	arrow::Status status = arrow.Convert("in.arrow","out.arrow");
+ *
+ * This class requires the Arrow C++ libraries and is only compiled into the
+ * command-line program when UNITCONVERT_WITH_ARROW is defined.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitArrow_
+#define UnitArrow_
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/api.h>
+#include "UnitPlan.h"
+
+
+/** @brief Field-metadata key holding the unit string of a column */
+#define ARROW_UNIT_KEY "unit"
+
+
+/**
+ * @brief Unit conversion of columns in Arrow IPC data.
+ */
+class UnitArrow {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre Registry exists and outlives this object.
+	 * @param reg Registry used to look up prefixes and units.
+	 * @post UnitArrow object exists with no columns selected.
+	 * @return None.
+	 */
+	UnitArrow(const UnitRegistry &reg);
+
+
+	/**
+	 * @brief Select a column to be converted.
+	 * @pre UnitArrow object exists.
+	 * @param name Column name.
+	 * @param unitsout Output unit string.
+	 * @post Column selected if the unit string is valid.
+	 * @return UNIT_OK or the reason the unit string is invalid.
+	 */
+	UnitErrorCode AddColumn(const std::string &name, const std::string &unitsout);
+
+
+	/**
+	 * @brief Convert the selected columns of an IPC file or stream.
+	 * @pre UnitArrow object exists.
+	 * @param filein Input file, in IPC file or stream format.
+	 * @param fileout Output file, written in IPC file format.
+	 * @post Output file written if successful.
+	 * @return Arrow status.  Unit errors are reported as Status::Invalid.
+	 */
+	arrow::Status Convert(const std::string &filein, const std::string &fileout);
+
+
+	/**
+	 * @brief Number of rows converted by the last call to Convert().
+	 * @pre UnitArrow object exists.
+	 * @post No changes to object.
+	 * @return Number of rows.
+	 */
+	int64_t NumRows() const;
+
+
+
+protected:
+	/**
+	 * @brief Conversion applied to one column.
+	 */
+	struct ColumnPlan {
+		/** @brief Column name */
+		std::string name;
+
+		/** @brief Output unit string */
+		std::string unitsout;
+
+		/** @brief Compiled output units */
+		CompiledUnits compiledout;
+
+		/** @brief Column index in the current schema, or -1 if not present */
+		int index;
+
+		/** @brief Double-precision plan */
+		UnitPlan<double> f64;
+
+		/** @brief Single-precision plan */
+		UnitPlan<float> f32;
+	};
+
+
+	/** @brief Registry used to look up prefixes and units */
+	const UnitRegistry &registry;
+
+	/** @brief Selected columns */
+	std::vector<ColumnPlan> columns;
+
+	/** @brief Number of rows converted */
+	int64_t nrows;
+
+
+	/**
+	 * @brief Build the plans for the selected columns and the output schema.
+	 * @pre UnitArrow object exists.
+	 * @param schema Input schema.
+	 * @param schemaout Reference to contain the output schema.
+	 * @post Plans built and column indices set.
+	 * @return Arrow status.
+	 */
+	arrow::Status Prepare(const std::shared_ptr<arrow::Schema> &schema,
+			std::shared_ptr<arrow::Schema> &schemaout);
+
+
+	/**
+	 * @brief Convert the selected columns of one record batch.
+	 * @pre Prepare() called with the schema of the batch.
+	 * @param batch Input record batch.
+	 * @param schemaout Output schema.
+	 * @return Output record batch.
+	 */
+	arrow::Result< std::shared_ptr<arrow::RecordBatch> > ConvertBatch(
+			const std::shared_ptr<arrow::RecordBatch> &batch,
+			const std::shared_ptr<arrow::Schema> &schemaout);
+
+
+	/**
+	 * @brief Convert the values of one array into a new buffer.  The validity
+	 * 			bitmap and offset are shared with the input.
+	 * @pre Array holds values of type T.
+	 * @param data Input array data.
+	 * @param plan Plan to be applied.
+	 * @return Output array.
+	 */
+	template <class T>
+	static arrow::Result< std::shared_ptr<arrow::Array> > ConvertArray(
+			const std::shared_ptr<arrow::ArrayData> &data, const UnitPlan<T> &plan);
+
+};
+
+
+
+// ==== PUBLIC FUNCTIONS =======================================================
+
+UnitArrow::UnitArrow(const UnitRegistry &reg) : registry(reg), nrows(0)
+{
+}
+
+
+UnitErrorCode UnitArrow::AddColumn(const std::string &name, const std::string &unitsout)
+{
+	ColumnPlan column;
+	UnitErrorCode err = column.compiledout.Compile(registry,unitsout);
+	if(err != UNIT_OK){
+		return err;
+	}
+	column.name = name;
+	column.unitsout = unitsout;
+	column.index = -1;
+	columns.push_back(column);
+	return UNIT_OK;
+}
+
+
+arrow::Status UnitArrow::Convert(const std::string &filein, const std::string &fileout)
+{
+	nrows = 0;
+
+	/*
+	 * MAP THE INPUT.  RECORD BATCHES READ FROM A MAPPED FILE REFERENCE THE
+	 * MAPPING RATHER THAN COPIES OF IT.
+	 */
+	std::shared_ptr<arrow::io::MemoryMappedFile> input;
+	ARROW_ASSIGN_OR_RAISE(input,arrow::io::MemoryMappedFile::Open(filein,
+			arrow::io::FileMode::READ));
+
+	std::shared_ptr<arrow::ipc::RecordBatchFileReader> filereader;
+	std::shared_ptr<arrow::ipc::RecordBatchStreamReader> streamreader;
+	std::shared_ptr<arrow::Schema> schema;
+	arrow::Result< std::shared_ptr<arrow::ipc::RecordBatchFileReader> > fileresult =
+			arrow::ipc::RecordBatchFileReader::Open(input);
+	if(fileresult.ok()){
+		filereader = *fileresult;
+		schema = filereader->schema();
+	} else {
+		ARROW_RETURN_NOT_OK(input->Seek(0));
+		ARROW_ASSIGN_OR_RAISE(streamreader,
+				arrow::ipc::RecordBatchStreamReader::Open(input));
+		schema = streamreader->schema();
+	}
+
+
+	/*
+	 * PREPARE PLANS AND OPEN THE OUTPUT
+	 */
+	std::shared_ptr<arrow::Schema> schemaout;
+	ARROW_RETURN_NOT_OK(Prepare(schema,schemaout));
+
+	std::shared_ptr<arrow::io::FileOutputStream> output;
+	ARROW_ASSIGN_OR_RAISE(output,arrow::io::FileOutputStream::Open(fileout));
+	std::shared_ptr<arrow::ipc::RecordBatchWriter> writer;
+	ARROW_ASSIGN_OR_RAISE(writer,arrow::ipc::MakeFileWriter(output,schemaout));
+
+
+	/*
+	 * CONVERT EACH RECORD BATCH
+	 */
+	std::shared_ptr<arrow::RecordBatch> batch;
+	std::shared_ptr<arrow::RecordBatch> batchout;
+	if(filereader){
+		for(int i=0; i<filereader->num_record_batches(); i++){
+			ARROW_ASSIGN_OR_RAISE(batch,filereader->ReadRecordBatch(i));
+			ARROW_ASSIGN_OR_RAISE(batchout,ConvertBatch(batch,schemaout));
+			ARROW_RETURN_NOT_OK(writer->WriteRecordBatch(*batchout));
+			nrows += batch->num_rows();
+		}
+	} else {
+		while(true){
+			ARROW_RETURN_NOT_OK(streamreader->ReadNext(&batch));
+			if(!batch){
+				break;
+			}
+			ARROW_ASSIGN_OR_RAISE(batchout,ConvertBatch(batch,schemaout));
+			ARROW_RETURN_NOT_OK(writer->WriteRecordBatch(*batchout));
+			nrows += batch->num_rows();
+		}
+	}
+
+	ARROW_RETURN_NOT_OK(writer->Close());
+	return output->Close();
+}
+
+
+int64_t UnitArrow::NumRows() const
+{
+	return nrows;
+}
+
+
+
+// ==== PROTECTED FUNCTIONS ====================================================
+
+arrow::Status UnitArrow::Prepare(const std::shared_ptr<arrow::Schema> &schema,
+		std::shared_ptr<arrow::Schema> &schemaout)
+{
+	std::vector< std::shared_ptr<arrow::Field> > fields = schema->fields();
+	for(size_t c=0; c<columns.size(); c++){
+		ColumnPlan &column = columns[c];
+
+		/*
+		 * FIND THE COLUMN AND CHECK ITS TYPE
+		 */
+		column.index = schema->GetFieldIndex(column.name);
+		if(column.index < 0){
+			return arrow::Status::KeyError("column '" + column.name +
+					"' not found (or not unique)");
+		}
+		std::shared_ptr<arrow::Field> field = fields[column.index];
+		arrow::Type::type type = field->type()->id();
+		if(type != arrow::Type::DOUBLE && type != arrow::Type::FLOAT){
+			return arrow::Status::TypeError("column '" + column.name +
+					"' is not float64 or float32");
+		}
+
+
+		/*
+		 * READ THE INPUT UNITS FROM THE FIELD METADATA AND BUILD THE PLANS
+		 */
+		std::shared_ptr<const arrow::KeyValueMetadata> metadata = field->metadata();
+		int key = metadata ? metadata->FindKey(ARROW_UNIT_KEY) : -1;
+		if(key < 0){
+			return arrow::Status::Invalid("column '" + column.name +
+					"' has no '" ARROW_UNIT_KEY "' metadata");
+		}
+		std::string unitsin = metadata->value(key);
+		CompiledUnits compiledin;
+		UnitErrorCode err = compiledin.Compile(registry,unitsin);
+		if(err == UNIT_OK){
+			err = column.f64.Build(compiledin,column.compiledout);
+		}
+		if(err == UNIT_OK){
+			err = column.f32.Build(compiledin,column.compiledout);
+		}
+		if(err != UNIT_OK){
+			return arrow::Status::Invalid("column '" + column.name + "': " +
+					unitsin + " -> " + column.unitsout + ": " + UnitErrorString(err));
+		}
+
+
+		/*
+		 * OUTPUT FIELD CARRIES THE OUTPUT UNITS
+		 */
+		std::shared_ptr<arrow::KeyValueMetadata> metadataout = metadata->Copy();
+		ARROW_RETURN_NOT_OK(metadataout->Set(ARROW_UNIT_KEY,column.unitsout));
+		fields[column.index] = field->WithMetadata(metadataout);
+	}
+
+	schemaout = arrow::schema(fields,schema->metadata());
+	return arrow::Status::OK();
+}
+
+
+arrow::Result< std::shared_ptr<arrow::RecordBatch> > UnitArrow::ConvertBatch(
+		const std::shared_ptr<arrow::RecordBatch> &batch,
+		const std::shared_ptr<arrow::Schema> &schemaout)
+{
+	/*
+	 * UNSELECTED COLUMNS ARE SHARED WITH THE INPUT BATCH
+	 */
+	std::vector< std::shared_ptr<arrow::Array> > arrays = batch->columns();
+	for(size_t c=0; c<columns.size(); c++){
+		const ColumnPlan &column = columns[c];
+		const std::shared_ptr<arrow::ArrayData> &data = arrays[column.index]->data();
+		if(data->type->id() == arrow::Type::DOUBLE){
+			ARROW_ASSIGN_OR_RAISE(arrays[column.index],ConvertArray<double>(data,column.f64));
+		} else {
+			ARROW_ASSIGN_OR_RAISE(arrays[column.index],ConvertArray<float>(data,column.f32));
+		}
+	}
+	return arrow::RecordBatch::Make(schemaout,batch->num_rows(),arrays);
+}
+
+
+template <class T>
+arrow::Result< std::shared_ptr<arrow::Array> > UnitArrow::ConvertArray(
+		const std::shared_ptr<arrow::ArrayData> &data, const UnitPlan<T> &plan)
+{
+	/*
+	 * THE NEW VALUES BUFFER KEEPS THE ARRAY OFFSET SO THAT THE VALIDITY BITMAP
+	 * CAN BE SHARED UNCHANGED.  NULL SLOTS ARE CONVERTED ALONG WITH THE REST.
+	 */
+	int64_t n = data->offset + data->length;
+	std::shared_ptr<arrow::Buffer> values;
+	ARROW_ASSIGN_OR_RAISE(values,arrow::AllocateBuffer(n*(int64_t)sizeof(T)));
+	T *out = reinterpret_cast<T*>(values->mutable_data());
+	plan.Convert(data->GetValues<T>(1),out + data->offset,(size_t)data->length);
+
+	std::vector< std::shared_ptr<arrow::Buffer> > buffers;
+	buffers.push_back(data->buffers[0]);
+	buffers.push_back(values);
+	return arrow::MakeArray(arrow::ArrayData::Make(data->type,data->length,buffers,
+			data->null_count,data->offset));
+}
+
+
+#endif /* UnitArrow_ */
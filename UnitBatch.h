@@ -0,0 +1,511 @@
+/**
+ * @file UnitBatch.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Conversion of values whose units differ from row to row (e.g. a "value,unit"
+ * table mixing "psi", "bar", and "k:Pa:1") to one set of output units.
+ * Converting row by row would compile both unit strings for every row.
+ * Instead, a batch is converted in three passes:
+ * 	-#	resolve: each row's units are looked up in a small open-addressing
+ * 		hash table; each distinct unit string is compiled into a plan once
+ * 		and the table is kept between batches (invalid strings only while
+ * 		it holds fewer than BATCH_CACHE_MAX).  Spellings of the same units
+ * 		(e.g. "k:m:1|-:s:-1" and "-:s:-1|k:m:1") share one plan, found by
+ * 		their canonical fingerprint (see CanonicalUnits),
+ * 	-#	partition: the rows are bucketed by plan with a counting (radix)
+ * 		partition, gathering the values of each plan into one contiguous
+ * 		run, and
+ * 	-#	convert: each run is converted by UnitPlan::Convert(), whose loop the
+ * 		compiler vectorizes, and the results are scattered back to their
+ * 		original rows.
+ * A batch with a single plan skips the partition.
+ *
+ * Units may be given as strings (unit strings, single symbols such as "psi" or
+ * "kPa", or conventional notation such as "km/h", see UnitNotation) or as IDs
+ * interned with UnitRegistry::InternUnits().
+ * Rows whose units are invalid or incompatible with the output units, or
+ * whose result is not finite, are set to NaN and marked in an
+ * UnitErrorBitmap.
+ *
+ * A UnitBatch object is not safe to use from several threads at once.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- Units may be given in conventional notation.
+ *
+ * @date 18 October 2026
+ *	- Invalid unit strings are not remembered once the table holds
+ *	  BATCH_CACHE_MAX strings.
+ *
+ * @date 18 October 2026
+ *	- Units are expanded by UnitNotation::Expand(); empty units are invalid.
+ *
+ * @date 18 October 2026
+ *	- Equivalent unit strings share one plan, keyed on the canonical
+ *	  fingerprint.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitBatch_
+#define UnitBatch_
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <cstring>
+#include <stdint.h>
+#include <unordered_map>
+#include "UnitCanonical.h"
+#include "UnitNotation.h"
+
+
+/** @brief Plan index of rows whose units are invalid */
+#define BATCH_NO_PLAN 0xFFFF
+
+/** @brief Plan index of interned IDs not yet resolved */
+#define BATCH_UNRESOLVED 0xFFFE
+
+/** @brief Number of unit strings remembered beyond which invalid ones are not */
+#define BATCH_CACHE_MAX 4096
+
+
+/**
+ * @brief Converter of values with per-row units to one set of output units.
+ */
+template <class T>
+class UnitBatch {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre Registry exists and outlives this object.
+	 * @param reg Registry used to compile units and look up interned IDs.
+	 * @post UnitBatch object exists.  Output units are dimensionless until
+	 * 			SetUnits() is called.
+	 * @return None.
+	 */
+	UnitBatch(const UnitRegistry &reg);
+
+
+	/**
+	 * @brief Set the output units.  Clears the resolved units.
+	 * @pre UnitBatch object exists.
+	 * @param unitsout Output unit string, symbol, or conventional notation.
+	 * @post Output units set if valid.
+	 * @return UNIT_OK or the reason the units are invalid.
+	 */
+	UnitErrorCode SetUnits(const std::string &unitsout);
+
+
+	/**
+	 * @brief Convert rows with units given as strings.
+	 * @pre UnitBatch object exists.
+	 * @param in Pointer to the values.
+	 * @param units Pointer to the units of each row.
+	 * @param out Pointer to the array to contain the converted values.  May
+	 * 			be the same as 'in'.
+	 * @param n Number of rows.
+	 * @param errors Reference to the bitmap to contain the failed rows.
+	 * @post 'out' and 'errors' filled.
+	 * @return Number of failed rows.
+	 */
+	size_t Convert(const T *in, const std::string *units, T *out, size_t n,
+			UnitErrorBitmap &errors);
+
+
+	/**
+	 * @brief Convert rows with units given as interned IDs.
+	 * @pre UnitBatch object exists.  Each ID was returned by
+	 * 			UnitRegistry::InternUnits().
+	 * @param in Pointer to the values.
+	 * @param ids Pointer to the unit ID of each row.
+	 * @param out Pointer to the array to contain the converted values.  May
+	 * 			be the same as 'in'.
+	 * @param n Number of rows.
+	 * @param errors Reference to the bitmap to contain the failed rows.
+	 * @post 'out' and 'errors' filled.
+	 * @return Number of failed rows.
+	 */
+	size_t Convert(const T *in, const uint16_t *ids, T *out, size_t n,
+			UnitErrorBitmap &errors);
+
+
+	/**
+	 * @brief Number of distinct input units resolved so far.  Equivalent
+	 * 			unit strings count once.
+	 * @pre UnitBatch object exists.
+	 * @post No changes to object.
+	 * @return Number of plans.
+	 */
+	size_t NumPlans() const;
+
+
+
+protected:
+	/**
+	 * @brief Slot of the unit hash table.
+	 */
+	struct Slot {
+		uint64_t hash;
+		std::string units;
+		uint16_t plan;
+		bool used;
+	};
+
+
+	/** @brief Registry used to compile units */
+	const UnitRegistry &registry;
+
+	/** @brief Parser for units in conventional notation */
+	UnitNotation notation;
+
+	/** @brief Output unit string */
+	std::string unitsout;
+
+	/** @brief Plan of each distinct input unit string */
+	std::vector< UnitPlan<T> > plans;
+
+	/** @brief Hash table from input unit string to plan index */
+	std::vector<Slot> table;
+
+	/** @brief Plan index of each canonical fingerprint */
+	std::unordered_map<uint64_t,uint16_t> fingerprints;
+
+	/** @brief Number of used slots */
+	size_t nused;
+
+	/** @brief Plan index of each interned ID */
+	std::vector<uint16_t> idplans;
+
+	/** @brief Plan index of each row of the current batch */
+	std::vector<uint16_t> rowplans;
+
+	/** @brief Number of rows of each plan, then the start of each bucket */
+	std::vector<size_t> buckets;
+
+	/** @brief Values gathered by plan, and their original rows */
+	std::vector<T> gathered;
+	std::vector<size_t> rows;
+
+
+	/**
+	 * @brief Plan index of a unit string, compiling it if not seen before.
+	 * @return Plan index, or BATCH_NO_PLAN.
+	 */
+	uint16_t Resolve(const char *units, size_t len);
+
+
+	/**
+	 * @brief Partition the rows by rowplans, convert, and scatter.
+	 * @return Number of failed rows.
+	 */
+	size_t Execute(const T *in, T *out, size_t n, UnitErrorBitmap &errors);
+
+
+	/**
+	 * @brief FNV-1a hash of a unit string.
+	 * @return Hash.
+	 */
+	static uint64_t Hash(const char *units, size_t len);
+
+};
+
+
+
+// ==== PUBLIC FUNCTIONS =======================================================
+
+template <class T>
+UnitBatch<T>::UnitBatch(const UnitRegistry &reg) : registry(reg), notation(reg), table(16),
+		nused(0)
+{
+	for(size_t i=0; i<table.size(); i++){
+		table[i].used = false;
+	}
+}
+
+
+template <class T>
+UnitErrorCode UnitBatch<T>::SetUnits(const std::string &units)
+{
+	std::string expanded;
+	UnitErrorCode err = notation.Expand(units,expanded);
+	if(err != UNIT_OK){
+		return err;
+	}
+	CompiledUnits check;
+	err = check.Compile(registry,expanded);
+	if(err != UNIT_OK){
+		return err;
+	}
+	unitsout = expanded;
+	plans.clear();
+	fingerprints.clear();
+	idplans.clear();
+	for(size_t i=0; i<table.size(); i++){
+		table[i].used = false;
+	}
+	nused = 0;
+	return UNIT_OK;
+}
+
+
+template <class T>
+size_t UnitBatch<T>::Convert(const T *in, const std::string *units, T *out, size_t n,
+		UnitErrorBitmap &errors)
+{
+	/*
+	 * RESOLVE EACH ROW.  ROWS OFTEN REPEAT THE PREVIOUS ROW'S UNITS.
+	 */
+	rowplans.resize(n);
+	const std::string *last = 0;
+	uint16_t lastplan = BATCH_NO_PLAN;
+	for(size_t i=0; i<n; i++){
+		if(!last || units[i] != *last){
+			last = &units[i];
+			lastplan = Resolve(units[i].data(),units[i].size());
+		}
+		rowplans[i] = lastplan;
+	}
+	return Execute(in,out,n,errors);
+}
+
+
+template <class T>
+size_t UnitBatch<T>::Convert(const T *in, const uint16_t *ids, T *out, size_t n,
+		UnitErrorBitmap &errors)
+{
+	rowplans.resize(n);
+	for(size_t i=0; i<n; i++){
+		uint16_t id = ids[i];
+		if(id >= registry.NumInterned()){
+			rowplans[i] = BATCH_NO_PLAN;
+			continue;
+		}
+		if(id >= idplans.size()){
+			idplans.resize(registry.NumInterned(),BATCH_UNRESOLVED);
+		}
+		if(idplans[id] == BATCH_UNRESOLVED){
+			const std::string &units = registry.InternedUnits(id);
+			idplans[id] = Resolve(units.data(),units.size());
+		}
+		rowplans[i] = idplans[id];
+	}
+	return Execute(in,out,n,errors);
+}
+
+
+template <class T>
+size_t UnitBatch<T>::NumPlans() const
+{
+	return plans.size();
+}
+
+
+
+// ==== PROTECTED FUNCTIONS ====================================================
+
+template <class T>
+uint16_t UnitBatch<T>::Resolve(const char *units, size_t len)
+{
+	uint64_t h = Hash(units,len);
+	size_t mask = table.size() - 1;
+	size_t s = (size_t)h & mask;
+	while(table[s].used){
+		if(table[s].hash == h && table[s].units.size() == len &&
+				std::memcmp(table[s].units.data(),units,len) == 0){
+			return table[s].plan;
+		}
+		s = (s + 1) & mask;
+	}
+
+
+	/*
+	 * NEW UNITS: COMPILE THE PLAN AND INSERT.  INVALID UNITS ARE CACHED TOO,
+	 * BUT ONCE THE TABLE IS FULL THEY ARE NOT REMEMBERED SO THAT JUNK INPUT
+	 * CANNOT GROW IT WITHOUT BOUND.  A NEW SPELLING OF UNITS ALREADY SEEN
+	 * REUSES THEIR PLAN.
+	 */
+	std::string str(units,len);
+	std::string expanded;
+	uint16_t plan = BATCH_NO_PLAN;
+	if(notation.Expand(str,expanded) == UNIT_OK){
+		CanonicalUnits canonical;
+		bool keyed = (canonical.Canonicalize(registry,expanded) == UNIT_OK);
+		std::unordered_map<uint64_t,uint16_t>::iterator it = fingerprints.end();
+		if(keyed){
+			it = fingerprints.find(canonical.Fingerprint());
+		}
+		if(it != fingerprints.end()){
+			plan = it->second;
+		} else if(plans.size() < BATCH_UNRESOLVED){
+			UnitResult< UnitPlan<T> > result = UnitPlan<T>::Create(registry,expanded,
+					unitsout);
+			if(result.Ok()){
+				plan = (uint16_t)plans.size();
+				plans.push_back(result.Value());
+				if(keyed){
+					fingerprints[canonical.Fingerprint()] = plan;
+				}
+			}
+		}
+	}
+	if(plan == BATCH_NO_PLAN && nused >= BATCH_CACHE_MAX){
+		return plan;
+	}
+	table[s].hash = h;
+	table[s].units = str;
+	table[s].plan = plan;
+	table[s].used = true;
+	nused++;
+
+
+	/*
+	 * KEEP THE TABLE AT MOST HALF FULL
+	 */
+	if(2*nused > table.size()){
+		std::vector<Slot> old;
+		old.swap(table);
+		table.resize(2*old.size());
+		for(size_t i=0; i<table.size(); i++){
+			table[i].used = false;
+		}
+		mask = table.size() - 1;
+		for(size_t i=0; i<old.size(); i++){
+			if(!old[i].used){
+				continue;
+			}
+			size_t t = (size_t)old[i].hash & mask;
+			while(table[t].used){
+				t = (t + 1) & mask;
+			}
+			table[t] = old[i];
+		}
+	}
+	return plan;
+}
+
+
+template <class T>
+size_t UnitBatch<T>::Execute(const T *in, T *out, size_t n, UnitErrorBitmap &errors)
+{
+	const T nan = std::numeric_limits<T>::quiet_NaN();
+	size_t nplans = plans.size();
+
+
+	/*
+	 * SINGLE PLAN: CONVERT DIRECTLY
+	 */
+	bool single = (n > 0);
+	for(size_t i=1; i<n && single; i++){
+		single = (rowplans[i] == rowplans[0]);
+	}
+	if(single && rowplans[0] != BATCH_NO_PLAN){
+		return plans[rowplans[0]].Convert(in,out,n,errors);
+	}
+
+
+	/*
+	 * COUNT THE ROWS OF EACH PLAN; INVALID ROWS GO IN THE LAST BUCKET
+	 */
+	buckets.assign(nplans + 2,0);
+	for(size_t i=0; i<n; i++){
+		uint16_t p = rowplans[i];
+		buckets[(p == BATCH_NO_PLAN ? nplans : p) + 1]++;
+	}
+	for(size_t b=1; b<buckets.size(); b++){
+		buckets[b] += buckets[b-1];
+	}
+
+
+	/*
+	 * GATHER EACH PLAN'S VALUES INTO A CONTIGUOUS RUN
+	 */
+	gathered.resize(n);
+	rows.resize(n);
+	std::vector<size_t> next(buckets.begin(),buckets.end() - 1);
+	for(size_t i=0; i<n; i++){
+		uint16_t p = rowplans[i];
+		size_t pos = next[p == BATCH_NO_PLAN ? nplans : p]++;
+		gathered[pos] = in[i];
+		rows[pos] = i;
+	}
+
+
+	/*
+	 * CONVERT EACH RUN, THEN SCATTER BACK TO THE ORIGINAL ROWS
+	 */
+	for(size_t p=0; p<nplans; p++){
+		size_t start = buckets[p];
+		size_t count = buckets[p+1] - start;
+		if(count > 0){
+			plans[p].Convert(&gathered[start],&gathered[start],count);
+		}
+	}
+	for(size_t pos=buckets[nplans]; pos<n; pos++){
+		gathered[pos] = nan;
+	}
+	for(size_t pos=0; pos<n; pos++){
+		out[rows[pos]] = gathered[pos];
+	}
+
+	errors.Reset(n);
+	errors.MarkNonFinite(out,0,n);
+	return errors.Count();
+}
+
+
+template <class T>
+uint64_t UnitBatch<T>::Hash(const char *units, size_t len)
+{
+	uint64_t h = 14695981039346656037ULL;
+	for(size_t i=0; i<len; i++){
+		h ^= (uint8_t)units[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+
+#endif /* UnitBatch_ */
@@ -0,0 +1,567 @@
+/**
+ * @file UnitBench.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Microbenchmarks of the conversion paths, reporting wall time together with
+ * hardware counters (cycles, instructions, and branch misses) per operation.
+ * They are run from the command line ("UnitConvert bench").  The benchmarks
+ * are:
+ * 	-#	scalar: ConvertValue() on each pair of the unit mix, which parses both
+ * 		unit strings on every call as the command-line conversion does,
+ * 	-#	parse: CompiledUnits::Compile() on each unit string of the mix,
+ * 	-#	cached: UnitPlanCache::Find() followed by a scalar conversion,
+ * 	-#	bulk: UnitPlan::Convert() over an array, and
+ * 	-#	bulk-checked: the same with the error bitmap.
+ *
+ * The bulk benchmarks convert in pieces of UNITPLAN_PARALLEL_MIN values so
+ * that they run on the calling thread, whose counters are the ones read; the
+ * results are per core.
+ *
+ * The unit mix is taken from the registry: every unit is paired with the
+ * first unit of its category (the grouping shown by PrintUnits()), with and
+ * without an SI prefix, plus compound units of the kind entered in the GUI.
+ * Logarithmic and non-linear units (dB, API, ...) are left out, so the mix measures affine
+ * conversions only.  The same run serves as the training workload of a profile-guided build
+ * (see README.md).
+ *
+ * Counters are read with perf_event_open(2), counting user-space events of the
+ * calling thread only.  Where the kernel does not permit this (e.g.
+ * perf_event_paranoid above 2, or inside some containers) only wall time is
+ * reported.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- Logarithmic units are left out of the unit mix.
+ *
+ * @date 18 October 2026
+ *	- Non-linear units are left out of the unit mix.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitBench_
+#define UnitBench_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <omp.h>
+#include "UnitCanonical.h"
+
+
+/** @brief Number of values converted per bulk sample */
+#define BENCH_BULK_VALUES 1048576
+
+/** @brief Number of samples of each benchmark; the fastest is reported */
+#define BENCH_SAMPLES 5
+
+
+/**
+ * @brief Group of hardware counters of the calling thread.
+ */
+class UnitCounters {
+
+public:
+	/**
+	 * @brief Constructor.  Opens the counters if permitted.
+	 * @pre None.
+	 * @post UnitCounters object exists.
+	 * @return None.
+	 */
+	UnitCounters();
+
+
+	/**
+	 * @brief Destructor.
+	 * @pre UnitCounters object exists.
+	 * @post Counters closed.
+	 * @return None.
+	 */
+	~UnitCounters();
+
+
+	/**
+	 * @brief Check whether the counters could be opened.
+	 * @pre UnitCounters object exists.
+	 * @post No changes to object.
+	 * @return Boolean value indicating availability.
+	 */
+	bool Available() const;
+
+
+	/**
+	 * @brief Reset and start counting.
+	 * @pre UnitCounters object exists.
+	 * @post Counters running.
+	 * @return None.
+	 */
+	void Start();
+
+
+	/**
+	 * @brief Stop counting and read the counts.
+	 * @pre UnitCounters object exists.
+	 * @param cycles Reference to contain the number of cycles.
+	 * @param instructions Reference to contain the number of instructions.
+	 * @param branchmisses Reference to contain the number of branch misses.
+	 * @post Counters stopped.
+	 * @return None.  Counts are 0 if the counters are not available.
+	 */
+	void Stop(uint64_t &cycles, uint64_t &instructions, uint64_t &branchmisses);
+
+
+
+protected:
+	/** @brief Counter descriptors: cycles (group leader), instructions, and
+	 * 			branch misses */
+	int fds[3];
+
+
+	/**
+	 * @brief Open one counter.
+	 * @return Descriptor, or -1.
+	 */
+	static int Open(uint64_t config, int group);
+
+};
+
+
+
+/**
+ * @brief Microbenchmarks of the conversion paths.
+ */
+class UnitBench {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre Registry exists and outlives this object.
+	 * @param reg Registry from which the unit mix is taken.
+	 * @post UnitBench object exists with the unit mix built.
+	 * @return None.
+	 */
+	UnitBench(const UnitRegistry &reg);
+
+
+	/**
+	 * @brief Run every benchmark.
+	 * @pre UnitBench object exists.
+	 * @param repeats Number of passes over the unit mix per sample of the
+	 * 			scalar, parse, and cached benchmarks.
+	 * @post Results appended to the report.
+	 * @return None.
+	 */
+	void Run(int repeats);
+
+
+	/**
+	 * @brief Number of unit pairs in the mix.
+	 * @pre UnitBench object exists.
+	 * @post No changes to object.
+	 * @return Number of pairs.
+	 */
+	size_t NumPairs() const;
+
+
+	/**
+	 * @brief Text of the results.
+	 * @pre UnitBench object exists.
+	 * @post No changes to object.
+	 * @return Report.
+	 */
+	std::string Report() const;
+
+
+
+protected:
+	/** @brief Registry from which the unit mix is taken */
+	const UnitRegistry &registry;
+
+	/** @brief Input and output unit strings of the mix */
+	std::vector<std::string> unitsin, unitsout;
+
+	/** @brief Hardware counters */
+	UnitCounters counters;
+
+	/** @brief Report text */
+	std::stringstream report;
+
+
+	/**
+	 * @brief Build the unit mix from the registry.
+	 * @return None.
+	 */
+	void BuildMix();
+
+
+	/**
+	 * @brief Start timing a sample.
+	 * @return Start time.
+	 */
+	double Begin();
+
+
+	/**
+	 * @brief Finish timing a sample and keep it if it is the fastest.
+	 * @param t0 Start time.
+	 * @param nops Number of operations in the sample.
+	 * @param best Array of 4 values (seconds, cycles, instructions, branch
+	 * 			misses per operation) updated if this sample is the fastest.
+	 * @return None.
+	 */
+	void End(double t0, size_t nops, double *best);
+
+
+	/**
+	 * @brief Append one line of results to the report.
+	 * @return None.
+	 */
+	void Print(const std::string &name, const double *best);
+
+};
+
+
+
+// ==== PUBLIC FUNCTIONS =======================================================
+
+UnitCounters::UnitCounters()
+{
+	fds[0] = Open(PERF_COUNT_HW_CPU_CYCLES,-1);
+	fds[1] = fds[0] < 0 ? -1 : Open(PERF_COUNT_HW_INSTRUCTIONS,fds[0]);
+	fds[2] = fds[0] < 0 ? -1 : Open(PERF_COUNT_HW_BRANCH_MISSES,fds[0]);
+	if(fds[1] < 0 || fds[2] < 0){
+		for(int i=0; i<3; i++){
+			if(fds[i] >= 0){ close(fds[i]); }
+			fds[i] = -1;
+		}
+	}
+}
+
+
+UnitCounters::~UnitCounters()
+{
+	for(int i=0; i<3; i++){
+		if(fds[i] >= 0){ close(fds[i]); }
+	}
+}
+
+
+bool UnitCounters::Available() const
+{
+	return fds[0] >= 0;
+}
+
+
+void UnitCounters::Start()
+{
+	if(fds[0] < 0){
+		return;
+	}
+	ioctl(fds[0],PERF_EVENT_IOC_RESET,PERF_IOC_FLAG_GROUP);
+	ioctl(fds[0],PERF_EVENT_IOC_ENABLE,PERF_IOC_FLAG_GROUP);
+}
+
+
+void UnitCounters::Stop(uint64_t &cycles, uint64_t &instructions, uint64_t &branchmisses)
+{
+	cycles = instructions = branchmisses = 0;
+	if(fds[0] < 0){
+		return;
+	}
+	ioctl(fds[0],PERF_EVENT_IOC_DISABLE,PERF_IOC_FLAG_GROUP);
+
+
+	/*
+	 * PERF_FORMAT_GROUP: NUMBER OF EVENTS, THEN ONE VALUE PER EVENT
+	 */
+	uint64_t buf[4] = {0,0,0,0};
+	if(read(fds[0],buf,sizeof(buf)) == (ssize_t)sizeof(buf) && buf[0] == 3){
+		cycles = buf[1];
+		instructions = buf[2];
+		branchmisses = buf[3];
+	}
+}
+
+
+UnitBench::UnitBench(const UnitRegistry &reg) : registry(reg)
+{
+	BuildMix();
+}
+
+
+void UnitBench::Run(int repeats)
+{
+	repeats = std::max(repeats,1);
+	size_t npairs = unitsin.size();
+	double sum = 0.0e0;
+	double best[4];
+
+	report << "unit mix: " << npairs << " pairs" << std::endl;
+	if(!counters.Available()){
+		report << "hardware counters not available; wall time only" << std::endl;
+	}
+	report << std::setw(14) << std::left << "benchmark" << std::right <<
+			std::setw(12) << "ns/op" << std::setw(12) << "cycles/op" <<
+			std::setw(12) << "instr/op" << std::setw(8) << "IPC" <<
+			std::setw(14) << "br-miss/op" << std::endl;
+
+
+	/*
+	 * SCALAR: PARSE BOTH UNIT STRINGS AND CONVERT, AS THE COMMAND LINE DOES
+	 */
+	best[0] = 0.0e0;
+	for(int s=0; s<BENCH_SAMPLES; s++){
+		double t0 = Begin();
+		for(int r=0; r<repeats; r++){
+			for(size_t i=0; i<npairs; i++){
+				UnitResult<double> res = ConvertValue<double>(registry,(double)(i+1),
+						unitsin[i],unitsout[i]);
+				sum += res.Value();
+			}
+		}
+		End(t0,npairs*(size_t)repeats,best);
+	}
+	Print("scalar",best);
+
+
+	/*
+	 * PARSE: COMPILE EACH UNIT STRING
+	 */
+	best[0] = 0.0e0;
+	CompiledUnits units;
+	for(int s=0; s<BENCH_SAMPLES; s++){
+		double t0 = Begin();
+		for(int r=0; r<repeats; r++){
+			for(size_t i=0; i<npairs; i++){
+				units.Compile(registry,unitsin[i]);
+				sum += units.Factor();
+			}
+		}
+		End(t0,npairs*(size_t)repeats,best);
+	}
+	Print("parse",best);
+
+
+	/*
+	 * CACHED: LOOK UP THE PLAN BY FINGERPRINT, THEN CONVERT
+	 */
+	best[0] = 0.0e0;
+	UnitPlanCache<double> cache(registry);
+	UnitPlan<double> plan;
+	for(size_t i=0; i<npairs; i++){
+		cache.Find(unitsin[i],unitsout[i],plan);
+	}
+	for(int s=0; s<BENCH_SAMPLES; s++){
+		double t0 = Begin();
+		for(int r=0; r<repeats; r++){
+			for(size_t i=0; i<npairs; i++){
+				cache.Find(unitsin[i],unitsout[i],plan);
+				sum += plan.Convert((double)(i+1));
+			}
+		}
+		End(t0,npairs*(size_t)repeats,best);
+	}
+	Print("cached",best);
+
+
+	/*
+	 * BULK: ONE PLAN OVER AN ARRAY, WITH AND WITHOUT THE ERROR BITMAP.  THE
+	 * PIECES STAY BELOW THE SIZE AT WHICH THE PLAN STARTS OpenMP THREADS.
+	 */
+	const size_t piece = UNITPLAN_PARALLEL_MIN;
+	std::vector<double> in(BENCH_BULK_VALUES);
+	std::vector<double> out(BENCH_BULK_VALUES);
+	for(size_t i=0; i<in.size(); i++){
+		in[i] = (double)i*0.5e0;
+	}
+	plan = UnitPlan<double>::Create(registry,"k:m:1|-:sec:-1","-:mile:1|-:hr:-1").Value();
+
+	best[0] = 0.0e0;
+	for(int s=0; s<BENCH_SAMPLES; s++){
+		double t0 = Begin();
+		for(size_t i=0; i<in.size(); i+=piece){
+			plan.Convert(&in[i],&out[i],std::min(piece,in.size() - i));
+		}
+		End(t0,in.size(),best);
+		sum += out[s];
+	}
+	Print("bulk",best);
+
+	best[0] = 0.0e0;
+	UnitErrorBitmap errors;
+	for(int s=0; s<BENCH_SAMPLES; s++){
+		double t0 = Begin();
+		for(size_t i=0; i<in.size(); i+=piece){
+			sum += (double)plan.Convert(&in[i],&out[i],std::min(piece,in.size() - i),errors);
+		}
+		End(t0,in.size(),best);
+		sum += out[s];
+	}
+	Print("bulk-checked",best);
+
+	volatile double sink = sum;
+	(void)sink;
+}
+
+
+size_t UnitBench::NumPairs() const
+{
+	return unitsin.size();
+}
+
+
+std::string UnitBench::Report() const
+{
+	return report.str();
+}
+
+
+
+// ==== PROTECTED FUNCTIONS ====================================================
+
+int UnitCounters::Open(uint64_t config, int group)
+{
+	struct perf_event_attr attr;
+	std::memset(&attr,0,sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = config;
+	attr.disabled = (group < 0) ? 1 : 0;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP;
+	return (int)syscall(__NR_perf_event_open,&attr,0,-1,group,0);
+}
+
+
+void UnitBench::BuildMix()
+{
+	/*
+	 * EACH UNIT TO THE FIRST UNIT OF ITS CATEGORY, PLAIN AND WITH A PREFIX.
+	 * UNITS WITH AN OFFSET (TEMPERATURES) ARE NOT GIVEN A PREFIX.
+	 */
+	std::map<std::string,size_t> first;
+	for(size_t i=0; i<registry.NumUnits(); i++){
+		const UnitDefinition &def = registry.Unit(i);
+		if(def.logscale != 0.0e0 || def.curve != 0){
+			continue;
+		}
+		std::map<std::string,size_t>::iterator it = first.find(def.category);
+		if(it == first.end()){
+			first[def.category] = i;
+			continue;
+		}
+		std::string target = "-:" + registry.Unit(it->second).symbol + ":1";
+		unitsin.push_back("-:" + def.symbol + ":1");
+		unitsout.push_back(target);
+		if(def.offset == 0.0e0){
+			unitsin.push_back("k:" + def.symbol + ":1");
+			unitsout.push_back(target);
+		}
+	}
+
+
+	/*
+	 * COMPOUND UNITS AS ASSEMBLED BY THE GUI
+	 */
+	static const char *compound[][2] = {
+		{"k:m:1|-:sec:-1", "-:mile:1|-:hr:-1"},
+		{"-:lbf:1|-:in:-2", "k:Pa:1"},
+		{"k:g:1|-:m:1|-:sec:-2", "-:lbf:1"},
+		{"-:ft:1|-:lbf:1", "-:J:1"},
+		{"k:g:1|-:m:-3", "-:lbm:1|-:ft:-3"},
+		{"-:W:1|-:m:-2", "-:W:1|c:m:-2"}
+	};
+	for(size_t i=0; i<sizeof(compound)/sizeof(compound[0]); i++){
+		unitsin.push_back(compound[i][0]);
+		unitsout.push_back(compound[i][1]);
+	}
+}
+
+
+double UnitBench::Begin()
+{
+	double t0 = omp_get_wtime();
+	counters.Start();
+	return t0;
+}
+
+
+void UnitBench::End(double t0, size_t nops, double *best)
+{
+	uint64_t cycles, instructions, branchmisses;
+	counters.Stop(cycles,instructions,branchmisses);
+	double t = (omp_get_wtime() - t0)/(double)nops;
+	if(best[0] == 0.0e0 || t < best[0]){
+		best[0] = t;
+		best[1] = (double)cycles/(double)nops;
+		best[2] = (double)instructions/(double)nops;
+		best[3] = (double)branchmisses/(double)nops;
+	}
+}
+
+
+void UnitBench::Print(const std::string &name, const double *best)
+{
+	report << std::setw(14) << std::left << name << std::right << std::fixed <<
+			std::setprecision(2) << std::setw(12) << best[0]*1.0e9;
+	if(counters.Available()){
+		report << std::setw(12) << best[1] << std::setw(12) << best[2] <<
+				std::setw(8) << (best[1] > 0.0e0 ? best[2]/best[1] : 0.0e0) <<
+				std::setw(14) << std::setprecision(4) << best[3];
+	}
+	report << std::defaultfloat << std::endl;
+}
+
+
+#endif /* UnitBench_ */
@@ -0,0 +1,682 @@
+/**
+ * @file UnitCanonical.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * These classes reduce unit strings to a canonical form so that equivalent
+ * strings can be recognized without comparing text.  Canonicalization:
+ * 	-#	resolves aliases to the registered unit symbol,
+ * 	-#	merges repeated units by summing their powers,
+ * 	-#	drops units whose net power is zero,
+ * 	-#	folds all SI prefixes into a single power-of-ten exponent, and
+ * 	-#	sorts the remaining units by symbol.
+ *
+ * Thus "k:m:1|-:s:-1" and "-:s:-1|k:m:1" have the same canonical form, as do
+ * "-:m:1|-:s:-1" and "-:m:1|-:s:-1|k:-:0".  Strings which CompiledUnits
+ * accepts but UnitPlan::Build() rejects, such as "-:dB:1|-:m:1|-:m:-1" or
+ * "-:API:1|-:m:1|-:m:-1", are rejected here with the same error rather than merged into a valid key.  The canonical form is hashed
+ * (64-bit FNV-1a) into a fingerprint which is stable across runs and platforms
+ * and can be used as a cache or deduplication key.
+ *
+ * UnitPlanCache uses fingerprints to share one UnitPlan between all spellings
+ * of the same pair of units.  UnitRegistry::InternUnits() is defined here, so
+ * that equivalent unit strings share one interned ID.
+ *
+ * All functions contained within these classes are intended for use with the
+ * GNU C++ compiler (g++).  Use with other compilers may produce unexpected
+ * results and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *	- Functions return UnitErrorCode rather than bool.
+ *	- Terms are split at '|' before looking for ':'.  A trailing '|' is
+ *	  rejected, as in CompiledUnits.  Powers limited to UNIT_MAX_POWER.
+ *
+ * @date 18 October 2026
+ *	- Canonicalize() rejects a logarithmic unit that is not the sole
+ *	  unprefixed term raised to the first power, since merging terms could
+ *	  otherwise turn an invalid string into the key of a valid one.
+ *	  UnitPlanCache stores nothing for a string that does not compile.
+ *
+ * @date 18 October 2026
+ *	- Canonicalize() rejects a non-linear (curve) unit under the same rule,
+ *	  with UNIT_ERR_CURVE_MISUSE.
+ *
+ * @date 18 October 2026
+ *	- UnitRegistry::InternUnits() moved here and keyed on the fingerprint.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitCanonical_
+#define UnitCanonical_
+
+#include <string>
+#include <sstream>
+#include <cstdlib>
+#include <stdint.h>
+#include <utility>
+#include <map>
+#include <unordered_map>
+#include "UnitPlan.h"
+
+
+/** @brief Maximum number of distinct units in a canonical unit string */
+#define CANONICAL_MAX_TERMS 16
+
+
+/**
+ * @brief Canonical form and fingerprint of a unit string.
+ */
+class CanonicalUnits {
+
+public:
+	/**
+	 * @brief Constructor.  The new object represents a dimensionless unit.
+	 * @pre None.
+	 * @post CanonicalUnits object exists.
+	 * @return None.
+	 */
+	CanonicalUnits();
+
+
+	/**
+	 * @brief Reset to a dimensionless unit.
+	 * @pre CanonicalUnits object exists.
+	 * @post All units removed.
+	 * @return None.
+	 */
+	void Clear();
+
+
+	/**
+	 * @brief Reduce a unit string to canonical form.
+	 * @pre CanonicalUnits object exists.
+	 * @param reg Registry used to look up prefixes and units.
+	 * @param units Unit string of the form "si:unit:power|si:unit:power|...".
+	 * @post Object contains the canonical form if the string is valid.  Object
+	 * 			is cleared otherwise.
+	 * @return UNIT_OK or the reason the string is invalid.
+	 */
+	UnitErrorCode Canonicalize(const UnitRegistry &reg, const std::string &units);
+
+
+	/**
+	 * @brief Canonical key.  Equivalent unit strings produce identical keys.
+	 * 			The key is not itself a unit string.
+	 * @pre CanonicalUnits object exists.
+	 * @post No changes to object.
+	 * @return Key such as "e3|m:1|sec:-1".
+	 */
+	std::string Key() const;
+
+
+	/**
+	 * @brief 64-bit fingerprint of the canonical key.
+	 * @pre CanonicalUnits object exists.
+	 * @post No changes to object.
+	 * @return Fingerprint.
+	 */
+	uint64_t Fingerprint() const;
+
+
+	/**
+	 * @brief Power-of-ten exponent accumulated from all SI prefixes.
+	 * @pre CanonicalUnits object exists.
+	 * @post No changes to object.
+	 * @return Exponent.
+	 */
+	int DecimalExponent() const;
+
+
+	/**
+	 * @brief Number of distinct units remaining after canonicalization.
+	 * @pre CanonicalUnits object exists.
+	 * @post No changes to object.
+	 * @return Number of units.
+	 */
+	int NumTerms() const;
+
+
+	/**
+	 * @brief Compute the 64-bit FNV-1a hash of a block of bytes.
+	 * @pre None.
+	 * @param data Pointer to the bytes.
+	 * @param n Number of bytes.
+	 * @param hash Hash of any preceding bytes.
+	 * @post No changes.
+	 * @return Hash.
+	 */
+	static uint64_t FNV1a(const char *data, size_t n,
+			uint64_t hash = 14695981039346656037ULL);
+
+
+
+protected:
+	/**
+	 * @brief Fold a single unit into the sorted list of units.
+	 * @pre CanonicalUnits object exists.
+	 * @param def Unit definition.
+	 * @param power Power of the unit.
+	 * @post Unit merged with an existing entry or inserted in sorted order.
+	 * @return Boolean value indicating success (false if too many units).
+	 */
+	bool Merge(const UnitDefinition *def, int power);
+
+
+	/** @brief Units remaining after canonicalization, sorted by symbol */
+	const UnitDefinition *units[CANONICAL_MAX_TERMS];
+
+	/** @brief Net power of each unit */
+	int powers[CANONICAL_MAX_TERMS];
+
+	/** @brief Number of units */
+	int nterms;
+
+	/** @brief Power-of-ten exponent accumulated from all SI prefixes */
+	int decexp;
+
+	/** @brief Indicator that the unit string retains an offset (a single
+	 * offset unit raised to the first power) */
+	bool affine;
+
+	/** @brief Fingerprint of the canonical key */
+	uint64_t fingerprint;
+
+};
+
+
+
+/**
+ * @brief Cache of UnitPlan objects keyed on the fingerprints of the input and
+ * 			output units.
+ */
+template <class T>
+class UnitPlanCache {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre None.
+	 * @param reg Registry used to compile unit strings.  Must remain valid for
+	 * 			the life of the cache.
+	 * @post UnitPlanCache object exists and is empty.
+	 * @return None.
+	 */
+	UnitPlanCache(const UnitRegistry &reg);
+
+
+	/**
+	 * @brief Find the plan converting between two unit strings, building it
+	 * 			if no equivalent pair has been seen before.
+	 * @pre UnitPlanCache object exists.
+	 * @param unitsin Input unit string.
+	 * @param unitsout Output unit string.
+	 * @param plan Reference to the plan to be filled.
+	 * @post Cache updated.
+	 * @return UNIT_OK or the reason the plan could not be built.
+	 */
+	UnitErrorCode Find(const std::string &unitsin, const std::string &unitsout,
+			UnitPlan<T> &plan);
+
+
+	/**
+	 * @brief Fingerprint of a unit string.  Fingerprints of previously-seen
+	 * 			strings are found with a single hash lookup.
+	 * @pre UnitPlanCache object exists.
+	 * @param units Unit string.
+	 * @param fingerprint Reference to the variable to contain the fingerprint.
+	 * @post Cache updated.
+	 * @return UNIT_OK or the reason the string is invalid.
+	 */
+	UnitErrorCode Fingerprint(const std::string &units, uint64_t &fingerprint);
+
+
+	/**
+	 * @brief Number of distinct plans held.
+	 * @pre UnitPlanCache object exists.
+	 * @post No changes to object.
+	 * @return Number of plans.
+	 */
+	size_t NumPlans() const;
+
+
+	/**
+	 * @brief Remove all cached entries.
+	 * @pre UnitPlanCache object exists.
+	 * @post Cache is empty.
+	 * @return None.
+	 */
+	void Clear();
+
+
+
+protected:
+	/**
+	 * @brief Hash of a pair of fingerprints.
+	 */
+	struct PairHash {
+		size_t operator()(const std::pair<uint64_t,uint64_t> &p) const
+		{ return (size_t)(p.first ^ (p.second*0x9E3779B97F4A7C15ULL)); }
+	};
+
+	/** @brief Registry used to compile unit strings */
+	const UnitRegistry &registry;
+
+	/** @brief Fingerprints of previously-seen unit strings */
+	std::unordered_map<std::string,uint64_t> fingerprints;
+
+	/** @brief Compiled units for each fingerprint */
+	std::unordered_map<uint64_t,CompiledUnits> compiled;
+
+	/** @brief Plans for each pair of fingerprints */
+	std::unordered_map<std::pair<uint64_t,uint64_t>,UnitPlan<T>,PairHash> plans;
+
+};
+
+
+
+// ==================================================================
+// ================
+// ================    CanonicalUnits PUBLIC FUNCTIONS
+// ================
+
+// CONSTRUCTOR
+CanonicalUnits::CanonicalUnits()
+{
+	Clear();
+}
+
+
+void CanonicalUnits::Clear()
+{
+	nterms = 0;
+	decexp = 0;
+	affine = false;
+	fingerprint = FNV1a(0,0);
+}
+
+
+UnitErrorCode CanonicalUnits::Canonicalize(const UnitRegistry &reg, const std::string &units)
+{
+	Clear();
+
+	const char *p = units.c_str();
+	const char *pend = p + units.size();
+	const UnitDefinition *lastdef = 0;
+	int lastpower = 0;
+	int lastsiexp = 0;
+	int nnonzero = 0;
+	int nlogunits = 0;
+	int ncurveunits = 0;
+	std::string si;
+	std::string symbol;
+
+	if(p < pend && *(pend - 1) == '|'){
+		Clear();
+		return UNIT_ERR_SYNTAX;
+	}
+	while(p < pend){
+		/*
+		 * SPLIT TERM INTO PREFIX, UNIT, AND POWER
+		 */
+		const char *tstart = p;
+		const char *tend = tstart;
+		while(tend < pend && *tend != '|'){ tend++; }
+		const char *c1 = tstart;
+		while(c1 < tend && *c1 != ':'){ c1++; }
+		const char *c2 = (c1 < tend) ? c1 + 1 : tend;
+		while(c2 < tend && *c2 != ':'){ c2++; }
+		if(c2 >= tend){
+			Clear();
+			return UNIT_ERR_SYNTAX;
+		}
+
+		char *numend = 0;
+		long power = std::strtol(c2 + 1,&numend,10);
+		if(tend == c2 + 1 || numend != tend || power > UNIT_MAX_POWER ||
+				power < -UNIT_MAX_POWER){
+			Clear();
+			return UNIT_ERR_BAD_POWER;
+		}
+		p = tend + 1;
+
+
+		/*
+		 * TERMS RAISED TO THE ZEROTH POWER CONTRIBUTE NOTHING
+		 */
+		if(power == 0){
+			continue;
+		}
+
+
+		/*
+		 * LOOK UP PREFIX AND UNIT, FOLD THE PREFIX INTO THE DECIMAL EXPONENT,
+		 * AND MERGE THE UNIT WITH ANY EARLIER OCCURRENCE
+		 */
+		int siexp = 0;
+		si.assign(tstart,c1);
+		symbol.assign(c1 + 1,c2);
+		if(!reg.FindPrefix(si,siexp)){
+			Clear();
+			return UNIT_ERR_BAD_PREFIX;
+		}
+		const UnitDefinition *def = reg.FindUnit(symbol);
+		if(!def){
+			Clear();
+			return UNIT_ERR_UNKNOWN_UNIT;
+		}
+		if(!Merge(def,(int)power)){
+			Clear();
+			return UNIT_ERR_TOO_MANY_TERMS;
+		}
+		decexp += siexp*(int)power;
+		lastdef = def;
+		lastpower = (int)power;
+		lastsiexp = siexp;
+		nnonzero++;
+		if(def->logscale != 0.0e0){
+			nlogunits++;
+		}
+		if(def->curve != 0){
+			ncurveunits++;
+		}
+	}
+
+
+	/*
+	 * A LOGARITHMIC OR NON-LINEAR UNIT MUST BE THE SOLE UNPREFIXED TERM
+	 * RAISED TO THE FIRST POWER (SEE UnitPlan::Build()), WHATEVER THE OTHER
+	 * TERMS CANCEL TO
+	 */
+	bool single = (nnonzero == 1 && lastpower == 1 && lastsiexp == 0);
+	if(nlogunits > 0 && !single){
+		Clear();
+		return UNIT_ERR_LOG_MISUSE;
+	}
+	if(ncurveunits > 0 && !single){
+		Clear();
+		return UNIT_ERR_CURVE_MISUSE;
+	}
+
+
+	/*
+	 * AN OFFSET IS RETAINED ONLY FOR A SINGLE TERM RAISED TO THE FIRST POWER
+	 * (SEE CompiledUnits).  THIS CHANGES THE CONVERSION, SO IT IS PART OF THE
+	 * CANONICAL FORM.
+	 */
+	affine = (nnonzero == 1 && lastpower == 1 && lastdef->offset != 0.0e0);
+
+
+	/*
+	 * HASH THE CANONICAL KEY
+	 */
+	std::string key = Key();
+	fingerprint = FNV1a(key.c_str(),key.size());
+	return UNIT_OK;
+}
+
+
+std::string CanonicalUnits::Key() const
+{
+	std::stringstream sstmp;
+	if(decexp != 0){
+		sstmp << "e" << decexp << "|";
+	}
+	for(int i=0; i<nterms; i++){
+		sstmp << (i == 0 ? "" : "|") << units[i]->symbol << ":" << powers[i];
+	}
+	if(affine){
+		sstmp << "|@";
+	}
+	return sstmp.str();
+}
+
+
+uint64_t CanonicalUnits::Fingerprint() const
+{
+	return fingerprint;
+}
+
+
+int CanonicalUnits::DecimalExponent() const
+{
+	return decexp;
+}
+
+
+int CanonicalUnits::NumTerms() const
+{
+	return nterms;
+}
+
+
+uint64_t CanonicalUnits::FNV1a(const char *data, size_t n, uint64_t hash)
+{
+	for(size_t i=0; i<n; i++){
+		hash ^= (uint64_t)(unsigned char)data[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+
+
+// ==================================================================
+// ================
+// ================    CanonicalUnits PROTECTED FUNCTIONS
+// ================
+
+bool CanonicalUnits::Merge(const UnitDefinition *def, int power)
+{
+	/*
+	 * FIND THE SORTED POSITION OF THE UNIT.  THE LIST IS SHORT, SO A LINEAR
+	 * SCAN IS FASTER THAN ANY TREE OR HASH.
+	 */
+	int pos = 0;
+	while(pos < nterms && units[pos]->symbol < def->symbol){
+		pos++;
+	}
+
+	if(pos < nterms && units[pos] == def){
+		powers[pos] += power;
+		if(powers[pos] == 0){
+			for(int i=pos; i<nterms-1; i++){
+				units[i] = units[i+1];
+				powers[i] = powers[i+1];
+			}
+			nterms--;
+		}
+		return true;
+	}
+
+	if(nterms == CANONICAL_MAX_TERMS){
+		return false;
+	}
+	for(int i=nterms; i>pos; i--){
+		units[i] = units[i-1];
+		powers[i] = powers[i-1];
+	}
+	units[pos] = def;
+	powers[pos] = power;
+	nterms++;
+	return true;
+}
+
+
+
+// ==================================================================
+// ================
+// ================    UnitPlanCache PUBLIC FUNCTIONS
+// ================
+
+// CONSTRUCTOR
+template <class T>
+UnitPlanCache<T>::UnitPlanCache(const UnitRegistry &reg) : registry(reg)
+{
+	// NOTHING.
+}
+
+
+template <class T>
+UnitErrorCode UnitPlanCache<T>::Fingerprint(const std::string &units, uint64_t &fingerprint)
+{
+	typename std::unordered_map<std::string,uint64_t>::iterator it =
+			fingerprints.find(units);
+	if(it != fingerprints.end()){
+		fingerprint = it->second;
+		return UNIT_OK;
+	}
+
+	CanonicalUnits canonical;
+	UnitErrorCode err = canonical.Canonicalize(registry,units);
+	if(err != UNIT_OK){
+		return err;
+	}
+	fingerprint = canonical.Fingerprint();
+
+
+	/*
+	 * COMPILE THE FIRST SPELLING SEEN FOR EACH FINGERPRINT.  NOTHING IS
+	 * STORED FOR A STRING THAT DOES NOT COMPILE.
+	 */
+	if(compiled.find(fingerprint) == compiled.end()){
+		CompiledUnits cu;
+		err = cu.Compile(registry,units);
+		if(err != UNIT_OK){
+			return err;
+		}
+		compiled[fingerprint] = cu;
+	}
+	fingerprints[units] = fingerprint;
+	return UNIT_OK;
+}
+
+
+template <class T>
+UnitErrorCode UnitPlanCache<T>::Find(const std::string &unitsin, const std::string &unitsout,
+		UnitPlan<T> &plan)
+{
+	uint64_t fpin = 0;
+	uint64_t fpout = 0;
+	UnitErrorCode err = Fingerprint(unitsin,fpin);
+	if(err != UNIT_OK){
+		return err;
+	}
+	err = Fingerprint(unitsout,fpout);
+	if(err != UNIT_OK){
+		return err;
+	}
+
+	std::pair<uint64_t,uint64_t> key(fpin,fpout);
+	typename std::unordered_map<std::pair<uint64_t,uint64_t>,UnitPlan<T>,PairHash>::iterator
+		it = plans.find(key);
+	if(it != plans.end()){
+		plan = it->second;
+		return UNIT_OK;
+	}
+
+	UnitPlan<T> newplan;
+	err = newplan.Build(compiled[fpin],compiled[fpout]);
+	if(err != UNIT_OK){
+		return err;
+	}
+	plans[key] = newplan;
+	plan = newplan;
+	return UNIT_OK;
+}
+
+
+template <class T>
+size_t UnitPlanCache<T>::NumPlans() const
+{
+	return plans.size();
+}
+
+
+template <class T>
+void UnitPlanCache<T>::Clear()
+{
+	fingerprints.clear();
+	compiled.clear();
+	plans.clear();
+}
+
+
+
+
+// ==================================================================
+// ================
+// ================    UnitRegistry FUNCTIONS USING CanonicalUnits
+// ================
+
+uint16_t UnitRegistry::InternUnits(const std::string &str)
+{
+	std::map<std::string,uint16_t>::iterator it = internindex.find(str);
+	if(it != internindex.end()){
+		return it->second;
+	}
+
+
+	/*
+	 * AN EQUIVALENT SPELLING RECEIVES THE ID OF THE FIRST.  IT IS NOT ADDED
+	 * TO THE INDEX, SO THAT MANY SPELLINGS OF A FEW UNITS CANNOT GROW IT.
+	 */
+	CanonicalUnits canonical;
+	bool valid = (canonical.Canonicalize(*this,str) == UNIT_OK);
+	if(valid){
+		std::map<uint64_t,uint16_t>::iterator fit =
+				internfingerprints.find(canonical.Fingerprint());
+		if(fit != internfingerprints.end()){
+			return fit->second;
+		}
+	}
+
+	if(interned.size() >= UNIT_NO_ID){
+		return UNIT_NO_ID;
+	}
+	uint16_t id = (uint16_t)interned.size();
+	interned.push_back(str);
+	internindex[str] = id;
+	if(valid){
+		internfingerprints[canonical.Fingerprint()] = id;
+	}
+	return id;
+}
+
+
+#endif /* UnitCanonical_ */
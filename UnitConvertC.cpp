@@ -0,0 +1,242 @@
+/**
+ * @file UnitConvertC.cpp
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Implementation of the C interface declared in UnitConvertC.h.  All plans
+ * share one unit registry, which is built on first use.
+ *
+ * All functions contained within this file are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- Added uc_plan_calibrate() and conversion of integer counts.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#include <new>
+#include "UnitPlan.h"
+#include "UnitConvertC.h"
+
+
+/**
+ * @brief Plan handed out through the C interface.  Both precisions are built
+ * 			from the same compiled units.
+ */
+struct uc_plan {
+	/** @brief Double-precision plan */
+	UnitPlan<double> f64;
+
+	/** @brief Single-precision plan */
+	UnitPlan<float> f32;
+};
+
+
+/**
+ * @brief Registry shared by all plans.  Built on first use; the construction
+ * 			of a function-local static is thread-safe.
+ * @pre None.
+ * @post Registry exists.
+ * @return Reference to the registry.
+ */
+static const UnitRegistry& SharedRegistry()
+{
+	static const UnitRegistry reg;
+	return reg;
+}
+
+
+
+// ==== C INTERFACE ============================================================
+
+int uc_abi_version(void)
+{
+	return UC_ABI_VERSION;
+}
+
+
+int uc_plan_create(const char *unitsin, const char *unitsout, uc_plan **plan)
+{
+	if(!plan){
+		return UNIT_ERR_SYNTAX;
+	}
+	*plan = 0;
+	if(!unitsin || !unitsout){
+		return UNIT_ERR_SYNTAX;
+	}
+
+	const UnitRegistry &reg = SharedRegistry();
+	CompiledUnits cin;
+	CompiledUnits cout;
+	UnitErrorCode err = cin.Compile(reg,unitsin);
+	if(err != UNIT_OK){
+		return err;
+	}
+	err = cout.Compile(reg,unitsout);
+	if(err != UNIT_OK){
+		return err;
+	}
+
+	uc_plan *newplan = new(std::nothrow) uc_plan;
+	if(!newplan){
+		return UNIT_ERR_BAD_VALUE;
+	}
+	err = newplan->f64.Build(cin,cout);
+	if(err == UNIT_OK){
+		err = newplan->f32.Build(cin,cout);
+	}
+	if(err != UNIT_OK){
+		delete newplan;
+		return err;
+	}
+	*plan = newplan;
+	return UNIT_OK;
+}
+
+
+void uc_plan_free(uc_plan *plan)
+{
+	delete plan;
+}
+
+
+void uc_plan_coefficients(const uc_plan *plan, double *scale, double *offset)
+{
+	if(scale){
+		*scale = plan->f64.Scale();
+	}
+	if(offset){
+		*offset = plan->f64.Offset();
+	}
+}
+
+
+void uc_convert_f64(const uc_plan *plan, const double *in, double *out, size_t n)
+{
+	plan->f64.Convert(in,out,n);
+}
+
+
+void uc_convert_f32(const uc_plan *plan, const float *in, float *out, size_t n)
+{
+	plan->f32.Convert(in,out,n);
+}
+
+
+int uc_plan_calibrate(const uc_plan *plan, double gain, double offset,
+		uc_plan **calibrated)
+{
+	if(!calibrated){
+		return UNIT_ERR_SYNTAX;
+	}
+	*calibrated = 0;
+	if(!plan || !(gain - gain == 0.0) || !(offset - offset == 0.0)){
+		return UNIT_ERR_BAD_VALUE;
+	}
+
+	uc_plan *newplan = new(std::nothrow) uc_plan;
+	if(!newplan){
+		return UNIT_ERR_BAD_VALUE;
+	}
+	newplan->f64 = plan->f64.Calibrated(gain,offset);
+	newplan->f32 = plan->f32.Calibrated(gain,offset);
+	*calibrated = newplan;
+	return UNIT_OK;
+}
+
+
+void uc_convert_i16_f64(const uc_plan *plan, const int16_t *in, double *out, size_t n)
+{
+	plan->f64.Convert(in,out,n);
+}
+
+
+void uc_convert_i16_f32(const uc_plan *plan, const int16_t *in, float *out, size_t n)
+{
+	plan->f32.Convert(in,out,n);
+}
+
+
+void uc_convert_u16_f64(const uc_plan *plan, const uint16_t *in, double *out, size_t n)
+{
+	plan->f64.Convert(in,out,n);
+}
+
+
+void uc_convert_u16_f32(const uc_plan *plan, const uint16_t *in, float *out, size_t n)
+{
+	plan->f32.Convert(in,out,n);
+}
+
+
+void uc_convert_i32_f64(const uc_plan *plan, const int32_t *in, double *out, size_t n)
+{
+	plan->f64.Convert(in,out,n);
+}
+
+
+void uc_convert_i32_f32(const uc_plan *plan, const int32_t *in, float *out, size_t n)
+{
+	plan->f32.Convert(in,out,n);
+}
+
+
+int uc_convert_value(double val, const char *unitsin, const char *unitsout,
+		double *result)
+{
+	if(!unitsin || !unitsout || !result){
+		return UNIT_ERR_SYNTAX;
+	}
+	UnitResult<double> valout = ConvertValue<double>(SharedRegistry(),val,
+			unitsin,unitsout);
+	if(!valout.Ok()){
+		return valout.Error();
+	}
+	*result = valout.Value();
+	return UNIT_OK;
+}
+
+
+const char* uc_error_string(int code)
+{
+	return UnitErrorString((UnitErrorCode)code);
+}
@@ -0,0 +1,229 @@
+/**
+ * @file UnitConvertC.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * C interface to the unit conversion routines, for use from other languages
+ * (e.g., the Python module in python/unitconvertmodule.c).  The interface is
+ * implemented in UnitConvertC.cpp, which is compiled into a shared library:
+ *
+ * 	g++ -O2 -fopenmp -fPIC -shared UnitConvertC.cpp -o libunitconvert.so
+ *
+ * A plan is compiled once from a pair of unit strings and then applied to any
+ * number of arrays.  Plans are opaque and immutable, so a single plan may be
+ * used from several threads at once.  No function prints, throws, or exits;
+ * failures are reported as the integer values of UnitErrorCode (UnitError.h),
+ * with 0 indicating success.
+ *
+ * Array conversions may be performed in place ('in' equal to 'out').
+ * Otherwise the input and output arrays must not overlap.
+ *
+ * Raw counts from data acquisition hardware are converted by a calibrated
+ * plan (uc_plan_calibrate()) straight from int16, uint16, or int32 arrays.
+ *
+ * Functions may be added in later versions, but existing functions will not
+ * change.  UC_ABI_VERSION is incremented when functions are added.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- Version 2: added uc_plan_calibrate() and conversion of integer counts.
+ *
+ * @date 18 October 2026
+ *	- Documented uc_plan_coefficients() for logarithmic units.
+ *
+ * @date 18 October 2026
+ *	- Documented uc_plan_coefficients() for non-linear units.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitConvertC_
+#define UnitConvertC_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/** @brief Version of this interface */
+#define UC_ABI_VERSION 2
+
+
+/** @brief Compiled conversion between two unit strings */
+typedef struct uc_plan uc_plan;
+
+
+/**
+ * @brief Version of the interface implemented by the library.
+ * @pre None.
+ * @post No changes.
+ * @return UC_ABI_VERSION of the library.
+ */
+int uc_abi_version(void);
+
+
+/**
+ * @brief Compile a conversion between two unit strings.
+ * @pre None.
+ * @param unitsin Input unit string, e.g. "k:m:1|-:sec:-1".
+ * @param unitsout Output unit string.
+ * @param plan Pointer to contain the new plan.  Set to NULL on failure.
+ * @post Plan allocated on success.  Free with uc_plan_free().
+ * @return 0 on success, otherwise a UnitErrorCode.
+ */
+int uc_plan_create(const char *unitsin, const char *unitsout, uc_plan **plan);
+
+
+/**
+ * @brief Free a plan.
+ * @pre Plan created by uc_plan_create(), or NULL.
+ * @param plan Plan to be freed.
+ * @post Plan freed.
+ * @return None.
+ */
+void uc_plan_free(uc_plan *plan);
+
+
+/**
+ * @brief Scale and offset applied by a plan: out = in*scale + offset.  For a
+ * 			plan to or from a logarithmic unit (e.g. dBm) or a non-linear
+ * 			unit (e.g. API), the affine step applied before the logarithm,
+ * 			exponential, or curves.
+ * @pre Plan exists.
+ * @param plan Plan.
+ * @param scale Pointer to contain the scale.  May be NULL.
+ * @param offset Pointer to contain the offset.  May be NULL.
+ * @post No changes to plan.
+ * @return None.
+ */
+void uc_plan_coefficients(const uc_plan *plan, double *scale, double *offset);
+
+
+/**
+ * @brief Convert an array of double-precision values.
+ * @pre Plan exists.  'in' and 'out' hold n values.
+ * @param plan Plan.
+ * @param in Pointer to the values to be converted.
+ * @param out Pointer to the array to contain the converted values.
+ * @param n Number of values.
+ * @post 'out' contains the converted values.
+ * @return None.
+ */
+void uc_convert_f64(const uc_plan *plan, const double *in, double *out, size_t n);
+
+
+/**
+ * @brief Convert an array of single-precision values.
+ * @pre Plan exists.  'in' and 'out' hold n values.
+ * @param plan Plan.
+ * @param in Pointer to the values to be converted.
+ * @param out Pointer to the array to contain the converted values.
+ * @param n Number of values.
+ * @post 'out' contains the converted values.
+ * @return None.
+ */
+void uc_convert_f32(const uc_plan *plan, const float *in, float *out, size_t n);
+
+
+/**
+ * @brief Derive a plan for raw counts calibrated as in = raw*gain + offset,
+ * 			where 'in' is in the input units of 'plan'.
+ * @pre Plan exists.
+ * @param plan Plan.
+ * @param gain Input units per count.
+ * @param offset Input value at a count of 0.
+ * @param calibrated Pointer to contain the new plan.  Set to NULL on failure.
+ * @post Plan allocated on success.  Free with uc_plan_free().
+ * @return 0 on success, otherwise a UnitErrorCode.
+ */
+int uc_plan_calibrate(const uc_plan *plan, double gain, double offset,
+		uc_plan **calibrated);
+
+
+/**
+ * @brief Convert an array of integer counts, typically with a plan from
+ * 			uc_plan_calibrate().  Named uc_convert_<input>_<output>.
+ * @pre Plan exists.  'in' and 'out' hold n values.
+ * @param plan Plan.
+ * @param in Pointer to the counts to be converted.
+ * @param out Pointer to the array to contain the converted values.
+ * @param n Number of values.
+ * @post 'out' contains the converted values.
+ * @return None.
+ */
+void uc_convert_i16_f64(const uc_plan *plan, const int16_t *in, double *out, size_t n);
+void uc_convert_i16_f32(const uc_plan *plan, const int16_t *in, float *out, size_t n);
+void uc_convert_u16_f64(const uc_plan *plan, const uint16_t *in, double *out, size_t n);
+void uc_convert_u16_f32(const uc_plan *plan, const uint16_t *in, float *out, size_t n);
+void uc_convert_i32_f64(const uc_plan *plan, const int32_t *in, double *out, size_t n);
+void uc_convert_i32_f32(const uc_plan *plan, const int32_t *in, float *out, size_t n);
+
+
+/**
+ * @brief Convert a single value between two unit strings.
+ * @pre None.
+ * @param val Value to be converted.
+ * @param unitsin Input unit string.
+ * @param unitsout Output unit string.
+ * @param result Pointer to contain the converted value.
+ * @post 'result' set on success.
+ * @return 0 on success, otherwise a UnitErrorCode.
+ */
+int uc_convert_value(double val, const char *unitsin, const char *unitsout,
+		double *result);
+
+
+/**
+ * @brief Short description of an error code.
+ * @pre None.
+ * @param code Value returned by one of the functions above.
+ * @post No changes.
+ * @return Pointer to a static string.
+ */
+const char* uc_error_string(int code);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UnitConvertC_ */
@@ -0,0 +1,679 @@
+/**
+ * @file UnitCurve.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Mapping between the value of a unit and the coherent SI unit, for units
+ * which are not affine.  A UnitCurve is one of
+ *
+ * 	-	affine:			value_SI = value*a + b
+ * 	-	exponential:	value_SI = a*10^(value/b)		(dB, dBm, AWG, ...)
+ * 	-	reciprocal:		value_SI = a/(value + b)		(API gravity, Baume)
+ * 	-	table:			value_SI interpolated linearly in a table of values
+ * 						at evenly spaced unit values		(sheet metal gauge)
+ *
+ * The affine and exponential forms describe ordinary and logarithmic units,
+ * so that a plan converting to or from a reciprocal or table unit can treat
+ * the other side the same way (see UnitPlan.h).
+ *
+ * Tables are strictly monotone (increasing or decreasing) and hold at most
+ * UNITCURVE_MAX_POINTS values.  Unit values outside the table, and SI values
+ * outside its range, convert to NaN.  Converting to SI computes the interval
+ * directly from the unit value.  Converting from SI computes it from a
+ * direct index: the range of the table is cut into up to
+ * UNITCURVE_MAX_BUCKETS equal buckets, fine enough that no bucket holds more
+ * than one table value, so a bucket load and one comparison find the
+ * interval.  A table too uneven for the index falls back to a binary search
+ * of fixed length over the table padded to UNITCURVE_MAX_POINTS.  Either
+ * way every value takes the same path and a loop over an array has no
+ * branches to mispredict; where the target has gathers (e.g. -mavx2
+ * -mtune=haswell) the loops vectorize.
+ *
+ * Tables are referenced, not copied, by UnitCurve objects, so a table must
+ * outlive the curves made from it.  The built-in tables are static (see
+ * UnitRegistry.h).
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitCurve_
+#define UnitCurve_
+
+#include <cstddef>
+#include "UnitLog.h"
+
+
+/** @brief Number of steps in the binary search of a table */
+#define UNITCURVE_SEARCH_STEPS 6
+
+/** @brief Largest number of values in a table */
+#define UNITCURVE_MAX_POINTS (1 << UNITCURVE_SEARCH_STEPS)
+
+/** @brief Largest number of buckets in the direct index of a table */
+#define UNITCURVE_MAX_BUCKETS 4096
+
+
+/**
+ * @brief Form of a UnitCurve.
+ */
+enum UnitCurveForm {
+	UNITCURVE_AFFINE = 0,		/**< value_SI = value*a + b */
+	UNITCURVE_EXPONENTIAL,		/**< value_SI = a*10^(value/b) */
+	UNITCURVE_RECIPROCAL,		/**< value_SI = a/(value + b) */
+	UNITCURVE_TABLE				/**< value_SI interpolated in a table */
+};
+
+
+/**
+ * @brief Table of SI values at evenly spaced unit values.
+ */
+class UnitCurveTable {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre 2 <= n <= UNITCURVE_MAX_POINTS, and y strictly increasing or
+	 * 			strictly decreasing.
+	 * @param x0 Unit value of the first entry.
+	 * @param dx Spacing of the unit values.
+	 * @param y Pointer to the n tabulated values, in any units.
+	 * @param n Number of values.
+	 * @param factor Multiplier from the tabulated values to the coherent SI
+	 * 			unit.
+	 * @post UnitCurveTable object exists.
+	 * @return None.
+	 */
+	UnitCurveTable(double x0, double dx, const double *y, int n, double factor);
+
+
+	/**
+	 * @brief SI value of a unit value, interpolated linearly.
+	 * @pre UnitCurveTable object exists.
+	 * @param v Unit value.
+	 * @post No changes to object.
+	 * @return SI value, or NaN outside the table.
+	 */
+	double ToSI(double v) const;
+
+
+	/**
+	 * @brief Unit value of an SI value, interpolated linearly.
+	 * @pre UnitCurveTable object exists.
+	 * @param si SI value.
+	 * @post No changes to object.
+	 * @return Unit value, or NaN outside the range of the table.
+	 */
+	double FromSI(double si) const;
+
+
+	/**
+	 * @brief Convert an array of unit values to SI, in place.
+	 * @pre UnitCurveTable object exists.
+	 * @param v Pointer to the values.
+	 * @param nv Number of values.
+	 * @post No changes to object.
+	 * @return None.
+	 */
+	void ToSI(double *v, size_t nv) const;
+
+
+	/**
+	 * @brief Convert an array of SI values to unit values, in place.
+	 * @pre UnitCurveTable object exists.
+	 * @param v Pointer to the values.
+	 * @param nv Number of values.
+	 * @post No changes to object.
+	 * @return None.
+	 */
+	void FromSI(double *v, size_t nv) const;
+
+
+
+protected:
+	/**
+	 * @brief Bucket of the direct index holding a key.
+	 * @pre nbucket > 0.
+	 * @param k Key (sign*SI value).
+	 * @post No changes to object.
+	 * @return Bucket, clamped to [0, nbucket-1].
+	 */
+	int Bucket(double k) const;
+
+
+	/**
+	 * @brief Interval of a key found through the direct index.
+	 * @pre nbucket > 0.
+	 * @param k Key (sign*SI value).
+	 * @post No changes to object.
+	 * @return Largest i <= n-2 with key[i] <= k, or 0.
+	 */
+	int Lookup(double k) const;
+
+
+	/**
+	 * @brief Interval of a key found by binary search.
+	 * @pre UnitCurveTable object exists.
+	 * @param k Key (sign*SI value).
+	 * @post No changes to object.
+	 * @return Largest i <= n-2 with key[i] <= k, or 0.
+	 */
+	int Search(double k) const;
+
+
+	/**
+	 * @brief Unit value of a key in a known interval.
+	 * @pre 0 <= i <= n-2.
+	 * @param k Key (sign*SI value).
+	 * @param i Interval.
+	 * @post No changes to object.
+	 * @return Unit value, or NaN outside the range of the table.
+	 */
+	double Interpolate(double k, int i) const;
+
+
+
+	/** @brief Number of values */
+	int n;
+
+	/** @brief Unit value of the first entry */
+	double x0;
+
+	/** @brief Spacing of the unit values */
+	double dx;
+
+	/** @brief 1 for an increasing table, -1 for a decreasing table */
+	double sign;
+
+	/** @brief SI values */
+	double y[UNITCURVE_MAX_POINTS];
+
+	/** @brief sign*y, increasing, padded with +inf for the binary search */
+	double key[UNITCURVE_MAX_POINTS];
+
+	/** @brief Number of buckets in the direct index, or 0 to search */
+	int nbucket;
+
+	/** @brief Key at the start of the first bucket */
+	double kmin;
+
+	/** @brief Buckets per unit of key */
+	double kscale;
+
+	/** @brief Largest interval starting at or before each bucket */
+	int bucket[UNITCURVE_MAX_BUCKETS];
+
+};
+
+
+/**
+ * @brief Mapping between the value of a unit and the coherent SI unit.
+ */
+class UnitCurve {
+
+public:
+	/**
+	 * @brief Constructor.  The new object is the identity.
+	 * @pre None.
+	 * @post UnitCurve object exists.
+	 * @return None.
+	 */
+	UnitCurve();
+
+
+	/**
+	 * @brief Affine curve, value_SI = value*factor + offset.
+	 * @param factor Multiplier.
+	 * @param offset Offset added after scaling.
+	 * @return Curve.
+	 */
+	static UnitCurve Affine(double factor, double offset);
+
+
+	/**
+	 * @brief Exponential curve, value_SI = factor*10^(value/logscale).
+	 * @pre logscale is not 0.
+	 * @param factor SI value at a unit value of 0.
+	 * @param logscale Unit values per decade.
+	 * @return Curve.
+	 */
+	static UnitCurve Exponential(double factor, double logscale);
+
+
+	/**
+	 * @brief Reciprocal curve, value_SI = a/(value + b).
+	 * @pre a is not 0.
+	 * @param a Numerator.
+	 * @param b Added to the unit value.
+	 * @return Curve.
+	 */
+	static UnitCurve Reciprocal(double a, double b);
+
+
+	/**
+	 * @brief Curve interpolated in a table.
+	 * @pre The table outlives the curve.
+	 * @param table Pointer to the table.
+	 * @return Curve.
+	 */
+	static UnitCurve Table(const UnitCurveTable *table);
+
+
+	/**
+	 * @brief Form of the curve.
+	 * @pre UnitCurve object exists.
+	 * @post No changes to object.
+	 * @return Form.
+	 */
+	UnitCurveForm Form() const;
+
+
+	/**
+	 * @brief Convert a unit value to SI.
+	 * @pre UnitCurve object exists.
+	 * @param v Unit value.
+	 * @post No changes to object.
+	 * @return SI value, or NaN outside the domain of the curve.
+	 */
+	double ToSI(double v) const;
+
+
+	/**
+	 * @brief Convert an SI value to the unit.
+	 * @pre UnitCurve object exists.
+	 * @param si SI value.
+	 * @post No changes to object.
+	 * @return Unit value, or NaN outside the range of the curve.
+	 */
+	double FromSI(double si) const;
+
+
+	/**
+	 * @brief Convert an array of unit values to SI, in place.
+	 * @pre UnitCurve object exists.
+	 * @param v Pointer to the values.
+	 * @param n Number of values.
+	 * @post No changes to object.
+	 * @return None.
+	 */
+	void ToSI(double *v, size_t n) const;
+
+
+	/**
+	 * @brief Convert an array of SI values to the unit, in place.
+	 * @pre UnitCurve object exists.
+	 * @param v Pointer to the values.
+	 * @param n Number of values.
+	 * @post No changes to object.
+	 * @return None.
+	 */
+	void FromSI(double *v, size_t n) const;
+
+
+
+protected:
+	/** @brief Form of the curve */
+	UnitCurveForm form;
+
+	/** @brief First parameter (see UnitCurveForm) */
+	double a;
+
+	/** @brief Second parameter (see UnitCurveForm) */
+	double b;
+
+	/** @brief Table, for UNITCURVE_TABLE */
+	const UnitCurveTable *table;
+
+};
+
+
+
+// ==================================================================
+// ================
+// ================    UnitCurveTable PUBLIC FUNCTIONS
+// ================
+
+UnitCurveTable::UnitCurveTable(double x0, double dx, const double *y, int n, double factor)
+{
+	this->n = n;
+	this->x0 = x0;
+	this->dx = dx;
+	sign = (y[n-1] > y[0] ? 1.0e0 : -1.0e0);
+	for(int i=0; i<UNITCURVE_MAX_POINTS; i++){
+		this->y[i] = (i < n ? y[i]*factor : 0.0e0);
+		key[i] = (i < n ? sign*this->y[i] : UnitLogDouble(0x7FF0000000000000ULL));
+	}
+
+	/*
+	 * DIRECT INDEX: THE KEY RANGE IS CUT INTO nbucket EQUAL BUCKETS, EACH
+	 * RECORDING THE INTERVAL OF ITS SMALLEST KEY.  IT IS USED WHEN NO BUCKET
+	 * HOLDS MORE THAN ONE TABLE VALUE, SO THAT A SINGLE COMPARISON FINISHES
+	 * THE LOOKUP.  THE BUCKETS ARE FOUND WITH Bucket() ITSELF SO THAT
+	 * ROUNDING CANNOT PUT A KEY ON THE WRONG SIDE OF A BOUNDARY.
+	 */
+	kmin = key[0];
+	nbucket = 0;
+	for(int nb=16; nb<=UNITCURVE_MAX_BUCKETS && nbucket == 0; nb*=2){
+		nbucket = nb;
+		kscale = (double)nb/(key[n-1] - key[0]);
+		int j = 0;
+		for(int b=0; b<nb && nbucket > 0; b++){
+			while(j < n && Bucket(key[j]) < b){
+				j++;
+			}
+			int start = (j > 1 ? j - 1 : 0);
+			int inside = 0;
+			for(int i=start+1; i<n && Bucket(key[i]) <= b; i++){
+				inside++;
+			}
+			bucket[b] = (start < n - 2 ? start : n - 2);
+			if(inside > 1){
+				nbucket = 0;
+			}
+		}
+	}
+}
+
+
+inline double UnitCurveTable::ToSI(double v) const
+{
+	/*
+	 * INTERVAL i FROM THE UNIT VALUE: u - 1/2 ROUNDED BY ADDING 1.5*2^52,
+	 * THEN CLAMPED AS AN INTEGER TO [0, n-2] (WHICH ALSO CATCHES NaN) SO
+	 * THAT THE LOADS STAY IN THE TABLE.  AT AN INTEGER u, i MAY BE u - 1 WITH
+	 * t = 1.  VALUES OUTSIDE THE TABLE ARE REPLACED BY A QUIET NaN WITH A
+	 * MASK.  THE CONVERSION AND THE SELECTS ARE DONE ON INTEGERS BECAUSE
+	 * CONDITIONAL EXPRESSIONS ON DOUBLES ARE TURNED INTO BRANCHES.
+	 */
+	const double shift = 6755399441055744.0e0;
+	double u = (v - x0)/dx;
+	int i = (int)(UnitLogBits(u - 0.5e0 + shift) - UnitLogBits(shift));
+	i = (i > 0 ? i : 0);
+	i = (i < n - 2 ? i : n - 2);
+	double t = u - (double)i;
+	uint64_t outside = (uint64_t)0 - (uint64_t)!((u >= 0.0e0) & (u <= (double)(n - 1)));
+	return UnitLogDouble((UnitLogBits(y[i] + t*(y[i+1] - y[i])) & ~outside) |
+			(outside & 0x7FF8000000000000ULL));
+}
+
+
+inline double UnitCurveTable::FromSI(double si) const
+{
+	double k = sign*si;
+	return Interpolate(k, (nbucket > 0 ? Lookup(k) : Search(k)));
+}
+
+
+void UnitCurveTable::ToSI(double *v, size_t nv) const
+{
+	const long long nn = (long long)nv;
+#pragma omp simd
+	for(long long i=0; i<nn; i++){
+		v[i] = ToSI(v[i]);
+	}
+}
+
+
+void UnitCurveTable::FromSI(double *v, size_t nv) const
+{
+	/*
+	 * THE CHOICE OF LOOKUP IS MADE ONCE, OUTSIDE THE LOOPS
+	 */
+	const long long nn = (long long)nv;
+	const double s = sign;
+	if(nbucket > 0){
+#pragma omp simd
+		for(long long i=0; i<nn; i++){
+			double k = s*v[i];
+			v[i] = Interpolate(k, Lookup(k));
+		}
+	} else {
+#pragma omp simd
+		for(long long i=0; i<nn; i++){
+			double k = s*v[i];
+			v[i] = Interpolate(k, Search(k));
+		}
+	}
+}
+
+
+
+// ==================================================================
+// ================
+// ================    UnitCurveTable PROTECTED FUNCTIONS
+// ================
+
+inline int UnitCurveTable::Bucket(double k) const
+{
+	/*
+	 * ROUNDED AS IN ToSI() AND CLAMPED AS AN INTEGER, WHICH ALSO CATCHES NaN
+	 */
+	const double shift = 6755399441055744.0e0;
+	int b = (int)(UnitLogBits((k - kmin)*kscale - 0.5e0 + shift) - UnitLogBits(shift));
+	b = (b > 0 ? b : 0);
+	return (b < nbucket - 1 ? b : nbucket - 1);
+}
+
+
+inline int UnitCurveTable::Lookup(double k) const
+{
+	int i = bucket[Bucket(k)];
+	i += (int)(key[i+1] <= k);
+	return (i < n - 2 ? i : n - 2);
+}
+
+
+inline int UnitCurveTable::Search(double k) const
+{
+	/*
+	 * BINARY SEARCH OF FIXED LENGTH.  THE PADDING OF +inf IS NEVER <= A
+	 * FINITE k.
+	 */
+	int i = 0;
+#pragma GCC unroll 16
+	for(int s=UNITCURVE_SEARCH_STEPS-1; s>=0; s--){
+		i += (int)(key[i + (1 << s)] <= k) << s;
+	}
+	return (i < n - 2 ? i : n - 2);
+}
+
+
+inline double UnitCurveTable::Interpolate(double k, int i) const
+{
+	double t = (k - key[i])/(key[i+1] - key[i]);
+	uint64_t outside = (uint64_t)0 - (uint64_t)!((k >= key[0]) & (k <= key[n-1]));
+	return UnitLogDouble((UnitLogBits(x0 + dx*((double)i + t)) & ~outside) |
+			(outside & 0x7FF8000000000000ULL));
+}
+
+
+// ==================================================================
+// ================
+// ================    UnitCurve PUBLIC FUNCTIONS
+// ================
+
+UnitCurve::UnitCurve()
+{
+	form = UNITCURVE_AFFINE;
+	a = 1.0e0;
+	b = 0.0e0;
+	table = 0;
+}
+
+
+UnitCurve UnitCurve::Affine(double factor, double offset)
+{
+	UnitCurve curve;
+	curve.a = factor;
+	curve.b = offset;
+	return curve;
+}
+
+
+UnitCurve UnitCurve::Exponential(double factor, double logscale)
+{
+	UnitCurve curve;
+	curve.form = UNITCURVE_EXPONENTIAL;
+	curve.a = factor;
+	curve.b = logscale;
+	return curve;
+}
+
+
+UnitCurve UnitCurve::Reciprocal(double a, double b)
+{
+	UnitCurve curve;
+	curve.form = UNITCURVE_RECIPROCAL;
+	curve.a = a;
+	curve.b = b;
+	return curve;
+}
+
+
+UnitCurve UnitCurve::Table(const UnitCurveTable *table)
+{
+	UnitCurve curve;
+	curve.form = UNITCURVE_TABLE;
+	curve.table = table;
+	return curve;
+}
+
+
+UnitCurveForm UnitCurve::Form() const
+{
+	return form;
+}
+
+
+double UnitCurve::ToSI(double v) const
+{
+	switch(form){
+	case UNITCURVE_AFFINE:		return v*a + b;
+	case UNITCURVE_EXPONENTIAL:	return a*UnitExp10(v/b);
+	case UNITCURVE_RECIPROCAL:	return a/(v + b);
+	case UNITCURVE_TABLE:		return table->ToSI(v);
+	}
+	return v;
+}
+
+
+double UnitCurve::FromSI(double si) const
+{
+	switch(form){
+	case UNITCURVE_AFFINE:		return (si - b)/a;
+	case UNITCURVE_EXPONENTIAL:	return b*UnitLog10(si/a);
+	case UNITCURVE_RECIPROCAL:	return a/si - b;
+	case UNITCURVE_TABLE:		return table->FromSI(si);
+	}
+	return si;
+}
+
+
+void UnitCurve::ToSI(double *v, size_t n) const
+{
+	/*
+	 * ONE LOOP PER FORM, SO THAT EACH VECTORIZES
+	 */
+	const double pa = a;
+	const double pb = b;
+	const UnitCurveTable *tab = table;
+	const long long nn = (long long)n;
+	switch(form){
+	case UNITCURVE_AFFINE:
+#pragma omp simd
+		for(long long i=0; i<nn; i++){
+			v[i] = v[i]*pa + pb;
+		}
+		break;
+	case UNITCURVE_EXPONENTIAL:
+#pragma omp simd
+		for(long long i=0; i<nn; i++){
+			v[i] = pa*UnitExp10(v[i]/pb);
+		}
+		break;
+	case UNITCURVE_RECIPROCAL:
+#pragma omp simd
+		for(long long i=0; i<nn; i++){
+			v[i] = pa/(v[i] + pb);
+		}
+		break;
+	case UNITCURVE_TABLE:
+		tab->ToSI(v, n);
+		break;
+	}
+}
+
+
+void UnitCurve::FromSI(double *v, size_t n) const
+{
+	const double pa = a;
+	const double pb = b;
+	const UnitCurveTable *tab = table;
+	const long long nn = (long long)n;
+	switch(form){
+	case UNITCURVE_AFFINE:
+#pragma omp simd
+		for(long long i=0; i<nn; i++){
+			v[i] = (v[i] - pb)/pa;
+		}
+		break;
+	case UNITCURVE_EXPONENTIAL:
+#pragma omp simd
+		for(long long i=0; i<nn; i++){
+			v[i] = pb*UnitLog10(v[i]/pa);
+		}
+		break;
+	case UNITCURVE_RECIPROCAL:
+#pragma omp simd
+		for(long long i=0; i<nn; i++){
+			v[i] = pa/v[i] - pb;
+		}
+		break;
+	case UNITCURVE_TABLE:
+		tab->FromSI(v, n);
+		break;
+	}
+}
+
+
+#endif /* UnitCurve_ */
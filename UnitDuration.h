@@ -0,0 +1,377 @@
+/**
+ * @file UnitDuration.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Parsing and formatting of durations written as text, for converting logs
+ * whose time fields are not plain numbers.  Two forms are understood, each
+ * with an optional leading '-':
+ *
+ * 	-	ISO 8601 durations, P[nW][nD][T[nH][nM][nS]] (e.g. PT1H30M12.5S).
+ * 		The smallest component may have a fraction, after '.' or ','.
+ * 		Years and months have no fixed length and are rejected.
+ * 	-	Clock times, h:mm:ss[.f] (e.g. 01:23:45.678), with any number of
+ * 		hour digits and minutes and seconds below 60.
+ *
+ * UnitParseDuration() returns seconds, which a plan from "-:sec:1" converts
+ * to any time unit.  The common clock layout hh:mm:ss is parsed eight bytes
+ * at a time in a 64-bit register: one subtraction, one mask test for the
+ * digits and colons, and one multiply-add combine the six digits into hours,
+ * minutes, and seconds without a loop.  Other layouts, the fraction, and ISO
+ * durations are parsed in a single pass in which the designators are looked
+ * up in a table rather than tested one by one.  Components are summed as
+ * integers and divided once by the power of ten of the fraction, so the
+ * seconds are correctly rounded unless they have more than 15 digits.
+ *
+ * UnitFormatDuration() writes seconds in either form, rounded to the
+ * nanosecond with trailing zeros dropped (01:30:12.5, PT1H30M12.5S).  Values
+ * which are not finite or exceed UNITDURATION_MAX_SECONDS are written as
+ * plain numbers.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitDuration_
+#define UnitDuration_
+
+#include <cstring>
+#include <charconv>
+#include <stdint.h>
+#include "UnitError.h"
+
+
+/** @brief Largest number of characters written by UnitFormatDuration() */
+#define UNITDURATION_MAX_CHARS 32
+
+/** @brief Largest magnitude, in seconds, formatted as a duration */
+#define UNITDURATION_MAX_SECONDS 9.0e9
+
+/** @brief Largest number of digits in one number of a duration */
+#define UNITDURATION_MAX_DIGITS 12
+
+
+/**
+ * @brief Text form of a duration.
+ */
+enum UnitDurationFormat {
+	UNITDURATION_NONE = 0,		/**< Plain number */
+	UNITDURATION_ISO,			/**< ISO 8601, e.g. PT1H30M12.5S */
+	UNITDURATION_CLOCK			/**< Clock time, e.g. 01:30:12.5 */
+};
+
+
+/**
+ * @brief Read a run of decimal digits.
+ * @pre p <= e.
+ * @param p Reference to the first character.  Advanced past the digits.
+ * @param e End of the text.
+ * @param v Reference to contain the value of the digits.
+ * @post No changes.
+ * @return Number of digits read.
+ */
+inline int UnitDurationDigits(const char *&p, const char *e, uint64_t &v)
+{
+	const char *start = p;
+	v = 0;
+	while(p < e && (unsigned)(*p - '0') < 10u){
+		v = v*10 + (uint64_t)(*p - '0');
+		p++;
+	}
+	return (int)(p - start);
+}
+
+
+/**
+ * @brief Parse a clock time laid out as hh:mm:ss in eight bytes.
+ * @pre s points to at least 8 readable bytes.
+ * @param s Pointer to the text.
+ * @param isec Reference to contain the whole seconds.
+ * @post No changes.
+ * @return Boolean value indicating that the bytes are a valid hh:mm:ss.
+ */
+inline bool UnitDurationClock8(const char *s, int64_t &isec)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	/*
+	 * BYTE i OF w IS s[i].  SUBTRACTING '0' FROM EVERY BYTE LEAVES 0-9 IN THE
+	 * DIGIT BYTES (A BYTE BELOW '0' BORROWS, BUT ITS OWN HIGH NIBBLE THEN
+	 * FAILS THE TEST).  A BYTE IS A DIGIT WHEN BOTH d AND d + 6 ARE BELOW 16.
+	 * d*10 + (d >> 8) PUTS 10*s[i] + s[i+1] IN BYTE i WITHOUT CARRIES.
+	 */
+	uint64_t w;
+	std::memcpy(&w,s,sizeof(w));
+	uint64_t d = w - 0x3030303030303030ULL;
+	bool digits = (((d | (d + 0x0606060606060606ULL)) & 0xF0F0F0F0F0F0F0F0ULL &
+			0xFFFF00FFFF00FFFFULL) == 0);
+	bool colons = ((w & 0x0000FF0000FF0000ULL) == 0x00003A00003A0000ULL);
+	uint64_t x = d*10 + (d >> 8);
+	int64_t h = (int64_t)(x & 0xFF);
+	int64_t m = (int64_t)((x >> 24) & 0xFF);
+	int64_t sec = (int64_t)((x >> 48) & 0xFF);
+	isec = h*3600 + m*60 + sec;
+	return digits & colons & (m < 60) & (sec < 60);
+#else
+	(void)s;
+	(void)isec;
+	return false;
+#endif
+}
+
+
+/**
+ * @brief Parse an ISO 8601 duration or a clock time.
+ * @pre s <= e.
+ * @param s Pointer to the first character.
+ * @param e Pointer one past the last character.
+ * @param sec Reference to contain the duration in seconds.
+ * @post 'sec' set if the text is a valid duration.
+ * @return UNIT_OK, or UNIT_ERR_BAD_VALUE if the text is not a duration.
+ */
+inline UnitErrorCode UnitParseDuration(const char *s, const char *e, double &sec)
+{
+	static const double pow10[UNITDURATION_MAX_DIGITS+1] = {1.0e0, 1.0e1, 1.0e2,
+			1.0e3, 1.0e4, 1.0e5, 1.0e6, 1.0e7, 1.0e8, 1.0e9, 1.0e10, 1.0e11, 1.0e12};
+
+	double sign = 1.0e0;
+	if(s < e && *s == '-'){
+		sign = -1.0e0;
+		s++;
+	}
+	int64_t isec = 0;
+	uint64_t frac = 0;
+	int nfrac = 0;
+	int64_t fracmult = 1;
+	const char *p = s;
+
+	if(p < e && *p == 'P'){
+		/*
+		 * ISO 8601.  EACH DESIGNATOR HAS A RANK AND A LENGTH IN SECONDS, BY
+		 * SECTION (DATE OR TIME) AND LETTER; RANK 0 IS NOT ALLOWED.  RANKS
+		 * MUST INCREASE, SO EACH COMPONENT APPEARS ONCE AND IN ORDER.
+		 */
+		static const int8_t rank[2][26] = {
+			{0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0},
+			{0,0,0,0,0,0,0,3,0,0,0,0,4,0,0,0,0,0,5,0,0,0,0,0,0,0}};
+		static const int64_t length[6] = {0, 604800, 86400, 3600, 60, 1};
+		int section = 0;
+		int last = 0;
+		bool empty = true;
+		p++;
+		while(p < e){
+			if(*p == 'T'){
+				if(section == 1){
+					return UNIT_ERR_BAD_VALUE;
+				}
+				section = 1;
+				empty = true;
+				p++;
+				continue;
+			}
+			uint64_t v;
+			int nd = UnitDurationDigits(p,e,v);
+			if(nd == 0 || nd > UNITDURATION_MAX_DIGITS || nfrac > 0){
+				return UNIT_ERR_BAD_VALUE;
+			}
+			if(p < e && (*p == '.' || *p == ',')){
+				p++;
+				nfrac = UnitDurationDigits(p,e,frac);
+				if(nfrac == 0 || nfrac > UNITDURATION_MAX_DIGITS){
+					return UNIT_ERR_BAD_VALUE;
+				}
+			}
+			unsigned letter = (p < e ? (unsigned)(*p - 'A') : 26u);
+			int r = (letter < 26u ? rank[section][letter] : 0);
+			if(r <= last){
+				return UNIT_ERR_BAD_VALUE;
+			}
+			last = r;
+			empty = false;
+			isec += (int64_t)v*length[r];
+			fracmult = length[r];
+			p++;
+		}
+		if(empty){
+			return UNIT_ERR_BAD_VALUE;
+		}
+	} else {
+		/*
+		 * CLOCK TIME.  hh:mm:ss IS READ IN ONE STEP; OTHERWISE THE HOURS MAY
+		 * HAVE ANY NUMBER OF DIGITS.
+		 */
+		if(e - p >= 8 && (e - p == 8 || p[8] == '.' || p[8] == ',') &&
+				UnitDurationClock8(p,isec)){
+			p += 8;
+		} else {
+			uint64_t h, m, ss;
+			int nh = UnitDurationDigits(p,e,h);
+			if(nh == 0 || nh > UNITDURATION_MAX_DIGITS || p == e || *p != ':'){
+				return UNIT_ERR_BAD_VALUE;
+			}
+			p++;
+			if(UnitDurationDigits(p,e,m) != 2 || m >= 60 || p == e || *p != ':'){
+				return UNIT_ERR_BAD_VALUE;
+			}
+			p++;
+			if(UnitDurationDigits(p,e,ss) != 2 || ss >= 60){
+				return UNIT_ERR_BAD_VALUE;
+			}
+			isec = (int64_t)(h*3600 + m*60 + ss);
+		}
+		if(p < e && (*p == '.' || *p == ',')){
+			p++;
+			nfrac = UnitDurationDigits(p,e,frac);
+			if(nfrac == 0 || nfrac > UNITDURATION_MAX_DIGITS){
+				return UNIT_ERR_BAD_VALUE;
+			}
+		}
+		if(p != e){
+			return UNIT_ERR_BAD_VALUE;
+		}
+	}
+
+	/*
+	 * THE DURATION IS (isec*10^nfrac + frac*fracmult)/10^nfrac.  WHEN THE
+	 * NUMERATOR IS BELOW 2^53 BOTH OPERANDS ARE EXACT AND THE RESULT IS
+	 * ROUNDED ONCE; OTHERWISE THE FRACTION IS ROUNDED BEFORE IT IS ADDED.
+	 */
+	const int64_t exact = (int64_t)1 << 52;
+	int64_t scale = (int64_t)pow10[nfrac];
+	int64_t ifrac = (int64_t)frac;
+	if(isec < exact/scale && ifrac < exact/fracmult){
+		sec = sign*((double)(isec*scale + ifrac*fracmult)/pow10[nfrac]);
+	} else {
+		sec = sign*((double)isec + (double)frac/pow10[nfrac]*(double)fracmult);
+	}
+	return UNIT_OK;
+}
+
+
+/**
+ * @brief Write a duration.
+ * @pre 'out' has room for UNITDURATION_MAX_CHARS characters.
+ * @param sec Duration in seconds.
+ * @param format UNITDURATION_ISO or UNITDURATION_CLOCK.  UNITDURATION_NONE
+ * 			writes a plain number.
+ * @param out Pointer to the output buffer.  Not null-terminated.
+ * @post Duration written to 'out'.
+ * @return Pointer one past the last character written.
+ */
+inline char* UnitFormatDuration(double sec, UnitDurationFormat format, char *out)
+{
+	double a = (sec < 0.0e0 ? -sec : sec);
+	if(format == UNITDURATION_NONE || !(a <= UNITDURATION_MAX_SECONDS)){
+		return std::to_chars(out,out + UNITDURATION_MAX_CHARS,sec).ptr;
+	}
+
+	/*
+	 * SPLIT INTO INTEGERS: WHOLE SECONDS AND NANOSECONDS, THEN HOURS,
+	 * MINUTES, AND SECONDS
+	 */
+	int64_t ns = (int64_t)(a*1.0e9 + 0.5e0);
+	int64_t whole = ns/1000000000;
+	int64_t nanos = ns - whole*1000000000;
+	int64_t h = whole/3600;
+	int m = (int)(whole/60 - h*60);
+	int ss = (int)(whole - (whole/60)*60);
+	char *o = out;
+	if(sec < 0.0e0 && ns > 0){
+		*o++ = '-';
+	}
+
+	/*
+	 * FRACTION: NINE DIGITS, TRAILING ZEROS DROPPED
+	 */
+	char fdigits[10];
+	int nf = 0;
+	if(nanos > 0){
+		fdigits[0] = '.';
+		int64_t f = nanos;
+		for(int i=9; i>=1; i--){
+			fdigits[i] = (char)('0' + f%10);
+			f /= 10;
+		}
+		nf = 9;
+		while(fdigits[nf] == '0'){
+			nf--;
+		}
+		nf++;
+	}
+
+	if(format == UNITDURATION_CLOCK){
+		if(h < 10){
+			*o++ = '0';
+		}
+		o = std::to_chars(o,out + UNITDURATION_MAX_CHARS,h).ptr;
+		o[0] = ':';
+		o[1] = (char)('0' + m/10);
+		o[2] = (char)('0' + m%10);
+		o[3] = ':';
+		o[4] = (char)('0' + ss/10);
+		o[5] = (char)('0' + ss%10);
+		o += 6;
+		std::memcpy(o,fdigits,(size_t)nf);
+		return o + nf;
+	}
+
+	*o++ = 'P';
+	*o++ = 'T';
+	if(h > 0){
+		o = std::to_chars(o,out + UNITDURATION_MAX_CHARS,h).ptr;
+		*o++ = 'H';
+	}
+	if(m > 0){
+		o = std::to_chars(o,out + UNITDURATION_MAX_CHARS,m).ptr;
+		*o++ = 'M';
+	}
+	if(ss > 0 || nf > 0 || (h == 0 && m == 0)){
+		o = std::to_chars(o,out + UNITDURATION_MAX_CHARS,ss).ptr;
+		std::memcpy(o,fdigits,(size_t)nf);
+		o += nf;
+		*o++ = 'S';
+	}
+	return o;
+}
+
+
+#endif /* UnitDuration_ */
@@ -0,0 +1,336 @@
+/**
+ * @file UnitError.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Error reporting for unit-string compilation and conversion.  No function on
+ * the conversion path throws or writes to a stream.  Instead:
+ * 	-#	functions which compile unit strings return a UnitErrorCode,
+ * 	-#	UnitResult<T> carries either a value or an error code, and
+ * 	-#	array conversions record the rows whose result is not a finite number
+ * 		in a UnitErrorBitmap, one bit per row.
+ *
+ * The bitmap is filled after the values have been converted, so a batch with
+ * a few bad rows is converted at the same speed as a clean batch.
+ *
+ * All functions contained within these classes are intended for use with the
+ * GNU C++ compiler (g++).  Use with other compilers may produce unexpected
+ * results and such use is at the users' own risk.  The checks for non-finite
+ * values do not work if compiled with -ffast-math.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- Added UNIT_ERR_LOG_MISUSE.
+ *
+ * @date 18 October 2026
+ *	- Added UNIT_ERR_CURVE_MISUSE.
+ *
+ * @date 18 October 2026
+ *	- Added UNIT_ERR_COLUMN_UNITS.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitError_
+#define UnitError_
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+
+/**
+ * @brief Reasons a unit string or conversion can fail.
+ */
+enum UnitErrorCode {
+	UNIT_OK = 0,					/**< No error */
+	UNIT_ERR_SYNTAX,				/**< Term is not of the form si:unit:power */
+	UNIT_ERR_UNKNOWN_UNIT,			/**< Unit symbol is not registered */
+	UNIT_ERR_BAD_PREFIX,			/**< SI prefix is not recognized */
+	UNIT_ERR_BAD_POWER,				/**< Power is not an integer in the range
+										 -UNIT_MAX_POWER ... UNIT_MAX_POWER */
+	UNIT_ERR_TOO_MANY_TERMS,		/**< Too many distinct units in one string */
+	UNIT_ERR_DIMENSION_MISMATCH,	/**< Input and output dimensions differ */
+	UNIT_ERR_OFFSET_MISUSE,			/**< Absolute temperature converted to or
+										 from a temperature difference */
+	UNIT_ERR_BAD_VALUE,				/**< Value is not a finite number */
+	UNIT_ERR_LOG_MISUSE,			/**< Logarithmic unit (e.g. dB) combined
+										 with other units, prefixed, or raised
+										 to a power */
+	UNIT_ERR_CURVE_MISUSE,			/**< Non-linear unit (e.g. API) combined
+										 with other units, prefixed, or raised
+										 to a power */
+	UNIT_ERR_COLUMN_UNITS			/**< Column of a formula given different
+										 units where it is used again */
+};
+
+
+/**
+ * @brief Short description of an error code.
+ * @pre None.
+ * @param code Error code.
+ * @post No changes.
+ * @return Pointer to a static string.
+ */
+inline const char* UnitErrorString(UnitErrorCode code)
+{
+	switch(code){
+	case UNIT_OK:						return "no error";
+	case UNIT_ERR_SYNTAX:				return "term is not of the form si:unit:power";
+	case UNIT_ERR_UNKNOWN_UNIT:			return "unknown unit";
+	case UNIT_ERR_BAD_PREFIX:			return "unknown SI prefix";
+	case UNIT_ERR_BAD_POWER:			return "power is not an integer or is too large";
+	case UNIT_ERR_TOO_MANY_TERMS:		return "too many units in unit string";
+	case UNIT_ERR_DIMENSION_MISMATCH:	return "input and output dimensions differ";
+	case UNIT_ERR_OFFSET_MISUSE:		return "absolute temperature mixed with temperature difference";
+	case UNIT_ERR_BAD_VALUE:			return "value is not a finite number";
+	case UNIT_ERR_LOG_MISUSE:			return "logarithmic unit must be used alone";
+	case UNIT_ERR_CURVE_MISUSE:			return "non-linear unit must be used alone";
+	case UNIT_ERR_COLUMN_UNITS:			return "column used again with different units";
+	}
+	return "unknown error";
+}
+
+
+
+/**
+ * @brief Either a value or the reason no value could be produced.
+ */
+template <class T>
+class UnitResult {
+
+public:
+	/**
+	 * @brief Constructor for a successful result.
+	 * @pre None.
+	 * @param val Value.
+	 * @post UnitResult object exists and holds 'val'.
+	 * @return None.
+	 */
+	UnitResult(const T &val) : value(val), error(UNIT_OK) {}
+
+
+	/**
+	 * @brief Constructor for a failed result.
+	 * @pre None.
+	 * @param code Error code (not UNIT_OK).
+	 * @post UnitResult object exists and holds 'code'.
+	 * @return None.
+	 */
+	UnitResult(UnitErrorCode code) : value(), error(code) {}
+
+
+	/**
+	 * @brief Check whether the result holds a value.
+	 * @pre UnitResult object exists.
+	 * @post No changes to object.
+	 * @return Boolean value indicating success.
+	 */
+	bool Ok() const { return error == UNIT_OK; }
+
+
+	/**
+	 * @brief Value held by the result.
+	 * @pre Ok() is true.
+	 * @post No changes to object.
+	 * @return Reference to the value.
+	 */
+	const T& Value() const { return value; }
+
+
+	/**
+	 * @brief Error held by the result.
+	 * @pre UnitResult object exists.
+	 * @post No changes to object.
+	 * @return Error code (UNIT_OK if the result holds a value).
+	 */
+	UnitErrorCode Error() const { return error; }
+
+
+
+protected:
+	/** @brief Value, valid if error is UNIT_OK */
+	T value;
+
+	/** @brief Error code */
+	UnitErrorCode error;
+
+};
+
+
+
+/**
+ * @brief One bit per row of a batch, set for rows which failed.
+ */
+class UnitErrorBitmap {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre None.
+	 * @post UnitErrorBitmap object exists and covers no rows.
+	 * @return None.
+	 */
+	UnitErrorBitmap() : nrows(0) {}
+
+
+	/**
+	 * @brief Set the number of rows covered and clear all bits.
+	 * @pre UnitErrorBitmap object exists.
+	 * @param n Number of rows.
+	 * @post All n bits cleared.
+	 * @return None.
+	 */
+	void Reset(size_t n)
+	{
+		nrows = n;
+		words.assign((n + 63)/64, 0);
+	}
+
+
+	/**
+	 * @brief Mark a row as failed.
+	 * @pre i < Size().
+	 * @param i Row.
+	 * @post Bit 'i' set.
+	 * @return None.
+	 */
+	void Set(size_t i) { words[i >> 6] |= (uint64_t)1 << (i & 63); }
+
+
+	/**
+	 * @brief Check whether a row failed.
+	 * @pre i < Size().
+	 * @param i Row.
+	 * @post No changes to object.
+	 * @return Boolean value indicating failure.
+	 */
+	bool Test(size_t i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+
+
+	/**
+	 * @brief Number of rows covered.
+	 * @pre UnitErrorBitmap object exists.
+	 * @post No changes to object.
+	 * @return Number of rows.
+	 */
+	size_t Size() const { return nrows; }
+
+
+	/**
+	 * @brief Check whether any row failed.
+	 * @pre UnitErrorBitmap object exists.
+	 * @post No changes to object.
+	 * @return Boolean value indicating whether any bit is set.
+	 */
+	bool Any() const
+	{
+		uint64_t acc = 0;
+		for(size_t i=0; i<words.size(); i++){
+			acc |= words[i];
+		}
+		return acc != 0;
+	}
+
+
+	/**
+	 * @brief Number of rows which failed.
+	 * @pre UnitErrorBitmap object exists.
+	 * @post No changes to object.
+	 * @return Number of bits set.
+	 */
+	size_t Count() const
+	{
+		size_t count = 0;
+		for(size_t i=0; i<words.size(); i++){
+			count += (size_t)__builtin_popcountll(words[i]);
+		}
+		return count;
+	}
+
+
+	/**
+	 * @brief Mark every row whose value is not finite (NaN or infinite).
+	 * 			The check is branch-free, so its cost does not depend on how
+	 * 			many rows fail.
+	 * @pre Reset() called with at least 'first + n' rows.  'first' is a
+	 * 			multiple of 64.
+	 * @param vals Pointer to the values of rows first ... first+n-1.
+	 * @param first Row of vals[0].
+	 * @param n Number of values.
+	 * @post Bits set for non-finite values.
+	 * @return None.
+	 */
+	template <class T>
+	void MarkNonFinite(const T *vals, size_t first, size_t n)
+	{
+		for(size_t b=0; b<n; b+=64){
+			size_t nb = (n - b < 64) ? n - b : 64;
+			uint64_t w = 0;
+			for(size_t j=0; j<nb; j++){
+				/* x - x IS 0 FOR FINITE x AND NaN OTHERWISE */
+				T d = vals[b+j] - vals[b+j];
+				w |= (uint64_t)(!(d == d)) << j;
+			}
+			words[(first + b) >> 6] |= w;
+		}
+	}
+
+
+	/**
+	 * @brief Raw bitmap words.  Bit j of word k corresponds to row 64*k + j.
+	 * @pre UnitErrorBitmap object exists.
+	 * @post No changes to object.
+	 * @return Pointer to the words.
+	 */
+	const uint64_t* Words() const { return words.empty() ? 0 : &words[0]; }
+
+
+
+protected:
+	/** @brief Number of rows covered */
+	size_t nrows;
+
+	/** @brief Bitmap words */
+	std::vector<uint64_t> words;
+
+};
+
+
+#endif /* UnitError_ */
@@ -0,0 +1,673 @@
+/**
+ * @file UnitExpression.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * This class holds the compiled form of a unit string of the form
+ *
+ * 		si:unit:power|si:unit:power|...
+ *
+ * as used by UnitConvert::ConvertUnits() and assembled by the GUI.  Rather than
+ * storing the text and re-parsing it for each conversion, the compiled form
+ * keeps the accumulated exponents of the base dimensions and the accumulated
+ * factor to the coherent SI unit.  Each term is folded in as it is added, so
+ * building a unit string one term at a time costs O(1) per term and invalid
+ * terms are detected immediately.
+ *
+ * A unit with an offset (e.g., degrees Celcius) keeps its offset only when it
+ * is the sole term and appears with a power of 1.  In all other cases it is
+ * treated as a temperature difference.
+ *
+ * Likewise a logarithmic unit (e.g., dBm) keeps its log scale only when it is
+ * the sole term, has no prefix, and appears with a power of 1.  Any other use
+ * is reported by UnitPlan::Build() as UNIT_ERR_LOG_MISUSE.  The same holds
+ * for the curve of a non-linear unit (e.g., API), reported as
+ * UNIT_ERR_CURVE_MISUSE.
+ *
+ * Errors are reported as UnitErrorCode values (see UnitError.h).
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *	- Functions return UnitErrorCode rather than bool.
+ *	- Powers limited to UNIT_MAX_POWER so that factors cannot overflow.
+ *
+ * @date 18 October 2026
+ *	- Added AddTerm() taking a looked-up unit definition, for front ends
+ *	  which resolve symbols themselves (UnitNotation).  Term text is built
+ *	  without a stringstream.
+ *
+ * @date 18 October 2026
+ *	- Added IsLogarithmic(), HasLogUnits(), and LogScale().
+ *
+ * @date 18 October 2026
+ *	- Added IsCurve(), HasCurveUnits(), and Curve().
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitExpression_
+#define UnitExpression_
+
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include "UnitRegistry.h"
+#include "UnitError.h"
+
+
+/** @brief Largest magnitude of the power applied to a single term */
+#define UNIT_MAX_POWER 32
+
+
+/**
+ * @brief Compiled representation of a unit string.
+ */
+class CompiledUnits {
+
+public:
+	/**
+	 * @brief Constructor.  The new object represents a dimensionless unit
+	 * 			with a factor of 1.
+	 * @pre None.
+	 * @post CompiledUnits object exists.
+	 * @return None.
+	 */
+	CompiledUnits();
+
+
+	/**
+	 * @brief Reset to a dimensionless unit with a factor of 1.
+	 * @pre CompiledUnits object exists.
+	 * @post All terms removed.
+	 * @return None.
+	 */
+	void Clear();
+
+
+	/**
+	 * @brief Fold a single term into the compiled representation.  Terms
+	 * 			with a power of 0 are accepted and have no effect.
+	 * @pre CompiledUnits object exists.
+	 * @param reg Registry used to look up the prefix and unit.
+	 * @param si SI prefix ("-" or "" for none).
+	 * @param unit Unit symbol.
+	 * @param power Power to which the prefixed unit is raised.
+	 * @post Term folded in if valid.  Object unchanged otherwise.
+	 * @return UNIT_OK, UNIT_ERR_BAD_PREFIX, or UNIT_ERR_UNKNOWN_UNIT.
+	 */
+	UnitErrorCode AddTerm(const UnitRegistry &reg, const std::string &si,
+			const std::string &unit, int power);
+
+
+	/**
+	 * @brief Fold a single term of the form "si:unit:power" into the
+	 * 			compiled representation.
+	 * @pre CompiledUnits object exists.
+	 * @param reg Registry used to look up the prefix and unit.
+	 * @param term Term to be added.
+	 * @post Term folded in if valid.  Object unchanged otherwise.
+	 * @return UNIT_OK or the reason the term is invalid.
+	 */
+	UnitErrorCode AddTerm(const UnitRegistry &reg, const std::string &term);
+
+
+	/**
+	 * @brief Fold a single term whose prefix and unit have already been
+	 * 			looked up.
+	 * @pre CompiledUnits object exists.
+	 * @param def Definition of the unit.
+	 * @param si SI prefix ("-" or "" for none), used for the text.
+	 * @param siscale Multiplier of the prefix, 10 to the power of its
+	 * 			exponent.  Callers may compute it once per prefix.
+	 * @param power Power to which the prefixed unit is raised.
+	 * @post Term folded in if valid.  Object unchanged otherwise.
+	 * @return UNIT_OK or UNIT_ERR_BAD_POWER.
+	 */
+	UnitErrorCode AddTerm(const UnitDefinition &def, const std::string &si, double siscale,
+			int power);
+
+
+	/**
+	 * @brief Compile a complete unit string, replacing the current contents.
+	 * @pre CompiledUnits object exists.
+	 * @param reg Registry used to look up prefixes and units.
+	 * @param units Unit string of the form "si:unit:power|si:unit:power|...".
+	 * 			An empty string denotes a dimensionless unit.
+	 * @post Object contains the compiled unit string if valid.  Object is
+	 * 			cleared otherwise.
+	 * @return UNIT_OK or the reason the first invalid term is invalid.
+	 */
+	UnitErrorCode Compile(const UnitRegistry &reg, const std::string &units);
+
+
+	/**
+	 * @brief Check whether two compiled units have the same dimension.
+	 * @pre CompiledUnits object exists.
+	 * @param other Compiled units to be compared.
+	 * @post No changes to object.
+	 * @return Boolean value indicating whether the dimensions match.
+	 */
+	bool SameDimension(const CompiledUnits &other) const;
+
+
+	/**
+	 * @brief Multiplier from these units to the coherent SI unit.
+	 * @pre CompiledUnits object exists.
+	 * @post No changes to object.
+	 * @return Factor.
+	 */
+	double Factor() const;
+
+
+	/**
+	 * @brief Offset added after scaling to the coherent SI unit.
+	 * @pre CompiledUnits object exists.
+	 * @post No changes to object.
+	 * @return Offset.
+	 */
+	double Offset() const;
+
+
+	/**
+	 * @brief Exponents of the base dimensions.
+	 * @pre CompiledUnits object exists.
+	 * @post No changes to object.
+	 * @return Pointer to UNIT_NDIMS exponents.
+	 */
+	const int* Dimensions() const;
+
+
+	/**
+	 * @brief Check whether the units denote an absolute temperature, i.e. a
+	 * 			single unit with a non-zero offset raised to the first power.
+	 * @pre CompiledUnits object exists.
+	 * @post No changes to object.
+	 * @return Boolean value indicating an absolute temperature.
+	 */
+	bool IsAbsolute() const;
+
+
+	/**
+	 * @brief Check whether the units contain a unit with a non-zero offset
+	 * 			whose offset was dropped, i.e. a temperature difference.
+	 * @pre CompiledUnits object exists.
+	 * @post No changes to object.
+	 * @return Boolean value indicating a temperature difference.
+	 */
+	bool IsDifference() const;
+
+
+	/**
+	 * @brief Check whether the units denote a logarithmic quantity, i.e. a
+	 * 			single unprefixed logarithmic unit raised to the first power.
+	 * @pre CompiledUnits object exists.
+	 * @post No changes to object.
+	 * @return Boolean value indicating a logarithmic quantity.
+	 */
+	bool IsLogarithmic() const;
+
+
+	/**
+	 * @brief Check whether the units contain a logarithmic unit.  Unless
+	 * 			IsLogarithmic() is also true, the units are invalid.
+	 * @pre CompiledUnits object exists.
+	 * @post No changes to object.
+	 * @return Boolean value indicating a logarithmic unit.
+	 */
+	bool HasLogUnits() const;
+
+
+	/**
+	 * @brief Log scale of a logarithmic quantity: value_SI =
+	 * 			Factor()*10^(value/LogScale()).
+	 * @pre CompiledUnits object exists.
+	 * @post No changes to object.
+	 * @return Log scale, or 0 unless IsLogarithmic().
+	 */
+	double LogScale() const;
+
+
+	/**
+	 * @brief Check whether the units denote a non-linear quantity, i.e. a
+	 * 			single unprefixed non-linear unit raised to the first power.
+	 * @pre CompiledUnits object exists.
+	 * @post No changes to object.
+	 * @return Boolean value indicating a non-linear quantity.
+	 */
+	bool IsCurve() const;
+
+
+	/**
+	 * @brief Check whether the units contain a non-linear unit.  Unless
+	 * 			IsCurve() is also true, the units are invalid.
+	 * @pre CompiledUnits object exists.
+	 * @post No changes to object.
+	 * @return Boolean value indicating a non-linear unit.
+	 */
+	bool HasCurveUnits() const;
+
+
+	/**
+	 * @brief Curve of a non-linear quantity: value_SI = Curve()->ToSI(value).
+	 * @pre CompiledUnits object exists.
+	 * @post No changes to object.
+	 * @return Pointer to the curve, or 0 unless IsCurve().
+	 */
+	const UnitCurve* Curve() const;
+
+
+	/**
+	 * @brief Number of terms folded in, including terms with a power of 0.
+	 * @pre CompiledUnits object exists.
+	 * @post No changes to object.
+	 * @return Number of terms.
+	 */
+	int NumTerms() const;
+
+
+	/**
+	 * @brief Unit string corresponding to the terms folded in.
+	 * @pre CompiledUnits object exists.
+	 * @post No changes to object.
+	 * @return Unit string, or an empty string if no terms have been added.
+	 */
+	std::string Text() const;
+
+
+
+protected:
+	/** @brief Exponents of the base dimensions */
+	int dims[UNIT_NDIMS];
+
+	/** @brief Multiplier to the coherent SI unit */
+	double factor;
+
+	/** @brief Offset to the coherent SI unit */
+	double offset;
+
+	/** @brief Number of terms folded in */
+	int nterms;
+
+	/** @brief Number of terms folded in with a non-zero power */
+	int nunits;
+
+	/** @brief Number of terms folded in whose unit has a non-zero offset */
+	int noffsetunits;
+
+	/** @brief Log scale of a sole logarithmic unit, 0 otherwise */
+	double logscale;
+
+	/** @brief Number of terms folded in whose unit is logarithmic */
+	int nlogunits;
+
+	/** @brief Curve of a sole non-linear unit, 0 otherwise */
+	const UnitCurve *curve;
+
+	/** @brief Number of terms folded in whose unit is non-linear */
+	int ncurveunits;
+
+	/** @brief Unit string corresponding to the terms folded in */
+	std::string text;
+
+
+	/**
+	 * @brief Fold a term with a non-zero power into the factor, offset, and
+	 * 			dimensions, counting it as a unit.
+	 * @param def Definition of the unit.
+	 * @param siscale Multiplier of the prefix.
+	 * @param power Power to which the prefixed unit is raised.
+	 */
+	void Fold(const UnitDefinition &def, double siscale, int power);
+
+
+	/**
+	 * @brief Append "si:unit:power" to the text.
+	 */
+	void AppendText(const std::string &si, const std::string &unit, int power);
+
+};
+
+
+
+// ==================================================================
+// ================
+// ================    PUBLIC FUNCTIONS
+// ================
+
+// CONSTRUCTOR
+CompiledUnits::CompiledUnits()
+{
+	Clear();
+}
+
+
+void CompiledUnits::Clear()
+{
+	for(int i=0; i<UNIT_NDIMS; i++){
+		dims[i] = 0;
+	}
+	factor = 1.0e0;
+	offset = 0.0e0;
+	nterms = 0;
+	nunits = 0;
+	noffsetunits = 0;
+	logscale = 0.0e0;
+	nlogunits = 0;
+	curve = 0;
+	ncurveunits = 0;
+	text = "";
+}
+
+
+UnitErrorCode CompiledUnits::AddTerm(const UnitRegistry &reg, const std::string &si,
+		const std::string &unit, int power)
+{
+	/*
+	 * TERMS RAISED TO THE ZEROTH POWER CONTRIBUTE NOTHING.  THEY ARE STILL
+	 * RECORDED SO THAT THE TEXT MATCHES WHAT THE USER ENTERED.
+	 */
+	if(power > UNIT_MAX_POWER || power < -UNIT_MAX_POWER){
+		return UNIT_ERR_BAD_POWER;
+	}
+	if(power == 0){
+		AppendText(si,unit,power);
+		nterms++;
+		return UNIT_OK;
+	}
+
+
+	/*
+	 * LOOK UP PREFIX AND UNIT
+	 */
+	int siexp = 0;
+	if(!reg.FindPrefix(si,siexp)){
+		return UNIT_ERR_BAD_PREFIX;
+	}
+	const UnitDefinition *def = reg.FindUnit(unit);
+	if(!def){
+		return UNIT_ERR_UNKNOWN_UNIT;
+	}
+
+	Fold(*def,std::pow(10.0e0,siexp),power);
+	AppendText(si,unit,power);
+	nterms++;
+	return UNIT_OK;
+}
+
+
+UnitErrorCode CompiledUnits::AddTerm(const UnitDefinition &def, const std::string &si,
+		double siscale, int power)
+{
+	if(power > UNIT_MAX_POWER || power < -UNIT_MAX_POWER){
+		return UNIT_ERR_BAD_POWER;
+	}
+	if(power != 0){
+		Fold(def,siscale,power);
+	}
+	AppendText(si,def.symbol,power);
+	nterms++;
+	return UNIT_OK;
+}
+
+
+UnitErrorCode CompiledUnits::AddTerm(const UnitRegistry &reg, const std::string &term)
+{
+	size_t c1 = term.find(':');
+	if(c1 == std::string::npos){
+		return UNIT_ERR_SYNTAX;
+	}
+	size_t c2 = term.find(':',c1+1);
+	if(c2 == std::string::npos){
+		return UNIT_ERR_SYNTAX;
+	}
+
+	std::string spower = term.substr(c2+1);
+	char *end = 0;
+	long power = std::strtol(spower.c_str(),&end,10);
+	if(spower.empty() || *end != '\0' || power > UNIT_MAX_POWER ||
+			power < -UNIT_MAX_POWER){
+		return UNIT_ERR_BAD_POWER;
+	}
+
+	return AddTerm(reg,term.substr(0,c1),term.substr(c1+1,c2-c1-1),(int)power);
+}
+
+
+UnitErrorCode CompiledUnits::Compile(const UnitRegistry &reg, const std::string &units)
+{
+	Clear();
+	if(units.empty()){
+		return UNIT_OK;
+	}
+
+	size_t start = 0;
+	while(start <= units.size()){
+		size_t end = units.find('|',start);
+		if(end == std::string::npos){
+			end = units.size();
+		}
+		UnitErrorCode err = AddTerm(reg,units.substr(start,end-start));
+		if(err != UNIT_OK){
+			Clear();
+			return err;
+		}
+		start = end + 1;
+	}
+	return UNIT_OK;
+}
+
+
+bool CompiledUnits::SameDimension(const CompiledUnits &other) const
+{
+	for(int i=0; i<UNIT_NDIMS; i++){
+		if(dims[i] != other.dims[i]){
+			return false;
+		}
+	}
+	return true;
+}
+
+
+bool CompiledUnits::IsAbsolute() const
+{
+	return nunits == 1 && offset != 0.0e0;
+}
+
+
+bool CompiledUnits::IsDifference() const
+{
+	return noffsetunits > 0 && !IsAbsolute();
+}
+
+
+bool CompiledUnits::IsLogarithmic() const
+{
+	return nunits == 1 && logscale != 0.0e0;
+}
+
+
+bool CompiledUnits::HasLogUnits() const
+{
+	return nlogunits > 0;
+}
+
+
+double CompiledUnits::LogScale() const
+{
+	return IsLogarithmic() ? logscale : 0.0e0;
+}
+
+
+bool CompiledUnits::IsCurve() const
+{
+	return nunits == 1 && curve != 0;
+}
+
+
+bool CompiledUnits::HasCurveUnits() const
+{
+	return ncurveunits > 0;
+}
+
+
+const UnitCurve* CompiledUnits::Curve() const
+{
+	return IsCurve() ? curve : 0;
+}
+
+
+double CompiledUnits::Factor() const
+{
+	return factor;
+}
+
+
+double CompiledUnits::Offset() const
+{
+	return offset;
+}
+
+
+const int* CompiledUnits::Dimensions() const
+{
+	return dims;
+}
+
+
+int CompiledUnits::NumTerms() const
+{
+	return nterms;
+}
+
+
+std::string CompiledUnits::Text() const
+{
+	return text;
+}
+
+
+// ==================================================================
+// ================
+// ================    PROTECTED FUNCTIONS
+// ================
+
+void CompiledUnits::Fold(const UnitDefinition &def, double siscale, int power)
+{
+	/*
+	 * FOLD TERM INTO ACCUMULATED FACTOR AND DIMENSIONS.  AN OFFSET IS ONLY
+	 * RETAINED FOR A SINGLE TERM RAISED TO THE FIRST POWER.  std::pow() IS
+	 * SKIPPED FOR THE FIRST POWER, WHERE IT WOULD BE EXACT ANYWAY.
+	 */
+	double termfactor = siscale*def.factor;
+	if(power != 1){
+		termfactor = std::pow(termfactor,power);
+	}
+	factor *= termfactor;
+	for(int i=0; i<UNIT_NDIMS; i++){
+		dims[i] += def.dims[i]*power;
+	}
+	if(nunits == 0 && power == 1){
+		offset = def.offset;
+	} else {
+		offset = 0.0e0;
+	}
+	if(nunits == 0 && power == 1 && siscale == 1.0e0){
+		logscale = def.logscale;
+		curve = def.curve;
+	} else {
+		logscale = 0.0e0;
+		curve = 0;
+	}
+
+	if(def.offset != 0.0e0){
+		noffsetunits++;
+	}
+	if(def.logscale != 0.0e0){
+		nlogunits++;
+	}
+	if(def.curve != 0){
+		ncurveunits++;
+	}
+	nunits++;
+}
+
+
+void CompiledUnits::AppendText(const std::string &si, const std::string &unit, int power)
+{
+	/*
+	 * POWERS ARE LIMITED TO UNIT_MAX_POWER, SO A FEW DIGITS SUFFICE
+	 */
+	char spower[8];
+	int n = sizeof(spower);
+	int p = (power < 0 ? -power : power);
+	do {
+		spower[--n] = (char)('0' + p % 10);
+		p /= 10;
+	} while(p > 0 && n > 1);
+	if(power < 0){
+		spower[--n] = '-';
+	}
+
+
+	/*
+	 * GROW THE TEXT ONCE AND COPY THE PIECES IN
+	 */
+	const char *sip = (si.empty() ? "-" : si.data());
+	size_t sil = (si.empty() ? 1 : si.size());
+	size_t pl = sizeof(spower) - n;
+	size_t start = text.size();
+	text.resize(start + (nterms > 0) + sil + unit.size() + pl + 2);
+	char *dst = &text[start];
+	if(nterms > 0){
+		*dst++ = '|';
+	}
+	std::memcpy(dst,sip,sil);
+	dst += sil;
+	*dst++ = ':';
+	std::memcpy(dst,unit.data(),unit.size());
+	dst += unit.size();
+	*dst++ = ':';
+	std::memcpy(dst,spower + n,pl);
+}
+
+
+#endif /* UnitExpression_ */
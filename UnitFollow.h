@@ -0,0 +1,657 @@
+/**
+ * @file UnitFollow.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Continuous conversion of a file which is being appended to (e.g. the log of
+ * a plant historian), in the manner of "tail -f".  Lines appended to the input
+ * are converted with a configured UnitStream and appended to the output; the
+ * conversion plan is compiled once.  Only complete lines are converted, so a
+ * record written in several pieces is converted once all of it has arrived.
+ *
+ * The input is watched with inotify, so an idle follower sleeps.  Small
+ * appends are gathered: after a change, the follower waits until at least
+ * FOLLOW_MIN_BATCH bytes are pending or FOLLOW_MAX_DELAY_MS has passed, then
+ * reads and converts everything pending (up to FOLLOW_MAX_BATCH bytes at a
+ * time).  At high ingest rates each wakeup therefore handles many records.
+ *
+ * With a state file, the byte offset of the first unconverted line and the
+ * identity of the input are saved after each batch is written, and a
+ * restarted follower resumes from there without rereading the input.  The
+ * state is saved after the output, so a crash between the two converts the
+ * last batch again on restart rather than losing it.
+ *
+ * An input truncated in place (e.g. "copytruncate" rotation) is followed from
+ * its start, provided the follower sees it shorter than the position reached.
+ * An input renamed or deleted is still read until a new file of the same
+ * name appears; it is then read to its end and the new file followed.
+ *
+ * Site units may be reloaded without restarting: after Reload() (e.g. from a
+ * SIGHUP handler), the follower loads the file given to SetReload() into a
+ * new registry of its UnitSnapshots object before the next batch and
+ * compiles the stream's units again with it.  A file which fails to load, or
+ * in which the units are no longer valid, leaves the previous conversion in
+ * use; the outcome of each reload is written to standard error.
+ *
+ * gzip and zstd files are not supported.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- Added SetReload() and Reload() to reload site units while following.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitFollow_
+#define UnitFollow_
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <stdint.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include "UnitStream.h"
+#include "UnitSnapshots.h"
+
+
+/** @brief Pending bytes at which a batch is converted without further delay */
+#define FOLLOW_MIN_BATCH 65536
+
+/** @brief Largest batch read at once, in bytes */
+#define FOLLOW_MAX_BATCH 4194304
+
+/** @brief Longest delay, in milliseconds, to gather small appends */
+#define FOLLOW_MAX_DELAY_MS 50
+
+/** @brief Interval, in milliseconds, between checks for a replaced input */
+#define FOLLOW_REOPEN_MS 500
+
+
+/**
+ * @brief Converter of lines appended to a file.
+ */
+class UnitFollow {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre Stream exists, is configured, and outlives this object.
+	 * @param conv Stream whose settings (units, field, NDJSON converter) are
+	 * 			used to convert the lines.
+	 * @post UnitFollow object exists.
+	 * @return None.
+	 */
+	UnitFollow(UnitStream &conv);
+
+
+	/**
+	 * @brief Set the file in which the position in the input is saved.
+	 * @pre UnitFollow object exists.
+	 * @param filename State file, or an empty string for none.
+	 * @post State file set.
+	 * @return None.
+	 */
+	void SetStateFile(const std::string &filename);
+
+
+	/**
+	 * @brief Set where site units are reloaded from.
+	 * @pre UnitFollow object exists.
+	 * @param snap Pointer to the snapshots which hold the reloaded registry,
+	 * 			or 0 to disable reloading.  Must outlive calls to Run().
+	 * @param filename Site units file.  An empty name reloads the built-in
+	 * 			units only.
+	 * @post Settings stored.
+	 * @return None.
+	 */
+	void SetReload(UnitSnapshots *snap, const std::string &filename);
+
+
+	/**
+	 * @brief Follow a file until Stop() is called.
+	 * @pre UnitFollow object exists.
+	 * @param filein Input file.  Must be a regular, uncompressed file.
+	 * @param fileout Output file, appended to.
+	 * @post Complete lines of the input converted and appended to the output.
+	 * @return Boolean value indicating success or failure.  See Error().
+	 */
+	bool Run(const std::string &filein, const std::string &fileout);
+
+
+	/**
+	 * @brief Stop following.  May be called from a signal handler.
+	 * @pre UnitFollow object exists.
+	 * @post Run() returns after the batch in progress.
+	 * @return None.
+	 */
+	void Stop();
+
+
+	/**
+	 * @brief Reload the site units before the next batch.  May be called from
+	 * 			a signal handler.
+	 * @pre SetReload() called.
+	 * @post Run() reloads the units once the batch in progress is written.
+	 * @return None.
+	 */
+	void Reload();
+
+
+	/**
+	 * @brief Description of the failure of the last call to Run().
+	 * @pre UnitFollow object exists.
+	 * @post No changes to object.
+	 * @return Error message, or an empty string.
+	 */
+	std::string Error() const;
+
+
+	/**
+	 * @brief Number of values converted by the last call to Run().
+	 * @pre UnitFollow object exists.
+	 * @post No changes to object.
+	 * @return Number of values.
+	 */
+	size_t NumValues() const;
+
+
+	/**
+	 * @brief Number of batches converted by the last call to Run().
+	 * @pre UnitFollow object exists.
+	 * @post No changes to object.
+	 * @return Number of batches.
+	 */
+	size_t NumBatches() const;
+
+
+	/**
+	 * @brief Number of successful reloads during the last call to Run().
+	 * @pre UnitFollow object exists.
+	 * @post No changes to object.
+	 * @return Number of reloads.
+	 */
+	size_t NumReloads() const;
+
+
+
+protected:
+	/** @brief Stream converting the lines */
+	UnitStream &stream;
+
+	/** @brief State file */
+	std::string statefile;
+
+	/** @brief Input file descriptor, its identity, and the next offset */
+	int fdin;
+	dev_t device;
+	ino_t inode;
+	uint64_t offset;
+
+	/** @brief Indicator that Stop() was called */
+	volatile sig_atomic_t stopped;
+
+	/** @brief Snapshots and file used to reload site units */
+	UnitSnapshots *snapshots;
+	std::string unitsfile;
+
+	/** @brief Indicator that Reload() was called */
+	volatile sig_atomic_t reloading;
+
+	/** @brief Counts of the last call to Run() */
+	size_t nvalues;
+	size_t nbatches;
+	size_t nreloads;
+
+	/** @brief Error message */
+	std::string errmsg;
+
+	/** @brief Input and output buffers */
+	std::vector<char> in;
+	std::vector<char> out;
+
+
+	/**
+	 * @brief Open the input and find where to resume.
+	 * @param filein Input file.
+	 * @param resume Boolean value indicating whether to use the state file.
+	 * @return Boolean value indicating whether the input exists.
+	 */
+	bool OpenInput(const std::string &filein, bool resume);
+
+
+	/**
+	 * @brief Convert and write the complete lines pending in the input.
+	 * @param fdout Output file descriptor.
+	 * @return Boolean value indicating success or failure.
+	 */
+	bool Drain(int fdout);
+
+
+	/**
+	 * @brief Save the offset and identity of the input to the state file.
+	 * @return Boolean value indicating success or failure.
+	 */
+	bool SaveState();
+
+
+	/**
+	 * @brief Bytes pending in the input, restarting if it was truncated.
+	 * @return Number of bytes.
+	 */
+	uint64_t Pending();
+
+
+	/**
+	 * @brief Load the site units into a new registry and compile the units of
+	 * 			the stream again with it.
+	 * @return None.
+	 */
+	void ReloadUnits();
+
+};
+
+
+
+// ==== PUBLIC FUNCTIONS =======================================================
+
+UnitFollow::UnitFollow(UnitStream &conv) : stream(conv), fdin(-1), device(0), inode(0),
+		offset(0), stopped(0), snapshots(0), reloading(0), nvalues(0), nbatches(0),
+		nreloads(0)
+{
+}
+
+
+void UnitFollow::SetStateFile(const std::string &filename)
+{
+	statefile = filename;
+}
+
+
+void UnitFollow::SetReload(UnitSnapshots *snap, const std::string &filename)
+{
+	snapshots = snap;
+	unitsfile = filename;
+}
+
+
+bool UnitFollow::Run(const std::string &filein, const std::string &fileout)
+{
+	errmsg = "";
+	nvalues = 0;
+	nbatches = 0;
+	nreloads = 0;
+	stopped = 0;
+	if(UnitStream::CodecFromName(filein) != STREAM_PLAIN ||
+			UnitStream::CodecFromName(fileout) != STREAM_PLAIN){
+		errmsg = "compressed files cannot be followed";
+		return false;
+	}
+
+	int fdout = open(fileout.c_str(),O_WRONLY | O_CREAT | O_APPEND,0644);
+	if(fdout < 0){
+		errmsg = "cannot open " + fileout;
+		return false;
+	}
+	int fdnotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(fdnotify < 0){
+		errmsg = "cannot watch " + filein;
+		close(fdout);
+		return false;
+	}
+
+
+	/*
+	 * WATCH THE DIRECTORY FOR A REPLACEMENT INPUT AND THE INPUT FOR APPENDS
+	 */
+	size_t slash = filein.rfind('/');
+	std::string dir = (slash == std::string::npos ? "." : filein.substr(0,slash == 0 ? 1 : slash));
+	int wddir = inotify_add_watch(fdnotify,dir.c_str(),IN_CREATE | IN_MOVED_TO);
+	int wdfile = -1;
+	if(wddir < 0){
+		errmsg = "cannot watch " + dir;
+	}
+	bool resume = true;
+	if(errmsg.empty() && OpenInput(filein,resume)){
+		wdfile = inotify_add_watch(fdnotify,filein.c_str(),
+				IN_MODIFY | IN_MOVE_SELF | IN_DELETE_SELF | IN_ATTRIB);
+	}
+	resume = false;
+
+	bool rotated = false;
+	char events[4096];
+	while(errmsg.empty() && !stopped){
+		/*
+		 * RELOAD THE UNITS IF ASKED (A SIGNAL INTERRUPTS THE SLEEP BELOW), THEN
+		 * CONVERT WHAT IS PENDING AND SLEEP UNTIL SOMETHING CHANGES
+		 */
+		if(reloading){
+			reloading = 0;
+			ReloadUnits();
+		}
+		if(fdin >= 0 && !Drain(fdout)){
+			break;
+		}
+		struct pollfd pfd;
+		pfd.fd = fdnotify;
+		pfd.events = POLLIN;
+		int ready = poll(&pfd,1,(fdin >= 0 && !rotated) ? -1 : FOLLOW_REOPEN_MS);
+		if(ready < 0 && errno != EINTR){
+			errmsg = "cannot watch " + filein;
+			break;
+		}
+		ssize_t len;
+		while((len = read(fdnotify,events,sizeof(events))) > 0){
+			for(char *p=events; p<events+len; ){
+				struct inotify_event *ev = reinterpret_cast<struct inotify_event*>(p);
+				if(ev->wd == wdfile && (ev->mask & (IN_MOVE_SELF | IN_DELETE_SELF))){
+					rotated = true;
+				}
+				if(ev->wd == wddir && ev->len > 0 &&
+						filein.compare(slash == std::string::npos ? 0 : slash+1,
+						std::string::npos,ev->name) == 0){
+					rotated = true;
+				}
+				p += sizeof(struct inotify_event) + ev->len;
+			}
+		}
+
+
+		/*
+		 * GATHER SMALL APPENDS: WAIT A LITTLE WHILE FEW BYTES ARE PENDING
+		 */
+		if(fdin >= 0 && !rotated && !stopped){
+			for(int waited=0; waited<FOLLOW_MAX_DELAY_MS && Pending() < FOLLOW_MIN_BATCH; waited+=5){
+				usleep(5000);
+			}
+		}
+
+
+		/*
+		 * A RENAMED INPUT IS STILL READ (WRITERS MAY HOLD IT OPEN) UNTIL A NEW
+		 * FILE TAKES ITS NAME; IT IS THEN READ TO ITS END AND CLOSED
+		 */
+		struct stat st;
+		if((rotated || fdin < 0) && stat(filein.c_str(),&st) == 0 &&
+				(fdin < 0 || st.st_dev != device || st.st_ino != inode)){
+			rotated = false;
+			if(fdin >= 0){
+				if(!Drain(fdout)){
+					break;
+				}
+				if(wdfile >= 0){
+					inotify_rm_watch(fdnotify,wdfile);
+					wdfile = -1;
+				}
+				close(fdin);
+				fdin = -1;
+			}
+			if(OpenInput(filein,false)){
+				wdfile = inotify_add_watch(fdnotify,filein.c_str(),
+						IN_MODIFY | IN_MOVE_SELF | IN_DELETE_SELF | IN_ATTRIB);
+			}
+		}
+	}
+
+	if(fdin >= 0){
+		close(fdin);
+		fdin = -1;
+	}
+	close(fdnotify);
+	if(close(fdout) != 0 && errmsg.empty()){
+		errmsg = "cannot write " + fileout;
+	}
+	return errmsg.empty();
+}
+
+
+void UnitFollow::Stop()
+{
+	stopped = 1;
+}
+
+
+void UnitFollow::Reload()
+{
+	reloading = 1;
+}
+
+
+std::string UnitFollow::Error() const
+{
+	return errmsg;
+}
+
+
+size_t UnitFollow::NumValues() const
+{
+	return nvalues;
+}
+
+
+size_t UnitFollow::NumBatches() const
+{
+	return nbatches;
+}
+
+
+size_t UnitFollow::NumReloads() const
+{
+	return nreloads;
+}
+
+
+
+// ==== PROTECTED FUNCTIONS ====================================================
+
+bool UnitFollow::OpenInput(const std::string &filein, bool resume)
+{
+	fdin = open(filein.c_str(),O_RDONLY | O_CLOEXEC);
+	struct stat st;
+	if(fdin < 0 || fstat(fdin,&st) != 0 || !S_ISREG(st.st_mode)){
+		if(fdin >= 0){
+			close(fdin);
+			fdin = -1;
+		}
+		return false;
+	}
+	device = st.st_dev;
+	inode = st.st_ino;
+	offset = 0;
+
+
+	/*
+	 * RESUME FROM THE STATE FILE IF IT DESCRIBES THIS FILE
+	 */
+	FILE *state = (resume && !statefile.empty()) ? fopen(statefile.c_str(),"r") : 0;
+	if(state){
+		unsigned long long savedoffset = 0;
+		unsigned long long saveddev = 0;
+		unsigned long long savedino = 0;
+		if(fscanf(state,"%llu %llu %llu",&savedoffset,&saveddev,&savedino) == 3 &&
+				saveddev == (unsigned long long)device && savedino == (unsigned long long)inode &&
+				savedoffset <= (unsigned long long)st.st_size){
+			offset = savedoffset;
+		}
+		fclose(state);
+	}
+	return true;
+}
+
+
+bool UnitFollow::Drain(int fdout)
+{
+	for(;;){
+		uint64_t pending = Pending();
+		if(pending == 0){
+			return true;
+		}
+		size_t want = (size_t)(pending < FOLLOW_MAX_BATCH ? pending : FOLLOW_MAX_BATCH);
+		in.resize(want);
+		ssize_t n = pread(fdin,in.data(),want,(off_t)offset);
+		if(n < 0){
+			if(errno == EINTR){
+				continue;
+			}
+			errmsg = "cannot read input";
+			return false;
+		}
+		if(n == 0){
+			return true;
+		}
+
+
+		/*
+		 * CONVERT THE COMPLETE LINES; A PARTIAL LAST LINE WAITS FOR THE REST
+		 */
+		size_t end = (size_t)n;
+		while(end > 0 && in[end-1] != '\n'){
+			end--;
+		}
+		if(end == 0){
+			if((size_t)n < FOLLOW_MAX_BATCH){
+				return true;
+			}
+			end = (size_t)n;	// LINE LONGER THAN A BATCH: CONVERT WHAT THERE IS
+		}
+		in.resize(end);
+		nvalues += stream.ConvertLines(in,out);
+
+		size_t written = 0;
+		while(written < out.size()){
+			ssize_t w = write(fdout,out.data() + written,out.size() - written);
+			if(w < 0 && errno == EINTR){
+				continue;
+			}
+			if(w <= 0){
+				errmsg = "cannot write output";
+				return false;
+			}
+			written += (size_t)w;
+		}
+		offset += end;
+		nbatches++;
+		if(!SaveState()){
+			return false;
+		}
+	}
+}
+
+
+bool UnitFollow::SaveState()
+{
+	if(statefile.empty()){
+		return true;
+	}
+
+
+	/*
+	 * WRITE A NEW FILE AND RENAME IT, SO THE STATE IS NEVER HALF WRITTEN
+	 */
+	std::string tmp = statefile + ".tmp";
+	FILE *state = fopen(tmp.c_str(),"w");
+	if(!state){
+		errmsg = "cannot write " + tmp;
+		return false;
+	}
+	fprintf(state,"%llu %llu %llu\n",(unsigned long long)offset,
+			(unsigned long long)device,(unsigned long long)inode);
+	if(fclose(state) != 0 || rename(tmp.c_str(),statefile.c_str()) != 0){
+		errmsg = "cannot write " + statefile;
+		return false;
+	}
+	return true;
+}
+
+
+uint64_t UnitFollow::Pending()
+{
+	struct stat st;
+	if(fstat(fdin,&st) != 0){
+		return 0;
+	}
+	if((uint64_t)st.st_size < offset){
+		offset = 0;
+	}
+	return (uint64_t)st.st_size - offset;
+}
+
+
+void UnitFollow::ReloadUnits()
+{
+	if(!snapshots){
+		return;
+	}
+	if(!snapshots->Load(unitsfile)){
+		std::cerr << "WARNING: units not reloaded: " << snapshots->Error() << std::endl;
+		return;
+	}
+
+
+	/*
+	 * THE PLAN HOLDS NO REFERENCE TO THE REGISTRY, SO THE GUARD IS ONLY
+	 * NEEDED WHILE COMPILING
+	 */
+	UnitErrorCode err = UNIT_OK;
+	{
+		UnitSnapshots::Reader reader(*snapshots);
+		err = stream.Recompile(reader.Registry());
+	}
+	if(err != UNIT_OK){
+		std::cerr << "WARNING: units not reloaded: " << UnitErrorString(err) << std::endl;
+		return;
+	}
+	nreloads++;
+	std::cerr << "units reloaded from " << (unitsfile.empty() ? "built-in units" : unitsfile) <<
+			" (generation " << snapshots->Generation() << ")" << std::endl;
+}
+
+
+#endif /* UnitFollow_ */
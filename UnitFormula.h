@@ -0,0 +1,1032 @@
+/**
+ * @file UnitFormula.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Derived quantities computed from unit-tagged columns, e.g.
+ *
+ * 		force[lbf] * distance[ft]			to "-:J:1"
+ * 		mass[lbm] * gee						to "-:N:1"
+ * 		0.5 * m[k:g:1] * v[-:mile:1|-:hr:-1]^2	to "-:ft:1|-:lbf:1"
+ *
+ * A formula is built from
+ * 	-	columns, written as a name followed by its units in brackets,
+ * 	-	numbers, optionally followed by units in brackets,
+ * 	-	unit symbols on their own (e.g. "gee"), denoting one of that unit,
+ * 	-	+, -, *, /, parentheses, and integer powers (^).
+ * Units in brackets are either a unit string ("si:unit:power|...") or a
+ * single unit symbol; "-" means dimensionless, in brackets or as the output
+ * units.  Every column must be given the same units wherever it appears
+ * (UNIT_ERR_COLUMN_UNITS otherwise).  Parentheses and unary minus signs may be
+ * nested at most FORMULA_MAX_DEPTH deep.  Logarithmic units (dB, dBm, pH, ...) and non-linear units (API,
+ * ga, ...) do not add or multiply linearly and are rejected.
+ *
+ * Compile() checks dimensions (terms of a sum, and the result against the
+ * output units) and produces a short program of array operations.  Each
+ * intermediate value is carried as an array times a constant; unit factors
+ * and numeric constants are folded into these constants as the formula is
+ * compiled, so e.g. "force[lbf] * distance[ft]" becomes a single multiply of
+ * the two columns followed by one scaling into the output units.  Integer
+ * powers are expanded into multiplies.
+ *
+ * Evaluate() runs the program over blocks of FORMULA_BLOCK_SIZE rows, so
+ * intermediate arrays stay in cache and each operation is a simple loop which
+ * the compiler vectorizes.  Large inputs are split across threads with
+ * OpenMP.  Nothing is interpreted per row.
+ *
+ * Temperatures follow the same rules as UnitPlan: a column or constant in a
+ * single unit with an offset (e.g. "T[F]") is an absolute temperature and is
+ * converted to kelvin before use; otherwise offsets are ignored.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- Logarithmic units are rejected.
+ *
+ * @date 18 October 2026
+ *	- Non-linear units are rejected.
+ *
+ * @date 18 October 2026
+ *	- Limited nesting depth, allowed formulas without columns to be evaluated
+ *	  with no column pointers, accepted "-" for dimensionless units, and
+ *	  report columns re-used with different units as UNIT_ERR_COLUMN_UNITS.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitFormula_
+#define UnitFormula_
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cctype>
+#include "UnitPlan.h"
+
+
+/** @brief Number of rows processed by each pass of the program */
+#define FORMULA_BLOCK_SIZE 1024
+
+/** @brief Maximum nesting depth of parentheses and unary minus signs */
+#define FORMULA_MAX_DEPTH 64
+
+
+/**
+ * @brief Operations in a compiled formula.
+ */
+enum FormulaOp {
+	FORMULA_MUL = 0,	/**< dst = m*a*b */
+	FORMULA_DIV,		/**< dst = m*a/b */
+	FORMULA_RCP,		/**< dst = m/a */
+	FORMULA_AXPY,		/**< dst = a + m*b */
+	FORMULA_AFFINE,		/**< dst = m*a + o */
+	FORMULA_SET			/**< dst = o */
+};
+
+
+/**
+ * @brief Formula over unit-tagged columns, compiled for array evaluation.
+ */
+template <class T>
+class UnitFormula {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre Registry exists and outlives this object.
+	 * @param reg Registry used to look up prefixes and units.
+	 * @post UnitFormula object exists with no program.
+	 * @return None.
+	 */
+	UnitFormula(const UnitRegistry &reg);
+
+
+	/**
+	 * @brief Compile a formula.
+	 * @pre UnitFormula object exists.
+	 * @param formula Formula text.
+	 * @param unitsout Units of the result.
+	 * @post Program and columns replaced if the formula is valid.  Object
+	 * 			cleared otherwise.
+	 * @return UNIT_OK or the reason the formula is invalid.  See
+	 * 			ErrorPosition().
+	 */
+	UnitErrorCode Compile(const std::string &formula, const std::string &unitsout);
+
+
+	/**
+	 * @brief Evaluate the formula over arrays.
+	 * @pre Compile() succeeded.
+	 * @param cols Pointers to the values of each column, in the order given by
+	 * 			ColumnName().
+	 * @param out Pointer to the array to contain the results.  May be one of
+	 * 			the columns.
+	 * @param n Number of rows.
+	 * @post 'out' contains the results.
+	 * @return None.
+	 */
+	void Evaluate(const T *const *cols, T *out, size_t n) const;
+
+
+	/**
+	 * @brief Evaluate the formula over arrays and record the rows whose result
+	 * 			is not a finite number (e.g. division by zero).
+	 * @pre Compile() succeeded.
+	 * @param cols Pointers to the values of each column.
+	 * @param out Pointer to the array to contain the results.
+	 * @param n Number of rows.
+	 * @param errors Reference to the bitmap to contain the failed rows.
+	 * @post 'out' contains the results.  'errors' covers n rows.
+	 * @return Number of failed rows.
+	 */
+	size_t Evaluate(const T *const *cols, T *out, size_t n, UnitErrorBitmap &errors) const;
+
+
+	/**
+	 * @brief Number of columns referenced by the formula.
+	 * @pre UnitFormula object exists.
+	 * @post No changes to object.
+	 * @return Number of columns.
+	 */
+	size_t NumColumns() const;
+
+
+	/**
+	 * @brief Name of a column.
+	 * @pre idx < NumColumns().
+	 * @param idx Position of the column.
+	 * @post No changes to object.
+	 * @return Name of the column.
+	 */
+	const std::string& ColumnName(size_t idx) const;
+
+
+	/**
+	 * @brief Units of a column.
+	 * @pre idx < NumColumns().
+	 * @param idx Position of the column.
+	 * @post No changes to object.
+	 * @return Compiled units of the column.
+	 */
+	const CompiledUnits& ColumnUnits(size_t idx) const;
+
+
+	/**
+	 * @brief Position of a column.
+	 * @pre UnitFormula object exists.
+	 * @param name Name of the column.
+	 * @post No changes to object.
+	 * @return Position of the column, or -1 if the formula does not use it.
+	 */
+	int ColumnIndex(const std::string &name) const;
+
+
+	/**
+	 * @brief Number of operations in the compiled program.
+	 * @pre UnitFormula object exists.
+	 * @post No changes to object.
+	 * @return Number of operations.
+	 */
+	size_t NumOperations() const;
+
+
+	/**
+	 * @brief Position in the formula text at which the last call to
+	 * 			Compile() failed.
+	 * @pre UnitFormula object exists.
+	 * @post No changes to object.
+	 * @return Character offset.
+	 */
+	size_t ErrorPosition() const;
+
+
+
+protected:
+	/**
+	 * @brief One array operation.  Operands are columns (>= 0) or registers
+	 * 			(-1 - register).  The destination is a register, or -1 for the
+	 * 			output.
+	 */
+	struct Instruction {
+		FormulaOp op;
+		int dst;
+		int a;
+		int b;
+		T m;
+		T o;
+	};
+
+
+	/**
+	 * @brief Intermediate value during compilation.  Its value in coherent SI
+	 * 			units is 'k' times operand 'src', or 'c' if 'src' is NOCONST.
+	 */
+	struct Value {
+		int src;
+		double k;
+		double c;
+		int dims[UNIT_NDIMS];
+	};
+
+
+	/** @brief Marker in Value::src for a constant */
+	static const int NOCONST = -1000000;
+
+	/** @brief Registry used to look up prefixes and units */
+	const UnitRegistry &registry;
+
+	/** @brief Names of the columns, in order of first use */
+	std::vector<std::string> colnames;
+
+	/** @brief Units of the columns */
+	std::vector<CompiledUnits> colunits;
+
+	/** @brief Compiled program */
+	std::vector<Instruction> program;
+
+	/** @brief Number of registers used by the program */
+	int nregs;
+
+	/** @brief Registers free for reuse during compilation */
+	std::vector<int> freeregs;
+
+	/** @brief Formula text being compiled */
+	std::string text;
+
+	/** @brief Parse position in 'text' */
+	size_t pos;
+
+	/** @brief Position of the last compile error */
+	size_t errpos;
+
+
+	/**
+	 * @brief Parse a sum or difference of terms.
+	 * @param v Reference to contain the value.
+	 * @param depth Nesting depth.
+	 * @return UNIT_OK or the reason the text is invalid.
+	 */
+	UnitErrorCode ParseSum(Value &v, int depth);
+
+
+	/**
+	 * @brief Parse a product or quotient of factors.
+	 * @param v Reference to contain the value.
+	 * @param depth Nesting depth.
+	 * @return UNIT_OK or the reason the text is invalid.
+	 */
+	UnitErrorCode ParseProduct(Value &v, int depth);
+
+
+	/**
+	 * @brief Parse a factor: an optionally negated, optionally raised primary.
+	 * @param v Reference to contain the value.
+	 * @param depth Nesting depth.
+	 * @return UNIT_OK or the reason the text is invalid.
+	 */
+	UnitErrorCode ParseFactor(Value &v, int depth);
+
+
+	/**
+	 * @brief Parse a column, number, unit symbol, or parenthesized formula.
+	 * @param v Reference to contain the value.
+	 * @param depth Nesting depth.
+	 * @return UNIT_OK or the reason the text is invalid.
+	 */
+	UnitErrorCode ParsePrimary(Value &v, int depth);
+
+
+	/**
+	 * @brief Parse units in brackets.  The opening bracket has been consumed.
+	 * @param units Reference to contain the compiled units.
+	 * @return UNIT_OK or the reason the units are invalid.
+	 */
+	UnitErrorCode ParseUnits(CompiledUnits &units);
+
+
+	/**
+	 * @brief Compile a unit string or a single unit symbol.
+	 * @param str Units.
+	 * @param units Reference to contain the compiled units.
+	 * @return UNIT_OK or the reason the units are invalid.
+	 */
+	UnitErrorCode CompileUnits(const std::string &str, CompiledUnits &units) const;
+
+
+	/**
+	 * @brief Skip white space.
+	 * @return None.
+	 */
+	void SkipSpace();
+
+
+	/**
+	 * @brief Skip white space and check for a character.
+	 * @param ch Character expected.
+	 * @return Boolean value indicating the character was found and consumed.
+	 */
+	bool Accept(char ch);
+
+
+	/**
+	 * @brief Emit an instruction into a newly allocated register.  Operands
+	 * 			which are no longer needed should be released first; since
+	 * 			operations are element-wise, the destination may re-use them.
+	 * @return Operand code of the destination.
+	 */
+	int Emit(FormulaOp op, int a, int b, double m, double o);
+
+
+	/**
+	 * @brief Return the register held by an operand, if any, for re-use.
+	 * @return None.
+	 */
+	void Release(int src);
+
+
+	/**
+	 * @brief Multiply or divide two values.
+	 * @return None.
+	 */
+	void Multiply(Value &a, const Value &b, bool divide);
+
+
+	/**
+	 * @brief Raise a value to an integer power.
+	 * @return None.
+	 */
+	void Power(Value &a, int power);
+
+
+	/**
+	 * @brief Add or subtract two values of the same dimension.
+	 * @return None.
+	 */
+	void Add(Value &a, const Value &b, double sign);
+
+
+	/**
+	 * @brief Value of a constant in units.
+	 * @return None.
+	 */
+	static void Constant(Value &v, double c, const CompiledUnits &units);
+
+
+	/**
+	 * @brief Evaluate rows first ... first+n-1.
+	 * @param regs Pointer to the registers (nregs*FORMULA_BLOCK_SIZE values).
+	 * @return None.
+	 */
+	void EvaluateBlock(const T *const *cols, T *out, size_t first, size_t n, T *regs) const;
+
+};
+
+
+
+// ==== PUBLIC FUNCTIONS =======================================================
+
+template <class T>
+UnitFormula<T>::UnitFormula(const UnitRegistry &reg) : registry(reg), nregs(0),
+		pos(0), errpos(0)
+{
+}
+
+
+template <class T>
+UnitErrorCode UnitFormula<T>::Compile(const std::string &formula, const std::string &unitsout)
+{
+	colnames.clear();
+	colunits.clear();
+	program.clear();
+	freeregs.clear();
+	nregs = 0;
+	text = formula;
+	pos = 0;
+	errpos = 0;
+
+
+	/*
+	 * PARSE AND COMPILE THE FORMULA IN ONE PASS
+	 */
+	CompiledUnits cout;
+	UnitErrorCode err = CompileUnits(unitsout,cout);
+	Value v;
+	if(err == UNIT_OK){
+		err = ParseSum(v,0);
+	}
+	SkipSpace();
+	if(err == UNIT_OK && pos < text.size()){
+		err = UNIT_ERR_SYNTAX;
+	}
+	if(err == UNIT_OK){
+		for(int d=0; d<UNIT_NDIMS; d++){
+			if(v.dims[d] != cout.Dimensions()[d]){
+				err = UNIT_ERR_DIMENSION_MISMATCH;
+			}
+		}
+	}
+	if(err != UNIT_OK){
+		errpos = pos;
+		colnames.clear();
+		colunits.clear();
+		program.clear();
+		nregs = 0;
+		return err;
+	}
+
+
+	/*
+	 * SCALE INTO THE OUTPUT UNITS.  IF THE LAST OPERATION PRODUCED THE VALUE,
+	 * THE SCALING IS FOLDED INTO IT AND IT WRITES THE OUTPUT DIRECTLY.
+	 */
+	double fout = cout.Factor();
+	double oout = cout.IsAbsolute() ? cout.Offset() : 0.0;
+	double s = v.k/fout;
+	double o = -oout/fout;
+	Instruction *last = program.empty() ? 0 : &program.back();
+	if(v.src == NOCONST){
+		Instruction ins = {FORMULA_SET, -1, 0, 0, (T)0, (T)((v.c - oout)/fout)};
+		program.push_back(ins);
+	} else if(v.src < 0 && last && last->dst == -1 - v.src && last->op == FORMULA_AFFINE){
+		last->dst = -1;
+		last->o = (T)(last->o*s + o);
+		last->m = (T)(last->m*s);
+	} else if(v.src < 0 && last && last->dst == -1 - v.src && oout == 0.0 &&
+			(last->op != FORMULA_AXPY || s == 1.0)){
+		/* AXPY HAS NO OVERALL SCALE, SO IS ONLY RETARGETED WHEN s IS 1 */
+		last->dst = -1;
+		if(last->op != FORMULA_AXPY){
+			last->m = (T)(last->m*s);
+		}
+	} else {
+		Instruction ins = {FORMULA_AFFINE, -1, v.src, 0, (T)s, (T)o};
+		program.push_back(ins);
+	}
+	return UNIT_OK;
+}
+
+
+template <class T>
+void UnitFormula<T>::Evaluate(const T *const *cols, T *out, size_t n) const
+{
+	const long long nblocks = (long long)((n + FORMULA_BLOCK_SIZE - 1)/FORMULA_BLOCK_SIZE);
+#pragma omp parallel if(n > UNITPLAN_PARALLEL_MIN)
+	{
+		std::vector<T> regs((size_t)(nregs > 0 ? nregs : 1)*FORMULA_BLOCK_SIZE);
+#pragma omp for schedule(static)
+		for(long long b=0; b<nblocks; b++){
+			size_t first = (size_t)b*FORMULA_BLOCK_SIZE;
+			size_t count = std::min((size_t)FORMULA_BLOCK_SIZE,n - first);
+			EvaluateBlock(cols,out,first,count,regs.data());
+		}
+	}
+}
+
+
+template <class T>
+size_t UnitFormula<T>::Evaluate(const T *const *cols, T *out, size_t n, UnitErrorBitmap &errors) const
+{
+	Evaluate(cols,out,n);
+	errors.Reset(n);
+	errors.MarkNonFinite(out,0,n);
+	return errors.Count();
+}
+
+
+template <class T>
+size_t UnitFormula<T>::NumColumns() const
+{
+	return colnames.size();
+}
+
+
+template <class T>
+const std::string& UnitFormula<T>::ColumnName(size_t idx) const
+{
+	return colnames[idx];
+}
+
+
+template <class T>
+const CompiledUnits& UnitFormula<T>::ColumnUnits(size_t idx) const
+{
+	return colunits[idx];
+}
+
+
+template <class T>
+int UnitFormula<T>::ColumnIndex(const std::string &name) const
+{
+	for(size_t i=0; i<colnames.size(); i++){
+		if(colnames[i] == name){
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+
+template <class T>
+size_t UnitFormula<T>::NumOperations() const
+{
+	return program.size();
+}
+
+
+template <class T>
+size_t UnitFormula<T>::ErrorPosition() const
+{
+	return errpos;
+}
+
+
+
+// ==== PROTECTED FUNCTIONS ====================================================
+
+template <class T>
+UnitErrorCode UnitFormula<T>::ParseSum(Value &v, int depth)
+{
+	UnitErrorCode err = ParseProduct(v,depth);
+	while(err == UNIT_OK){
+		double sign = 0.0;
+		if(Accept('+')){
+			sign = 1.0;
+		} else if(Accept('-')){
+			sign = -1.0;
+		} else {
+			break;
+		}
+		Value rhs;
+		err = ParseProduct(rhs,depth);
+		if(err != UNIT_OK){
+			break;
+		}
+		for(int d=0; d<UNIT_NDIMS; d++){
+			if(v.dims[d] != rhs.dims[d]){
+				return UNIT_ERR_DIMENSION_MISMATCH;
+			}
+		}
+		Add(v,rhs,sign);
+	}
+	return err;
+}
+
+
+template <class T>
+UnitErrorCode UnitFormula<T>::ParseProduct(Value &v, int depth)
+{
+	UnitErrorCode err = ParseFactor(v,depth);
+	while(err == UNIT_OK){
+		bool divide = false;
+		if(Accept('*')){
+			divide = false;
+		} else if(Accept('/')){
+			divide = true;
+		} else {
+			break;
+		}
+		Value rhs;
+		err = ParseFactor(rhs,depth);
+		if(err == UNIT_OK){
+			Multiply(v,rhs,divide);
+		}
+	}
+	return err;
+}
+
+
+template <class T>
+UnitErrorCode UnitFormula<T>::ParseFactor(Value &v, int depth)
+{
+	if(Accept('-')){
+		if(depth == FORMULA_MAX_DEPTH){
+			return UNIT_ERR_SYNTAX;
+		}
+		UnitErrorCode err = ParseFactor(v,depth+1);
+		v.k = -v.k;
+		v.c = -v.c;
+		return err;
+	}
+
+	UnitErrorCode err = ParsePrimary(v,depth);
+	if(err != UNIT_OK || !Accept('^')){
+		return err;
+	}
+	bool negative = Accept('-');
+	SkipSpace();
+	size_t start = pos;
+	while(pos < text.size() && std::isdigit((unsigned char)text[pos])){
+		pos++;
+	}
+	if(pos == start){
+		return UNIT_ERR_SYNTAX;
+	}
+	long power = std::strtol(text.substr(start,pos-start).c_str(),0,10);
+	if(pos - start > 3 || power > UNIT_MAX_POWER){
+		return UNIT_ERR_BAD_POWER;
+	}
+	Power(v,negative ? -(int)power : (int)power);
+	return UNIT_OK;
+}
+
+
+template <class T>
+UnitErrorCode UnitFormula<T>::ParsePrimary(Value &v, int depth)
+{
+	if(Accept('(')){
+		if(depth == FORMULA_MAX_DEPTH){
+			return UNIT_ERR_SYNTAX;
+		}
+		UnitErrorCode err = ParseSum(v,depth+1);
+		if(err == UNIT_OK && !Accept(')')){
+			err = UNIT_ERR_SYNTAX;
+		}
+		return err;
+	}
+
+
+	/*
+	 * NUMBER, OPTIONALLY WITH UNITS
+	 */
+	SkipSpace();
+	if(pos >= text.size()){
+		return UNIT_ERR_SYNTAX;
+	}
+	char ch = text[pos];
+	if(std::isdigit((unsigned char)ch) || ch == '.'){
+		const char *start = text.c_str() + pos;
+		char *end = 0;
+		double c = std::strtod(start,&end);
+		if(end == start){
+			return UNIT_ERR_SYNTAX;
+		}
+		pos += (size_t)(end - start);
+		CompiledUnits units;
+		if(Accept('[')){
+			UnitErrorCode err = ParseUnits(units);
+			if(err != UNIT_OK){
+				return err;
+			}
+		}
+		Constant(v,c,units);
+		return UNIT_OK;
+	}
+
+
+	/*
+	 * COLUMN (NAME WITH UNITS) OR UNIT SYMBOL
+	 */
+	if(!std::isalpha((unsigned char)ch) && ch != '_'){
+		return UNIT_ERR_SYNTAX;
+	}
+	size_t start = pos;
+	while(pos < text.size() && (std::isalnum((unsigned char)text[pos]) || text[pos] == '_')){
+		pos++;
+	}
+	std::string name = text.substr(start,pos-start);
+	CompiledUnits units;
+	if(!Accept('[')){
+		UnitErrorCode err = CompileUnits(name,units);
+		if(err != UNIT_OK){
+			pos = start;
+			return err;
+		}
+		Constant(v,1.0,units);
+		return UNIT_OK;
+	}
+	UnitErrorCode err = ParseUnits(units);
+	if(err != UNIT_OK){
+		return err;
+	}
+
+	int col = ColumnIndex(name);
+	if(col < 0){
+		col = (int)colnames.size();
+		colnames.push_back(name);
+		colunits.push_back(units);
+	} else if(!units.SameDimension(colunits[col]) ||
+			units.Factor() != colunits[col].Factor() ||
+			units.IsAbsolute() != colunits[col].IsAbsolute() ||
+			(units.IsAbsolute() && units.Offset() != colunits[col].Offset())){
+		pos = start;
+		return UNIT_ERR_COLUMN_UNITS;
+	}
+
+	for(int d=0; d<UNIT_NDIMS; d++){
+		v.dims[d] = units.Dimensions()[d];
+	}
+	v.c = 0.0;
+	if(units.IsAbsolute()){
+		v.src = Emit(FORMULA_AFFINE,col,0,units.Factor(),units.Offset());
+		v.k = 1.0;
+	} else {
+		v.src = col;
+		v.k = units.Factor();
+	}
+	return UNIT_OK;
+}
+
+
+template <class T>
+UnitErrorCode UnitFormula<T>::ParseUnits(CompiledUnits &units)
+{
+	size_t close = text.find(']',pos);
+	if(close == std::string::npos){
+		return UNIT_ERR_SYNTAX;
+	}
+	UnitErrorCode err = CompileUnits(text.substr(pos,close-pos),units);
+	if(err == UNIT_OK){
+		pos = close + 1;
+	}
+	return err;
+}
+
+
+template <class T>
+UnitErrorCode UnitFormula<T>::CompileUnits(const std::string &str, CompiledUnits &units) const
+{
+	UnitErrorCode err;
+	if(str == "-"){
+		units.Clear();
+		err = UNIT_OK;
+	} else if(str.find(':') != std::string::npos || str.empty()){
+		err = units.Compile(registry,str);
+	} else {
+		units.Clear();
+		err = units.AddTerm(registry,"-",str,1);
+	}
+	if(err == UNIT_OK && units.HasLogUnits()){
+		err = UNIT_ERR_LOG_MISUSE;
+	}
+	if(err == UNIT_OK && units.HasCurveUnits()){
+		err = UNIT_ERR_CURVE_MISUSE;
+	}
+	return err;
+}
+
+
+template <class T>
+void UnitFormula<T>::SkipSpace()
+{
+	while(pos < text.size() && std::isspace((unsigned char)text[pos])){
+		pos++;
+	}
+}
+
+
+template <class T>
+bool UnitFormula<T>::Accept(char ch)
+{
+	SkipSpace();
+	if(pos < text.size() && text[pos] == ch){
+		pos++;
+		return true;
+	}
+	return false;
+}
+
+
+template <class T>
+int UnitFormula<T>::Emit(FormulaOp op, int a, int b, double m, double o)
+{
+	int reg = 0;
+	if(freeregs.empty()){
+		reg = nregs++;
+	} else {
+		reg = freeregs.back();
+		freeregs.pop_back();
+	}
+	Instruction ins = {op, reg, a, b, (T)m, (T)o};
+	program.push_back(ins);
+	return -1 - reg;
+}
+
+
+template <class T>
+void UnitFormula<T>::Release(int src)
+{
+	if(src < 0 && src != NOCONST){
+		freeregs.push_back(-1 - src);
+	}
+}
+
+
+template <class T>
+void UnitFormula<T>::Multiply(Value &a, const Value &b, bool divide)
+{
+	double sign = divide ? -1.0 : 1.0;
+	for(int d=0; d<UNIT_NDIMS; d++){
+		a.dims[d] += (int)sign*b.dims[d];
+	}
+
+	if(a.src == NOCONST && b.src == NOCONST){
+		a.c = divide ? a.c/b.c : a.c*b.c;
+	} else if(b.src == NOCONST){
+		a.k = divide ? a.k/b.c : a.k*b.c;
+	} else if(a.src == NOCONST){
+		if(divide){
+			Release(b.src);
+			a.src = Emit(FORMULA_RCP,b.src,0,1.0,0.0);
+			a.k = a.c/b.k;
+		} else {
+			a.src = b.src;
+			a.k = a.c*b.k;
+		}
+		a.c = 0.0;
+	} else {
+		Release(a.src);
+		Release(b.src);
+		a.src = Emit(divide ? FORMULA_DIV : FORMULA_MUL,a.src,b.src,1.0,0.0);
+		a.k = divide ? a.k/b.k : a.k*b.k;
+	}
+}
+
+
+template <class T>
+void UnitFormula<T>::Power(Value &a, int power)
+{
+	for(int d=0; d<UNIT_NDIMS; d++){
+		a.dims[d] *= power;
+	}
+	if(a.src == NOCONST){
+		a.c = std::pow(a.c,(double)power);
+		return;
+	}
+	if(power == 0){
+		Release(a.src);
+		a.src = NOCONST;
+		a.c = 1.0;
+		return;
+	}
+
+
+	/*
+	 * EXPAND INTO MULTIPLIES BY REPEATED SQUARING.  WHILE THE RESULT IS STILL
+	 * THE ORIGINAL BASE ('shared'), SQUARING MUST NOT RELEASE IT.
+	 */
+	int n = power < 0 ? -power : power;
+	int base = a.src;
+	int result = NOCONST;
+	bool shared = false;
+	while(n > 0){
+		if(n & 1){
+			if(result == NOCONST){
+				result = base;
+				shared = true;
+			} else {
+				Release(result);
+				if(n == 1){
+					Release(base);
+				}
+				result = Emit(FORMULA_MUL,result,base,1.0,0.0);
+			}
+		}
+		n >>= 1;
+		if(n > 0){
+			if(!shared){
+				Release(base);
+			}
+			base = Emit(FORMULA_MUL,base,base,1.0,0.0);
+			shared = false;
+		}
+	}
+	if(power < 0){
+		Release(result);
+		result = Emit(FORMULA_RCP,result,0,1.0,0.0);
+	}
+	a.src = result;
+	a.k = std::pow(a.k,(double)power);
+}
+
+
+template <class T>
+void UnitFormula<T>::Add(Value &a, const Value &b, double sign)
+{
+	Release(a.src);
+	Release(b.src);
+	if(a.src == NOCONST && b.src == NOCONST){
+		a.c += sign*b.c;
+	} else if(b.src == NOCONST){
+		a.src = Emit(FORMULA_AFFINE,a.src,0,a.k,sign*b.c);
+		a.k = 1.0;
+	} else if(a.src == NOCONST){
+		a.src = Emit(FORMULA_AFFINE,b.src,0,sign*b.k,a.c);
+		a.k = 1.0;
+	} else if(a.k != 0.0){
+		a.src = Emit(FORMULA_AXPY,a.src,b.src,sign*b.k/a.k,0.0);
+	} else {
+		a.src = Emit(FORMULA_AFFINE,b.src,0,sign*b.k,0.0);
+		a.k = 1.0;
+	}
+}
+
+
+template <class T>
+void UnitFormula<T>::Constant(Value &v, double c, const CompiledUnits &units)
+{
+	v.src = NOCONST;
+	v.k = 1.0;
+	v.c = c*units.Factor() + (units.IsAbsolute() ? units.Offset() : 0.0);
+	for(int d=0; d<UNIT_NDIMS; d++){
+		v.dims[d] = units.Dimensions()[d];
+	}
+}
+
+
+template <class T>
+void UnitFormula<T>::EvaluateBlock(const T *const *cols, T *out, size_t first, size_t n,
+		T *regs) const
+{
+	for(size_t p=0; p<program.size(); p++){
+		const Instruction &ins = program[p];
+		T *d = (ins.dst < 0) ? out + first : regs + (size_t)ins.dst*FORMULA_BLOCK_SIZE;
+		const T m = ins.m;
+		const T o = ins.o;
+		if(ins.op == FORMULA_SET){
+			for(size_t i=0; i<n; i++){ d[i] = o; }
+			continue;
+		}
+
+
+		/*
+		 * OPERANDS ARE ONLY RESOLVED FOR OPERATIONS WHICH READ THEM, SO A
+		 * FORMULA WITHOUT COLUMNS MAY BE EVALUATED WITH NO COLUMN POINTERS
+		 */
+		const T *a = (ins.a >= 0) ? cols[ins.a] + first :
+				regs + (size_t)(-1 - ins.a)*FORMULA_BLOCK_SIZE;
+		const T *b = a;
+		if(ins.op == FORMULA_MUL || ins.op == FORMULA_DIV || ins.op == FORMULA_AXPY){
+			b = (ins.b >= 0) ? cols[ins.b] + first :
+					regs + (size_t)(-1 - ins.b)*FORMULA_BLOCK_SIZE;
+		}
+
+		switch(ins.op){
+		case FORMULA_MUL:
+#pragma omp simd
+			for(size_t i=0; i<n; i++){ d[i] = m*a[i]*b[i]; }
+			break;
+		case FORMULA_DIV:
+#pragma omp simd
+			for(size_t i=0; i<n; i++){ d[i] = m*a[i]/b[i]; }
+			break;
+		case FORMULA_RCP:
+#pragma omp simd
+			for(size_t i=0; i<n; i++){ d[i] = m/a[i]; }
+			break;
+		case FORMULA_AXPY:
+#pragma omp simd
+			for(size_t i=0; i<n; i++){ d[i] = a[i] + m*b[i]; }
+			break;
+		case FORMULA_AFFINE:
+#pragma omp simd
+			for(size_t i=0; i<n; i++){ d[i] = m*a[i] + o; }
+			break;
+		case FORMULA_SET:
+			break;
+		}
+	}
+}
+
+
+#endif /* UnitFormula_ */
@@ -0,0 +1,1010 @@
+/**
+ * @file UnitIO.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Sequential file input and output for the bulk conversion modes.  On Linux
+ * kernels with io_uring, regular files are read and written asynchronously:
+ * 	-	UnitFileReader keeps UNITIO_DEPTH block reads in flight, so the device
+ * 		queue stays full while earlier blocks are being converted, and
+ * 	-	UnitFileWriter copies output into one of UNITIO_DEPTH blocks and
+ * 		returns while the block is written.
+ *
+ * The blocks are registered with the kernel when possible (fixed buffers),
+ * which avoids mapping them for every request.  Files may optionally be
+ * opened with O_DIRECT to bypass the page cache; blocks are aligned for this,
+ * and a final partial block is padded when written and the file truncated
+ * afterwards.
+ *
+ * Where io_uring is unavailable (older kernels, or disabled by a security
+ * policy) the same classes fall back to pread()/pwrite().  Pipes and
+ * terminals, including standard input and output, always use read()/write().
+ *
+ * io_uring is used through its system calls directly, so no additional
+ * library is required.
+ *
+ * All functions contained within these classes are intended for use with the
+ * GNU C++ compiler (g++).  Use with other compilers may produce unexpected
+ * results and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitIO_
+#define UnitIO_
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+
+/** @brief Size of each block read or written */
+#define UNITIO_BLOCK_SIZE 1048576
+
+/** @brief Number of blocks in flight */
+#define UNITIO_DEPTH 8
+
+/** @brief Alignment of blocks, offsets, and sizes for O_DIRECT */
+#define UNITIO_ALIGN 4096
+
+
+/**
+ * @brief Minimal io_uring submission and completion rings.
+ */
+class UnitRing {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre None.
+	 * @post UnitRing object exists but is not usable until Init() succeeds.
+	 * @return None.
+	 */
+	UnitRing();
+
+
+	/**
+	 * @brief Destructor.
+	 * @pre UnitRing object exists.
+	 * @post Rings unmapped and closed.
+	 * @return None.
+	 */
+	~UnitRing();
+
+
+	/**
+	 * @brief Create the rings.
+	 * @pre UnitRing object exists.
+	 * @param entries Number of submission entries.
+	 * @post Rings created if io_uring is available.
+	 * @return Boolean value indicating success or failure.
+	 */
+	bool Init(unsigned entries);
+
+
+	/**
+	 * @brief Release the rings.  Requests in flight must have completed.
+	 * @pre UnitRing object exists.
+	 * @post Rings unmapped and closed.
+	 * @return None.
+	 */
+	void Exit();
+
+
+	/**
+	 * @brief Register buffers for use with fixed-buffer requests.
+	 * @pre Init() succeeded.
+	 * @param iov Pointer to the buffer descriptions.
+	 * @param n Number of buffers.
+	 * @post Buffers registered if permitted.
+	 * @return Boolean value indicating success or failure.
+	 */
+	bool Register(const struct iovec *iov, unsigned n);
+
+
+	/**
+	 * @brief Queue a read or write.  The request is passed to the kernel by
+	 * 			the next call to Submit() or Wait().
+	 * @pre Init() succeeded.  Fewer than 'entries' requests outstanding.
+	 * @param write Indicator for a write rather than a read.
+	 * @param fd File descriptor.
+	 * @param iov Pointer to the buffer description.  Must remain valid until
+	 * 			submitted.
+	 * @param offset File offset.
+	 * @param index Index of the registered buffer, or -1 if not registered.
+	 * @param tag Value returned with the completion.
+	 * @post Request queued.
+	 * @return None.
+	 */
+	void Queue(bool write, int fd, const struct iovec *iov, uint64_t offset,
+			int index, uint64_t tag);
+
+
+	/**
+	 * @brief Pass queued requests to the kernel.
+	 * @pre Init() succeeded.
+	 * @post Queued requests submitted.
+	 * @return Boolean value indicating success or failure.
+	 */
+	bool Submit();
+
+
+	/**
+	 * @brief Submit queued requests and wait for one completion.
+	 * @pre Init() succeeded.  At least one request outstanding.
+	 * @param tag Reference to contain the tag of the completed request.
+	 * @param result Reference to contain the number of bytes transferred, or
+	 * 			a negative errno value.
+	 * @post Completion consumed.
+	 * @return Boolean value indicating success or failure.
+	 */
+	bool Wait(uint64_t &tag, int &result);
+
+
+
+protected:
+	/** @brief Ring file descriptor */
+	int ringfd;
+
+	/** @brief Mapped submission ring */
+	void *sqring;
+
+	/** @brief Mapped completion ring (may equal sqring) */
+	void *cqring;
+
+	/** @brief Mapped submission entries */
+	struct io_uring_sqe *sqes;
+
+	/** @brief Sizes of the mappings */
+	size_t sqsize, cqsize, sqesize;
+
+	/** @brief Pointers into the submission ring */
+	unsigned *sqhead, *sqtail, *sqmask, *sqarray;
+
+	/** @brief Pointers into the completion ring */
+	unsigned *cqhead, *cqtail, *cqmask;
+
+	/** @brief Completion entries */
+	struct io_uring_cqe *cqes;
+
+	/** @brief Number of requests queued but not yet submitted */
+	unsigned nqueued;
+
+};
+
+
+
+/**
+ * @brief Sequential reader with read-ahead.
+ */
+class UnitFileReader {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre None.
+	 * @post UnitFileReader object exists.
+	 * @return None.
+	 */
+	UnitFileReader();
+
+
+	/**
+	 * @brief Destructor.
+	 * @pre UnitFileReader object exists.
+	 * @post File closed and buffers released.
+	 * @return None.
+	 */
+	~UnitFileReader();
+
+
+	/**
+	 * @brief Open a file and start reading ahead.
+	 * @pre UnitFileReader object exists and no file is open.
+	 * @param filename File name, or "-" for standard input.
+	 * @param direct Indicator to bypass the page cache (regular files only).
+	 * @post File open.
+	 * @return Boolean value indicating success or failure.
+	 */
+	bool Open(const std::string &filename, bool direct);
+
+
+	/**
+	 * @brief Next block of the file.
+	 * @pre File open.
+	 * @param data Reference to contain a pointer to the block.  The block is
+	 * 			valid until the next call.
+	 * @return Number of bytes, 0 at end of file, or -1 on error.
+	 */
+	ssize_t Read(const char *&data);
+
+
+	/**
+	 * @brief Check whether io_uring is in use.
+	 * @pre UnitFileReader object exists.
+	 * @post No changes to object.
+	 * @return Boolean value indicating io_uring is in use.
+	 */
+	bool Async() const;
+
+
+	/**
+	 * @brief Close the file, abandoning any reads in flight.
+	 * @pre UnitFileReader object exists.
+	 * @post File closed.
+	 * @return None.
+	 */
+	void Close();
+
+
+
+protected:
+	/** @brief File descriptor */
+	int fd;
+
+	/** @brief Indicator that the file is regular (supports offsets) */
+	bool regular;
+
+	/** @brief Size of a regular file */
+	uint64_t filesize;
+
+	/** @brief Aligned blocks */
+	std::vector<char*> blocks;
+
+	/** @brief Buffer descriptions for the blocks */
+	std::vector<struct iovec> iovs;
+
+	/** @brief Result of the read into each block, or 1 while in flight */
+	std::vector<ssize_t> results;
+
+	/** @brief io_uring rings */
+	UnitRing ring;
+
+	/** @brief Indicator that io_uring is in use */
+	bool async;
+
+	/** @brief Indicator that the blocks are registered */
+	bool fixed;
+
+	/** @brief Number of reads in flight */
+	unsigned inflight;
+
+	/** @brief Index of the next block to be returned by Read() */
+	uint64_t nextblock;
+
+	/** @brief Index of the next block to be requested */
+	uint64_t nextrequest;
+
+
+	/**
+	 * @brief Queue the read of the next unrequested block, if any remain.
+	 * @post Request queued.
+	 * @return None.
+	 */
+	void RequestNext();
+
+};
+
+
+
+/**
+ * @brief Sequential writer with write-behind.
+ */
+class UnitFileWriter {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre None.
+	 * @post UnitFileWriter object exists.
+	 * @return None.
+	 */
+	UnitFileWriter();
+
+
+	/**
+	 * @brief Destructor.  Calls Close() if a file is open.
+	 * @pre UnitFileWriter object exists.
+	 * @post File closed and buffers released.
+	 * @return None.
+	 */
+	~UnitFileWriter();
+
+
+	/**
+	 * @brief Create a file.
+	 * @pre UnitFileWriter object exists and no file is open.
+	 * @param filename File name, or "-" for standard output.
+	 * @param direct Indicator to bypass the page cache (regular files only).
+	 * @post File created or truncated.
+	 * @return Boolean value indicating success or failure.
+	 */
+	bool Open(const std::string &filename, bool direct);
+
+
+	/**
+	 * @brief Append bytes to the file.
+	 * @pre File open.
+	 * @param data Pointer to the bytes.
+	 * @param n Number of bytes.
+	 * @post Bytes copied; they may not yet be written.
+	 * @return Boolean value indicating success or failure of this and all
+	 * 			earlier writes.
+	 */
+	bool Write(const char *data, size_t n);
+
+
+	/**
+	 * @brief Write remaining bytes, wait for all writes, and close the file.
+	 * @pre UnitFileWriter object exists.
+	 * @post File closed.
+	 * @return Boolean value indicating success or failure of all writes.
+	 */
+	bool Close();
+
+
+
+protected:
+	/** @brief File descriptor */
+	int fd;
+
+	/** @brief Indicator that the file is regular (supports offsets) */
+	bool regular;
+
+	/** @brief Indicator that the file was opened with O_DIRECT */
+	bool direct;
+
+	/** @brief Aligned blocks */
+	std::vector<char*> blocks;
+
+	/** @brief Buffer descriptions for the blocks */
+	std::vector<struct iovec> iovs;
+
+	/** @brief Indicator that each block is being written */
+	std::vector<bool> busy;
+
+	/** @brief io_uring rings */
+	UnitRing ring;
+
+	/** @brief Indicator that io_uring is in use */
+	bool async;
+
+	/** @brief Indicator that the blocks are registered */
+	bool fixed;
+
+	/** @brief Number of writes in flight */
+	unsigned inflight;
+
+	/** @brief Block being filled */
+	unsigned current;
+
+	/** @brief Number of bytes in the block being filled */
+	size_t fill;
+
+	/** @brief File offset of the block being filled */
+	uint64_t offset;
+
+	/** @brief Indicator that a write failed */
+	bool failed;
+
+
+	/**
+	 * @brief Write the block being filled and move to a free block.
+	 * @param n Number of bytes to write (may exceed 'fill' when padded).
+	 * @post Block written or submitted.
+	 * @return Boolean value indicating success or failure.
+	 */
+	bool Flush(size_t n);
+
+
+	/**
+	 * @brief Wait for one write to complete.
+	 * @post Block released.
+	 * @return Boolean value indicating success or failure.
+	 */
+	bool Reap();
+
+};
+
+
+
+// ==== HELPER FUNCTIONS =======================================================
+
+/**
+ * @brief Allocate aligned blocks and describe them.
+ * @param blocks Reference to contain the blocks.
+ * @param iovs Reference to contain the descriptions.
+ * @return Boolean value indicating success or failure.
+ */
+inline bool UnitIOAllocate(std::vector<char*> &blocks, std::vector<struct iovec> &iovs)
+{
+	blocks.assign(UNITIO_DEPTH,(char*)0);
+	iovs.resize(UNITIO_DEPTH);
+	for(int i=0; i<UNITIO_DEPTH; i++){
+		void *p = 0;
+		if(posix_memalign(&p,UNITIO_ALIGN,UNITIO_BLOCK_SIZE) != 0){
+			return false;
+		}
+		blocks[i] = (char*)p;
+		iovs[i].iov_base = p;
+		iovs[i].iov_len = UNITIO_BLOCK_SIZE;
+	}
+	return true;
+}
+
+
+/**
+ * @brief Release blocks allocated by UnitIOAllocate().
+ * @param blocks Reference to the blocks.  Cleared.
+ * @return None.
+ */
+inline void UnitIORelease(std::vector<char*> &blocks)
+{
+	for(size_t i=0; i<blocks.size(); i++){
+		free(blocks[i]);
+	}
+	blocks.clear();
+}
+
+
+
+// ==== UnitRing ===============================================================
+
+UnitRing::UnitRing() : ringfd(-1), sqring(MAP_FAILED), cqring(MAP_FAILED),
+		sqes((struct io_uring_sqe*)MAP_FAILED), sqsize(0), cqsize(0), sqesize(0),
+		sqhead(0), sqtail(0), sqmask(0), sqarray(0), cqhead(0), cqtail(0),
+		cqmask(0), cqes(0), nqueued(0)
+{
+}
+
+
+UnitRing::~UnitRing()
+{
+	Exit();
+}
+
+
+bool UnitRing::Init(unsigned entries)
+{
+	Exit();
+	struct io_uring_params params;
+	std::memset(&params,0,sizeof(params));
+	ringfd = (int)syscall(__NR_io_uring_setup,entries,&params);
+	if(ringfd < 0){
+		return false;
+	}
+
+
+	/*
+	 * MAP THE RINGS.  NEWER KERNELS SHARE ONE MAPPING FOR BOTH.
+	 */
+	sqsize = params.sq_off.array + params.sq_entries*sizeof(unsigned);
+	cqsize = params.cq_off.cqes + params.cq_entries*sizeof(struct io_uring_cqe);
+	bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if(single){
+		sqsize = cqsize = (sqsize > cqsize ? sqsize : cqsize);
+	}
+	sqring = mmap(0,sqsize,PROT_READ | PROT_WRITE,MAP_SHARED | MAP_POPULATE,
+			ringfd,IORING_OFF_SQ_RING);
+	if(sqring == MAP_FAILED){
+		return false;
+	}
+	cqring = single ? sqring : mmap(0,cqsize,PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE,ringfd,IORING_OFF_CQ_RING);
+	if(cqring == MAP_FAILED){
+		return false;
+	}
+	sqesize = params.sq_entries*sizeof(struct io_uring_sqe);
+	sqes = (struct io_uring_sqe*)mmap(0,sqesize,PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE,ringfd,IORING_OFF_SQES);
+	if(sqes == MAP_FAILED){
+		return false;
+	}
+
+	char *sq = (char*)sqring;
+	char *cq = (char*)cqring;
+	sqhead = (unsigned*)(sq + params.sq_off.head);
+	sqtail = (unsigned*)(sq + params.sq_off.tail);
+	sqmask = (unsigned*)(sq + params.sq_off.ring_mask);
+	sqarray = (unsigned*)(sq + params.sq_off.array);
+	cqhead = (unsigned*)(cq + params.cq_off.head);
+	cqtail = (unsigned*)(cq + params.cq_off.tail);
+	cqmask = (unsigned*)(cq + params.cq_off.ring_mask);
+	cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+	return true;
+}
+
+
+void UnitRing::Exit()
+{
+	if(sqes != MAP_FAILED){ munmap(sqes,sqesize); }
+	if(cqring != MAP_FAILED && cqring != sqring){ munmap(cqring,cqsize); }
+	if(sqring != MAP_FAILED){ munmap(sqring,sqsize); }
+	if(ringfd >= 0){ close(ringfd); }
+	sqes = (struct io_uring_sqe*)MAP_FAILED;
+	sqring = cqring = MAP_FAILED;
+	ringfd = -1;
+	nqueued = 0;
+}
+
+
+bool UnitRing::Register(const struct iovec *iov, unsigned n)
+{
+	return syscall(__NR_io_uring_register,ringfd,IORING_REGISTER_BUFFERS,iov,n) == 0;
+}
+
+
+void UnitRing::Queue(bool write, int fd, const struct iovec *iov, uint64_t offset,
+		int index, uint64_t tag)
+{
+	unsigned tail = *sqtail;
+	unsigned idx = tail & *sqmask;
+	struct io_uring_sqe *sqe = &sqes[idx];
+	std::memset(sqe,0,sizeof(*sqe));
+	sqe->fd = fd;
+	sqe->off = offset;
+	sqe->user_data = tag;
+	if(index >= 0){
+		sqe->opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+		sqe->addr = (uint64_t)(uintptr_t)iov->iov_base;
+		sqe->len = (uint32_t)iov->iov_len;
+		sqe->buf_index = (uint16_t)index;
+	} else {
+		sqe->opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+		sqe->addr = (uint64_t)(uintptr_t)iov;
+		sqe->len = 1;
+	}
+	sqarray[idx] = idx;
+	__atomic_store_n(sqtail,tail + 1,__ATOMIC_RELEASE);
+	nqueued++;
+}
+
+
+bool UnitRing::Submit()
+{
+	while(nqueued > 0){
+		int ret = (int)syscall(__NR_io_uring_enter,ringfd,nqueued,0,0,0,0);
+		if(ret < 0){
+			if(errno == EINTR || errno == EAGAIN){
+				continue;
+			}
+			return false;
+		}
+		nqueued -= (unsigned)ret;
+	}
+	return true;
+}
+
+
+bool UnitRing::Wait(uint64_t &tag, int &result)
+{
+	if(!Submit()){
+		return false;
+	}
+	while(true){
+		unsigned head = *cqhead;
+		if(head != __atomic_load_n(cqtail,__ATOMIC_ACQUIRE)){
+			struct io_uring_cqe *cqe = &cqes[head & *cqmask];
+			tag = cqe->user_data;
+			result = cqe->res;
+			__atomic_store_n(cqhead,head + 1,__ATOMIC_RELEASE);
+			return true;
+		}
+		int ret = (int)syscall(__NR_io_uring_enter,ringfd,0,1,IORING_ENTER_GETEVENTS,0,0);
+		if(ret < 0 && errno != EINTR){
+			return false;
+		}
+	}
+}
+
+
+
+// ==== UnitFileReader =========================================================
+
+UnitFileReader::UnitFileReader() : fd(-1), regular(false), filesize(0),
+		async(false), fixed(false), inflight(0), nextblock(0), nextrequest(0)
+{
+}
+
+
+UnitFileReader::~UnitFileReader()
+{
+	Close();
+}
+
+
+bool UnitFileReader::Open(const std::string &filename, bool direct)
+{
+	fd = (filename == "-") ? STDIN_FILENO : open(filename.c_str(),O_RDONLY);
+	if(fd < 0){
+		return false;
+	}
+
+	/* STANDARD INPUT IS READ FROM ITS CURRENT POSITION EVEN IF REDIRECTED */
+	struct stat st;
+	regular = (fd != STDIN_FILENO && fstat(fd,&st) == 0 && S_ISREG(st.st_mode));
+	filesize = regular ? (uint64_t)st.st_size : 0;
+	if(regular && direct){
+		/* O_DIRECT IS A REQUEST; IGNORE FILESYSTEMS WHICH REFUSE IT */
+		int flags = fcntl(fd,F_GETFL);
+		fcntl(fd,F_SETFL,flags | O_DIRECT);
+	}
+	if(!UnitIOAllocate(blocks,iovs)){
+		return false;
+	}
+	results.assign(UNITIO_DEPTH,0);
+	nextblock = 0;
+	nextrequest = 0;
+	inflight = 0;
+
+
+	/*
+	 * START READ-AHEAD ON REGULAR FILES IF io_uring IS AVAILABLE
+	 */
+	async = regular && ring.Init(2*UNITIO_DEPTH);
+	if(async){
+		fixed = ring.Register(&iovs[0],UNITIO_DEPTH);
+		for(int i=0; i<UNITIO_DEPTH; i++){
+			RequestNext();
+		}
+		if(!ring.Submit()){
+			return false;
+		}
+	}
+	return true;
+}
+
+
+ssize_t UnitFileReader::Read(const char *&data)
+{
+	/*
+	 * FALLBACK: BLOCKING READS INTO THE FIRST BLOCK.  PIPES ARE READ UNTIL THE
+	 * BLOCK IS FULL SO THAT CALLERS SEE REASONABLY LARGE BLOCKS.
+	 */
+	if(!async){
+		size_t n = 0;
+		while(n < UNITIO_BLOCK_SIZE){
+			ssize_t r = regular ?
+					pread(fd,blocks[0] + n,UNITIO_BLOCK_SIZE - n,(off_t)(nextblock*UNITIO_BLOCK_SIZE + n)) :
+					read(fd,blocks[0] + n,UNITIO_BLOCK_SIZE - n);
+			if(r < 0){
+				if(errno == EINTR){
+					continue;
+				}
+				return -1;
+			}
+			if(r == 0){
+				break;
+			}
+			n += (size_t)r;
+		}
+		nextblock++;
+		data = blocks[0];
+		return (ssize_t)n;
+	}
+
+
+	/*
+	 * RE-USE THE BLOCK RETURNED BY THE PREVIOUS CALL FOR THE NEXT READ-AHEAD
+	 */
+	if(nextblock > 0){
+		RequestNext();
+	}
+	if(nextblock*UNITIO_BLOCK_SIZE >= filesize){
+		return 0;
+	}
+
+
+	/*
+	 * WAIT UNTIL THE NEXT BLOCK IN ORDER HAS ARRIVED
+	 */
+	unsigned slot = (unsigned)(nextblock % UNITIO_DEPTH);
+	while(results[slot] == 1){
+		uint64_t tag = 0;
+		int res = 0;
+		if(!ring.Wait(tag,res)){
+			return -1;
+		}
+		results[tag % UNITIO_DEPTH] = res;
+		inflight--;
+	}
+	ssize_t n = results[slot];
+	if(n < 0){
+		errno = (int)-n;
+		return -1;
+	}
+
+
+	/*
+	 * COMPLETE A SHORT READ (RARE EXCEPT AT THE END OF THE FILE)
+	 */
+	uint64_t offset = nextblock*UNITIO_BLOCK_SIZE;
+	size_t want = (size_t)std::min<uint64_t>(UNITIO_BLOCK_SIZE,filesize - offset);
+	while((size_t)n < want){
+		ssize_t r = pread(fd,blocks[slot] + n,want - (size_t)n,(off_t)(offset + n));
+		if(r < 0 && errno == EINTR){
+			continue;
+		}
+		if(r <= 0){
+			return -1;
+		}
+		n += r;
+	}
+
+	nextblock++;
+	data = blocks[slot];
+	return n;
+}
+
+
+bool UnitFileReader::Async() const
+{
+	return async;
+}
+
+
+void UnitFileReader::Close()
+{
+	/*
+	 * THE KERNEL MAY STILL WRITE INTO THE BLOCKS, SO WAIT FOR READS IN FLIGHT
+	 * BEFORE RELEASING THEM
+	 */
+	while(async && inflight > 0){
+		uint64_t tag = 0;
+		int res = 0;
+		if(!ring.Wait(tag,res)){
+			break;
+		}
+		inflight--;
+	}
+	ring.Exit();
+	async = false;
+	if(fd >= 0 && fd != STDIN_FILENO){
+		close(fd);
+	}
+	fd = -1;
+	UnitIORelease(blocks);
+}
+
+
+void UnitFileReader::RequestNext()
+{
+	uint64_t offset = nextrequest*UNITIO_BLOCK_SIZE;
+	if(offset >= filesize){
+		return;
+	}
+	unsigned slot = (unsigned)(nextrequest % UNITIO_DEPTH);
+	results[slot] = 1;
+	ring.Queue(false,fd,&iovs[slot],offset,fixed ? (int)slot : -1,nextrequest);
+	inflight++;
+	nextrequest++;
+}
+
+
+
+// ==== UnitFileWriter =========================================================
+
+UnitFileWriter::UnitFileWriter() : fd(-1), regular(false), direct(false),
+		async(false), fixed(false), inflight(0), current(0), fill(0), offset(0),
+		failed(false)
+{
+}
+
+
+UnitFileWriter::~UnitFileWriter()
+{
+	if(fd >= 0){
+		Close();
+	}
+}
+
+
+bool UnitFileWriter::Open(const std::string &filename, bool usedirect)
+{
+	fd = (filename == "-") ? STDOUT_FILENO :
+			open(filename.c_str(),O_WRONLY | O_CREAT | O_TRUNC,0644);
+	if(fd < 0){
+		return false;
+	}
+	struct stat st;
+	regular = (fd != STDOUT_FILENO && fstat(fd,&st) == 0 && S_ISREG(st.st_mode));
+	direct = false;
+	if(regular && usedirect){
+		int flags = fcntl(fd,F_GETFL);
+		direct = (fcntl(fd,F_SETFL,flags | O_DIRECT) == 0);
+	}
+	if(!UnitIOAllocate(blocks,iovs)){
+		return false;
+	}
+	busy.assign(UNITIO_DEPTH,false);
+	current = 0;
+	fill = 0;
+	offset = 0;
+	inflight = 0;
+	failed = false;
+
+	async = regular && ring.Init(2*UNITIO_DEPTH);
+	if(async){
+		fixed = ring.Register(&iovs[0],UNITIO_DEPTH);
+	}
+	return true;
+}
+
+
+bool UnitFileWriter::Write(const char *data, size_t n)
+{
+	while(n > 0 && !failed){
+		size_t m = std::min(n,(size_t)UNITIO_BLOCK_SIZE - fill);
+		std::memcpy(blocks[current] + fill,data,m);
+		fill += m;
+		data += m;
+		n -= m;
+		if(fill == UNITIO_BLOCK_SIZE && !Flush(fill)){
+			failed = true;
+		}
+	}
+	return !failed;
+}
+
+
+bool UnitFileWriter::Close()
+{
+	if(fd < 0){
+		return !failed;
+	}
+
+
+	/*
+	 * WRITE THE LAST PARTIAL BLOCK.  WITH O_DIRECT IT IS PADDED TO THE
+	 * ALIGNMENT AND THE FILE TRUNCATED AFTERWARDS.
+	 */
+	uint64_t size = offset + fill;
+	if(fill > 0 && !failed){
+		size_t n = fill;
+		if(direct){
+			n = (fill + UNITIO_ALIGN - 1)/UNITIO_ALIGN*UNITIO_ALIGN;
+			std::memset(blocks[current] + fill,0,n - fill);
+		}
+		if(!Flush(n)){
+			failed = true;
+		}
+	}
+	while(inflight > 0){
+		if(!Reap()){
+			failed = true;
+			break;
+		}
+	}
+	if(direct && !failed && ftruncate(fd,(off_t)size) != 0){
+		failed = true;
+	}
+
+	ring.Exit();
+	async = false;
+	if(fd != STDOUT_FILENO && close(fd) != 0){
+		failed = true;
+	}
+	fd = -1;
+	UnitIORelease(blocks);
+	return !failed;
+}
+
+
+bool UnitFileWriter::Flush(size_t n)
+{
+	/*
+	 * FALLBACK: BLOCKING WRITE OF THE WHOLE BLOCK
+	 */
+	if(!async){
+		size_t done = 0;
+		while(done < n){
+			ssize_t w = regular ?
+					pwrite(fd,blocks[current] + done,n - done,(off_t)(offset + done)) :
+					write(fd,blocks[current] + done,n - done);
+			if(w < 0 && errno == EINTR){
+				continue;
+			}
+			if(w <= 0){
+				return false;
+			}
+			done += (size_t)w;
+		}
+		offset += fill;
+		fill = 0;
+		return true;
+	}
+
+
+	/*
+	 * SUBMIT THE BLOCK AND MOVE TO A FREE ONE, WAITING IF ALL ARE BUSY
+	 */
+	iovs[current].iov_len = n;
+	busy[current] = true;
+	ring.Queue(true,fd,&iovs[current],offset,fixed ? (int)current : -1,
+			((uint64_t)current << 32) | (uint64_t)n);
+	inflight++;
+	if(!ring.Submit()){
+		return false;
+	}
+	offset += fill;
+	fill = 0;
+
+	current = (current + 1) % UNITIO_DEPTH;
+	while(busy[current]){
+		if(!Reap()){
+			return false;
+		}
+	}
+	iovs[current].iov_len = UNITIO_BLOCK_SIZE;
+	return true;
+}
+
+
+bool UnitFileWriter::Reap()
+{
+	uint64_t tag = 0;
+	int res = 0;
+	if(!ring.Wait(tag,res)){
+		return false;
+	}
+	inflight--;
+	unsigned slot = (unsigned)(tag >> 32);
+	busy[slot] = false;
+
+	/*
+	 * A SHORT WRITE IS NOT RESUBMITTED; THE POSITION OF THE BLOCK IS NO LONGER
+	 * KNOWN HERE, SO IT IS TREATED AS AN ERROR
+	 */
+	return res >= 0 && (uint64_t)res == (tag & 0xffffffffULL);
+}
+
+
+#endif /* UnitIO_ */
@@ -0,0 +1,752 @@
+/**
+ * @file UnitJson.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Conversion of named numeric fields in newline-delimited JSON (NDJSON), e.g.
+ *
+ * 		{"t": 1718000000, "p": 14.7, "p_unit": "psi"}
+ *
+ * converted for field "p" to "kPa" becomes
+ *
+ * 		{"t": 1718000000, "p": 101.35, "p_unit": "kPa"}
+ *
+ * Each record names the units of a field in a sibling field (the field name
+ * followed by "_unit" by default).  The units are a unit string, a single
+ * unit symbol, or conventional notation (see UnitNotation::Expand()).  A default input unit may be given for records without the
+ * sibling field.  Only fields of the top-level object are converted.
+ *
+ * The text is scanned in 64-byte blocks.  For each block, bit masks of quotes,
+ * backslashes, and structural characters are built (with SSE2 where
+ * available); escaped quotes are removed and the extent of every string is
+ * found by a prefix XOR over the quote mask, so that structural characters
+ * inside strings are discarded without examining them one at a time.  The
+ * parser then visits only the remaining structural characters.  Numbers are
+ * parsed with std::from_chars (the Eisel-Lemire algorithm in recent
+ * libstdc++) and written with std::to_chars (shortest representation which
+ * reads back to the same value).
+ *
+ * Output is produced by copying the text between edited values, so records
+ * without the named fields are copied unchanged.  Values whose units are
+ * unknown or incompatible are left unchanged and counted by NumErrors().
+ *
+ * Records end at every newline, whether or not it falls inside a string.  A
+ * record left inside a string or with unbalanced brackets at its end (e.g. a
+ * truncated line) is copied unchanged and counted by NumMalformed(); the
+ * string state is reset so that the records after it are still converted.
+ *
+ * A UnitJson object caches the conversions for the units it has seen, up to
+ * JSON_CACHE_MAX per field.  It is not safe to use one object from several
+ * threads; copy it instead.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- Unit symbols expanded by UnitRegistry::ExpandSymbol().
+ *
+ * @date 18 October 2026
+ *	- Limited the conversions cache to JSON_CACHE_MAX units per field.
+ *
+ * @date 18 October 2026
+ *	- Newlines end a record even inside a string.  Malformed records are
+ *	  copied unchanged and counted by NumMalformed().
+ *
+ * @date 18 October 2026
+ *	- Units expanded by UnitNotation::Expand(), so conventional notation
+ *	  ("km/h") is accepted.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitJson_
+#define UnitJson_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "UnitPlan.h"
+#include "UnitNotation.h"
+
+
+/** @brief Default suffix of the field naming the units of a value */
+#define JSON_UNIT_SUFFIX "_unit"
+
+/** @brief Longest formatted value */
+#define JSON_MAX_VALUE_CHARS 32
+
+/** @brief Maximum number of distinct input units remembered per field */
+#define JSON_CACHE_MAX 4096
+
+
+/**
+ * @brief Converter of named numeric fields in NDJSON records.
+ */
+class UnitJson {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre Registry exists and outlives this object.
+	 * @param reg Registry used to look up prefixes and units.
+	 * @post UnitJson object exists with no fields.
+	 * @return None.
+	 */
+	UnitJson(const UnitRegistry &reg);
+
+
+	/**
+	 * @brief Add a field to be converted.
+	 * @pre UnitJson object exists.
+	 * @param name Name of the field.
+	 * @param unitsout Units to which the field is converted.  Also written to
+	 * 			the units field of each converted record.
+	 * @param unitsin Units assumed for records without a units field, or an
+	 * 			empty string to leave such records unchanged.
+	 * @post Field added if the units are valid.
+	 * @return UNIT_OK or the reason the units are invalid.
+	 */
+	UnitErrorCode AddField(const std::string &name, const std::string &unitsout,
+			const std::string &unitsin = "");
+
+
+	/**
+	 * @brief Set the suffix of the field naming the units of a value.
+	 * @pre UnitJson object exists.  Called before AddField().
+	 * @param suffix Suffix (JSON_UNIT_SUFFIX by default).
+	 * @post Suffix set.
+	 * @return None.
+	 */
+	void SetUnitSuffix(const std::string &suffix);
+
+
+	/**
+	 * @brief Convert complete records.
+	 * @pre UnitJson object exists.
+	 * @param in Pointer to the text, which ends at the end of a record.
+	 * @param n Number of characters.
+	 * @param out Reference to contain the converted text.  Replaced.
+	 * @post 'out' contains the converted records.
+	 * @return Number of values converted.
+	 */
+	size_t Convert(const char *in, size_t n, std::vector<char> &out);
+
+
+	/**
+	 * @brief Number of values left unchanged because their units were
+	 * 			invalid or incompatible, or the result was not finite.
+	 * @pre UnitJson object exists.
+	 * @post No changes to object.
+	 * @return Number of values.
+	 */
+	size_t NumErrors() const;
+
+
+	/**
+	 * @brief Number of records copied unchanged because they ended inside a
+	 * 			string or with unbalanced brackets.
+	 * @pre UnitJson object exists.
+	 * @post No changes to object.
+	 * @return Number of records.
+	 */
+	size_t NumMalformed() const;
+
+
+
+protected:
+	/**
+	 * @brief Conversion for one set of input units.
+	 */
+	struct Conversion {
+		UnitErrorCode err;
+		UnitPlan<double> plan;
+	};
+
+
+	/**
+	 * @brief Field to be converted, with its conversions cache.
+	 */
+	struct Field {
+		/** @brief Name of the field */
+		std::string name;
+
+		/** @brief Name of the field holding its units */
+		std::string unitname;
+
+		/** @brief Output units as given */
+		std::string unitsout;
+
+		/** @brief Output units as a unit string */
+		std::string expandedout;
+
+		/** @brief Output units as a JSON string, with quotes */
+		std::string unitslabel;
+
+		/** @brief Default input units, or empty */
+		std::string unitsin;
+
+		/** @brief Conversions by input unit text */
+		std::map<std::string,Conversion,std::less<> > conversions;
+
+		/** @brief Input unit text and conversion not remembered in
+		 * 			'conversions' because it is full */
+		std::string scratchunits;
+		Conversion scratch;
+
+		/** @brief Most recently used input unit text and its conversion */
+		std::string_view lastunits;
+		const Conversion *last;
+	};
+
+
+	/**
+	 * @brief Position of a value in the current record.
+	 */
+	struct Span {
+		size_t start;
+		size_t end;
+	};
+
+
+	/**
+	 * @brief Replacement of the text [start, end) of a record.
+	 */
+	struct Edit {
+		size_t start;
+		size_t end;
+		const char *text;
+		size_t len;
+	};
+
+
+	/** @brief Registry used to look up prefixes and units */
+	const UnitRegistry &registry;
+
+	/** @brief Parser for units in conventional notation */
+	UnitNotation notation;
+
+	/** @brief Suffix of the units fields */
+	std::string unitsuffix;
+
+	/** @brief Fields to be converted */
+	std::vector<Field> fields;
+
+	/** @brief Number of values left unchanged */
+	size_t nerrors;
+
+	/** @brief Number of malformed records */
+	size_t nmalformed;
+
+	/** @brief Edits of the current record */
+	std::vector<Edit> edits;
+
+	/** @brief Formatted values of the current record, JSON_MAX_VALUE_CHARS each */
+	std::vector<char> numbers;
+
+
+	/**
+	 * @brief Bit masks of one 64-byte block.
+	 * @param p Pointer to 64 characters.
+	 * @param quote Reference to contain the mask of '"'.
+	 * @param backslash Reference to contain the mask of '\\'.
+	 * @param structural Reference to contain the mask of {}[]:,
+	 * @param newline Reference to contain the mask of newlines.
+	 * @return None.
+	 */
+	static void Classify(const char *p, uint64_t &quote, uint64_t &backslash,
+			uint64_t &structural, uint64_t &newline);
+
+
+	/**
+	 * @brief Look up the conversion of a field for the given input units.
+	 * @return Pointer to the conversion.
+	 */
+	const Conversion* Find(Field &field, const char *units, size_t n);
+
+
+	/**
+	 * @brief Convert the fields found in one record.
+	 * @return Number of values converted.
+	 */
+	size_t Finish(const char *in, const std::vector<Span> &values,
+			const std::vector<Span> &units, size_t &copied, std::vector<char> &out);
+
+};
+
+
+
+// ==== PUBLIC FUNCTIONS =======================================================
+
+UnitJson::UnitJson(const UnitRegistry &reg) : registry(reg), notation(reg),
+		unitsuffix(JSON_UNIT_SUFFIX), nerrors(0), nmalformed(0)
+{
+}
+
+
+UnitErrorCode UnitJson::AddField(const std::string &name, const std::string &unitsout,
+		const std::string &unitsin)
+{
+	std::string expandedin;
+	std::string expandedout;
+	UnitErrorCode err = notation.Expand(unitsout,expandedout);
+	if(err == UNIT_OK){
+		err = notation.Expand(unitsin.empty() ? unitsout : unitsin,expandedin);
+	}
+	if(err != UNIT_OK){
+		return err;
+	}
+	UnitResult< UnitPlan<double> > check = UnitPlan<double>::Create(registry,
+			expandedin,expandedout);
+	if(!check.Ok()){
+		return check.Error();
+	}
+
+	Field field;
+	field.name = name;
+	field.unitname = name + unitsuffix;
+	field.unitsout = unitsout;
+	field.expandedout = expandedout;
+	field.unitslabel = "\"" + unitsout + "\"";
+	field.unitsin = unitsin;
+	field.last = 0;
+	fields.push_back(field);
+	edits.resize(2*fields.size());
+	numbers.resize(JSON_MAX_VALUE_CHARS*fields.size());
+	return UNIT_OK;
+}
+
+
+void UnitJson::SetUnitSuffix(const std::string &suffix)
+{
+	unitsuffix = suffix;
+}
+
+
+size_t UnitJson::Convert(const char *in, size_t n, std::vector<char> &out)
+{
+	out.clear();
+	out.reserve(n + n/8);
+	for(size_t f=0; f<fields.size(); f++){
+		fields[f].last = 0;
+	}
+
+	const size_t NONE = (size_t)-1;
+	std::vector<Span> values(fields.size());
+	std::vector<Span> units(fields.size());
+	for(size_t f=0; f<fields.size(); f++){
+		values[f].start = units[f].start = NONE;
+	}
+
+
+	/*
+	 * STATE CARRIED BETWEEN BLOCKS
+	 */
+	bool escapecarry = false;
+	uint64_t instringcarry = 0;
+	int depth = 0;
+	bool expectkey = false;
+	size_t keystart = NONE;
+	size_t keyend = NONE;
+	size_t valstart = NONE;
+	int current = -1;
+	size_t copied = 0;
+	size_t nconverted = 0;
+
+	char tail[64];
+	for(size_t block=0; block<n; block+=64){
+		const char *p = in + block;
+		size_t len = std::min((size_t)64,n - block);
+		if(len < 64){
+			std::memset(tail,' ',sizeof(tail));
+			std::memcpy(tail,p,len);
+			p = tail;
+		}
+		uint64_t quote, backslash, structural, newline;
+		Classify(p,quote,backslash,structural,newline);
+
+
+		/*
+		 * REMOVE ESCAPED QUOTES.  EACH BACKSLASH WHICH IS NOT ITSELF ESCAPED
+		 * ESCAPES THE NEXT CHARACTER.  BACKSLASHES ARE RARE, SO THEY ARE
+		 * VISITED ONE AT A TIME.  A BACKSLASH BEFORE A NEWLINE ONLY ESCAPES
+		 * THE NEWLINE, SO NO ESCAPE IS CARRIED INTO THE NEXT RECORD.
+		 */
+		uint64_t escaped = escapecarry ? 1 : 0;
+		escapecarry = false;
+		uint64_t bs = backslash & ~escaped;
+		while(bs){
+			int i = __builtin_ctzll(bs);
+			if(i == 63){
+				escapecarry = true;
+				bs = 0;
+			} else {
+				escaped |= (uint64_t)1 << (i+1);
+				bs &= ~((uint64_t)3 << i);
+			}
+		}
+		quote &= ~escaped;
+
+
+		/*
+		 * PREFIX XOR OF THE QUOTES GIVES THE CHARACTERS INSIDE STRINGS
+		 * (INCLUDING THE OPENING QUOTE)
+		 */
+		uint64_t instring = quote;
+		instring ^= instring << 1;
+		instring ^= instring << 2;
+		instring ^= instring << 4;
+		instring ^= instring << 8;
+		instring ^= instring << 16;
+		instring ^= instring << 32;
+		instring ^= instringcarry;
+
+
+		/*
+		 * A STRING STILL OPEN AT A NEWLINE IS MALFORMED.  THE NEWLINE KEEPS
+		 * ITS BIT SO THAT THE RECORD IS REPORTED, AND THE CHARACTERS AFTER IT
+		 * ARE FLIPPED BACK OUTSIDE OF STRINGS.
+		 */
+		uint64_t nl = newline & instring;
+		while(nl){
+			int i = __builtin_ctzll(nl);
+			uint64_t after = (i == 63) ? 0 : ~(uint64_t)0 << (i+1);
+			instring ^= after;
+			nl = newline & instring & after;
+		}
+		instringcarry = (uint64_t)0 - (instring >> 63);
+
+		uint64_t tokens = (structural & ~instring) | quote | newline;
+		if(len < 64){
+			tokens &= ((uint64_t)1 << len) - 1;
+		}
+
+
+		/*
+		 * VISIT THE STRUCTURAL CHARACTERS.  ONLY THE KEYS AND VALUES OF THE
+		 * TOP-LEVEL OBJECT ARE RECORDED.
+		 */
+		while(tokens){
+			int bit = __builtin_ctzll(tokens);
+			tokens &= tokens - 1;
+			size_t pos = block + (size_t)bit;
+			char c = in[pos];
+
+			switch(c){
+			case '"':
+				if(depth == 1 && expectkey){
+					if((instring >> bit) & 1){
+						keystart = pos + 1;
+					} else {
+						keyend = pos;
+					}
+				}
+				break;
+			case '{':
+			case '[':
+				depth++;
+				if(depth == 1){
+					expectkey = true;
+				}
+				break;
+			case ':':
+				if(depth == 1 && keystart != NONE && keyend != NONE && keyend >= keystart){
+					current = -1;
+					size_t klen = keyend - keystart;
+					for(size_t f=0; f<fields.size(); f++){
+						const Field &field = fields[f];
+						if(klen == field.name.size() &&
+								std::memcmp(in + keystart,field.name.data(),klen) == 0){
+							current = (int)(2*f);
+						} else if(klen == field.unitname.size() &&
+								std::memcmp(in + keystart,field.unitname.data(),klen) == 0){
+							current = (int)(2*f + 1);
+						}
+					}
+					valstart = pos + 1;
+					expectkey = false;
+				}
+				break;
+			case ',':
+			case '}':
+			case ']':
+				if(depth == 1 && valstart != NONE){
+					/* END OF A TOP-LEVEL VALUE; TRIM WHITE SPACE */
+					size_t s = valstart;
+					size_t e = pos;
+					while(s < e && (in[s] == ' ' || in[s] == '\t')){ s++; }
+					while(e > s && (in[e-1] == ' ' || in[e-1] == '\t' || in[e-1] == '\r')){ e--; }
+					if(current >= 0){
+						Span &span = (current & 1) ? units[current/2] : values[current/2];
+						span.start = s;
+						span.end = e;
+					}
+					valstart = NONE;
+					current = -1;
+					keystart = keyend = NONE;
+					expectkey = (c == ',');
+				}
+				if(c != ','){
+					depth--;
+				}
+				break;
+			case '\n':
+				/* A MALFORMED RECORD IS LEFT FOR THE NEXT COPY, UNCHANGED */
+				if(depth != 0 || ((instring >> bit) & 1)){
+					nmalformed++;
+				} else {
+					nconverted += Finish(in,values,units,copied,out);
+				}
+				for(size_t f=0; f<fields.size(); f++){
+					values[f].start = units[f].start = NONE;
+				}
+				depth = 0;
+				expectkey = false;
+				valstart = keystart = keyend = NONE;
+				current = -1;
+				break;
+			}
+		}
+	}
+
+
+	/*
+	 * A FINAL RECORD NEED NOT END WITH A NEWLINE
+	 */
+	if(depth != 0 || instringcarry){
+		nmalformed++;
+	} else {
+		nconverted += Finish(in,values,units,copied,out);
+	}
+	out.insert(out.end(),in + copied,in + n);
+	return nconverted;
+}
+
+
+size_t UnitJson::NumErrors() const
+{
+	return nerrors;
+}
+
+
+size_t UnitJson::NumMalformed() const
+{
+	return nmalformed;
+}
+
+
+
+// ==== PROTECTED FUNCTIONS ====================================================
+
+void UnitJson::Classify(const char *p, uint64_t &quote, uint64_t &backslash,
+		uint64_t &structural, uint64_t &newline)
+{
+	quote = backslash = structural = newline = 0;
+#ifdef __SSE2__
+	const __m128i vquote = _mm_set1_epi8('"');
+	const __m128i vbackslash = _mm_set1_epi8('\\');
+	const __m128i vcolon = _mm_set1_epi8(':');
+	const __m128i vcomma = _mm_set1_epi8(',');
+	const __m128i vnewline = _mm_set1_epi8('\n');
+	const __m128i vbrace = _mm_set1_epi8(0x20);
+	const __m128i vopen = _mm_set1_epi8('{');
+	const __m128i vclose = _mm_set1_epi8('}');
+	for(int k=0; k<4; k++){
+		__m128i v = _mm_loadu_si128((const __m128i*)(p + 16*k));
+
+		/* '[' AND ']' DIFFER FROM '{' AND '}' ONLY IN BIT 0x20 */
+		__m128i folded = _mm_or_si128(v,vbrace);
+		__m128i s = _mm_or_si128(_mm_cmpeq_epi8(folded,vopen),_mm_cmpeq_epi8(folded,vclose));
+		s = _mm_or_si128(s,_mm_cmpeq_epi8(v,vcolon));
+		s = _mm_or_si128(s,_mm_cmpeq_epi8(v,vcomma));
+		quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v,vquote)) << (16*k);
+		backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v,vbackslash)) << (16*k);
+		structural |= (uint64_t)(uint16_t)_mm_movemask_epi8(s) << (16*k);
+		newline |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v,vnewline)) << (16*k);
+	}
+#else
+	for(int i=0; i<64; i++){
+		char c = p[i];
+		uint64_t bit = (uint64_t)1 << i;
+		if(c == '"'){ quote |= bit; }
+		if(c == '\\'){ backslash |= bit; }
+		if(c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ','){
+			structural |= bit;
+		}
+		if(c == '\n'){ newline |= bit; }
+	}
+#endif
+}
+
+
+const UnitJson::Conversion* UnitJson::Find(Field &field, const char *units, size_t n)
+{
+	std::string_view key(units,n);
+	if(field.last && field.lastunits == key){
+		return field.last;
+	}
+
+
+	/*
+	 * LOOK UP WITHOUT COPYING THE KEY; COMPILE UNITS NOT SEEN BEFORE
+	 */
+	std::map<std::string,Conversion,std::less<> >::iterator it = field.conversions.find(key);
+	if(it != field.conversions.end()){
+		field.lastunits = it->first;
+		field.last = &it->second;
+		return field.last;
+	}
+	Conversion conv;
+	std::string expanded;
+	conv.err = notation.Expand(std::string(key),expanded);
+	if(conv.err == UNIT_OK){
+		UnitResult< UnitPlan<double> > result = UnitPlan<double>::Create(registry,
+				expanded,field.expandedout);
+		conv.err = result.Error();
+		if(result.Ok()){
+			conv.plan = result.Value();
+		}
+	}
+
+
+	/*
+	 * ONCE THE CACHE IS FULL, NEW UNITS ARE NOT REMEMBERED SO THAT JUNK INPUT
+	 * CANNOT GROW IT WITHOUT BOUND
+	 */
+	if(field.conversions.size() >= JSON_CACHE_MAX){
+		field.scratchunits.assign(key.data(),key.size());
+		field.scratch = conv;
+		field.lastunits = field.scratchunits;
+		field.last = &field.scratch;
+		return field.last;
+	}
+	it = field.conversions.insert(std::make_pair(std::string(key),conv)).first;
+	field.lastunits = it->first;
+	field.last = &it->second;
+	return field.last;
+}
+
+
+size_t UnitJson::Finish(const char *in, const std::vector<Span> &values,
+		const std::vector<Span> &units, size_t &copied, std::vector<char> &out)
+{
+	const size_t NONE = (size_t)-1;
+	size_t nconverted = 0;
+
+
+	/*
+	 * COLLECT THE EDITS OF THIS RECORD IN TEXT ORDER
+	 */
+	size_t nedits = 0;
+	for(size_t f=0; f<fields.size(); f++){
+		const Span &val = values[f];
+		const Span &unit = units[f];
+		if(val.start == NONE){
+			continue;
+		}
+		Field &field = fields[f];
+
+
+		/*
+		 * INPUT UNITS FROM THE RECORD (A JSON STRING), OR THE DEFAULT
+		 */
+		const Conversion *conv = 0;
+		bool haveunit = (unit.start != NONE && unit.end >= unit.start + 2 &&
+				in[unit.start] == '"' && in[unit.end-1] == '"');
+		if(haveunit){
+			conv = Find(field,in + unit.start + 1,unit.end - unit.start - 2);
+		} else if(!field.unitsin.empty()){
+			conv = Find(field,field.unitsin.data(),field.unitsin.size());
+		} else {
+			continue;
+		}
+
+		double x = 0.0;
+		std::from_chars_result r = std::from_chars(in + val.start,in + val.end,x);
+		if(r.ec != std::errc() || r.ptr != in + val.end){
+			continue;
+		}
+		if(conv->err != UNIT_OK){
+			nerrors++;
+			continue;
+		}
+		double y = conv->plan.Convert(x);
+		if(!(y - y == 0.0)){
+			nerrors++;
+			continue;
+		}
+
+		char *num = &numbers[JSON_MAX_VALUE_CHARS*f];
+		size_t nlen = (size_t)(std::to_chars(num,num + JSON_MAX_VALUE_CHARS,y).ptr - num);
+		Edit ev = {val.start, val.end, num, nlen};
+		edits[nedits++] = ev;
+		if(haveunit){
+			Edit eu = {unit.start, unit.end, field.unitslabel.data(), field.unitslabel.size()};
+			edits[nedits++] = eu;
+		}
+		nconverted++;
+	}
+	if(nedits == 0){
+		return 0;
+	}
+	std::sort(edits.begin(),edits.begin() + nedits,[](const Edit &a, const Edit &b){ return a.start < b.start; });
+
+
+	/*
+	 * COPY THE TEXT BEFORE EACH EDIT, THEN THE REPLACEMENT
+	 */
+	for(size_t i=0; i<nedits; i++){
+		out.insert(out.end(),in + copied,in + edits[i].start);
+		out.insert(out.end(),edits[i].text,edits[i].text + edits[i].len);
+		copied = edits[i].end;
+	}
+	return nconverted;
+}
+
+
+#endif /* UnitJson_ */
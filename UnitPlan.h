@@ -0,0 +1,613 @@
+/**
+ * @file UnitPlan.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * This class holds a conversion between two compiled unit strings.  Between
+ * ordinary units, and between two logarithmic units, the conversion is affine:
+ *
+ * 		value_out = value_in*scale + offset
+ *
+ * with 'scale' and 'offset' computed once when the plan is built.  Converting
+ * a value with a plan involves no string handling.  Conversions to and from a
+ * logarithmic unit (see UnitRegistry.h) add a logarithm or exponential:
+ *
+ * 		value_out = outscale*log10(value_in*scale + offset)			(to log)
+ * 		value_out = outscale*10^(value_in*scale + offset) + outoffset	(from log)
+ *
+ * evaluated with UnitLog10() and UnitExp10() from UnitLog.h, which vectorize,
+ * rather than libm.  Values outside the domain of the logarithm (e.g. a
+ * negative power converted to dBm) give NaN.
+ *
+ * When either side is a non-linear unit (API gravity, sheet gauge, ...; see
+ * UnitCurve.h), each side is described by a UnitCurve and values pass
+ * through the coherent SI unit:
+ *
+ * 		value_out = curveout.FromSI(curvein.ToSI(value_in*scale + offset))
+ *
+ * Arrays are converted in blocks of UNITPLAN_CURVE_BLOCK values, each block
+ * going through one vectorized loop per curve.  Values outside the range of
+ * a table give NaN.
+ *
+ * Arrays are converted with a single loop which the compiler vectorizes.
+ * Large arrays are additionally split across threads with OpenMP.
+ *
+ * Raw integer counts from data acquisition hardware (int16_t, uint16_t,
+ * int32_t) are converted directly, without first widening them into a
+ * floating-point buffer.  Calibrated() folds the calibration of the counts
+ * (value_in = counts*gain + offset) into the plan, so each count still costs
+ * one integer-to-floating conversion and one multiply-add; the input read
+ * from memory is a quarter of that of doubles for 16-bit counts.
+ *
+ * Building a plan reports a UnitErrorCode.  Create() and ConvertValue()
+ * provide the same as UnitResult objects directly from unit strings, and the
+ * array conversion can record non-finite results in a UnitErrorBitmap.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *	- Errors reported as UnitErrorCode, UnitResult, and UnitErrorBitmap.
+ *
+ * @date 18 October 2026
+ *	- Added Calibrated() and conversion of integer counts.
+ *
+ * @date 18 October 2026
+ *	- Added conversions to and from logarithmic units.
+ *
+ * @date 18 October 2026
+ *	- Added conversions to and from non-linear units.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitPlan_
+#define UnitPlan_
+
+#include <cstddef>
+#include <stdint.h>
+#include <omp.h>
+#include <cmath>
+#include "UnitExpression.h"
+#include "UnitLog.h"
+#include "UnitCurve.h"
+
+
+/** @brief Minimum array length converted using multiple threads */
+#define UNITPLAN_PARALLEL_MIN 65536
+
+/** @brief Number of values passed through the curves of a plan at a time */
+#define UNITPLAN_CURVE_BLOCK 512
+
+
+/**
+ * @brief Form of a conversion.
+ */
+enum UnitPlanKind {
+	UNITPLAN_AFFINE = 0,		/**< out = in*scale + offset */
+	UNITPLAN_TO_LOG,			/**< out = outscale*log10(in*scale + offset) */
+	UNITPLAN_FROM_LOG,			/**< out = outscale*10^(in*scale + offset) + outoffset */
+	UNITPLAN_CURVE				/**< out = curveout.FromSI(curvein.ToSI(in*scale + offset)) */
+};
+
+
+/**
+ * @brief Conversion between two compiled unit strings.
+ */
+template <class T>
+class UnitPlan {
+
+public:
+	/**
+	 * @brief Constructor.  The new plan is the identity conversion.
+	 * @pre None.
+	 * @post UnitPlan object exists.
+	 * @return None.
+	 */
+	UnitPlan();
+
+
+	/**
+	 * @brief Build the plan converting from 'unitsin' to 'unitsout'.
+	 * @pre UnitPlan object exists.
+	 * @param unitsin Compiled input units.
+	 * @param unitsout Compiled output units.
+	 * @post Plan updated if the units are compatible.  Plan unchanged
+	 * 			otherwise.
+	 * @return UNIT_OK, UNIT_ERR_DIMENSION_MISMATCH, UNIT_ERR_OFFSET_MISUSE,
+	 * 			UNIT_ERR_LOG_MISUSE, or UNIT_ERR_CURVE_MISUSE.
+	 */
+	UnitErrorCode Build(const CompiledUnits &unitsin, const CompiledUnits &unitsout);
+
+
+	/**
+	 * @brief Compile two unit strings and build the plan converting between
+	 * 			them.
+	 * @pre None.
+	 * @param reg Registry used to look up prefixes and units.
+	 * @param unitsin Input unit string.
+	 * @param unitsout Output unit string.
+	 * @post No changes.
+	 * @return The plan, or the reason it could not be built.
+	 */
+	static UnitResult< UnitPlan<T> > Create(const UnitRegistry &reg,
+			const std::string &unitsin, const std::string &unitsout);
+
+
+	/**
+	 * @brief Convert a single value.
+	 * @pre UnitPlan object exists.
+	 * @param val Value to be converted.
+	 * @post No changes to object.
+	 * @return Converted value.
+	 */
+	T Convert(T val) const;
+
+
+	/**
+	 * @brief Convert an array of values.  'in' and 'out' may be the same
+	 * 			array.
+	 * @pre UnitPlan object exists.
+	 * @param in Pointer to the values to be converted.
+	 * @param out Pointer to the array to contain the converted values.
+	 * @param n Number of values.
+	 * @post 'out' contains the converted values.
+	 * @return None.
+	 */
+	void Convert(const T *in, T *out, size_t n) const;
+
+
+	/**
+	 * @brief Convert an array of values and record the rows whose result is
+	 * 			not a finite number.  All rows are converted regardless.
+	 * @pre UnitPlan object exists.
+	 * @param in Pointer to the values to be converted.
+	 * @param out Pointer to the array to contain the converted values.
+	 * @param n Number of values.
+	 * @param errors Reference to the bitmap to contain the failed rows.
+	 * @post 'out' contains the converted values.  'errors' covers n rows.
+	 * @return Number of failed rows.
+	 */
+	size_t Convert(const T *in, T *out, size_t n, UnitErrorBitmap &errors) const;
+
+
+	/**
+	 * @brief Convert an array of integer counts.  The plan should include
+	 * 			the calibration of the counts (see Calibrated()).
+	 * @pre UnitPlan object exists.
+	 * @param in Pointer to the counts to be converted.
+	 * @param out Pointer to the array to contain the converted values.
+	 * @param n Number of values.
+	 * @post 'out' contains the converted values.
+	 * @return None.
+	 */
+	void Convert(const int16_t *in, T *out, size_t n) const;
+	void Convert(const uint16_t *in, T *out, size_t n) const;
+	void Convert(const int32_t *in, T *out, size_t n) const;
+
+
+	/**
+	 * @brief Plan converting calibrated input, value_in = raw*gain + caloffset,
+	 * 			in one step.
+	 * @pre UnitPlan object exists.
+	 * @param gain Input units per count.
+	 * @param caloffset Input value at a count of 0.
+	 * @post No changes to object.
+	 * @return Plan converting raw values to the output units.
+	 */
+	UnitPlan<T> Calibrated(double gain, double caloffset) const;
+
+
+	/**
+	 * @brief Multiplier applied by the plan.  For plans to or from a
+	 * 			logarithmic or non-linear unit, the multiplier applied before
+	 * 			the logarithm, exponential, or curves.
+	 * @pre UnitPlan object exists.
+	 * @post No changes to object.
+	 * @return Scale.
+	 */
+	T Scale() const;
+
+
+	/**
+	 * @brief Offset applied by the plan after scaling.
+	 * @pre UnitPlan object exists.
+	 * @post No changes to object.
+	 * @return Offset.
+	 */
+	T Offset() const;
+
+
+	/**
+	 * @brief Form of the conversion.
+	 * @pre UnitPlan object exists.
+	 * @post No changes to object.
+	 * @return UNITPLAN_AFFINE unless converting to or from a logarithmic or
+	 * 			non-linear unit.
+	 */
+	UnitPlanKind Kind() const;
+
+
+
+protected:
+	/** @brief Multiplier applied to input values */
+	T scale;
+
+	/** @brief Offset added after scaling */
+	T offset;
+
+	/** @brief Form of the conversion */
+	UnitPlanKind kind;
+
+	/** @brief Multiplier applied after the logarithm or exponential */
+	double outscale;
+
+	/** @brief Offset added after the exponential */
+	double outoffset;
+
+	/** @brief Input units to SI, for UNITPLAN_CURVE */
+	UnitCurve curvein;
+
+	/** @brief SI to output units, for UNITPLAN_CURVE */
+	UnitCurve curveout;
+
+
+	/**
+	 * @brief Convert an array of integers.
+	 * @param in Pointer to the integers to be converted.
+	 * @param out Pointer to the array to contain the converted values.
+	 * @param n Number of values.
+	 */
+	template <class I>
+	void ConvertCounts(const I *in, T *out, size_t n) const;
+
+
+	/**
+	 * @brief Curve relating compiled units to the coherent SI unit.
+	 * @param units Compiled units.
+	 * @return The curve of a non-linear unit, or an exponential or affine
+	 * 			curve.
+	 */
+	static UnitCurve CurveOf(const CompiledUnits &units);
+
+};
+
+
+
+// ==================================================================
+// ================
+// ================    PUBLIC FUNCTIONS
+// ================
+
+// CONSTRUCTOR
+template <class T>
+UnitPlan<T>::UnitPlan()
+{
+	scale = (T)1.0e0;
+	offset = (T)0.0e0;
+	kind = UNITPLAN_AFFINE;
+	outscale = 1.0e0;
+	outoffset = 0.0e0;
+}
+
+
+template <class T>
+UnitErrorCode UnitPlan<T>::Build(const CompiledUnits &unitsin, const CompiledUnits &unitsout)
+{
+	if((unitsin.HasLogUnits() && !unitsin.IsLogarithmic()) ||
+			(unitsout.HasLogUnits() && !unitsout.IsLogarithmic())){
+		return UNIT_ERR_LOG_MISUSE;
+	}
+	if((unitsin.HasCurveUnits() && !unitsin.IsCurve()) ||
+			(unitsout.HasCurveUnits() && !unitsout.IsCurve())){
+		return UNIT_ERR_CURVE_MISUSE;
+	}
+	if(!unitsin.SameDimension(unitsout)){
+		return UNIT_ERR_DIMENSION_MISMATCH;
+	}
+	if((unitsin.IsAbsolute() && unitsout.IsDifference()) ||
+			(unitsin.IsDifference() && unitsout.IsAbsolute())){
+		return UNIT_ERR_OFFSET_MISUSE;
+	}
+
+	/*
+	 * value_SI = value_in*fin + oin AND value_SI = value_out*fout + oout, OR
+	 * value_SI = f*10^(value/s) FOR A LOGARITHMIC UNIT
+	 */
+	double fin = unitsin.Factor();
+	double fout = unitsout.Factor();
+	double sin = unitsin.LogScale();
+	double sout = unitsout.LogScale();
+	kind = UNITPLAN_AFFINE;
+	outscale = 1.0e0;
+	outoffset = 0.0e0;
+	curvein = UnitCurve();
+	curveout = UnitCurve();
+	if(unitsin.IsCurve() || unitsout.IsCurve()){
+		kind = UNITPLAN_CURVE;
+		scale = (T)1.0e0;
+		offset = (T)0.0e0;
+		curvein = CurveOf(unitsin);
+		curveout = CurveOf(unitsout);
+	} else if(sin != 0.0e0 && sout != 0.0e0){
+		scale = (T)(sout/sin);
+		offset = (T)(sout*std::log10(fin/fout));
+	} else if(sin != 0.0e0){
+		kind = UNITPLAN_FROM_LOG;
+		scale = (T)(1.0e0/sin);
+		offset = (T)0.0e0;
+		outscale = fin/fout;
+		outoffset = -unitsout.Offset()/fout;
+	} else if(sout != 0.0e0){
+		kind = UNITPLAN_TO_LOG;
+		scale = (T)(fin/fout);
+		offset = (T)(unitsin.Offset()/fout);
+		outscale = sout;
+	} else {
+		scale = (T)(fin/fout);
+		offset = (T)((unitsin.Offset() - unitsout.Offset())/fout);
+	}
+	return UNIT_OK;
+}
+
+
+template <class T>
+UnitResult< UnitPlan<T> > UnitPlan<T>::Create(const UnitRegistry &reg,
+		const std::string &unitsin, const std::string &unitsout)
+{
+	CompiledUnits cin;
+	CompiledUnits cout;
+	UnitErrorCode err = cin.Compile(reg,unitsin);
+	if(err != UNIT_OK){
+		return UnitResult< UnitPlan<T> >(err);
+	}
+	err = cout.Compile(reg,unitsout);
+	if(err != UNIT_OK){
+		return UnitResult< UnitPlan<T> >(err);
+	}
+
+	UnitPlan<T> plan;
+	err = plan.Build(cin,cout);
+	if(err != UNIT_OK){
+		return UnitResult< UnitPlan<T> >(err);
+	}
+	return UnitResult< UnitPlan<T> >(plan);
+}
+
+
+template <class T>
+T UnitPlan<T>::Convert(T val) const
+{
+	if(kind == UNITPLAN_TO_LOG){
+		return (T)(outscale*UnitLog10((double)(val*scale + offset)));
+	}
+	if(kind == UNITPLAN_FROM_LOG){
+		return (T)(outscale*UnitExp10((double)(val*scale + offset)) + outoffset);
+	}
+	if(kind == UNITPLAN_CURVE){
+		return (T)curveout.FromSI(curvein.ToSI((double)(val*scale + offset)));
+	}
+	return val*scale + offset;
+}
+
+
+template <class T>
+void UnitPlan<T>::Convert(const T *in, T *out, size_t n) const
+{
+	if(kind != UNITPLAN_AFFINE){
+		ConvertCounts(in,out,n);
+		return;
+	}
+	const T s = scale;
+	const T o = offset;
+	const long long nn = (long long)n;
+#pragma omp parallel for simd schedule(static) if(nn > UNITPLAN_PARALLEL_MIN)
+	for(long long i=0; i<nn; i++){
+		out[i] = in[i]*s + o;
+	}
+}
+
+
+template <class T>
+size_t UnitPlan<T>::Convert(const T *in, T *out, size_t n, UnitErrorBitmap &errors) const
+{
+	Convert(in,out,n);
+	errors.Reset(n);
+	errors.MarkNonFinite(out,0,n);
+	return errors.Count();
+}
+
+
+template <class T>
+void UnitPlan<T>::Convert(const int16_t *in, T *out, size_t n) const
+{
+	ConvertCounts(in,out,n);
+}
+
+
+template <class T>
+void UnitPlan<T>::Convert(const uint16_t *in, T *out, size_t n) const
+{
+	ConvertCounts(in,out,n);
+}
+
+
+template <class T>
+void UnitPlan<T>::Convert(const int32_t *in, T *out, size_t n) const
+{
+	ConvertCounts(in,out,n);
+}
+
+
+template <class T>
+UnitPlan<T> UnitPlan<T>::Calibrated(double gain, double caloffset) const
+{
+	/*
+	 * out = (raw*gain + caloffset)*scale + offset
+	 */
+	UnitPlan<T> plan(*this);
+	plan.scale = (T)(gain*(double)scale);
+	plan.offset = (T)(caloffset*(double)scale + (double)offset);
+	return plan;
+}
+
+
+template <class T>
+T UnitPlan<T>::Scale() const
+{
+	return scale;
+}
+
+
+template <class T>
+T UnitPlan<T>::Offset() const
+{
+	return offset;
+}
+
+
+template <class T>
+UnitPlanKind UnitPlan<T>::Kind() const
+{
+	return kind;
+}
+
+
+
+// ==================================================================
+// ================
+// ================    PROTECTED FUNCTIONS
+// ================
+
+template <class T>
+template <class I>
+void UnitPlan<T>::ConvertCounts(const I *in, T *out, size_t n) const
+{
+	const T s = scale;
+	const T o = offset;
+	const double os = outscale;
+	const double oo = outoffset;
+	const long long nn = (long long)n;
+
+
+	/*
+	 * ONE LOOP PER KIND, SO THAT EACH VECTORIZES.  THE LOGARITHM AND
+	 * EXPONENTIAL ARE EVALUATED IN DOUBLE PRECISION.  CURVES ARE APPLIED TO
+	 * A BLOCK AT A TIME IN A BUFFER ON THE STACK, SO THAT THE SWITCH ON THEIR
+	 * FORM IS OUTSIDE THE LOOPS.
+	 */
+	if(kind == UNITPLAN_CURVE){
+		const UnitCurve &ci = curvein;
+		const UnitCurve &co = curveout;
+#pragma omp parallel for schedule(static) if(nn > UNITPLAN_PARALLEL_MIN)
+		for(long long b=0; b<nn; b+=UNITPLAN_CURVE_BLOCK){
+			double buf[UNITPLAN_CURVE_BLOCK];
+			long long m = (nn - b < UNITPLAN_CURVE_BLOCK ? nn - b : UNITPLAN_CURVE_BLOCK);
+#pragma omp simd
+			for(long long j=0; j<m; j++){
+				buf[j] = (double)((T)in[b+j]*s + o);
+			}
+			ci.ToSI(buf,(size_t)m);
+			co.FromSI(buf,(size_t)m);
+#pragma omp simd
+			for(long long j=0; j<m; j++){
+				out[b+j] = (T)buf[j];
+			}
+		}
+	} else if(kind == UNITPLAN_TO_LOG){
+#pragma omp parallel for simd schedule(static) if(nn > UNITPLAN_PARALLEL_MIN)
+		for(long long i=0; i<nn; i++){
+			out[i] = (T)(os*UnitLog10((double)((T)in[i]*s + o)));
+		}
+	} else if(kind == UNITPLAN_FROM_LOG){
+#pragma omp parallel for simd schedule(static) if(nn > UNITPLAN_PARALLEL_MIN)
+		for(long long i=0; i<nn; i++){
+			out[i] = (T)(os*UnitExp10((double)((T)in[i]*s + o)) + oo);
+		}
+	} else {
+#pragma omp parallel for simd schedule(static) if(nn > UNITPLAN_PARALLEL_MIN)
+		for(long long i=0; i<nn; i++){
+			out[i] = (T)in[i]*s + o;
+		}
+	}
+}
+
+
+template <class T>
+UnitCurve UnitPlan<T>::CurveOf(const CompiledUnits &units)
+{
+	if(units.IsCurve()){
+		return *units.Curve();
+	}
+	if(units.IsLogarithmic()){
+		return UnitCurve::Exponential(units.Factor(),units.LogScale());
+	}
+	return UnitCurve::Affine(units.Factor(),units.Offset());
+}
+
+
+
+/**
+ * @brief Convert a single value between two unit strings without throwing or
+ * 			printing.
+ * @pre None.
+ * @param reg Registry used to look up prefixes and units.
+ * @param val Value to be converted.
+ * @param unitsin Input unit string.
+ * @param unitsout Output unit string.
+ * @post No changes.
+ * @return Converted value, or the reason it could not be converted.
+ */
+template <class T>
+UnitResult<T> ConvertValue(const UnitRegistry &reg, T val,
+		const std::string &unitsin, const std::string &unitsout)
+{
+	UnitResult< UnitPlan<T> > plan = UnitPlan<T>::Create(reg,unitsin,unitsout);
+	if(!plan.Ok()){
+		return UnitResult<T>(plan.Error());
+	}
+	T valout = plan.Value().Convert(val);
+	if(!(valout - valout == (T)0)){
+		return UnitResult<T>(UNIT_ERR_BAD_VALUE);
+	}
+	return UnitResult<T>(valout);
+}
+
+
+#endif /* UnitPlan_ */
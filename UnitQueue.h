@@ -0,0 +1,166 @@
+/**
+ * @file UnitQueue.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Bounded first-in, first-out queue for handing work between threads.  Push()
+ * blocks while the queue is full and Pop() blocks while it is empty, so a fast
+ * producer cannot run arbitrarily far ahead of a slow consumer.  Closing the
+ * queue wakes all waiting threads; Pop() continues to return queued items and
+ * then returns false.
+ *
+ * The queue is also used as a pool of reusable buffers: the pool is filled
+ * once with pointers to preallocated buffers, and each buffer is returned to
+ * it after use.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitQueue_
+#define UnitQueue_
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+
+/**
+ * @brief Bounded, closable, thread-safe queue.
+ */
+template <class T>
+class UnitQueue {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre capacity > 0.
+	 * @param capacity Maximum number of queued items.
+	 * @post UnitQueue object exists, open and empty.
+	 * @return None.
+	 */
+	explicit UnitQueue(size_t capacity) : maxsize(capacity), closed(false) {}
+
+
+	/**
+	 * @brief Add an item, waiting while the queue is full.
+	 * @pre UnitQueue object exists.
+	 * @param item Item to be added.
+	 * @post Item queued unless the queue was closed.
+	 * @return Boolean value indicating whether the item was queued.
+	 */
+	bool Push(const T &item)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		notfull.wait(lock, [this]{ return closed || items.size() < maxsize; });
+		if(closed){
+			return false;
+		}
+		items.push_back(item);
+		notempty.notify_one();
+		return true;
+	}
+
+
+	/**
+	 * @brief Remove the oldest item, waiting while the queue is empty.
+	 * @pre UnitQueue object exists.
+	 * @param item Reference to contain the item.
+	 * @post Item removed from queue.
+	 * @return Boolean value indicating whether an item was removed.  False
+	 * 			only once the queue is closed and empty.
+	 */
+	bool Pop(T &item)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		notempty.wait(lock, [this]{ return closed || !items.empty(); });
+		if(items.empty()){
+			return false;
+		}
+		item = items.front();
+		items.pop_front();
+		notfull.notify_one();
+		return true;
+	}
+
+
+	/**
+	 * @brief Close the queue.  Further pushes fail, and pops fail once the
+	 * 			queue is empty.
+	 * @pre UnitQueue object exists.
+	 * @post Queue closed and all waiting threads woken.
+	 * @return None.
+	 */
+	void Close()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		closed = true;
+		notfull.notify_all();
+		notempty.notify_all();
+	}
+
+
+
+protected:
+	/** @brief Queued items */
+	std::deque<T> items;
+
+	/** @brief Maximum number of queued items */
+	size_t maxsize;
+
+	/** @brief Indicator that the queue has been closed */
+	bool closed;
+
+	/** @brief Lock protecting all members */
+	std::mutex mutex;
+
+	/** @brief Signalled when an item is removed */
+	std::condition_variable notfull;
+
+	/** @brief Signalled when an item is added */
+	std::condition_variable notempty;
+
+};
+
+
+#endif /* UnitQueue_ */
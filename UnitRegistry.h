@@ -0,0 +1,823 @@
+/**
+ * @file UnitRegistry.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * This class contains the table of units and SI prefixes understood by the
+ * unit-string compiler.  Each unit is described by its symbol, a short
+ * description, the category in which it is listed, and its relationship to the
+ * coherent SI unit of the same dimension:
+ *
+ * 		value_SI = value*factor + offset
+ *
+ * Logarithmic units (dB, dBm, dBW, Np, pH) instead have a nonzero 'logscale':
+ *
+ * 		value_SI = factor*10^(value/logscale)
+ *
+ * so that e.g. dBm (factor 1 mW, logscale 10) has the dimensions of power.
+ * dB and Np are levels of a power ratio (1 Np = 20/ln(10) dB, about 8.69 dB,
+ * as for field quantities), and pH is the negative logarithm of the hydrogen
+ * ion concentration in mol/L.
+ *
+ * Units that are neither affine nor logarithmic (API gravity, degrees Baume,
+ * sheet metal gauge) have a non-null 'curve' giving value_SI (see
+ * UnitCurve.h); their 'factor' is 1 and 'offset' and 'logscale' are unused.
+ * American wire gauge is exponential in the diameter and is defined as a
+ * logarithmic unit:
+ *
+ * 		d = 0.127 mm * 92^((36 - AWG)/39)
+ *
+ * The dimension of each unit is stored as a vector of integer exponents of
+ * the base dimensions (length, mass, time, temperature, amount, angle, and
+ * charge).  The symbols and categories match those listed by the GUI and by
+ * UnitConvert::PrintUnits().
+ *
+ * Unit strings may be interned to 16-bit IDs so that containers of values
+ * (e.g., QuantityColumn) can record their units in two bytes.  Equivalent
+ * unit strings share an ID (see UnitCanonical.h, where InternUnits() is
+ * defined since it canonicalizes with this registry).
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- Added InternUnits() and InternedUnits().
+ *
+ * @date 18 October 2026
+ *	- Added ExpandSymbol().
+ *
+ * @date 18 October 2026
+ *	- Added PrintUnits() and NumBuiltinUnits() for listing site units added
+ *	  after construction.
+ *
+ * @date 18 October 2026
+ *	- Added "h" as an alias for hours.
+ *
+ * @date 18 October 2026
+ *	- Added logarithmic units dB, Np, dBm, dBW, and pH.
+ *
+ * @date 18 October 2026
+ *	- Added non-linear units API, Be, Be_l, and ga, and wire gauge AWG.
+ *
+ * @date 18 October 2026
+ *	- InternUnits() gives equivalent unit strings the same ID, keyed on the
+ *	  canonical fingerprint.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitRegistry_
+#define UnitRegistry_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <sstream>
+#include <cmath>
+#include <stdint.h>
+#include "UnitCurve.h"
+
+
+/** @brief Number of base dimensions tracked for each unit */
+#define UNIT_NDIMS 7
+
+/** @brief Interned unit ID denoting no units (all IDs are in use) */
+#define UNIT_NO_ID 0xFFFF
+
+
+/**
+ * @brief Index of each base dimension within a unit's exponent vector.
+ */
+enum UnitDimension {
+	DIM_LENGTH = 0,
+	DIM_MASS,
+	DIM_TIME,
+	DIM_TEMPERATURE,
+	DIM_AMOUNT,
+	DIM_ANGLE,
+	DIM_CHARGE
+};
+
+
+/**
+ * @brief Definition of a single unit.
+ */
+struct UnitDefinition {
+	/** @brief Symbol used in unit strings (e.g., "ft") */
+	std::string symbol;
+
+	/** @brief Description shown to the user (e.g., "feet") */
+	std::string description;
+
+	/** @brief Category in which the unit is listed (e.g., "Length") */
+	std::string category;
+
+	/** @brief Multiplier from this unit to the coherent SI unit */
+	double factor;
+
+	/** @brief Offset added after scaling to the coherent SI unit */
+	double offset;
+
+	/** @brief Exponents of the base dimensions */
+	int dims[UNIT_NDIMS];
+
+	/** @brief 0 for ordinary units.  For logarithmic units, value_SI =
+	 * 			factor*10^(value/logscale) and 'offset' is unused. */
+	double logscale;
+
+	/** @brief 0 for affine and logarithmic units.  For other units,
+	 * 			value_SI = curve->ToSI(value). */
+	const UnitCurve *curve;
+};
+
+
+/**
+ * @brief Table of units and SI prefixes known to the unit-string compiler.
+ */
+class UnitRegistry {
+
+public:
+	/**
+	 * @brief Constructor.  Populates the registry with the default unit set.
+	 * @pre None.
+	 * @post UnitRegistry object exists and contains the default units.
+	 * @return None.
+	 */
+	UnitRegistry();
+
+
+	/**
+	 * @brief Add a unit to the registry.  An existing unit with the same
+	 * 			symbol is replaced.
+	 * @pre UnitRegistry object exists.
+	 * @param def Definition of the unit to be added.
+	 * @post Unit available for lookup.
+	 * @return None.
+	 */
+	void AddUnit(const UnitDefinition &def);
+
+
+	/**
+	 * @brief Add an alternate symbol for an existing unit.
+	 * @pre UnitRegistry object exists.
+	 * @param alias Alternate symbol.
+	 * @param symbol Symbol of the existing unit.
+	 * @post Alias available for lookup.
+	 * @return Boolean value indicating success or failure.
+	 */
+	bool AddAlias(const std::string &alias, const std::string &symbol);
+
+
+	/**
+	 * @brief Find the definition of a unit.
+	 * @pre UnitRegistry object exists.
+	 * @param symbol Unit symbol (or alias) to be found.
+	 * @post No changes to object.
+	 * @return Pointer to the unit definition, or 0 if the symbol is unknown.
+	 */
+	const UnitDefinition* FindUnit(const std::string &symbol) const;
+
+
+	/**
+	 * @brief Find the power-of-ten exponent associated with an SI prefix.
+	 * 			Both "-" and an empty string denote the absence of a prefix.
+	 * @pre UnitRegistry object exists.
+	 * @param si SI prefix symbol.
+	 * @param exponent Reference to the variable to contain the exponent.
+	 * @post No changes to object.
+	 * @return Boolean value indicating whether the prefix is known.
+	 */
+	bool FindPrefix(const std::string &si, int &exponent) const;
+
+
+	/**
+	 * @brief Expand a single unit symbol, possibly with an SI prefix (e.g.
+	 * 			"kPa"), into a unit string ("k:Pa:1").  Unit strings and empty
+	 * 			strings are returned unchanged.
+	 * @pre UnitRegistry object exists.
+	 * @param units Unit symbol or unit string.
+	 * @post No changes to object.
+	 * @return Unit string.  Unknown symbols are returned as "-:symbol:1" so
+	 * 			that compiling them reports the unknown unit.
+	 */
+	std::string ExpandSymbol(const std::string &units) const;
+
+
+	/**
+	 * @brief Number of units in the registry.
+	 * @pre UnitRegistry object exists.
+	 * @post No changes to object.
+	 * @return Number of units.
+	 */
+	size_t NumUnits() const;
+
+
+	/**
+	 * @brief Access a unit by its position in the registry.
+	 * @pre UnitRegistry object exists and idx < NumUnits().
+	 * @param idx Position of the unit.
+	 * @post No changes to object.
+	 * @return Reference to the unit definition.
+	 */
+	const UnitDefinition& Unit(size_t idx) const;
+
+
+	/**
+	 * @brief Number of units defined by the constructor.  Units added later
+	 * 			(e.g., site units) follow them.
+	 * @pre UnitRegistry object exists.
+	 * @post No changes to object.
+	 * @return Number of units.
+	 */
+	size_t NumBuiltinUnits() const;
+
+
+	/**
+	 * @brief List units by category, one per line as "symbol - description".
+	 * @pre UnitRegistry object exists.
+	 * @param first Position of the first unit listed.
+	 * @post No changes to object.
+	 * @return Listing, with categories in order of first appearance.
+	 */
+	std::string PrintUnits(size_t first = 0) const;
+
+
+	/**
+	 * @brief Format a vector of dimension exponents for display.
+	 * @pre None.
+	 * @param dims Exponents of the base dimensions.
+	 * @post No changes.
+	 * @return String such as "L^1 T^-1", or "dimensionless".
+	 */
+	static std::string DimensionString(const int *dims);
+
+
+	/**
+	 * @brief Assign a 16-bit ID to a unit string.  Equivalent unit strings
+	 * 			(the same canonical fingerprint, see CanonicalUnits) receive
+	 * 			the same ID, and InternedUnits() returns the first spelling
+	 * 			seen.  Strings which are not valid unit strings are interned
+	 * 			by their text.  Defined in UnitCanonical.h.
+	 * @pre UnitRegistry object exists.
+	 * @param str Unit string.
+	 * @post String interned.
+	 * @return ID, or UNIT_NO_ID if every ID is in use.
+	 */
+	uint16_t InternUnits(const std::string &str);
+
+
+	/**
+	 * @brief Unit string of an interned ID.
+	 * @pre UnitRegistry object exists and id < NumInterned().
+	 * @param id ID returned by InternUnits().
+	 * @post No changes to object.
+	 * @return Reference to the unit string.
+	 */
+	const std::string& InternedUnits(uint16_t id) const;
+
+
+	/**
+	 * @brief Number of interned unit strings.
+	 * @pre UnitRegistry object exists.
+	 * @post No changes to object.
+	 * @return Number of strings.
+	 */
+	size_t NumInterned() const;
+
+
+
+protected:
+	/**
+	 * @brief Define a unit in the registry.
+	 * @pre UnitRegistry object exists.
+	 * @param symbol Unit symbol.
+	 * @param description Unit description.
+	 * @param category Unit category.
+	 * @param factor Multiplier to the coherent SI unit.
+	 * @param offset Offset to the coherent SI unit.
+	 * @param L Length exponent.
+	 * @param M Mass exponent.
+	 * @param T Time exponent.
+	 * @param K Temperature exponent.
+	 * @param N Amount exponent.
+	 * @param A Angle exponent.
+	 * @param Q Charge exponent.
+	 * @param logscale Scale of a logarithmic unit, 0 for ordinary units.
+	 * @post Unit added to registry.
+	 * @return None.
+	 */
+	void Define(const char *symbol, const char *description, const char *category,
+			double factor, double offset, int L, int M, int T, int K, int N,
+			int A, int Q, double logscale = 0.0);
+
+
+	/**
+	 * @brief Define a non-linear unit in the registry.
+	 * @pre UnitRegistry object exists and the curve outlives it.
+	 * @param symbol Unit symbol.
+	 * @param description Unit description.
+	 * @param category Unit category.
+	 * @param curve Mapping from the unit to the coherent SI unit.
+	 * @param L Length exponent.
+	 * @param M Mass exponent.
+	 * @param T Time exponent.
+	 * @param K Temperature exponent.
+	 * @param N Amount exponent.
+	 * @param A Angle exponent.
+	 * @param Q Charge exponent.
+	 * @post Unit added to registry.
+	 * @return None.
+	 */
+	void DefineCurve(const char *symbol, const char *description,
+			const char *category, const UnitCurve *curve, int L, int M, int T,
+			int K, int N, int A, int Q);
+
+
+	/** @brief Unit definitions, in the order they were added */
+	std::vector<UnitDefinition> units;
+
+	/** @brief Map from unit symbol (or alias) to position in 'units' */
+	std::map<std::string,size_t> unitindex;
+
+	/** @brief Number of units defined by the constructor */
+	size_t nbuiltin;
+
+	/** @brief Map from SI prefix symbol to power-of-ten exponent */
+	std::map<std::string,int> prefixes;
+
+	/** @brief Interned unit strings, by ID */
+	std::vector<std::string> interned;
+
+	/** @brief Map from interned unit string to ID */
+	std::map<std::string,uint16_t> internindex;
+
+	/** @brief Map from canonical fingerprint of interned unit strings to ID */
+	std::map<uint64_t,uint16_t> internfingerprints;
+
+};
+
+
+
+// ==================================================================
+// ================
+// ================    PUBLIC FUNCTIONS
+// ================
+
+// CONSTRUCTOR
+UnitRegistry::UnitRegistry()
+{
+	/*
+	 * SI PREFIXES
+	 */
+	prefixes[""] = 0;
+	prefixes["-"] = 0;
+	prefixes["y"] = -24;
+	prefixes["z"] = -21;
+	prefixes["a"] = -18;
+	prefixes["f"] = -15;
+	prefixes["p"] = -12;
+	prefixes["n"] = -9;
+	prefixes["u"] = -6;
+	prefixes["m"] = -3;
+	prefixes["c"] = -2;
+	prefixes["d"] = -1;
+	prefixes["da"] = 1;
+	prefixes["h"] = 2;
+	prefixes["k"] = 3;
+	prefixes["M"] = 6;
+	prefixes["G"] = 9;
+	prefixes["T"] = 12;
+	prefixes["P"] = 15;
+	prefixes["E"] = 18;
+	prefixes["Z"] = 21;
+	prefixes["Y"] = 24;
+
+
+	/*
+	 * UNITS.  FACTORS CONVERT TO THE COHERENT SI UNIT (m, kg, s, K, mol, rad, C)
+	 *                                                       L  M  T  K  N  A  Q
+	 */
+	const double pi = 3.14159265358979323846;
+	const double gn = 9.80665;
+	const double rhow = 999.016;		// WATER AT 60 F, FOR SPECIFIC GRAVITY
+
+	/*
+	 * CURVES OF THE NON-LINEAR UNITS.  STATIC, SINCE DEFINITIONS (AND COPIES
+	 * OF THE REGISTRY) POINT TO THEM.  SHEET GAUGE IS THE MANUFACTURERS'
+	 * STANDARD FOR STEEL, GAUGES 3-38, IN INCHES.
+	 */
+	static const double sheetgauge[] = {
+		0.2391, 0.2242, 0.2092, 0.1943, 0.1793, 0.1644, 0.1495, 0.1345, 0.1196,
+		0.1046, 0.0897, 0.0747, 0.0673, 0.0598, 0.0538, 0.0478, 0.0418, 0.0359,
+		0.0329, 0.0299, 0.0269, 0.0239, 0.0209, 0.0179, 0.0164, 0.0149, 0.0135,
+		0.0120, 0.0105, 0.0097, 0.0090, 0.0082, 0.0075, 0.0067, 0.0064, 0.0060};
+	static const UnitCurveTable sheettable(3.0,1.0,sheetgauge,
+			(int)(sizeof(sheetgauge)/sizeof(sheetgauge[0])),0.0254);
+	static const UnitCurve sheetcurve = UnitCurve::Table(&sheettable);
+	static const UnitCurve apicurve = UnitCurve::Reciprocal(141.5*rhow,131.5);
+	static const UnitCurve beheavycurve = UnitCurve::Reciprocal(-145.0*rhow,-145.0);
+	static const UnitCurve belightcurve = UnitCurve::Reciprocal(140.0*rhow,130.0);
+
+	// ---- ACIDITY (LOGARITHMIC): [H+] = 10^-pH mol/L = 1000*10^-pH mol/m^3
+	Define("pH","pH, -log10 of H+ concentration in mol/L","Acidity",1000.0,0.0,
+	                                                        -3, 0, 0, 0, 1, 0, 0, -1.0);
+
+	// ---- ACCELERATION
+	Define("gee","gravitational acceleration at Earth's surface","Acceleration",
+			gn,0.0,                                          1, 0,-2, 0, 0, 0, 0);
+
+	// ---- ANGLE
+	Define("deg","degrees","Angle",pi/180.0,0.0,             0, 0, 0, 0, 0, 1, 0);
+	Define("grad","gradian","Angle",pi/200.0,0.0,            0, 0, 0, 0, 0, 1, 0);
+	Define("radian","radians","Angle",1.0,0.0,               0, 0, 0, 0, 0, 1, 0);
+
+	// ---- AREA
+	Define("acre","acres","Area",4046.8564224,0.0,           2, 0, 0, 0, 0, 0, 0);
+	Define("ha","hectares","Area",1.0e4,0.0,                 2, 0, 0, 0, 0, 0, 0);
+
+	// ---- DENSITY (NON-LINEAR): SPECIFIC GRAVITY SCALES
+	DefineCurve("API","degrees API gravity","Density",&apicurve,
+	                                                        -3, 1, 0, 0, 0, 0, 0);
+	DefineCurve("Be","degrees Baume, liquids heavier than water","Density",
+			&beheavycurve,                                  -3, 1, 0, 0, 0, 0, 0);
+	DefineCurve("Be_l","degrees Baume, liquids lighter than water","Density",
+			&belightcurve,                                  -3, 1, 0, 0, 0, 0, 0);
+
+	// ---- ENERGY/MOMENT/TORQUE/WORK
+	const char *energy = "Energy/Moment/Torque/Work";
+	Define("BTU","British Thermal Units",energy,1055.05585262,0.0,
+	                                                         2, 1,-2, 0, 0, 0, 0);
+	Define("cal","small (gram) calories",energy,4.184,0.0,   2, 1,-2, 0, 0, 0, 0);
+	Define("Cal","large (dietary) calories",energy,4184.0,0.0,
+	                                                         2, 1,-2, 0, 0, 0, 0);
+	Define("erg","ergs",energy,1.0e-7,0.0,                   2, 1,-2, 0, 0, 0, 0);
+	Define("eV","electron volts",energy,1.602176634e-19,0.0, 2, 1,-2, 0, 0, 0, 0);
+	Define("ft_lbf","foot-pounds-force",energy,1.3558179483314004,0.0,
+	                                                         2, 1,-2, 0, 0, 0, 0);
+	Define("J","Joules",energy,1.0,0.0,                      2, 1,-2, 0, 0, 0, 0);
+	Define("N_m","Newton-meters",energy,1.0,0.0,             2, 1,-2, 0, 0, 0, 0);
+
+	// ---- FORCE (BIBLICAL WEIGHTS ARE BASED ON A SHEKEL OF 11.4 g)
+	Define("bpound","Biblical pounds","Force",0.3265*gn,0.0, 1, 1,-2, 0, 0, 0, 0);
+	Define("cwt","US hundredweight","Force",444.82216152605,0.0,
+	                                                         1, 1,-2, 0, 0, 0, 0);
+	Define("dyn","dynes","Force",1.0e-5,0.0,                 1, 1,-2, 0, 0, 0, 0);
+	Define("gerah","Biblical gerahs","Force",0.00057*gn,0.0, 1, 1,-2, 0, 0, 0, 0);
+	Define("lbf","pounds-force","Force",4.4482216152605,0.0, 1, 1,-2, 0, 0, 0, 0);
+	Define("mina","Biblical minas","Force",0.570*gn,0.0,     1, 1,-2, 0, 0, 0, 0);
+	Define("N","Newtons","Force",1.0,0.0,                    1, 1,-2, 0, 0, 0, 0);
+	Define("oz","US ounces, non-fluid","Force",4.4482216152605/16.0,0.0,
+	                                                         1, 1,-2, 0, 0, 0, 0);
+	Define("shek","Biblical shekels","Force",0.0114*gn,0.0,  1, 1,-2, 0, 0, 0, 0);
+	Define("tal","Biblical talents","Force",34.2*gn,0.0,     1, 1,-2, 0, 0, 0, 0);
+
+	// ---- LENGTH
+	Define("AU","astronomical units","Length",1.495978707e11,0.0,
+	                                                         1, 0, 0, 0, 0, 0, 0);
+	Define("AWG","American wire gauge, diameter","Length",
+			0.127e-3*std::pow(92.0,36.0/39.0),0.0,           1, 0, 0, 0, 0, 0, 0,
+			-39.0/std::log10(92.0));
+	Define("cb","cables","Length",219.456,0.0,               1, 0, 0, 0, 0, 0, 0);
+	Define("chain","chains","Length",20.1168,0.0,            1, 0, 0, 0, 0, 0, 0);
+	Define("cubit","Biblical cubits, 18-inch definition","Length",0.4572,0.0,
+	                                                         1, 0, 0, 0, 0, 0, 0);
+	Define("ft","feet","Length",0.3048,0.0,                  1, 0, 0, 0, 0, 0, 0);
+	Define("ftm","fathoms","Length",1.8288,0.0,              1, 0, 0, 0, 0, 0, 0);
+	Define("fur","furlongs","Length",201.168,0.0,            1, 0, 0, 0, 0, 0, 0);
+	DefineCurve("ga","sheet metal gauge, steel","Length",&sheetcurve,
+	                                                         1, 0, 0, 0, 0, 0, 0);
+	Define("hand","hands","Length",0.1016,0.0,               1, 0, 0, 0, 0, 0, 0);
+	Define("in","inches","Length",0.0254,0.0,                1, 0, 0, 0, 0, 0, 0);
+	Define("lea","leagues","Length",4828.032,0.0,            1, 0, 0, 0, 0, 0, 0);
+	Define("li","links","Length",0.201168,0.0,               1, 0, 0, 0, 0, 0, 0);
+	Define("ly","light years","Length",9.4607304725808e15,0.0,
+	                                                         1, 0, 0, 0, 0, 0, 0);
+	Define("m","meters","Length",1.0,0.0,                    1, 0, 0, 0, 0, 0, 0);
+	Define("mile","miles","Length",1609.344,0.0,             1, 0, 0, 0, 0, 0, 0);
+	Define("nmi","nautical miles","Length",1852.0,0.0,       1, 0, 0, 0, 0, 0, 0);
+	Define("p","points","Length",0.0254/72.0,0.0,            1, 0, 0, 0, 0, 0, 0);
+	Define("P","picas","Length",0.0254/6.0,0.0,              1, 0, 0, 0, 0, 0, 0);
+	Define("ps","parsecs","Length",3.0856775814913673e16,0.0,1, 0, 0, 0, 0, 0, 0);
+	Define("rod","rods","Length",5.0292,0.0,                 1, 0, 0, 0, 0, 0, 0);
+	Define("sdj","Sabbath day's journeys","Length",914.4,0.0,1, 0, 0, 0, 0, 0, 0);
+	Define("span","Biblical spans","Length",0.2286,0.0,      1, 0, 0, 0, 0, 0, 0);
+
+	// ---- LEVEL (LOGARITHMIC).  1 Np OF A FIELD QUANTITY IS A POWER RATIO OF e^2
+	Define("dB","decibels","Level",1.0,0.0,                  0, 0, 0, 0, 0, 0, 0, 10.0);
+	Define("Np","nepers","Level",1.0,0.0,                    0, 0, 0, 0, 0, 0, 0,
+			1.15129254649702284201);
+
+	// ---- MASS
+	Define("dr","drams","Mass",1.7718451953125e-3,0.0,       0, 1, 0, 0, 0, 0, 0);
+	Define("dwt","pennyweight","Mass",1.55517384e-3,0.0,     0, 1, 0, 0, 0, 0, 0);
+	Define("g","grams","Mass",1.0e-3,0.0,                    0, 1, 0, 0, 0, 0, 0);
+	Define("gr","grains","Mass",64.79891e-6,0.0,             0, 1, 0, 0, 0, 0, 0);
+	Define("lbm","pounds-mass","Mass",0.45359237,0.0,        0, 1, 0, 0, 0, 0, 0);
+	Define("slug","slugs","Mass",14.593902937206364,0.0,     0, 1, 0, 0, 0, 0, 0);
+
+	// ---- POWER
+	Define("dBm","decibels relative to 1 mW","Power",1.0e-3,0.0,
+	                                                         2, 1,-3, 0, 0, 0, 0, 10.0);
+	Define("dBW","decibels relative to 1 W","Power",1.0,0.0, 2, 1,-3, 0, 0, 0, 0, 10.0);
+	Define("hp","horsepower, 1 hp = ~746 W","Power",745.69987158227022,0.0,
+	                                                         2, 1,-3, 0, 0, 0, 0);
+	Define("W","Watts","Power",1.0,0.0,                      2, 1,-3, 0, 0, 0, 0);
+
+	// ---- PRESSURE
+	Define("at","technical atmospheres","Pressure",98066.5,0.0,
+	                                                        -1, 1,-2, 0, 0, 0, 0);
+	Define("atm","atmospheres","Pressure",101325.0,0.0,     -1, 1,-2, 0, 0, 0, 0);
+	Define("bar","100 kPa","Pressure",1.0e5,0.0,            -1, 1,-2, 0, 0, 0, 0);
+	Define("ksi","1000 psi","Pressure",6894757.2931683613,0.0,
+	                                                        -1, 1,-2, 0, 0, 0, 0);
+	Define("Pa","Pascals","Pressure",1.0,0.0,               -1, 1,-2, 0, 0, 0, 0);
+	Define("psi","pounds-force per square inch","Pressure",6894.7572931683613,0.0,
+	                                                        -1, 1,-2, 0, 0, 0, 0);
+	Define("torr","Torrs","Pressure",101325.0/760.0,0.0,    -1, 1,-2, 0, 0, 0, 0);
+
+	// ---- QUANTITY
+	Define("mol","6.02 x10^23 particles","Quantity",1.0,0.0, 0, 0, 0, 0, 1, 0, 0);
+
+	// ---- RADIOACTIVE DECAY
+	Define("Bq","becquerels","Radioactive Decay",1.0,0.0,    0, 0,-1, 0, 0, 0, 0);
+	Define("Ci","Curies","Radioactive Decay",3.7e10,0.0,     0, 0,-1, 0, 0, 0, 0);
+
+	// ---- RADIATION DOSE
+	Define("Gy","Grays","Radiation Dose",1.0,0.0,            2, 0,-2, 0, 0, 0, 0);
+	Define("rad","radiation dose","Radiation Dose",0.01,0.0, 2, 0,-2, 0, 0, 0, 0);
+	Define("rem","rad-equivalent-man, assuming Q = 1","Radiation Dose",0.01,0.0,
+	                                                         2, 0,-2, 0, 0, 0, 0);
+	Define("Sv","Sieverts","Radiation Dose",1.0,0.0,         2, 0,-2, 0, 0, 0, 0);
+
+	// ---- RADIATION QUANTITY
+	Define("R","Roentgens","Radiation Quantity",2.58e-4,0.0, 0,-1, 0, 0, 0, 0, 1);
+
+	// ---- TEMPERATURE
+	Define("C","degrees Celcius","Temperature",1.0,273.15,   0, 0, 0, 1, 0, 0, 0);
+	Define("F","degrees Fahrenheight","Temperature",5.0/9.0,459.67*5.0/9.0,
+	                                                         0, 0, 0, 1, 0, 0, 0);
+	Define("K","Kelvins","Temperature",1.0,0.0,              0, 0, 0, 1, 0, 0, 0);
+
+	// ---- TIME
+	Define("day","days","Time",86400.0,0.0,                  0, 0, 1, 0, 0, 0, 0);
+	Define("hr","hours","Time",3600.0,0.0,                   0, 0, 1, 0, 0, 0, 0);
+	Define("min","minutes","Time",60.0,0.0,                  0, 0, 1, 0, 0, 0, 0);
+	Define("sec","seconds","Time",1.0,0.0,                   0, 0, 1, 0, 0, 0, 0);
+	AddAlias("s","sec");
+	AddAlias("h","hr");
+
+	// ---- VOLUME (BIBLICAL VOLUMES ARE BASED ON A BATH OF 22 L)
+	Define("bath","Biblical baths","Volume",0.022,0.0,       3, 0, 0, 0, 0, 0, 0);
+	Define("bbl","oil barrels","Volume",0.158987294928,0.0,  3, 0, 0, 0, 0, 0, 0);
+	Define("bu","bushels","Volume",0.03523907016688,0.0,     3, 0, 0, 0, 0, 0, 0);
+	Define("cup","US cups","Volume",2.365882365e-4,0.0,      3, 0, 0, 0, 0, 0, 0);
+	Define("dbbl","dry barrels","Volume",0.115628198985075,0.0,
+	                                                         3, 0, 0, 0, 0, 0, 0);
+	Define("dpt","dry pint","Volume",5.506104713575e-4,0.0,  3, 0, 0, 0, 0, 0, 0);
+	Define("dqt","dry quart","Volume",1.101220942715e-3,0.0, 3, 0, 0, 0, 0, 0, 0);
+	Define("ephah","Biblical ephahs","Volume",0.022,0.0,     3, 0, 0, 0, 0, 0, 0);
+	Define("fl_dr","US fluid drams","Volume",3.6966911953125e-6,0.0,
+	                                                         3, 0, 0, 0, 0, 0, 0);
+	Define("fl_oz","US fluid ounces","Volume",2.95735295625e-5,0.0,
+	                                                         3, 0, 0, 0, 0, 0, 0);
+	Define("gal","US gallons","Volume",3.785411784e-3,0.0,   3, 0, 0, 0, 0, 0, 0);
+	Define("gi","gills","Volume",1.1829411825e-4,0.0,        3, 0, 0, 0, 0, 0, 0);
+	Define("hin","Biblical hins","Volume",0.022/6.0,0.0,     3, 0, 0, 0, 0, 0, 0);
+	Define("hghd","hogsheads","Volume",0.238480942392,0.0,   3, 0, 0, 0, 0, 0, 0);
+	Define("homer","Biblical homers","Volume",0.22,0.0,      3, 0, 0, 0, 0, 0, 0);
+	Define("imp_gal","imperial gallons","Volume",4.54609e-3,0.0,
+	                                                         3, 0, 0, 0, 0, 0, 0);
+	Define("jig","jiggers","Volume",4.436029434375e-5,0.0,   3, 0, 0, 0, 0, 0, 0);
+	Define("L","liters","Volume",1.0e-3,0.0,                 3, 0, 0, 0, 0, 0, 0);
+	Define("lbbl","liquid barrels","Volume",0.119240471196,0.0,
+	                                                         3, 0, 0, 0, 0, 0, 0);
+	Define("minim","minims","Volume",6.1611519921875e-8,0.0, 3, 0, 0, 0, 0, 0, 0);
+	Define("omer","Biblical omers","Volume",0.0022,0.0,      3, 0, 0, 0, 0, 0, 0);
+	Define("pk","pecks","Volume",8.80976754172e-3,0.0,       3, 0, 0, 0, 0, 0, 0);
+	Define("lpt","US pints","Volume",4.73176473e-4,0.0,      3, 0, 0, 0, 0, 0, 0);
+	Define("lqt","US quarts","Volume",9.46352946e-4,0.0,     3, 0, 0, 0, 0, 0, 0);
+	Define("tsp","teaspoons","Volume",4.92892159375e-6,0.0,  3, 0, 0, 0, 0, 0, 0);
+	Define("Tbsp","tablespoons","Volume",1.478676478125e-5,0.0,
+	                                                         3, 0, 0, 0, 0, 0, 0);
+
+	nbuiltin = units.size();
+}
+
+
+void UnitRegistry::AddUnit(const UnitDefinition &def)
+{
+	std::map<std::string,size_t>::iterator it = unitindex.find(def.symbol);
+	if(it != unitindex.end()){
+		units[it->second] = def;
+	} else {
+		unitindex[def.symbol] = units.size();
+		units.push_back(def);
+	}
+}
+
+
+bool UnitRegistry::AddAlias(const std::string &alias, const std::string &symbol)
+{
+	std::map<std::string,size_t>::iterator it = unitindex.find(symbol);
+	if(it == unitindex.end()){
+		return false;
+	}
+	unitindex[alias] = it->second;
+	return true;
+}
+
+
+const UnitDefinition* UnitRegistry::FindUnit(const std::string &symbol) const
+{
+	std::map<std::string,size_t>::const_iterator it = unitindex.find(symbol);
+	if(it == unitindex.end()){
+		return 0;
+	}
+	return &units[it->second];
+}
+
+
+bool UnitRegistry::FindPrefix(const std::string &si, int &exponent) const
+{
+	std::map<std::string,int>::const_iterator it = prefixes.find(si);
+	if(it == prefixes.end()){
+		return false;
+	}
+	exponent = it->second;
+	return true;
+}
+
+
+std::string UnitRegistry::ExpandSymbol(const std::string &units) const
+{
+	if(units.empty() || units.find(':') != std::string::npos){
+		return units;
+	}
+	if(FindUnit(units)){
+		return "-:" + units + ":1";
+	}
+
+	/*
+	 * TRY A PREFIX OF ONE OR TWO CHARACTERS ("k", "da")
+	 */
+	int exponent = 0;
+	for(size_t k=1; k<=2 && k<units.size(); k++){
+		std::string si = units.substr(0,k);
+		std::string rest = units.substr(k);
+		if(FindPrefix(si,exponent) && FindUnit(rest)){
+			return si + ":" + rest + ":1";
+		}
+	}
+	return "-:" + units + ":1";
+}
+
+
+size_t UnitRegistry::NumUnits() const
+{
+	return units.size();
+}
+
+
+const UnitDefinition& UnitRegistry::Unit(size_t idx) const
+{
+	return units[idx];
+}
+
+
+size_t UnitRegistry::NumBuiltinUnits() const
+{
+	return nbuiltin;
+}
+
+
+std::string UnitRegistry::PrintUnits(size_t first) const
+{
+	std::vector<std::string> categories;
+	for(size_t i=first; i<units.size(); i++){
+		if(std::find(categories.begin(),categories.end(),units[i].category) == categories.end()){
+			categories.push_back(units[i].category);
+		}
+	}
+
+	std::stringstream sstmp;
+	for(size_t c=0; c<categories.size(); c++){
+		sstmp << categories[c] << std::endl;
+		for(size_t i=first; i<units.size(); i++){
+			if(units[i].category == categories[c]){
+				sstmp << "   " << units[i].symbol << " - " << units[i].description << std::endl;
+			}
+		}
+	}
+	return sstmp.str();
+}
+
+
+const std::string& UnitRegistry::InternedUnits(uint16_t id) const
+{
+	return interned[id];
+}
+
+
+size_t UnitRegistry::NumInterned() const
+{
+	return interned.size();
+}
+
+
+std::string UnitRegistry::DimensionString(const int *dims)
+{
+	const char *names[UNIT_NDIMS] = { "L", "M", "T", "K", "N", "A", "Q" };
+	std::stringstream sstmp;
+	bool first = true;
+	for(int i=0; i<UNIT_NDIMS; i++){
+		if(dims[i] != 0){
+			if(!first){ sstmp << " "; }
+			sstmp << names[i] << "^" << dims[i];
+			first = false;
+		}
+	}
+	if(first){
+		return std::string("dimensionless");
+	}
+	return sstmp.str();
+}
+
+
+
+// ==================================================================
+// ================
+// ================    PROTECTED FUNCTIONS
+// ================
+
+void UnitRegistry::Define(const char *symbol, const char *description,
+		const char *category, double factor, double offset, int L, int M,
+		int T, int K, int N, int A, int Q, double logscale)
+{
+	UnitDefinition def;
+	def.symbol = symbol;
+	def.description = description;
+	def.category = category;
+	def.factor = factor;
+	def.offset = offset;
+	def.dims[DIM_LENGTH] = L;
+	def.dims[DIM_MASS] = M;
+	def.dims[DIM_TIME] = T;
+	def.dims[DIM_TEMPERATURE] = K;
+	def.dims[DIM_AMOUNT] = N;
+	def.dims[DIM_ANGLE] = A;
+	def.dims[DIM_CHARGE] = Q;
+	def.logscale = logscale;
+	def.curve = 0;
+	AddUnit(def);
+}
+
+
+void UnitRegistry::DefineCurve(const char *symbol, const char *description,
+		const char *category, const UnitCurve *curve, int L, int M, int T,
+		int K, int N, int A, int Q)
+{
+	Define(symbol,description,category,1.0,0.0,L,M,T,K,N,A,Q);
+	units[unitindex[symbol]].curve = curve;
+}
+
+
+#endif /* UnitRegistry_ */
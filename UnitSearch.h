@@ -0,0 +1,710 @@
+/**
+ * @file UnitSearch.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Search index over the unit symbols, unit descriptions, and SI prefixes of a
+ * UnitRegistry, used to suggest completions while a unit string is typed.
+ *
+ * Every unit is indexed under its symbol, its description, and each word of
+ * its description, so "fathoms", "journ" (Sabbath day's journeys), and "ftm"
+ * all find the intended unit.  Prefixes are indexed under their symbol and
+ * name ("k", "kilo").  Keys are folded to lower case.
+ *
+ * The keys are sorted and stored in a trie whose nodes are kept in flat arrays
+ * (children of a node are contiguous, with their first characters in a
+ * separate array).  Each node records the range of sorted keys below it, so
+ * every key beginning with a prefix is found by walking one path.  Queries of
+ * UNITSEARCH_FUZZY_MIN or more characters also match keys within one edit
+ * (insertion, deletion, substitution, or transposition of adjacent
+ * characters) of a prefix; with a single edit allowed, the search visits few
+ * nodes beyond the exact path.
+ *
+ * Results are ranked by edit distance, then by whether the symbol (rather than
+ * the description) matched, then by key length.  Nodes with more than
+ * UNITSEARCH_TOP keys below them store their UNITSEARCH_TOP best entries when
+ * the index is built, so short queries do not scan every key they match and
+ * the cost of a search does not grow with the number of units.  A search
+ * therefore returns at most UNITSEARCH_TOP results per matching node.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitSearch_
+#define UnitSearch_
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+#include <stdint.h>
+#include "UnitRegistry.h"
+
+
+/** @brief Minimum query length for which near matches are included */
+#define UNITSEARCH_FUZZY_MIN 3
+
+/** @brief Number of best entries kept for nodes with many keys below them */
+#define UNITSEARCH_TOP 32
+
+
+/**
+ * @brief Kind of item found by a search.
+ */
+enum UnitSearchKind {
+	UNITSEARCH_UNIT = 1,	/**< Unit */
+	UNITSEARCH_PREFIX = 2	/**< SI prefix */
+};
+
+
+/**
+ * @brief Item which can be found by a search.
+ */
+struct UnitSearchEntry {
+	/** @brief Unit or prefix */
+	UnitSearchKind kind;
+
+	/** @brief Symbol used in unit strings */
+	std::string symbol;
+
+	/** @brief Description or prefix name */
+	std::string description;
+};
+
+
+/**
+ * @brief Result of a search.
+ */
+struct UnitSearchResult {
+	/** @brief Position of the entry (see UnitSearch::Entry()) */
+	size_t entry;
+
+	/** @brief Number of edits between the query and the matched prefix */
+	int distance;
+};
+
+
+/**
+ * @brief Prefix-trie index over units and SI prefixes.
+ */
+class UnitSearch {
+
+public:
+	/**
+	 * @brief Constructor.  The new index is empty.
+	 * @pre None.
+	 * @post UnitSearch object exists.
+	 * @return None.
+	 */
+	UnitSearch();
+
+
+	/**
+	 * @brief Index the units and prefixes of a registry, replacing the
+	 * 			current contents.
+	 * @pre UnitSearch object exists.
+	 * @param reg Registry to be indexed.
+	 * @post Index built.
+	 * @return None.
+	 */
+	void Build(const UnitRegistry &reg);
+
+
+	/**
+	 * @brief Find entries with a key beginning with the query, or within one
+	 * 			edit of doing so.
+	 * @pre UnitSearch object exists.
+	 * @param query Text typed so far (case is ignored).
+	 * @param kinds Combination of UnitSearchKind values to be returned.
+	 * @param maxresults Maximum number of results.
+	 * @param results Reference to contain the results, best first.
+	 * @post No changes to object.
+	 * @return Number of results.
+	 */
+	size_t Search(const std::string &query, int kinds, size_t maxresults,
+			std::vector<UnitSearchResult> &results) const;
+
+
+	/**
+	 * @brief Access an entry.
+	 * @pre idx < NumEntries().
+	 * @param idx Position of the entry.
+	 * @post No changes to object.
+	 * @return Reference to the entry.
+	 */
+	const UnitSearchEntry& Entry(size_t idx) const;
+
+
+	/**
+	 * @brief Number of entries.
+	 * @pre UnitSearch object exists.
+	 * @post No changes to object.
+	 * @return Number of entries.
+	 */
+	size_t NumEntries() const;
+
+
+	/**
+	 * @brief Number of trie nodes.
+	 * @pre UnitSearch object exists.
+	 * @post No changes to object.
+	 * @return Number of nodes.
+	 */
+	size_t NumNodes() const;
+
+
+	/**
+	 * @brief Locate the part of a unit string being typed.  This is the last
+	 * 			term (after the last '|'); within it, the text after the
+	 * 			prefix if a ':' has been typed.
+	 * @pre None.
+	 * @param text Unit string typed so far.
+	 * @param query Reference to contain the text to be searched for.
+	 * @param kinds Reference to contain the UnitSearchKind values which may
+	 * 			complete the text, or 0 if the power is being typed.
+	 * @post No changes.
+	 * @return None.
+	 */
+	static void CompletionQuery(const std::string &text, std::string &query, int &kinds);
+
+
+	/**
+	 * @brief Complete the term being typed with an entry.
+	 * @pre idx < NumEntries().
+	 * @param text Unit string typed so far.
+	 * @param idx Position of the entry.
+	 * @post No changes to object.
+	 * @return Unit string with the last term completed, e.g. "-:ftm:1" for a
+	 * 			unit or "k:" for a prefix.
+	 */
+	std::string Complete(const std::string &text, size_t idx) const;
+
+
+
+protected:
+	/**
+	 * @brief Indexed text.
+	 */
+	struct Key {
+		/** @brief Lower-case text */
+		std::string text;
+
+		/** @brief Position of the entry */
+		uint32_t entry;
+
+		/** @brief 0 for a symbol, 1 for a description, 2 for a later word */
+		uint32_t field;
+
+		bool operator<(const Key &other) const { return text < other.text; }
+	};
+
+
+	/**
+	 * @brief Trie node.  Keys [lo,hi) share the node's prefix; its children
+	 * 			are edges [firstedge, firstedge+nedges).  If ntop is not 0, the
+	 * 			best keys below the node are tops[firsttop, firsttop+ntop).
+	 */
+	struct Node {
+		uint32_t lo;
+		uint32_t hi;
+		uint32_t firstedge;
+		uint32_t nedges;
+		uint32_t firsttop;
+		uint32_t ntop;
+	};
+
+
+	/**
+	 * @brief Candidate result during a search.
+	 */
+	struct Candidate {
+		uint32_t entry;
+		uint32_t distance;
+		uint32_t field;
+		uint32_t length;
+	};
+
+
+	/** @brief Entries */
+	std::vector<UnitSearchEntry> entries;
+
+	/** @brief Sorted keys */
+	std::vector<Key> keys;
+
+	/** @brief Trie nodes; node 0 is the root */
+	std::vector<Node> nodes;
+
+	/** @brief First character of each edge, sorted within each node */
+	std::vector<char> edgechar;
+
+	/** @brief Node reached by each edge */
+	std::vector<uint32_t> edgenode;
+
+	/** @brief Best keys below nodes with many keys */
+	std::vector<uint32_t> tops;
+
+
+	/**
+	 * @brief Add the keys of an entry.
+	 * @return None.
+	 */
+	void AddKeys(uint32_t entry, const std::string &symbol, const std::string &description);
+
+
+	/**
+	 * @brief Build the node for keys [lo,hi), which share 'depth' characters.
+	 * @return Position of the node.
+	 */
+	uint32_t BuildNode(uint32_t lo, uint32_t hi, size_t depth);
+
+
+	/**
+	 * @brief Keys below a node, limited to the best UNITSEARCH_TOP entries.
+	 * @return None.
+	 */
+	void NodeKeys(uint32_t node, std::vector<uint32_t> &out) const;
+
+
+	/**
+	 * @brief Order keys by rank, ignoring edit distance.
+	 * @return Boolean value indicating key a ranks before key b.
+	 */
+	bool Better(uint32_t a, uint32_t b) const;
+
+
+	/**
+	 * @brief Child of a node.
+	 * @return Position of the child, or 0 if there is none.
+	 */
+	uint32_t Child(uint32_t node, char ch) const;
+
+
+	/**
+	 * @brief Collect the nodes whose prefix is within one edit of a prefix of
+	 * 			the query.
+	 * @return None.
+	 */
+	void Fuzzy(uint32_t node, const std::string &q, size_t i, bool edit,
+			std::vector<uint32_t> &found) const;
+
+
+	/**
+	 * @brief Lower-case copy of a string.
+	 * @return Lower-case string.
+	 */
+	static std::string Fold(const std::string &str);
+
+};
+
+
+
+// ==== PUBLIC FUNCTIONS =======================================================
+
+UnitSearch::UnitSearch()
+{
+}
+
+
+void UnitSearch::Build(const UnitRegistry &reg)
+{
+	entries.clear();
+	keys.clear();
+	nodes.clear();
+	edgechar.clear();
+	edgenode.clear();
+	tops.clear();
+
+
+	/*
+	 * ENTRIES AND KEYS.  PREFIXES ARE ONLY LISTED IF THE REGISTRY KNOWS THEM.
+	 */
+	const char *prefixes[][2] = {
+		{"y","yocto"}, {"z","zepto"}, {"a","atto"}, {"f","femto"}, {"p","pico"},
+		{"n","nano"}, {"u","micro"}, {"m","milli"}, {"c","centi"}, {"d","deci"},
+		{"da","deka"}, {"h","hecto"}, {"k","kilo"}, {"M","mega"}, {"G","giga"},
+		{"T","tera"}, {"P","peta"}, {"E","exa"}, {"Z","zetta"}, {"Y","yotta"}
+	};
+	for(size_t i=0; i<sizeof(prefixes)/sizeof(prefixes[0]); i++){
+		int exponent = 0;
+		if(reg.FindPrefix(prefixes[i][0],exponent)){
+			UnitSearchEntry entry = {UNITSEARCH_PREFIX, prefixes[i][0], prefixes[i][1]};
+			AddKeys((uint32_t)entries.size(),entry.symbol,entry.description);
+			entries.push_back(entry);
+		}
+	}
+	for(size_t i=0; i<reg.NumUnits(); i++){
+		const UnitDefinition &def = reg.Unit(i);
+		UnitSearchEntry entry = {UNITSEARCH_UNIT, def.symbol, def.description};
+		AddKeys((uint32_t)entries.size(),entry.symbol,entry.description);
+		entries.push_back(entry);
+	}
+
+
+	/*
+	 * TRIE OVER THE SORTED KEYS
+	 */
+	std::stable_sort(keys.begin(),keys.end());
+	nodes.reserve(keys.size()*4);
+	BuildNode(0,(uint32_t)keys.size(),0);
+}
+
+
+size_t UnitSearch::Search(const std::string &query, int kinds, size_t maxresults,
+		std::vector<UnitSearchResult> &results) const
+{
+	results.clear();
+	std::string q = Fold(query);
+	if(q.empty() || nodes.empty() || maxresults == 0){
+		return 0;
+	}
+
+
+	/*
+	 * EXACT PREFIX, THEN NEAR MATCHES
+	 */
+	std::vector<uint32_t> found;
+	uint32_t node = 0;
+	for(size_t i=0; i<q.size(); i++){
+		/* NODE 0 IS THE ROOT, WHICH IS NEVER A CHILD */
+		node = Child(node,q[i]);
+		if(node == 0){
+			break;
+		}
+	}
+	if(node != 0){
+		found.push_back(node);
+	}
+	size_t nexact = found.size();
+	if(q.size() >= UNITSEARCH_FUZZY_MIN){
+		Fuzzy(0,q,0,true,found);
+		std::sort(found.begin() + nexact,found.end());
+		found.erase(std::unique(found.begin() + nexact,found.end()),found.end());
+	}
+
+
+	/*
+	 * RANK ALL KEYS BELOW THE NODES FOUND, KEEPING EACH ENTRY ONCE
+	 */
+	std::vector<Candidate> cands;
+	std::vector<uint32_t> nodekeys;
+	for(size_t f=0; f<found.size(); f++){
+		uint32_t distance = (f < nexact) ? 0 : 1;
+		NodeKeys(found[f],nodekeys);
+		for(size_t j=0; j<nodekeys.size(); j++){
+			const Key &key = keys[nodekeys[j]];
+			if(!(entries[key.entry].kind & kinds)){
+				continue;
+			}
+			Candidate c = {key.entry, distance, key.field, (uint32_t)key.text.size()};
+			cands.push_back(c);
+		}
+	}
+	std::sort(cands.begin(),cands.end(),[](const Candidate &a, const Candidate &b){
+		if(a.entry != b.entry){ return a.entry < b.entry; }
+		if(a.distance != b.distance){ return a.distance < b.distance; }
+		if(a.field != b.field){ return a.field < b.field; }
+		return a.length < b.length;
+	});
+	cands.erase(std::unique(cands.begin(),cands.end(),[](const Candidate &a, const Candidate &b){
+		return a.entry == b.entry;
+	}),cands.end());
+
+	size_t nresults = std::min(maxresults,cands.size());
+	std::partial_sort(cands.begin(),cands.begin() + nresults,cands.end(),
+			[](const Candidate &a, const Candidate &b){
+		if(a.distance != b.distance){ return a.distance < b.distance; }
+		if(a.field != b.field){ return a.field < b.field; }
+		if(a.length != b.length){ return a.length < b.length; }
+		return a.entry < b.entry;
+	});
+	for(size_t i=0; i<nresults; i++){
+		UnitSearchResult r = {cands[i].entry, (int)cands[i].distance};
+		results.push_back(r);
+	}
+	return nresults;
+}
+
+
+const UnitSearchEntry& UnitSearch::Entry(size_t idx) const
+{
+	return entries[idx];
+}
+
+
+size_t UnitSearch::NumEntries() const
+{
+	return entries.size();
+}
+
+
+size_t UnitSearch::NumNodes() const
+{
+	return nodes.size();
+}
+
+
+void UnitSearch::CompletionQuery(const std::string &text, std::string &query, int &kinds)
+{
+	size_t bar = text.rfind('|');
+	std::string term = (bar == std::string::npos) ? text : text.substr(bar+1);
+	size_t c1 = term.find(':');
+	if(c1 == std::string::npos){
+		query = term;
+		kinds = UNITSEARCH_UNIT | UNITSEARCH_PREFIX;
+	} else if(term.find(':',c1+1) == std::string::npos){
+		query = term.substr(c1+1);
+		kinds = UNITSEARCH_UNIT;
+	} else {
+		query = "";
+		kinds = 0;
+	}
+}
+
+
+std::string UnitSearch::Complete(const std::string &text, size_t idx) const
+{
+	size_t bar = text.rfind('|');
+	size_t start = (bar == std::string::npos) ? 0 : bar+1;
+	std::string term = text.substr(start);
+	const UnitSearchEntry &entry = entries[idx];
+
+	std::string replacement;
+	if(entry.kind == UNITSEARCH_PREFIX){
+		replacement = entry.symbol + ":";
+	} else {
+		size_t c1 = term.find(':');
+		std::string si = (c1 == std::string::npos || c1 == 0) ? "-" : term.substr(0,c1);
+		replacement = si + ":" + entry.symbol + ":1";
+	}
+	return text.substr(0,start) + replacement;
+}
+
+
+
+// ==== PROTECTED FUNCTIONS ====================================================
+
+void UnitSearch::AddKeys(uint32_t entry, const std::string &symbol, const std::string &description)
+{
+	Key key;
+	key.entry = entry;
+	key.text = Fold(symbol);
+	key.field = 0;
+	keys.push_back(key);
+
+	/* THE WHOLE DESCRIPTION, THEN EACH LATER WORD TO THE END */
+	std::string desc = Fold(description);
+	for(size_t i=0; i<desc.size(); i++){
+		bool wordstart = (i == 0) || (!std::isalnum((unsigned char)desc[i-1]) &&
+				desc[i-1] != '\'' && std::isalnum((unsigned char)desc[i]));
+		if(wordstart){
+			key.text = desc.substr(i);
+			key.field = (i == 0) ? 1 : 2;
+			keys.push_back(key);
+		}
+	}
+}
+
+
+uint32_t UnitSearch::BuildNode(uint32_t lo, uint32_t hi, size_t depth)
+{
+	uint32_t idx = (uint32_t)nodes.size();
+	Node node = {lo, hi, 0, 0, 0, 0};
+	nodes.push_back(node);
+
+
+	/*
+	 * KEYS ENDING HERE SORT FIRST.  THE REST ARE GROUPED BY THEIR NEXT
+	 * CHARACTER; EACH GROUP BECOMES ONE CHILD.
+	 */
+	uint32_t k = lo;
+	while(k < hi && keys[k].text.size() == depth){
+		k++;
+	}
+	std::vector<uint32_t> starts;
+	for(; k<hi; k++){
+		if(starts.empty() || keys[k].text[depth] != keys[starts.back()].text[depth]){
+			starts.push_back(k);
+		}
+	}
+	starts.push_back(hi);
+
+	uint32_t first = (uint32_t)edgechar.size();
+	uint32_t nedges = (uint32_t)starts.size() - 1;
+	for(uint32_t e=0; e<nedges; e++){
+		edgechar.push_back(keys[starts[e]].text[depth]);
+		edgenode.push_back(0);
+	}
+	for(uint32_t e=0; e<nedges; e++){
+		uint32_t child = BuildNode(starts[e],starts[e+1],depth+1);
+		edgenode[first + e] = child;
+	}
+	nodes[idx].firstedge = first;
+	nodes[idx].nedges = nedges;
+
+
+	/*
+	 * FOR LARGE NODES, KEEP THE BEST KEYS FROM THOSE ENDING HERE AND THOSE
+	 * ALREADY SELECTED FOR EACH CHILD, ONE KEY PER ENTRY
+	 */
+	if(hi - lo <= UNITSEARCH_TOP){
+		return idx;
+	}
+	std::vector<uint32_t> best;
+	for(uint32_t j=lo; j<starts[0]; j++){
+		best.push_back(j);
+	}
+	std::vector<uint32_t> childkeys;
+	for(uint32_t e=0; e<nedges; e++){
+		NodeKeys(edgenode[first + e],childkeys);
+		best.insert(best.end(),childkeys.begin(),childkeys.end());
+	}
+	std::sort(best.begin(),best.end(),[this](uint32_t a, uint32_t b){
+		if(keys[a].entry != keys[b].entry){ return keys[a].entry < keys[b].entry; }
+		return Better(a,b);
+	});
+	best.erase(std::unique(best.begin(),best.end(),[this](uint32_t a, uint32_t b){
+		return keys[a].entry == keys[b].entry;
+	}),best.end());
+	size_t ntop = std::min((size_t)UNITSEARCH_TOP,best.size());
+	std::partial_sort(best.begin(),best.begin() + ntop,best.end(),
+			[this](uint32_t a, uint32_t b){ return Better(a,b); });
+	nodes[idx].firsttop = (uint32_t)tops.size();
+	nodes[idx].ntop = (uint32_t)ntop;
+	tops.insert(tops.end(),best.begin(),best.begin() + ntop);
+	return idx;
+}
+
+
+void UnitSearch::NodeKeys(uint32_t node, std::vector<uint32_t> &out) const
+{
+	const Node &n = nodes[node];
+	out.clear();
+	if(n.ntop > 0){
+		out.assign(tops.begin() + n.firsttop,tops.begin() + n.firsttop + n.ntop);
+	} else {
+		for(uint32_t k=n.lo; k<n.hi; k++){
+			out.push_back(k);
+		}
+	}
+}
+
+
+bool UnitSearch::Better(uint32_t a, uint32_t b) const
+{
+	if(keys[a].field != keys[b].field){ return keys[a].field < keys[b].field; }
+	if(keys[a].text.size() != keys[b].text.size()){
+		return keys[a].text.size() < keys[b].text.size();
+	}
+	return keys[a].entry < keys[b].entry;
+}
+
+
+uint32_t UnitSearch::Child(uint32_t node, char ch) const
+{
+	const Node &n = nodes[node];
+	const char *begin = &edgechar[0] + n.firstedge;
+	const char *end = begin + n.nedges;
+	const char *it = std::lower_bound(begin,end,ch);
+	if(it == end || *it != ch){
+		return 0;
+	}
+	return edgenode[n.firstedge + (uint32_t)(it - begin)];
+}
+
+
+void UnitSearch::Fuzzy(uint32_t node, const std::string &q, size_t i, bool edit,
+		std::vector<uint32_t> &found) const
+{
+	/*
+	 * THE WHOLE QUERY HAS BEEN MATCHED.  ONLY NODES WHICH USED THE EDIT ARE
+	 * NEW; THE EXACT MATCH IS ALREADY IN THE LIST.
+	 */
+	if(i == q.size()){
+		if(!edit){
+			found.push_back(node);
+		}
+		return;
+	}
+
+	const Node &n = nodes[node];
+	for(uint32_t e=n.firstedge; e<n.firstedge + n.nedges; e++){
+		uint32_t child = edgenode[e];
+		if(edgechar[e] == q[i]){
+			Fuzzy(child,q,i+1,edit,found);
+		} else if(edit){
+			/* SUBSTITUTION */
+			Fuzzy(child,q,i+1,false,found);
+		}
+		if(edit && edgechar[e] != q[i]){
+			/* INSERTION OF A CHARACTER MISSING FROM THE QUERY */
+			Fuzzy(child,q,i,false,found);
+		}
+	}
+	if(edit){
+		/* DELETION OF AN EXTRA CHARACTER IN THE QUERY */
+		Fuzzy(node,q,i+1,false,found);
+
+		/* TRANSPOSITION OF TWO ADJACENT CHARACTERS */
+		if(i+1 < q.size() && q[i] != q[i+1]){
+			uint32_t child = Child(node,q[i+1]);
+			uint32_t grandchild = (child != 0) ? Child(child,q[i]) : 0;
+			if(grandchild != 0){
+				Fuzzy(grandchild,q,i+2,false,found);
+			}
+		}
+	}
+}
+
+
+std::string UnitSearch::Fold(const std::string &str)
+{
+	std::string folded(str);
+	for(size_t i=0; i<folded.size(); i++){
+		folded[i] = (char)std::tolower((unsigned char)folded[i]);
+	}
+	return folded;
+}
+
+
+#endif /* UnitSearch_ */
@@ -0,0 +1,689 @@
+/**
+ * @file UnitShard.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Conversion of very large uncompressed files (delimited text or NDJSON) by a
+ * pool of worker processes.  The input is divided into shards: byte ranges
+ * which end at the end of a line.  The calling process acts as coordinator; it
+ * forks the workers, each of which inherits its own copy of the configured
+ * UnitStream, and hands out shards over one local socket per worker.
+ *
+ * Shards are handed out on request, in input order, so an idle worker always
+ * takes the next unclaimed shard and no worker is left with a queue of work
+ * while others wait.  Shards shrink towards the end of the input (each is at
+ * most a fraction of what remains per worker) so that the last shards finish
+ * close together and a slow worker does not hold up the job.
+ *
+ * A worker converts a shard in memory and reports the length of its output.
+ * Once the lengths of all earlier shards are known, the coordinator assigns
+ * the shard its offset in the output file and the worker writes it there
+ * directly.  The output is therefore assembled in order without a separate
+ * concatenation pass.  A worker keeps converting further shards while it
+ * waits for offsets, up to SHARD_MAX_PENDING shards held in memory.
+ *
+ * Messages are fixed-size records of 64-bit fields on a stream socket, and
+ * shards are identified only by byte ranges of a named file, so the same
+ * protocol could be carried over TCP to workers on other machines sharing
+ * the file system.
+ *
+ * gzip and zstd input cannot be divided at byte offsets and are rejected; use
+ * UnitStream for compressed files.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitShard_
+#define UnitShard_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <stdint.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "UnitStream.h"
+
+
+/** @brief Largest shard, in bytes */
+#define SHARD_MAX_SIZE 67108864
+
+/** @brief Smallest shard, in bytes (except at the end of the input) */
+#define SHARD_MIN_SIZE 4194304
+
+/** @brief Converted shards a worker may hold while waiting for their offsets */
+#define SHARD_MAX_PENDING 4
+
+
+/**
+ * @brief Coordinator of a pool of worker processes converting one file.
+ */
+class UnitShard {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre Stream exists, is configured, and outlives this object.
+	 * @param conv Stream whose settings (units, field, NDJSON converter) are
+	 * 			used by the workers.
+	 * @post UnitShard object exists.
+	 * @return None.
+	 */
+	UnitShard(UnitStream &conv);
+
+
+	/**
+	 * @brief Set the number of worker processes.
+	 * @pre UnitShard object exists.
+	 * @param n Number of workers.  Values below 1 select the number of
+	 * 			processors.
+	 * @post Number of workers set.
+	 * @return None.
+	 */
+	void SetWorkers(int n);
+
+
+	/**
+	 * @brief Set the largest shard.
+	 * @pre UnitShard object exists.
+	 * @param bytes Size in bytes (SHARD_MAX_SIZE by default).
+	 * @post Size set.
+	 * @return None.
+	 */
+	void SetShardSize(size_t bytes);
+
+
+	/**
+	 * @brief Convert a file.
+	 * @pre UnitShard object exists.  The calling process has no other threads
+	 * 			running, since it forks.
+	 * @param filein Input file.  Must be a regular, uncompressed file.
+	 * @param fileout Output file.  Must be a regular file or a new file.
+	 * @post Output written.
+	 * @return Boolean value indicating success or failure.  See Error().
+	 */
+	bool Run(const std::string &filein, const std::string &fileout);
+
+
+	/**
+	 * @brief Description of the failure of the last call to Run().
+	 * @pre UnitShard object exists.
+	 * @post No changes to object.
+	 * @return Error message, or an empty string.
+	 */
+	std::string Error() const;
+
+
+	/**
+	 * @brief Number of values converted by the last call to Run().
+	 * @pre UnitShard object exists.
+	 * @post No changes to object.
+	 * @return Number of values.
+	 */
+	size_t NumValues() const;
+
+
+	/**
+	 * @brief Number of shards of the last call to Run().
+	 * @pre UnitShard object exists.
+	 * @post No changes to object.
+	 * @return Number of shards.
+	 */
+	size_t NumShards() const;
+
+
+
+protected:
+	/**
+	 * @brief Message types.
+	 */
+	enum MessageType {
+		SHARD_READY = 1,		/**< worker: ready for another shard */
+		SHARD_WORK,				/**< coordinator: convert [a, a+b) */
+		SHARD_DONE,				/**< worker: output is a bytes, b values */
+		SHARD_WRITE,			/**< coordinator: write output at offset a */
+		SHARD_WRITTEN,			/**< worker: output written */
+		SHARD_STOP,				/**< coordinator: exit */
+		SHARD_FAILED			/**< worker: read or write failed */
+	};
+
+
+	/**
+	 * @brief Message exchanged between the coordinator and a worker.
+	 */
+	struct Message {
+		uint64_t type;
+		uint64_t shard;
+		uint64_t a;
+		uint64_t b;
+	};
+
+
+	/** @brief Stream used to convert each shard */
+	UnitStream &stream;
+
+	/** @brief Number of workers */
+	int nworkers;
+
+	/** @brief Largest shard */
+	size_t shardsize;
+
+	/** @brief Start of each shard, followed by the size of the input */
+	std::vector<uint64_t> bounds;
+
+	/** @brief Number of values converted */
+	size_t nvalues;
+
+	/** @brief Description of the failure */
+	std::string errmsg;
+
+
+	/**
+	 * @brief Divide the input into shards ending at line boundaries.
+	 * @param fd Input file.
+	 * @param size Size of the input.
+	 * @post bounds set.
+	 * @return Boolean value indicating success.
+	 */
+	bool Divide(int fd, uint64_t size);
+
+
+	/**
+	 * @brief Hand out shards and offsets until every shard is written.
+	 * @param socks Socket of each worker.
+	 * @param outsize Reference to contain the size of the output.
+	 * @return Boolean value indicating success.
+	 */
+	bool Coordinate(const std::vector<int> &socks, uint64_t &outsize);
+
+
+	/**
+	 * @brief Worker process.  Does not return.
+	 * @param sock Socket to the coordinator.
+	 * @param fdin Input file.
+	 * @param fdout Output file.
+	 * @return None.
+	 */
+	void Worker(int sock, int fdin, int fdout);
+
+
+	/**
+	 * @brief Send a message.
+	 * @return Boolean value indicating success.
+	 */
+	static bool Send(int sock, uint64_t type, uint64_t shard, uint64_t a, uint64_t b);
+
+
+	/**
+	 * @brief Receive a message.
+	 * @return Boolean value indicating success (false at end of stream).
+	 */
+	static bool Receive(int sock, Message &msg);
+
+};
+
+
+
+// ==== PUBLIC FUNCTIONS =======================================================
+
+UnitShard::UnitShard(UnitStream &conv) : stream(conv), nworkers(0),
+		shardsize(SHARD_MAX_SIZE), nvalues(0)
+{
+}
+
+
+void UnitShard::SetWorkers(int n)
+{
+	nworkers = n;
+}
+
+
+void UnitShard::SetShardSize(size_t bytes)
+{
+	shardsize = std::max(bytes,(size_t)1);
+}
+
+
+bool UnitShard::Run(const std::string &filein, const std::string &fileout)
+{
+	errmsg = "";
+	nvalues = 0;
+	bounds.clear();
+
+
+	/*
+	 * OPEN FILES.  THE INPUT MUST BE A REGULAR, UNCOMPRESSED FILE SO THAT IT
+	 * CAN BE READ AT ANY OFFSET.
+	 */
+	int fdin = open(filein.c_str(),O_RDONLY);
+	struct stat st;
+	if(fdin < 0 || fstat(fdin,&st) != 0 || !S_ISREG(st.st_mode)){
+		errmsg = "cannot open " + filein + " as a regular file";
+		if(fdin >= 0){ close(fdin); }
+		return false;
+	}
+	unsigned char magic[4] = {0,0,0,0};
+	ssize_t nmagic = pread(fdin,magic,sizeof(magic),0);
+	if((nmagic >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) ||
+			(nmagic >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)){
+		errmsg = "compressed input cannot be sharded";
+		close(fdin);
+		return false;
+	}
+	if(UnitStream::CodecFromName(fileout) != STREAM_PLAIN){
+		errmsg = "compressed output cannot be sharded";
+		close(fdin);
+		return false;
+	}
+	int fdout = open(fileout.c_str(),O_WRONLY | O_CREAT | O_TRUNC,0644);
+	if(fdout < 0){
+		errmsg = "cannot create " + fileout;
+		close(fdin);
+		return false;
+	}
+
+	if(!Divide(fdin,(uint64_t)st.st_size)){
+		errmsg = "cannot read " + filein;
+		close(fdin);
+		close(fdout);
+		return false;
+	}
+
+
+	/*
+	 * START THE WORKERS.  NO MORE WORKERS THAN SHARDS ARE NEEDED.
+	 */
+	size_t nshards = bounds.size() - 1;
+	int nwork = nworkers;
+	if(nwork < 1){
+		nwork = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	nwork = (int)std::max((size_t)1,std::min((size_t)nwork,nshards));
+
+	std::vector<int> socks;
+	std::vector<pid_t> pids;
+	bool ok = (nshards == 0);
+	for(int i=0; i<nwork && nshards > 0; i++){
+		int sv[2];
+		if(socketpair(AF_UNIX,SOCK_STREAM | SOCK_CLOEXEC,0,sv) != 0){
+			errmsg = "cannot create socket";
+			break;
+		}
+		pid_t pid = fork();
+		if(pid == 0){
+			close(sv[0]);
+			for(size_t k=0; k<socks.size(); k++){
+				close(socks[k]);
+			}
+			Worker(sv[1],fdin,fdout);
+		}
+		close(sv[1]);
+		if(pid < 0){
+			close(sv[0]);
+			errmsg = "cannot start worker";
+			break;
+		}
+		socks.push_back(sv[0]);
+		pids.push_back(pid);
+	}
+
+
+	/*
+	 * COORDINATE, THEN STOP AND COLLECT THE WORKERS.  ON FAILURE, WORKERS
+	 * WHICH DO NOT RESPOND ARE KILLED.
+	 */
+	uint64_t outsize = 0;
+	if(errmsg.empty() && nshards > 0){
+		ok = Coordinate(socks,outsize);
+	}
+	for(size_t i=0; i<socks.size(); i++){
+		if(!ok){
+			kill(pids[i],SIGTERM);
+		} else {
+			Send(socks[i],SHARD_STOP,0,0,0);
+		}
+		close(socks[i]);
+	}
+	for(size_t i=0; i<pids.size(); i++){
+		int status = 0;
+		while(waitpid(pids[i],&status,0) < 0 && errno == EINTR){}
+		if(ok && !(WIFEXITED(status) && WEXITSTATUS(status) == 0)){
+			errmsg = "worker failed";
+			ok = false;
+		}
+	}
+
+	if(ok && ftruncate(fdout,(off_t)outsize) != 0){
+		errmsg = "cannot write " + fileout;
+		ok = false;
+	}
+	close(fdin);
+	if(close(fdout) != 0 && ok){
+		errmsg = "cannot write " + fileout;
+		ok = false;
+	}
+	return ok;
+}
+
+
+std::string UnitShard::Error() const
+{
+	return errmsg;
+}
+
+
+size_t UnitShard::NumValues() const
+{
+	return nvalues;
+}
+
+
+size_t UnitShard::NumShards() const
+{
+	return bounds.empty() ? 0 : bounds.size() - 1;
+}
+
+
+
+// ==== PROTECTED FUNCTIONS ====================================================
+
+bool UnitShard::Divide(int fd, uint64_t size)
+{
+	int nwork = nworkers < 1 ? (int)sysconf(_SC_NPROCESSORS_ONLN) : nworkers;
+	nwork = std::max(nwork,1);
+	size_t minsize = std::min(shardsize,(size_t)SHARD_MIN_SIZE);
+
+	char buf[65536];
+	uint64_t start = 0;
+	while(start < size){
+		bounds.push_back(start);
+
+
+		/*
+		 * EACH SHARD IS AT MOST HALF OF WHAT REMAINS PER WORKER, SO SHARDS
+		 * SHRINK TOWARDS THE END OF THE INPUT
+		 */
+		uint64_t remain = size - start;
+		uint64_t len = std::min((uint64_t)shardsize,remain/(2*(uint64_t)nwork));
+		len = std::max(len,(uint64_t)minsize);
+		if(len >= remain){
+			break;
+		}
+
+
+		/*
+		 * MOVE THE END FORWARD TO JUST AFTER THE NEXT NEWLINE
+		 */
+		uint64_t end = start + len;
+		bool found = false;
+		while(!found && end < size){
+			ssize_t n = pread(fd,buf,sizeof(buf),(off_t)end);
+			if(n <= 0){
+				return false;
+			}
+			const char *nl = (const char*)std::memchr(buf,'\n',(size_t)n);
+			if(nl){
+				end += (uint64_t)(nl - buf) + 1;
+				found = true;
+			} else {
+				end += (uint64_t)n;
+			}
+		}
+		start = end;
+	}
+	bounds.push_back(size);
+	return true;
+}
+
+
+bool UnitShard::Coordinate(const std::vector<int> &socks, uint64_t &outsize)
+{
+	size_t nshards = bounds.size() - 1;
+	std::vector<int64_t> outlen(nshards,-1);
+	std::vector<int> owner(nshards,-1);
+	size_t next = 0;
+	size_t frontier = 0;
+	size_t nwritten = 0;
+	outsize = 0;
+
+	std::vector<struct pollfd> fds(socks.size());
+	for(size_t i=0; i<socks.size(); i++){
+		fds[i].fd = socks[i];
+		fds[i].events = POLLIN;
+	}
+
+	while(nwritten < nshards){
+		if(poll(fds.data(),fds.size(),-1) < 0){
+			if(errno == EINTR){
+				continue;
+			}
+			errmsg = "cannot wait for workers";
+			return false;
+		}
+
+		for(size_t w=0; w<fds.size(); w++){
+			if(!(fds[w].revents & (POLLIN | POLLHUP | POLLERR))){
+				continue;
+			}
+			Message msg;
+			if(!Receive(socks[w],msg)){
+				errmsg = "worker exited unexpectedly";
+				return false;
+			}
+
+			switch(msg.type){
+			case SHARD_READY:
+				if(next < nshards){
+					owner[next] = (int)w;
+					Send(socks[w],SHARD_WORK,next,bounds[next],bounds[next+1] - bounds[next]);
+					next++;
+				}
+				break;
+			case SHARD_DONE:
+				if(msg.shard >= nshards){
+					errmsg = "invalid message from worker";
+					return false;
+				}
+				outlen[msg.shard] = (int64_t)msg.a;
+				nvalues += (size_t)msg.b;
+
+
+				/*
+				 * EVERY SHARD WHOSE PREDECESSORS ARE ALL CONVERTED CAN BE
+				 * PLACED IN THE OUTPUT
+				 */
+				while(frontier < nshards && outlen[frontier] >= 0){
+					Send(socks[owner[frontier]],SHARD_WRITE,frontier,outsize,0);
+					outsize += (uint64_t)outlen[frontier];
+					frontier++;
+				}
+				break;
+			case SHARD_WRITTEN:
+				nwritten++;
+				break;
+			default:
+				errmsg = "worker cannot read input or write output";
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+
+void UnitShard::Worker(int sock, int fdin, int fdout)
+{
+	std::map<uint64_t,std::vector<char> > pending;
+	std::vector<char> in;
+	bool requested = true;
+	int status = 0;
+	if(!Send(sock,SHARD_READY,0,0,0)){
+		_exit(1);
+	}
+
+	Message msg;
+	while(Receive(sock,msg)){
+		if(msg.type == SHARD_STOP){
+			break;
+		}
+
+		if(msg.type == SHARD_WORK){
+			/*
+			 * READ AND CONVERT THE SHARD, THEN HOLD THE RESULT UNTIL ITS
+			 * OFFSET IS KNOWN
+			 */
+			requested = false;
+			in.resize((size_t)msg.b);
+			size_t got = 0;
+			while(got < in.size()){
+				ssize_t n = pread(fdin,in.data() + got,in.size() - got,(off_t)(msg.a + got));
+				if(n < 0 && errno == EINTR){
+					continue;
+				}
+				if(n <= 0){
+					break;
+				}
+				got += (size_t)n;
+			}
+			if(got < in.size()){
+				Send(sock,SHARD_FAILED,msg.shard,0,0);
+				status = 1;
+				break;
+			}
+			std::vector<char> &out = pending[msg.shard];
+			size_t nconv = stream.ConvertLines(in,out);
+			Send(sock,SHARD_DONE,msg.shard,out.size(),nconv);
+		}
+
+		if(msg.type == SHARD_WRITE){
+			std::map<uint64_t,std::vector<char> >::iterator it = pending.find(msg.shard);
+			if(it == pending.end()){
+				Send(sock,SHARD_FAILED,msg.shard,0,0);
+				status = 1;
+				break;
+			}
+			const std::vector<char> &out = it->second;
+			size_t put = 0;
+			while(put < out.size()){
+				ssize_t n = pwrite(fdout,out.data() + put,out.size() - put,(off_t)(msg.a + put));
+				if(n < 0 && errno == EINTR){
+					continue;
+				}
+				if(n <= 0){
+					break;
+				}
+				put += (size_t)n;
+			}
+			if(put < out.size()){
+				Send(sock,SHARD_FAILED,msg.shard,0,0);
+				status = 1;
+				break;
+			}
+			pending.erase(it);
+			Send(sock,SHARD_WRITTEN,msg.shard,0,0);
+		}
+
+
+		/*
+		 * ASK FOR MORE WORK UNLESS ENOUGH CONVERTED SHARDS ARE WAITING
+		 */
+		if(!requested && pending.size() < SHARD_MAX_PENDING){
+			requested = Send(sock,SHARD_READY,0,0,0);
+		}
+	}
+	close(sock);
+	_exit(status);
+}
+
+
+bool UnitShard::Send(int sock, uint64_t type, uint64_t shard, uint64_t a, uint64_t b)
+{
+	Message msg;
+	msg.type = type;
+	msg.shard = shard;
+	msg.a = a;
+	msg.b = b;
+	const char *p = (const char*)&msg;
+	size_t sent = 0;
+	while(sent < sizeof(msg)){
+		ssize_t n = send(sock,p + sent,sizeof(msg) - sent,MSG_NOSIGNAL);
+		if(n < 0 && errno == EINTR){
+			continue;
+		}
+		if(n <= 0){
+			return false;
+		}
+		sent += (size_t)n;
+	}
+	return true;
+}
+
+
+bool UnitShard::Receive(int sock, Message &msg)
+{
+	char *p = (char*)&msg;
+	size_t got = 0;
+	while(got < sizeof(msg)){
+		ssize_t n = recv(sock,p + got,sizeof(msg) - got,0);
+		if(n < 0 && errno == EINTR){
+			continue;
+		}
+		if(n <= 0){
+			return false;
+		}
+		got += (size_t)n;
+	}
+	return true;
+}
+
+
+#endif /* UnitShard_ */
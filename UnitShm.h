@@ -0,0 +1,951 @@
+/**
+ * @file UnitShm.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Conversion service for processes on the same host, exchanging values
+ * through a POSIX shared-memory segment rather than a socket.  The server
+ * (UnitShmServer) creates the segment and owns a fixed set of plans, added
+ * with AddPlan() before the segment is created; a plan is identified by its
+ * position.  Clients (UnitShmClient) attach to the segment by name and look up
+ * plans with FindPlan(), which also finds a plan given another spelling of
+ * its units: the segment holds the canonical fingerprints (see CanonicalUnits)
+ * of each plan's units.
+ *
+ * The segment holds a ring of slots, each with room for a fixed number of
+ * values.  Any number of clients may submit batches and the server consumes
+ * them in order (a bounded multi-producer, single-consumer queue).  Each slot
+ * carries a 32-bit sequence word which moves through four states on lap
+ * 'pos' of the ring:
+ * 	-#	pos:		free; the client which claimed 'pos' may fill it,
+ * 	-#	pos + 1:	submitted; the server may convert it,
+ * 	-#	pos + 2:	converted in place; the client may read the results,
+ * 	-#	pos + slots:	released; free for the next lap.
+ * Clients claim positions with one atomic increment and write their values
+ * directly into the slot, and the server converts them there, so values are
+ * not copied between processes.
+ *
+ * Waiting first spins on the word, then sleeps on it with a futex; the party
+ * which changes a word wakes it only when someone is asleep, so a busy server
+ * and client exchange a batch without any system call.  With SetBusyPoll()
+ * the waiting side never sleeps, for the lowest latency at the cost of a
+ * processor.
+ *
+ * Values are doubles.  Batches larger than a slot are split by
+ * UnitShmClient::Convert(), which also copies values in and out for callers
+ * that do not fill the slots themselves.
+ *
+ * Link with -lrt on systems where shm_open() is not in the C library.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- The header holds the canonical fingerprints of each plan's units, and
+ *	  FindPlan() matches on them.  SHM_MAGIC changed with the layout.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitShm_
+#define UnitShm_
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <new>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <stdint.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "UnitCanonical.h"
+
+
+/** @brief Identifies a conversion segment and its layout */
+#define SHM_MAGIC 0x554E4302
+
+/** @brief Largest number of plans */
+#define SHM_MAX_PLANS 64
+
+/** @brief Longest unit string of a plan, including the terminating null */
+#define SHM_UNIT_CHARS 64
+
+/** @brief Spins before sleeping on a futex */
+#define SHM_SPIN_COUNT 4096
+
+/** @brief Longest sleep, in nanoseconds, before checking for a stopped server */
+#define SHM_SLEEP_NS 100000000
+
+
+/**
+ * @brief Layout of the shared-memory segment.
+ */
+struct UnitShmLayout {
+
+	/**
+	 * @brief Segment header.
+	 */
+	struct Header {
+		uint32_t magic;
+		uint32_t slots;						/**< power of two */
+		uint32_t slotvalues;
+		uint32_t nplans;
+		char units[SHM_MAX_PLANS][2][SHM_UNIT_CHARS];
+		uint64_t fingerprints[SHM_MAX_PLANS][2];	/**< 0 if not canonical */
+		alignas(64) std::atomic<uint32_t> tail;		/**< next position to claim */
+		alignas(64) std::atomic<uint32_t> doorbell;	/**< bumped on each submission */
+		std::atomic<uint32_t> sleeping;		/**< server asleep on 'doorbell' */
+		std::atomic<uint32_t> stop;
+	};
+
+	/**
+	 * @brief Ring slot.  Its values follow all slots in the segment.
+	 */
+	struct Slot {
+		alignas(64) std::atomic<uint32_t> seq;
+		std::atomic<uint32_t> waiting;		/**< clients asleep on 'seq' */
+		uint32_t plan;
+		uint32_t count;
+		uint32_t nerrors;					/**< non-finite results */
+		uint32_t status;					/**< 0, or 1 for an invalid batch */
+	};
+
+
+	/**
+	 * @brief Size of a segment.
+	 * @return Size in bytes.
+	 */
+	static size_t Size(uint32_t slots, uint32_t slotvalues)
+	{
+		return sizeof(Header) + slots*sizeof(Slot) + (size_t)slots*slotvalues*sizeof(double);
+	}
+
+
+	/**
+	 * @brief Slot of a position.
+	 * @return Pointer to the slot.
+	 */
+	static Slot* SlotAt(Header *hdr, uint32_t pos)
+	{
+		Slot *first = reinterpret_cast<Slot*>(hdr + 1);
+		return first + (pos & (hdr->slots - 1));
+	}
+
+
+	/**
+	 * @brief Values of the slot of a position.
+	 * @return Pointer to the first value.
+	 */
+	static double* ValuesAt(Header *hdr, uint32_t pos)
+	{
+		Slot *first = reinterpret_cast<Slot*>(hdr + 1);
+		double *values = reinterpret_cast<double*>(first + hdr->slots);
+		return values + (size_t)(pos & (hdr->slots - 1))*hdr->slotvalues;
+	}
+
+
+	/**
+	 * @brief Sleep while a word holds a value, for at most SHM_SLEEP_NS.
+	 */
+	static void Sleep(std::atomic<uint32_t> &word, uint32_t val)
+	{
+		struct timespec ts;
+		ts.tv_sec = 0;
+		ts.tv_nsec = SHM_SLEEP_NS;
+		syscall(SYS_futex,reinterpret_cast<uint32_t*>(&word),FUTEX_WAIT,val,&ts,0,0);
+	}
+
+
+	/**
+	 * @brief Wake all processes asleep on a word.
+	 */
+	static void Wake(std::atomic<uint32_t> &word)
+	{
+		syscall(SYS_futex,reinterpret_cast<uint32_t*>(&word),FUTEX_WAKE,INT_MAX,0,0,0);
+	}
+
+
+	/**
+	 * @brief Hint to the processor that this is a spin loop.
+	 */
+	static void Pause()
+	{
+#ifdef __SSE2__
+		_mm_pause();
+#endif
+	}
+
+};
+
+
+
+/**
+ * @brief Process serving conversions through a shared-memory segment.
+ */
+class UnitShmServer {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre Registry exists and outlives this object.
+	 * @param reg Registry used to build the plans.
+	 * @post UnitShmServer object exists, without plans or segment.
+	 * @return None.
+	 */
+	UnitShmServer(const UnitRegistry &reg);
+
+
+	/**
+	 * @brief Destructor.  Removes the segment.
+	 * @pre UnitShmServer object exists.
+	 * @post Segment unmapped and unlinked.
+	 * @return None.
+	 */
+	~UnitShmServer();
+
+
+	/**
+	 * @brief Add a plan.  Must be called before Create().
+	 * @pre UnitShmServer object exists.
+	 * @param unitsin Input unit string.
+	 * @param unitsout Output unit string.
+	 * @post Plan added if valid; its ID is the number of plans added before it.
+	 * @return UNIT_OK or the reason the conversion is invalid
+	 * 			(UNIT_ERR_TOO_MANY_TERMS if there are SHM_MAX_PLANS plans or a
+	 * 			unit string is too long).
+	 */
+	UnitErrorCode AddPlan(const std::string &unitsin, const std::string &unitsout);
+
+
+	/**
+	 * @brief Select whether the server spins rather than sleeps while idle.
+	 * @pre UnitShmServer object exists.
+	 * @param busy Boolean value indicating whether to busy-poll.
+	 * @post Setting changed.
+	 * @return None.
+	 */
+	void SetBusyPoll(bool busy);
+
+
+	/**
+	 * @brief Create the segment.
+	 * @pre UnitShmServer object exists and no segment of this name is in use.
+	 * @param name Segment name (e.g. "/unitconvert").
+	 * @param slots Number of slots, rounded up to a power of two (at least 4).
+	 * @param slotvalues Values per slot.
+	 * @post Segment created and initialized.
+	 * @return Boolean value indicating success or failure.  See Error().
+	 */
+	bool Create(const std::string &name, uint32_t slots, uint32_t slotvalues);
+
+
+	/**
+	 * @brief Serve batches until Stop() is called.
+	 * @pre Segment created.
+	 * @post Submitted batches converted.
+	 * @return Boolean value indicating success or failure.  See Error().
+	 */
+	bool Run();
+
+
+	/**
+	 * @brief Stop the server and wake all waiting processes.  May be called
+	 * 			from a signal handler.
+	 * @pre UnitShmServer object exists.
+	 * @post Run() returns after the batch in progress.
+	 * @return None.
+	 */
+	void Stop();
+
+
+	/**
+	 * @brief Description of the last failure.
+	 * @pre UnitShmServer object exists.
+	 * @post No changes to object.
+	 * @return Error message, or an empty string.
+	 */
+	std::string Error() const;
+
+
+	/**
+	 * @brief Number of batches converted.
+	 * @pre UnitShmServer object exists.
+	 * @post No changes to object.
+	 * @return Number of batches.
+	 */
+	size_t NumBatches() const;
+
+
+
+protected:
+	/** @brief Registry used to build the plans */
+	const UnitRegistry &registry;
+
+	/** @brief Plans, by ID, and their unit strings */
+	std::vector< UnitPlan<double> > plans;
+	std::vector<std::string> unitsin;
+	std::vector<std::string> unitsout;
+
+	/** @brief Canonical fingerprints of the unit strings of each plan */
+	std::vector<uint64_t> fingerprintsin;
+	std::vector<uint64_t> fingerprintsout;
+
+	/** @brief Segment name, and the mapped segment */
+	std::string shmname;
+	UnitShmLayout::Header *header;
+	size_t shmsize;
+
+	/** @brief Spin rather than sleep while idle */
+	bool busypoll;
+
+	/** @brief Stop requested before the segment was created */
+	volatile bool stopped;
+
+	/** @brief Batches converted */
+	size_t nbatches;
+
+	/** @brief Error message */
+	std::string errmsg;
+
+};
+
+
+
+/**
+ * @brief Process submitting batches to a UnitShmServer.
+ */
+class UnitShmClient {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre None.
+	 * @post UnitShmClient object exists, not attached.
+	 * @return None.
+	 */
+	UnitShmClient();
+
+
+	/**
+	 * @brief Destructor.
+	 * @pre UnitShmClient object exists.
+	 * @post Segment unmapped.
+	 * @return None.
+	 */
+	~UnitShmClient();
+
+
+	/**
+	 * @brief Attach to a server's segment.
+	 * @pre UnitShmClient object exists.
+	 * @param name Segment name given to UnitShmServer::Create().
+	 * @post Attached if the segment exists.
+	 * @return Boolean value indicating success or failure.  See Error().
+	 */
+	bool Open(const std::string &name);
+
+
+	/**
+	 * @brief Select whether waits spin rather than sleep.
+	 * @pre UnitShmClient object exists.
+	 * @param busy Boolean value indicating whether to busy-poll.
+	 * @post Setting changed.
+	 * @return None.
+	 */
+	void SetBusyPoll(bool busy);
+
+
+	/**
+	 * @brief Find the ID of a plan.  Unit strings are canonicalized with the
+	 * 			built-in units; those using site units match only as given
+	 * 			to UnitShmServer::AddPlan().
+	 * @pre Attached.
+	 * @param unitsin Input unit string.
+	 * @param unitsout Output unit string.
+	 * @post No changes to object.
+	 * @return Plan ID, or -1 if the server has no such plan.
+	 */
+	int FindPlan(const std::string &unitsin, const std::string &unitsout) const;
+
+
+	/**
+	 * @brief Find the ID of a plan, canonicalizing the unit strings with a
+	 * 			registry.
+	 * @pre Attached.
+	 * @param reg Registry of the units, normally the server's.
+	 * @param unitsin Input unit string.
+	 * @param unitsout Output unit string.
+	 * @post No changes to object.
+	 * @return Plan ID of the first plan whose unit strings are the same as,
+	 * 			or equivalent to, these, or -1 if the server has no such plan.
+	 */
+	int FindPlan(const UnitRegistry &reg, const std::string &unitsin,
+			const std::string &unitsout) const;
+
+
+	/**
+	 * @brief Number of values a slot holds.
+	 * @pre Attached.
+	 * @post No changes to object.
+	 * @return Number of values.
+	 */
+	size_t SlotValues() const;
+
+
+	/**
+	 * @brief Claim a slot, waiting while the ring is full.
+	 * @pre Attached.
+	 * @param ticket Reference to contain the position of the slot.
+	 * @post Slot claimed unless the server stopped.  A claimed slot must be
+	 * 			submitted.
+	 * @return Pointer to the values of the slot, or 0 if the server stopped.
+	 */
+	double* Acquire(uint32_t &ticket);
+
+
+	/**
+	 * @brief Submit a claimed slot for conversion.
+	 * @pre Slot claimed by Acquire() and its first 'count' values filled.
+	 * @param ticket Position of the slot.
+	 * @param plan Plan ID.
+	 * @param count Number of values, at most SlotValues().
+	 * @post Slot submitted.
+	 * @return None.
+	 */
+	void Submit(uint32_t ticket, int plan, size_t count);
+
+
+	/**
+	 * @brief Wait until a submitted slot is converted.
+	 * @pre Slot submitted.
+	 * @param ticket Position of the slot.
+	 * @post Values of the slot converted in place.  The slot must be released.
+	 * @return Number of non-finite results, or -1 if the plan or count was
+	 * 			invalid or the server stopped.
+	 */
+	long Wait(uint32_t ticket);
+
+
+	/**
+	 * @brief Release a converted slot.
+	 * @pre Wait() returned for this slot.
+	 * @param ticket Position of the slot.
+	 * @post Slot free for reuse; its values must no longer be accessed.
+	 * @return None.
+	 */
+	void Release(uint32_t ticket);
+
+
+	/**
+	 * @brief Convert an array through the server, copying it in and out of
+	 * 			the slots.
+	 * @pre Attached.
+	 * @param plan Plan ID.
+	 * @param in Pointer to the values.
+	 * @param out Pointer to the array to contain the converted values.  May be
+	 * 			the same as 'in'.
+	 * @param n Number of values.
+	 * @post 'out' filled.
+	 * @return Number of non-finite results, or -1 on failure.
+	 */
+	long Convert(int plan, const double *in, double *out, size_t n);
+
+
+	/**
+	 * @brief Description of the last failure.
+	 * @pre UnitShmClient object exists.
+	 * @post No changes to object.
+	 * @return Error message, or an empty string.
+	 */
+	std::string Error() const;
+
+
+
+protected:
+	/** @brief Mapped segment */
+	UnitShmLayout::Header *header;
+	size_t shmsize;
+
+	/** @brief Spin rather than sleep while waiting */
+	bool busypoll;
+
+	/** @brief Error message */
+	std::string errmsg;
+
+
+	/**
+	 * @brief Wait until the sequence word of a slot reaches a value.
+	 * @return Boolean value indicating whether it did before the server
+	 * 			stopped.
+	 */
+	bool WaitFor(UnitShmLayout::Slot *slot, uint32_t want);
+
+};
+
+
+
+// ==== PUBLIC FUNCTIONS =======================================================
+
+UnitShmServer::UnitShmServer(const UnitRegistry &reg) : registry(reg), header(0),
+		shmsize(0), busypoll(false), stopped(false), nbatches(0)
+{
+}
+
+
+UnitShmServer::~UnitShmServer()
+{
+	if(header){
+		munmap(header,shmsize);
+		shm_unlink(shmname.c_str());
+	}
+}
+
+
+UnitErrorCode UnitShmServer::AddPlan(const std::string &in, const std::string &out)
+{
+	if(plans.size() >= SHM_MAX_PLANS || in.size() >= SHM_UNIT_CHARS ||
+			out.size() >= SHM_UNIT_CHARS){
+		return UNIT_ERR_TOO_MANY_TERMS;
+	}
+	UnitResult< UnitPlan<double> > result = UnitPlan<double>::Create(registry,in,out);
+	if(!result.Ok()){
+		return result.Error();
+	}
+	plans.push_back(result.Value());
+	unitsin.push_back(in);
+	unitsout.push_back(out);
+	CanonicalUnits canonical;
+	fingerprintsin.push_back(canonical.Canonicalize(registry,in) == UNIT_OK ?
+			canonical.Fingerprint() : 0);
+	fingerprintsout.push_back(canonical.Canonicalize(registry,out) == UNIT_OK ?
+			canonical.Fingerprint() : 0);
+	return UNIT_OK;
+}
+
+
+void UnitShmServer::SetBusyPoll(bool busy)
+{
+	busypoll = busy;
+}
+
+
+bool UnitShmServer::Create(const std::string &name, uint32_t slots, uint32_t slotvalues)
+{
+	errmsg = "";
+	uint32_t n = 4;
+	while(n < slots && n < 0x80000000u){
+		n *= 2;
+	}
+	if(slotvalues == 0){
+		errmsg = "slots must hold at least one value";
+		return false;
+	}
+
+	int fd = shm_open(name.c_str(),O_CREAT | O_EXCL | O_RDWR,0600);
+	if(fd < 0){
+		errmsg = "cannot create shared memory " + name + ": " + strerror(errno);
+		return false;
+	}
+	size_t size = UnitShmLayout::Size(n,slotvalues);
+	if(ftruncate(fd,(off_t)size) != 0){
+		errmsg = "cannot size shared memory " + name + ": " + strerror(errno);
+		close(fd);
+		shm_unlink(name.c_str());
+		return false;
+	}
+	void *addr = mmap(0,size,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+	close(fd);
+	if(addr == MAP_FAILED){
+		errmsg = "cannot map shared memory " + name + ": " + strerror(errno);
+		shm_unlink(name.c_str());
+		return false;
+	}
+
+
+	/*
+	 * INITIALIZE THE HEADER AND SLOTS.  THE MAGIC NUMBER IS WRITTEN LAST SO
+	 * THAT CLIENTS NEVER SEE A PARTLY INITIALIZED SEGMENT.
+	 */
+	header = new(addr) UnitShmLayout::Header;
+	shmname = name;
+	shmsize = size;
+	header->slots = n;
+	header->slotvalues = slotvalues;
+	header->nplans = (uint32_t)plans.size();
+	std::memset(header->units,0,sizeof(header->units));
+	for(size_t i=0; i<plans.size(); i++){
+		std::memcpy(header->units[i][0],unitsin[i].c_str(),unitsin[i].size());
+		std::memcpy(header->units[i][1],unitsout[i].c_str(),unitsout[i].size());
+		header->fingerprints[i][0] = fingerprintsin[i];
+		header->fingerprints[i][1] = fingerprintsout[i];
+	}
+	header->tail.store(0);
+	header->doorbell.store(0);
+	header->sleeping.store(0);
+	header->stop.store(stopped ? 1 : 0);
+	for(uint32_t i=0; i<n; i++){
+		UnitShmLayout::Slot *slot = new(UnitShmLayout::SlotAt(header,i)) UnitShmLayout::Slot;
+		slot->seq.store(i);
+		slot->waiting.store(0);
+	}
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	header->magic = SHM_MAGIC;
+	return true;
+}
+
+
+bool UnitShmServer::Run()
+{
+	if(!header){
+		errmsg = "shared memory not created";
+		return false;
+	}
+
+	UnitErrorBitmap errors;
+	uint32_t head = 0;
+	while(header->stop.load() == 0){
+		UnitShmLayout::Slot *slot = UnitShmLayout::SlotAt(header,head);
+		uint32_t want = head + 1;
+
+
+		/*
+		 * WAIT FOR THE NEXT BATCH: SPIN, THEN SLEEP ON THE DOORBELL.  THE
+		 * SLEEPING FLAG IS SET BEFORE THE SLOT IS CHECKED AGAIN, AND CLIENTS
+		 * BUMP THE DOORBELL BEFORE READING THE FLAG, SO NO WAKE-UP IS LOST.
+		 */
+		bool ready = false;
+		for(int i=0; i<SHM_SPIN_COUNT || busypoll; i++){
+			if(slot->seq.load(std::memory_order_acquire) == want){
+				ready = true;
+				break;
+			}
+			if(busypoll && header->stop.load(std::memory_order_relaxed)){
+				break;
+			}
+			UnitShmLayout::Pause();
+		}
+		if(!ready){
+			header->sleeping.store(1);
+			uint32_t bell = header->doorbell.load();
+			if(slot->seq.load() != want && header->stop.load() == 0){
+				UnitShmLayout::Sleep(header->doorbell,bell);
+			}
+			header->sleeping.store(0);
+			continue;
+		}
+
+
+		/*
+		 * CONVERT IN PLACE AND HAND THE SLOT BACK
+		 */
+		if(slot->plan < plans.size() && slot->count <= header->slotvalues){
+			double *values = UnitShmLayout::ValuesAt(header,head);
+			slot->nerrors = (uint32_t)plans[slot->plan].Convert(values,values,slot->count,errors);
+			slot->status = 0;
+		} else {
+			slot->nerrors = 0;
+			slot->status = 1;
+		}
+		slot->seq.store(head + 2);
+		if(slot->waiting.load() > 0){
+			UnitShmLayout::Wake(slot->seq);
+		}
+		head++;
+		nbatches++;
+	}
+	return true;
+}
+
+
+void UnitShmServer::Stop()
+{
+	stopped = true;
+	if(header){
+		header->stop.store(1);
+		UnitShmLayout::Wake(header->doorbell);
+		for(uint32_t i=0; i<header->slots; i++){
+			UnitShmLayout::Wake(UnitShmLayout::SlotAt(header,i)->seq);
+		}
+	}
+}
+
+
+std::string UnitShmServer::Error() const
+{
+	return errmsg;
+}
+
+
+size_t UnitShmServer::NumBatches() const
+{
+	return nbatches;
+}
+
+
+
+UnitShmClient::UnitShmClient() : header(0), shmsize(0), busypoll(false)
+{
+}
+
+
+UnitShmClient::~UnitShmClient()
+{
+	if(header){
+		munmap(header,shmsize);
+	}
+}
+
+
+bool UnitShmClient::Open(const std::string &name)
+{
+	errmsg = "";
+	if(header){
+		munmap(header,shmsize);
+		header = 0;
+	}
+
+	int fd = shm_open(name.c_str(),O_RDWR,0);
+	if(fd < 0){
+		errmsg = "cannot open shared memory " + name + ": " + strerror(errno);
+		return false;
+	}
+	struct stat st;
+	if(fstat(fd,&st) != 0 || (size_t)st.st_size < sizeof(UnitShmLayout::Header)){
+		errmsg = "shared memory " + name + " is not a conversion segment";
+		close(fd);
+		return false;
+	}
+	void *addr = mmap(0,st.st_size,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+	close(fd);
+	if(addr == MAP_FAILED){
+		errmsg = "cannot map shared memory " + name + ": " + strerror(errno);
+		return false;
+	}
+
+	UnitShmLayout::Header *hdr = static_cast<UnitShmLayout::Header*>(addr);
+	if(hdr->magic != SHM_MAGIC ||
+			UnitShmLayout::Size(hdr->slots,hdr->slotvalues) != (size_t)st.st_size){
+		errmsg = "shared memory " + name + " is not a conversion segment";
+		munmap(addr,st.st_size);
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	header = hdr;
+	shmsize = st.st_size;
+	return true;
+}
+
+
+void UnitShmClient::SetBusyPoll(bool busy)
+{
+	busypoll = busy;
+}
+
+
+int UnitShmClient::FindPlan(const std::string &unitsin, const std::string &unitsout) const
+{
+	static const UnitRegistry builtin;
+	return FindPlan(builtin,unitsin,unitsout);
+}
+
+
+int UnitShmClient::FindPlan(const UnitRegistry &reg, const std::string &unitsin,
+		const std::string &unitsout) const
+{
+	/*
+	 * A FINGERPRINT OF 0 MARKS UNITS WHICH COULD NOT BE CANONICALIZED; THOSE
+	 * MATCH ONLY BY THEIR TEXT.
+	 */
+	CanonicalUnits canonical;
+	uint64_t fpin = (canonical.Canonicalize(reg,unitsin) == UNIT_OK) ?
+			canonical.Fingerprint() : 0;
+	uint64_t fpout = (canonical.Canonicalize(reg,unitsout) == UNIT_OK) ?
+			canonical.Fingerprint() : 0;
+	for(uint32_t i=0; i<header->nplans; i++){
+		if(unitsin == header->units[i][0] && unitsout == header->units[i][1]){
+			return (int)i;
+		}
+		if(fpin != 0 && fpout != 0 && fpin == header->fingerprints[i][0] &&
+				fpout == header->fingerprints[i][1]){
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+
+size_t UnitShmClient::SlotValues() const
+{
+	return header->slotvalues;
+}
+
+
+double* UnitShmClient::Acquire(uint32_t &ticket)
+{
+	ticket = header->tail.fetch_add(1);
+	if(!WaitFor(UnitShmLayout::SlotAt(header,ticket),ticket)){
+		return 0;
+	}
+	return UnitShmLayout::ValuesAt(header,ticket);
+}
+
+
+void UnitShmClient::Submit(uint32_t ticket, int plan, size_t count)
+{
+	UnitShmLayout::Slot *slot = UnitShmLayout::SlotAt(header,ticket);
+	slot->plan = (uint32_t)plan;
+	slot->count = (count > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)count);
+	slot->seq.store(ticket + 1);
+	header->doorbell.fetch_add(1);
+	if(header->sleeping.load() != 0){
+		UnitShmLayout::Wake(header->doorbell);
+	}
+}
+
+
+long UnitShmClient::Wait(uint32_t ticket)
+{
+	UnitShmLayout::Slot *slot = UnitShmLayout::SlotAt(header,ticket);
+	if(!WaitFor(slot,ticket + 2)){
+		errmsg = "server stopped";
+		return -1;
+	}
+	if(slot->status != 0){
+		errmsg = "invalid plan or count";
+		return -1;
+	}
+	return slot->nerrors;
+}
+
+
+void UnitShmClient::Release(uint32_t ticket)
+{
+	UnitShmLayout::Slot *slot = UnitShmLayout::SlotAt(header,ticket);
+	slot->seq.store(ticket + header->slots);
+	if(slot->waiting.load() > 0){
+		UnitShmLayout::Wake(slot->seq);
+	}
+}
+
+
+long UnitShmClient::Convert(int plan, const double *in, double *out, size_t n)
+{
+	long nerrors = 0;
+	size_t per = header->slotvalues;
+	for(size_t first=0; first<n; first+=per){
+		size_t count = (n - first < per ? n - first : per);
+		uint32_t ticket;
+		double *values = Acquire(ticket);
+		if(!values){
+			errmsg = "server stopped";
+			return -1;
+		}
+		std::memcpy(values,in + first,count*sizeof(double));
+		Submit(ticket,plan,count);
+		long err = Wait(ticket);
+		if(err >= 0){
+			std::memcpy(out + first,values,count*sizeof(double));
+		}
+		Release(ticket);
+		if(err < 0){
+			return -1;
+		}
+		nerrors += err;
+	}
+	return nerrors;
+}
+
+
+std::string UnitShmClient::Error() const
+{
+	return errmsg;
+}
+
+
+
+// ==== PROTECTED FUNCTIONS ====================================================
+
+bool UnitShmClient::WaitFor(UnitShmLayout::Slot *slot, uint32_t want)
+{
+	for(int i=0; i<SHM_SPIN_COUNT || busypoll; i++){
+		if(slot->seq.load(std::memory_order_acquire) == want){
+			return true;
+		}
+		if(header->stop.load(std::memory_order_relaxed)){
+			return false;
+		}
+		UnitShmLayout::Pause();
+	}
+
+
+	/*
+	 * SLEEP ON THE SEQUENCE WORD.  THE WAITING COUNT IS RAISED BEFORE THE
+	 * WORD IS CHECKED AGAIN, SO THE PROCESS CHANGING IT SEES THE COUNT.
+	 */
+	slot->waiting.fetch_add(1);
+	bool ok = true;
+	for(;;){
+		uint32_t seq = slot->seq.load();
+		if(seq == want){
+			break;
+		}
+		if(header->stop.load()){
+			ok = false;
+			break;
+		}
+		UnitShmLayout::Sleep(slot->seq,seq);
+	}
+	slot->waiting.fetch_sub(1);
+	return ok;
+}
+
+
+#endif /* UnitShm_ */
@@ -0,0 +1,584 @@
+/**
+ * @file UnitSnapshots.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Site units loaded at run time, and a registry which can be replaced while
+ * other threads are converting with it.
+ *
+ * LoadUnitDefinitions() adds units from a text file to a registry.  Each line
+ * defines one unit in terms of units already known, or an alias:
+ *
+ * 		# symbol | description | category | factor unit_string [| offset]
+ * 		tank7 | tank 7 (strapped) | Volume | 1234.5 -:bbl:1
+ * 		kscfd | thousand std cubic feet per day | Flow | 1000 -:ft:3|-:day:-1
+ * 		gpm = -:gal:1|-:min:-1
+ * 		bbls = bbl
+ *
+ * A line "symbol = unit_string" defines a unit with factor 1, described by
+ * the unit string and listed in the "Site" category; "alias = symbol" where
+ * the right-hand side is a known symbol adds an alias.  The optional offset is in
+ * the coherent SI unit.  New units may not be defined in terms of logarithmic
+ * or non-linear units, though aliases of them are allowed.  Blank lines and lines beginning with '#' are
+ * ignored.  A symbol already defined is replaced.  Units defined after the
+ * built-in set are listed by UnitRegistry::PrintUnits(NumBuiltinUnits()).
+ *
+ * UnitSnapshots holds the current registry.  Readers take a Reader guard,
+ * convert with Reader::Registry(), and drop the guard; a registry seen
+ * through a guard stays valid and unchanged for the life of the guard.
+ * Load() builds a new registry from the built-in units and a definitions
+ * file, publishes it with one atomic store, and frees the previous registry
+ * once every reader which might hold it has dropped its guard.
+ * LoadAsync() does the same on a background thread.
+ *
+ * Readers never wait.  A guard costs two uncontended atomic increments: each
+ * thread counts itself in one of SNAPSHOT_SLOTS per-thread counters, in one
+ * of two phases (sleepable read-copy-update).  Publishing a registry flips
+ * the phase; the writer then waits only for readers of the old phase, which
+ * are the only ones that can hold the old registry.  Readers which arrive
+ * during a reload see the new registry at once.
+ *
+ * The registry of a guard is const, so units may not be interned in it;
+ * intern units in a registry owned by the caller.
+ *
+ * The site units file is named by the environment variable UNITCONVERT_UNITS
+ * (SiteUnitsFile()).  "UnitConvert stream --follow" reloads it on SIGHUP and
+ * the GUI from File->Reload Site Units, each through a UnitSnapshots object.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- Definitions in terms of logarithmic units are rejected.
+ *
+ * @date 18 October 2026
+ *	- Definitions in terms of non-linear units are rejected.
+ *
+ * @date 18 October 2026
+ *	- Added SiteUnitsFile().
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitSnapshots_
+#define UnitSnapshots_
+
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <cstdlib>
+#include "UnitExpression.h"
+
+
+/** @brief Number of per-thread reader counters */
+#define SNAPSHOT_SLOTS 64
+
+/** @brief Environment variable naming the site units file */
+#define SNAPSHOT_UNITS_ENV "UNITCONVERT_UNITS"
+
+
+/**
+ * @brief Add units and aliases from a definitions file to a registry.
+ * @pre Registry exists.
+ * @param reg Registry to which units are added.
+ * @param in Stream containing the definitions.
+ * @param line Reference to contain the number of the line which failed.
+ * @post Units added, up to the line which failed.
+ * @return UNIT_OK or the reason the line is invalid.
+ */
+UnitErrorCode LoadUnitDefinitions(UnitRegistry &reg, std::istream &in, size_t &line);
+
+
+/**
+ * @brief Name of the site units file, given by the environment variable
+ * 			SNAPSHOT_UNITS_ENV.
+ * @pre None.
+ * @post No changes.
+ * @return File name, or an empty string if none is set.
+ */
+std::string SiteUnitsFile();
+
+
+/**
+ * @brief Registry replaceable while in use by other threads.
+ */
+class UnitSnapshots {
+
+public:
+	/**
+	 * @brief Guard giving a thread a stable registry.
+	 */
+	class Reader {
+
+	public:
+		/**
+		 * @brief Constructor.  Pins the current registry.
+		 * @pre Snapshots exist and outlive this object.
+		 * @param snap Snapshots to be read.
+		 * @post Registry pinned.
+		 * @return None.
+		 */
+		Reader(const UnitSnapshots &snap);
+
+
+		/**
+		 * @brief Destructor.  Releases the registry.
+		 * @pre Reader object exists.
+		 * @post Registry may be freed by a writer.
+		 * @return None.
+		 */
+		~Reader();
+
+
+		/**
+		 * @brief Registry pinned by this guard.
+		 * @pre Reader object exists.
+		 * @post No changes to object.
+		 * @return Reference to the registry.
+		 */
+		const UnitRegistry& Registry() const;
+
+
+	protected:
+		const UnitSnapshots &snapshots;
+		unsigned int phase;
+		size_t slot;
+		const UnitRegistry *registry;
+
+	private:
+		Reader(const Reader&);
+		Reader& operator=(const Reader&);
+
+	};
+
+
+	/**
+	 * @brief Constructor.
+	 * @pre None.
+	 * @post UnitSnapshots object exists, holding the built-in units.
+	 * @return None.
+	 */
+	UnitSnapshots();
+
+
+	/**
+	 * @brief Destructor.
+	 * @pre No Reader guards exist.
+	 * @post Background load finished and registry freed.
+	 * @return None.
+	 */
+	~UnitSnapshots();
+
+
+	/**
+	 * @brief Build a registry from the built-in units and a definitions file
+	 * 			and make it current.
+	 * @pre UnitSnapshots object exists.
+	 * @param filename Definitions file.  An empty name restores the built-in
+	 * 			units.
+	 * @post New registry current if the file is valid; previous registry
+	 * 			freed once unused.
+	 * @return Boolean value indicating success or failure.  See Error().
+	 */
+	bool Load(const std::string &filename);
+
+
+	/**
+	 * @brief Run Load() on a background thread.  A load in progress is
+	 * 			finished first.
+	 * @pre UnitSnapshots object exists.
+	 * @param filename Definitions file.
+	 * @post Load started.
+	 * @return None.
+	 */
+	void LoadAsync(const std::string &filename);
+
+
+	/**
+	 * @brief Wait for a background load to finish.
+	 * @pre UnitSnapshots object exists.
+	 * @post No load in progress.
+	 * @return Boolean value indicating whether the last load succeeded.
+	 */
+	bool Wait();
+
+
+	/**
+	 * @brief Description of the failure of the last load.
+	 * @pre UnitSnapshots object exists and no load is in progress.
+	 * @post No changes to object.
+	 * @return Error message, or an empty string.
+	 */
+	std::string Error() const;
+
+
+	/**
+	 * @brief Number of registries published, including the initial one.
+	 * @pre UnitSnapshots object exists.
+	 * @post No changes to object.
+	 * @return Generation of the current registry.
+	 */
+	size_t Generation() const;
+
+
+
+protected:
+	/**
+	 * @brief Reader counters of one slot, for each phase, on their own
+	 * 			cache line.
+	 */
+	struct alignas(64) Slot {
+		std::atomic<size_t> count[2];
+	};
+
+
+	/** @brief Current registry */
+	std::atomic<const UnitRegistry*> current;
+
+	/** @brief Phase of new readers (0 or 1) */
+	std::atomic<unsigned int> phase;
+
+	/** @brief Reader counters */
+	mutable Slot slots[SNAPSHOT_SLOTS];
+
+	/** @brief Generation of the current registry */
+	std::atomic<size_t> generation;
+
+	/** @brief Serializes writers */
+	std::mutex writer;
+
+	/** @brief Background load */
+	std::thread loader;
+
+	/** @brief Result of the last load */
+	bool loaded;
+	std::string errmsg;
+
+
+	/**
+	 * @brief Make a registry current and free the previous one once unused.
+	 * @param reg Registry.  Ownership passes to this object.
+	 */
+	void Publish(const UnitRegistry *reg);
+
+
+	/**
+	 * @brief Reader counter slot of the calling thread.
+	 * @return Slot index.
+	 */
+	static size_t ThreadSlot();
+
+};
+
+
+
+// ==== PUBLIC FUNCTIONS =======================================================
+
+UnitErrorCode LoadUnitDefinitions(UnitRegistry &reg, std::istream &in, size_t &line)
+{
+	line = 0;
+	std::string text;
+	while(std::getline(in,text)){
+		line++;
+		size_t first = text.find_first_not_of(" \t\r");
+		if(first == std::string::npos || text[first] == '#'){
+			continue;
+		}
+
+
+		/*
+		 * SPLIT INTO TRIMMED FIELDS ON '|' (FULL DEFINITION) OR '=' (SHORT
+		 * DEFINITION OR ALIAS)
+		 */
+		size_t eq = text.find('=');
+		bool isshort = (eq != std::string::npos && eq < text.find('|'));
+		std::vector<std::string> fields;
+		if(isshort){
+			fields.push_back(text.substr(0,eq));
+			fields.push_back(text.substr(eq+1));
+		} else {
+			std::stringstream sstext(text);
+			std::string field;
+			while(std::getline(sstext,field,'|')){
+				fields.push_back(field);
+			}
+			/* THE DEFINITION MAY ITSELF CONTAIN '|' BETWEEN TERMS */
+			while(fields.size() > 5 || (fields.size() == 5 &&
+					fields[4].find(':') != std::string::npos)){
+				fields[3] += "|" + fields[4];
+				fields.erase(fields.begin() + 4);
+			}
+		}
+		for(size_t i=0; i<fields.size(); i++){
+			size_t b = fields[i].find_first_not_of(" \t\r");
+			size_t e = fields[i].find_last_not_of(" \t\r");
+			fields[i] = (b == std::string::npos ? "" : fields[i].substr(b,e-b+1));
+		}
+		if((isshort && fields.size() != 2) || (!isshort && fields.size() < 4) ||
+				fields[0].empty() || fields[0].find_first_of(":| \t") != std::string::npos){
+			return UNIT_ERR_SYNTAX;
+		}
+
+		if(isshort && fields[1].find(':') == std::string::npos){
+			if(!reg.AddAlias(fields[0],fields[1])){
+				return UNIT_ERR_UNKNOWN_UNIT;
+			}
+			continue;
+		}
+
+
+		/*
+		 * DEFINE THE UNIT RELATIVE TO ITS UNIT STRING
+		 */
+		double factor = 1.0;
+		std::string units = fields[1];
+		double offset = 0.0;
+		if(!isshort){
+			std::stringstream ssdef(fields[3]);
+			if(!(ssdef >> factor)){
+				return UNIT_ERR_BAD_VALUE;
+			}
+			std::getline(ssdef,units);
+			size_t b = units.find_first_not_of(" \t");
+			units = (b == std::string::npos ? "" : units.substr(b));
+			if(fields.size() == 5){
+				char *end = 0;
+				offset = std::strtod(fields[4].c_str(),&end);
+				if(fields[4].empty() || *end != '\0'){
+					return UNIT_ERR_BAD_VALUE;
+				}
+			}
+		}
+
+		CompiledUnits compiled;
+		UnitErrorCode err = compiled.Compile(reg,units);
+		if(err != UNIT_OK){
+			return err;
+		}
+		if(compiled.Offset() != 0.0){
+			return UNIT_ERR_OFFSET_MISUSE;
+		}
+		if(compiled.HasLogUnits()){
+			return UNIT_ERR_LOG_MISUSE;
+		}
+		if(compiled.HasCurveUnits()){
+			return UNIT_ERR_CURVE_MISUSE;
+		}
+
+		UnitDefinition def;
+		def.symbol = fields[0];
+		def.description = (isshort ? units : fields[1]);
+		def.category = (isshort ? "Site" : fields[2]);
+		def.factor = factor*compiled.Factor();
+		def.offset = offset;
+		def.logscale = 0.0;
+		def.curve = 0;
+		for(int i=0; i<UNIT_NDIMS; i++){
+			def.dims[i] = compiled.Dimensions()[i];
+		}
+		reg.AddUnit(def);
+	}
+	return UNIT_OK;
+}
+
+
+std::string SiteUnitsFile()
+{
+	const char *filename = getenv(SNAPSHOT_UNITS_ENV);
+	return filename ? filename : "";
+}
+
+
+
+UnitSnapshots::Reader::Reader(const UnitSnapshots &snap) : snapshots(snap)
+{
+	/*
+	 * COUNT THIS READER IN THE CURRENT PHASE.  IF THE PHASE FLIPPED IN THE
+	 * MEANTIME, THE WRITER MAY ALREADY HAVE CHECKED THAT PHASE, SO TRY AGAIN.
+	 */
+	slot = ThreadSlot();
+	for(;;){
+		phase = snapshots.phase.load();
+		snapshots.slots[slot].count[phase].fetch_add(1);
+		if(snapshots.phase.load() == phase){
+			break;
+		}
+		snapshots.slots[slot].count[phase].fetch_sub(1);
+	}
+	registry = snapshots.current.load();
+}
+
+
+UnitSnapshots::Reader::~Reader()
+{
+	snapshots.slots[slot].count[phase].fetch_sub(1,std::memory_order_release);
+}
+
+
+const UnitRegistry& UnitSnapshots::Reader::Registry() const
+{
+	return *registry;
+}
+
+
+
+UnitSnapshots::UnitSnapshots() : current(new UnitRegistry), phase(0), generation(1),
+		loaded(true)
+{
+	for(size_t i=0; i<SNAPSHOT_SLOTS; i++){
+		slots[i].count[0].store(0);
+		slots[i].count[1].store(0);
+	}
+}
+
+
+UnitSnapshots::~UnitSnapshots()
+{
+	Wait();
+	delete current.load();
+}
+
+
+bool UnitSnapshots::Load(const std::string &filename)
+{
+	std::lock_guard<std::mutex> lock(writer);
+	errmsg = "";
+	loaded = false;
+
+	UnitRegistry *reg = new UnitRegistry;
+	if(!filename.empty()){
+		std::ifstream file(filename.c_str());
+		if(!file){
+			errmsg = "cannot open " + filename;
+			delete reg;
+			return false;
+		}
+		size_t line = 0;
+		UnitErrorCode err = LoadUnitDefinitions(*reg,file,line);
+		if(err != UNIT_OK){
+			std::stringstream sstmp;
+			sstmp << filename << ":" << line << ": " << UnitErrorString(err);
+			errmsg = sstmp.str();
+			delete reg;
+			return false;
+		}
+	}
+
+	Publish(reg);
+	loaded = true;
+	return true;
+}
+
+
+void UnitSnapshots::LoadAsync(const std::string &filename)
+{
+	Wait();
+	loader = std::thread([this,filename]{ Load(filename); });
+}
+
+
+bool UnitSnapshots::Wait()
+{
+	if(loader.joinable()){
+		loader.join();
+	}
+	return loaded;
+}
+
+
+std::string UnitSnapshots::Error() const
+{
+	return errmsg;
+}
+
+
+size_t UnitSnapshots::Generation() const
+{
+	return generation.load();
+}
+
+
+
+// ==== PROTECTED FUNCTIONS ====================================================
+
+void UnitSnapshots::Publish(const UnitRegistry *reg)
+{
+	const UnitRegistry *old = current.exchange(reg);
+	generation.fetch_add(1);
+
+
+	/*
+	 * FLIP THE PHASE AND WAIT FOR THE READERS OF THE OLD PHASE.  READERS OF
+	 * THE NEW PHASE LOADED THE NEW REGISTRY.
+	 */
+	unsigned int oldphase = phase.load();
+	phase.store(1 - oldphase);
+	for(int spins=0; ; spins++){
+		size_t readers = 0;
+		for(size_t i=0; i<SNAPSHOT_SLOTS; i++){
+			readers += slots[i].count[oldphase].load(std::memory_order_acquire);
+		}
+		if(readers == 0){
+			break;
+		}
+		if(spins < 100){
+			std::this_thread::yield();
+		} else {
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+	}
+	delete old;
+}
+
+
+size_t UnitSnapshots::ThreadSlot()
+{
+	static std::atomic<size_t> nthreads(0);
+	static thread_local size_t slot = nthreads.fetch_add(1) % SNAPSHOT_SLOTS;
+	return slot;
+}
+
+
+#endif /* UnitSnapshots_ */
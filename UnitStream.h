@@ -0,0 +1,1106 @@
+/**
+ * @file UnitStream.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Streaming conversion of delimited text (e.g., CSV exports), optionally
+ * compressed with gzip or zstd.  The work is split into pipeline stages which
+ * each run on their own threads, connected by bounded queues:
+ * 	-#	decompress: read the input and decompress it into raw blocks,
+ * 	-#	split: cut the raw blocks into chunks which end on a line boundary,
+ * 	-#	work (several threads): parse the values in a chunk, convert them as
+ * 		one array, format the result, and compress it if requested, and
+ * 	-#	write (calling thread): write the chunks in their original order.
+ *
+ * Raw blocks and chunks are drawn from fixed pools and returned after use, so
+ * memory use is bounded and buffers are not reallocated once they have grown
+ * to their working size.  Parse, convert, format, and compress are performed
+ * by the same thread on each chunk while it is still in cache.
+ *
+ * The input format is detected from its first bytes.  gzip input may contain
+ * several members.  The output is compressed according to the extension of
+ * the output file (".gz" or ".zst"); each chunk is compressed separately into
+ * its own gzip member or zstd frame, so compression scales with the number of
+ * threads.  Decompression of a single gzip or zstd stream is inherently
+ * sequential and is the only serial stage apart from reading and writing.
+ *
+ * Lines are split into fields at commas.  Either every numeric field or only
+ * one field (numbered from 1) is converted.  Fields which are not numbers,
+ * such as headers and time stamps, are copied unchanged.
+ *
+ * Files are read and written through UnitFileReader and UnitFileWriter, which
+ * keep several blocks in flight with io_uring where available.  SetDirect()
+ * bypasses the page cache for regular files, which avoids evicting other data
+ * when converting files larger than memory.
+ *
+ * SetDurations() reads fields written as durations (PT1H30M12.5S,
+ * 01:23:45.678) as seconds and/or writes the converted values as durations
+ * (see UnitDuration.h), in place of plain numbers.
+ *
+ * SetJson() selects newline-delimited JSON records instead of delimited text;
+ * the named fields are then converted by a copy of the given UnitJson in each
+ * work thread (see UnitJson.h).
+ *
+ * gzip support requires zlib.  zstd support requires libzstd and is only
+ * compiled when UNITCONVERT_WITH_ZSTD is defined.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- Read and write files through UnitIO.h (io_uring with read-ahead, optional
+ *	  O_DIRECT).
+ *
+ * @date 18 October 2026
+ *	- Added SetJson() to convert fields of NDJSON records.
+ *
+ * @date 18 October 2026
+ *	- Added ConvertLines() for converting text held in memory.
+ *
+ * @date 18 October 2026
+ *	- Added SetDurations() to read and write ISO 8601 durations and clock
+ *	  times.
+ *
+ * @date 18 October 2026
+ *	- Added Recompile() so that a long-running stream can pick up reloaded
+ *	  site units.
+ *
+ * @date 18 October 2026
+ *	- Added NumMalformed() for NDJSON records copied unchanged.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitStream_
+#define UnitStream_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <charconv>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#ifdef UNITCONVERT_WITH_ZSTD
+#include <zstd.h>
+#endif
+#include "UnitPlan.h"
+#include "UnitQueue.h"
+#include "UnitIO.h"
+#include "UnitJson.h"
+#include "UnitDuration.h"
+
+
+/** @brief Size of the blocks read from the input and produced by decompression */
+#define STREAM_BLOCK_SIZE 262144
+
+/** @brief Target size of the line-aligned chunks handed to the work threads */
+#define STREAM_CHUNK_SIZE 1048576
+
+/** @brief Number of raw blocks in the pool */
+#define STREAM_BLOCKS 8
+
+/** @brief Number of chunks in the pool per work thread */
+#define STREAM_CHUNKS_PER_THREAD 3
+
+/** @brief Longest formatted value */
+#define STREAM_MAX_VALUE_CHARS 32
+
+
+/**
+ * @brief Compression of a stream.
+ */
+enum StreamCodec {
+	STREAM_PLAIN = 0,	/**< Not compressed */
+	STREAM_GZIP,		/**< gzip */
+	STREAM_ZSTD			/**< zstd */
+};
+
+
+/**
+ * @brief Multi-threaded conversion of delimited text streams.
+ */
+class UnitStream {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre Registry exists and outlives this object.
+	 * @param reg Registry used to look up prefixes and units.
+	 * @post UnitStream object exists.  Every numeric field is converted with
+	 * 			an identity conversion until SetUnits() is called.
+	 * @return None.
+	 */
+	UnitStream(const UnitRegistry &reg);
+
+
+	/**
+	 * @brief Set the input and output units.
+	 * @pre UnitStream object exists.
+	 * @param unitsin Input unit string.
+	 * @param unitsout Output unit string.
+	 * @post Conversion set if the units are valid.
+	 * @return UNIT_OK or the reason the units are invalid.
+	 */
+	UnitErrorCode SetUnits(const std::string &unitsin, const std::string &unitsout);
+
+
+	/**
+	 * @brief Compile the units last given to SetUnits() again, looking them
+	 * 			up in another registry (e.g. after site units are reloaded).
+	 * @pre UnitStream object exists and no call to Run() is in progress.
+	 * @param reg Registry used to look up prefixes and units.  Need not
+	 * 			outlive this call.
+	 * @post Conversion replaced if the units are valid in 'reg'.  Previous
+	 * 			conversion kept otherwise.
+	 * @return UNIT_OK or the reason the units are invalid.
+	 */
+	UnitErrorCode Recompile(const UnitRegistry &reg);
+
+
+	/**
+	 * @brief Set the field to be converted.
+	 * @pre UnitStream object exists.
+	 * @param col Field number, counted from 1, or 0 to convert every numeric
+	 * 			field.
+	 * @post Field set.
+	 * @return None.
+	 */
+	void SetColumn(int col);
+
+
+	/**
+	 * @brief Set the number of work threads.
+	 * @pre UnitStream object exists.
+	 * @param n Number of work threads.  Values below 1 select one fewer than
+	 * 			the number of processors.
+	 * @post Number of threads set.
+	 * @return None.
+	 */
+	void SetThreads(int n);
+
+
+	/**
+	 * @brief Set whether regular files bypass the page cache.
+	 * @pre UnitStream object exists.
+	 * @param flag Indicator to open files with O_DIRECT.
+	 * @post Setting stored.
+	 * @return None.
+	 */
+	void SetDirect(bool flag);
+
+
+	/**
+	 * @brief Set whether fields are durations rather than plain numbers.
+	 * @pre UnitStream object exists.
+	 * @param in Indicator that the fields to be converted are durations
+	 * 			(ISO 8601 or clock time), read as seconds.  Other fields are
+	 * 			copied unchanged.  The input units should then be seconds.
+	 * @param out Form in which converted values are written.  Values are
+	 * 			written as durations of that many seconds, so the output units
+	 * 			should then be seconds.
+	 * @post Setting stored.
+	 * @return None.
+	 */
+	void SetDurations(bool in, UnitDurationFormat out);
+
+
+	/**
+	 * @brief Convert NDJSON records instead of delimited text.
+	 * @pre UnitStream object exists.
+	 * @param conv Pointer to the converter, which must outlive calls to
+	 * 			Run(), or 0 to convert delimited text.  The units and field set
+	 * 			by SetUnits() and SetColumn() are not used for NDJSON.
+	 * @post Setting stored.
+	 * @return None.
+	 */
+	void SetJson(const UnitJson *conv);
+
+
+	/**
+	 * @brief Convert a stream.
+	 * @pre UnitStream object exists.
+	 * @param filein Input file, or "-" for standard input.
+	 * @param fileout Output file, or "-" for standard output.
+	 * @post Output written.
+	 * @return Boolean value indicating success or failure.  See Error().
+	 */
+	bool Run(const std::string &filein, const std::string &fileout);
+
+
+	/**
+	 * @brief Description of the failure of the last call to Run().
+	 * @pre UnitStream object exists.
+	 * @post No changes to object.
+	 * @return Error message, or an empty string.
+	 */
+	std::string Error() const;
+
+
+	/**
+	 * @brief Number of values converted by the last call to Run().
+	 * @pre UnitStream object exists.
+	 * @post No changes to object.
+	 * @return Number of values.
+	 */
+	size_t NumValues() const;
+
+
+	/**
+	 * @brief Number of NDJSON values left unchanged by the last call to Run()
+	 * 			(see UnitJson::NumErrors()).
+	 * @pre UnitStream object exists.
+	 * @post No changes to object.
+	 * @return Number of values.
+	 */
+	size_t NumErrors() const;
+
+
+	/**
+	 * @brief Number of malformed NDJSON records copied unchanged by the last
+	 * 			call to Run() (see UnitJson::NumMalformed()).
+	 * @pre UnitStream object exists.
+	 * @post No changes to object.
+	 * @return Number of records.
+	 */
+	size_t NumMalformed() const;
+
+
+	/**
+	 * @brief Convert whole lines held in memory, as a work thread of Run()
+	 * 			would, without starting any threads.  Used by the workers of
+	 * 			UnitShard.
+	 * @pre UnitStream object exists and Run() is not in progress.
+	 * @param in Reference to the input text, which ends at the end of a line.
+	 * 			Its contents are preserved.
+	 * @param out Reference to contain the converted text.  Replaced.
+	 * @post 'out' contains the converted text.
+	 * @return Number of values converted.
+	 */
+	size_t ConvertLines(std::vector<char> &in, std::vector<char> &out);
+
+
+	/**
+	 * @brief Compression selected by the extension of a file name.
+	 * @pre None.
+	 * @param filename File name.
+	 * @post No changes.
+	 * @return STREAM_GZIP for ".gz", STREAM_ZSTD for ".zst", STREAM_PLAIN
+	 * 			otherwise.
+	 */
+	static StreamCodec CodecFromName(const std::string &filename);
+
+
+
+protected:
+	/**
+	 * @brief Decompressed bytes passed from the decompress to the split stage.
+	 */
+	struct Block {
+		/** @brief Buffer of STREAM_BLOCK_SIZE bytes */
+		std::vector<char> data;
+
+		/** @brief Number of bytes used */
+		size_t size;
+	};
+
+
+	/**
+	 * @brief Whole lines passed from the split stage through the work stage
+	 * 			to the writer.
+	 */
+	struct Chunk {
+		/** @brief Position in the stream */
+		size_t seq;
+
+		/** @brief Input text */
+		std::vector<char> in;
+
+		/** @brief Output text */
+		std::vector<char> out;
+
+		/** @brief Compressed output text */
+		std::vector<char> packed;
+
+		/** @brief Values parsed from the input */
+		std::vector<double> vals;
+
+		/** @brief Offset of the first character of each value in 'in' */
+		std::vector<size_t> starts;
+
+		/** @brief Offset one past the last character of each value in 'in' */
+		std::vector<size_t> ends;
+	};
+
+
+	/** @brief Registry used to look up prefixes and units */
+	const UnitRegistry &registry;
+
+	/** @brief Conversion applied to each value, and its units as given */
+	UnitPlan<double> plan;
+	std::string planin;
+	std::string planout;
+
+	/** @brief Field to be converted, or 0 for all */
+	int column;
+
+	/** @brief Number of work threads */
+	int nthreads;
+
+	/** @brief Compression of the output */
+	StreamCodec codecout;
+
+	/** @brief Indicator to open files with O_DIRECT */
+	bool direct;
+
+	/** @brief Indicator that fields are read as durations */
+	bool durationin;
+
+	/** @brief Form in which converted values are written */
+	UnitDurationFormat durationout;
+
+	/** @brief NDJSON converter, or 0 for delimited text */
+	const UnitJson *json;
+
+	/** @brief Input file */
+	UnitFileReader reader;
+
+	/** @brief Output file */
+	UnitFileWriter writer;
+
+	/** @brief Pool of unused raw blocks */
+	std::vector<Block> blocks;
+
+	/** @brief Pool of unused chunks */
+	std::vector<Chunk> chunks;
+
+	/** @brief Queues between stages (created by Run()) */
+	UnitQueue<Block*> *freeblocks, *rawblocks;
+	UnitQueue<Chunk*> *freechunks, *workchunks, *donechunks;
+
+	/** @brief Number of work threads still running */
+	std::atomic<int> nworking;
+
+	/** @brief Number of values converted */
+	std::atomic<size_t> nvalues;
+
+	/** @brief Number of NDJSON values left unchanged */
+	std::atomic<size_t> nerrors;
+
+	/** @brief Number of malformed NDJSON records */
+	std::atomic<size_t> nmalformed;
+
+	/** @brief Indicator that a stage failed */
+	std::atomic<bool> failed;
+
+	/** @brief Description of the first failure */
+	std::string errmsg;
+
+	/** @brief Lock protecting errmsg */
+	mutable std::mutex errmutex;
+
+	/** @brief Scratch buffers used by ConvertLines() */
+	Chunk lines;
+
+
+	/**
+	 * @brief Record a failure and stop all stages.
+	 * @param msg Description of the failure.
+	 * @post All queues closed.
+	 * @return None.
+	 */
+	void Fail(const std::string &msg);
+
+
+	/**
+	 * @brief Decompress stage.
+	 * @post Raw block queue closed.
+	 * @return None.
+	 */
+	void DecompressThread();
+
+
+	/**
+	 * @brief Split stage.
+	 * @post Work queue closed.
+	 * @return None.
+	 */
+	void SplitThread();
+
+
+	/**
+	 * @brief Work stage.
+	 * @post Done queue closed by the last work thread to finish.
+	 * @return None.
+	 */
+	void WorkThread();
+
+
+	/**
+	 * @brief Parse, convert, and format one chunk.
+	 * @param chunk Reference to the chunk.
+	 * @param jsonconv Pointer to the work thread's NDJSON converter, or 0 for
+	 * 			delimited text.
+	 * @post chunk.out contains the converted text.
+	 * @return None.
+	 */
+	void ConvertChunk(Chunk &chunk, UnitJson *jsonconv);
+
+
+	/**
+	 * @brief Read the next block of input.  Only called once the previous
+	 * 			block has been consumed.
+	 * @param buf Reference to contain a pointer to the block.
+	 * @param pos Reference to the offset of the first unconsumed byte.  Set
+	 * 			to 0.
+	 * @param len Reference to the number of valid bytes.
+	 * @return Number of bytes read, 0 at end of input, or -1 on error.
+	 */
+	ssize_t ReadInput(const char *&buf, size_t &pos, size_t &len);
+
+};
+
+
+
+// ==== PUBLIC FUNCTIONS =======================================================
+
+UnitStream::UnitStream(const UnitRegistry &reg) : registry(reg), column(0),
+		nthreads(0), codecout(STREAM_PLAIN), direct(false), durationin(false),
+		durationout(UNITDURATION_NONE), json(0),
+		freeblocks(0), rawblocks(0), freechunks(0), workchunks(0), donechunks(0),
+		nworking(0), nvalues(0), nerrors(0), nmalformed(0), failed(false)
+{
+}
+
+
+UnitErrorCode UnitStream::SetUnits(const std::string &unitsin, const std::string &unitsout)
+{
+	UnitResult< UnitPlan<double> > result = UnitPlan<double>::Create(registry,
+			unitsin,unitsout);
+	if(!result.Ok()){
+		return result.Error();
+	}
+	plan = result.Value();
+	planin = unitsin;
+	planout = unitsout;
+	return UNIT_OK;
+}
+
+
+UnitErrorCode UnitStream::Recompile(const UnitRegistry &reg)
+{
+	UnitResult< UnitPlan<double> > result = UnitPlan<double>::Create(reg,planin,planout);
+	if(!result.Ok()){
+		return result.Error();
+	}
+	plan = result.Value();
+	return UNIT_OK;
+}
+
+
+void UnitStream::SetColumn(int col)
+{
+	column = col < 0 ? 0 : col;
+}
+
+
+void UnitStream::SetThreads(int n)
+{
+	nthreads = n;
+}
+
+
+void UnitStream::SetDirect(bool flag)
+{
+	direct = flag;
+}
+
+
+void UnitStream::SetDurations(bool in, UnitDurationFormat out)
+{
+	durationin = in;
+	durationout = out;
+}
+
+
+void UnitStream::SetJson(const UnitJson *conv)
+{
+	json = conv;
+}
+
+
+bool UnitStream::Run(const std::string &filein, const std::string &fileout)
+{
+	errmsg = "";
+	failed = false;
+	nvalues = 0;
+	nerrors = 0;
+	nmalformed = 0;
+
+
+	/*
+	 * OPEN FILES
+	 */
+	codecout = (fileout == "-") ? STREAM_PLAIN : CodecFromName(fileout);
+#ifndef UNITCONVERT_WITH_ZSTD
+	if(codecout == STREAM_ZSTD){
+		errmsg = "zstd support not compiled in";
+		return false;
+	}
+#endif
+	if(!reader.Open(filein,direct)){
+		errmsg = "cannot open " + filein;
+		reader.Close();
+		return false;
+	}
+	if(!writer.Open(fileout,direct)){
+		errmsg = "cannot create " + fileout;
+		reader.Close();
+		writer.Close();
+		return false;
+	}
+
+
+	/*
+	 * CREATE POOLS AND QUEUES.  EVERY QUEUE CAN HOLD ITS WHOLE POOL, SO ONLY
+	 * AN EMPTY POOL BLOCKS A STAGE.
+	 */
+	int nwork = nthreads;
+	if(nwork < 1){
+		nwork = (int)std::thread::hardware_concurrency() - 1;
+		nwork = nwork < 1 ? 1 : nwork;
+	}
+	size_t nchunks = (size_t)nwork*STREAM_CHUNKS_PER_THREAD + 2;
+	blocks.resize(STREAM_BLOCKS);
+	chunks.resize(nchunks);
+	UnitQueue<Block*> qfreeblocks(STREAM_BLOCKS), qrawblocks(STREAM_BLOCKS);
+	UnitQueue<Chunk*> qfreechunks(nchunks), qworkchunks(nchunks), qdonechunks(nchunks);
+	freeblocks = &qfreeblocks;
+	rawblocks = &qrawblocks;
+	freechunks = &qfreechunks;
+	workchunks = &qworkchunks;
+	donechunks = &qdonechunks;
+	for(size_t i=0; i<blocks.size(); i++){
+		blocks[i].data.resize(STREAM_BLOCK_SIZE);
+		freeblocks->Push(&blocks[i]);
+	}
+	for(size_t i=0; i<chunks.size(); i++){
+		freechunks->Push(&chunks[i]);
+	}
+
+
+	/*
+	 * START STAGES AND WRITE COMPLETED CHUNKS IN ORDER ON THIS THREAD
+	 */
+	nworking = nwork;
+	std::vector<std::thread> threads;
+	threads.push_back(std::thread(&UnitStream::DecompressThread,this));
+	threads.push_back(std::thread(&UnitStream::SplitThread,this));
+	for(int i=0; i<nwork; i++){
+		threads.push_back(std::thread(&UnitStream::WorkThread,this));
+	}
+
+	std::map<size_t,Chunk*> pending;
+	size_t nextseq = 0;
+	Chunk *chunk = 0;
+	while(donechunks->Pop(chunk)){
+		pending[chunk->seq] = chunk;
+		std::map<size_t,Chunk*>::iterator it;
+		while((it = pending.find(nextseq)) != pending.end()){
+			Chunk *c = it->second;
+			const std::vector<char> &text = (codecout == STREAM_PLAIN) ? c->out : c->packed;
+			if(!failed && !writer.Write(text.data(),text.size())){
+				Fail("cannot write " + fileout);
+			}
+			pending.erase(it);
+			freechunks->Push(c);
+			nextseq++;
+		}
+	}
+
+	for(size_t i=0; i<threads.size(); i++){
+		threads[i].join();
+	}
+	reader.Close();
+	if(!writer.Close() && !failed){
+		Fail("cannot write " + fileout);
+	}
+	freeblocks = rawblocks = 0;
+	freechunks = workchunks = donechunks = 0;
+	return !failed;
+}
+
+
+std::string UnitStream::Error() const
+{
+	std::lock_guard<std::mutex> lock(errmutex);
+	return errmsg;
+}
+
+
+size_t UnitStream::NumValues() const
+{
+	return nvalues;
+}
+
+
+size_t UnitStream::NumErrors() const
+{
+	return nerrors;
+}
+
+
+size_t UnitStream::NumMalformed() const
+{
+	return nmalformed;
+}
+
+
+size_t UnitStream::ConvertLines(std::vector<char> &in, std::vector<char> &out)
+{
+	/*
+	 * BORROW THE CALLER'S BUFFERS RATHER THAN COPYING THEM
+	 */
+	size_t before = nvalues;
+	lines.in.swap(in);
+	lines.out.swap(out);
+	if(json){
+		UnitJson jsonconv(*json);
+		ConvertChunk(lines,&jsonconv);
+		nerrors += jsonconv.NumErrors();
+		nmalformed += jsonconv.NumMalformed();
+	} else {
+		ConvertChunk(lines,0);
+	}
+	lines.in.swap(in);
+	lines.out.swap(out);
+	return nvalues - before;
+}
+
+
+StreamCodec UnitStream::CodecFromName(const std::string &filename)
+{
+	size_t n = filename.size();
+	if(n > 3 && filename.compare(n-3,3,".gz") == 0){
+		return STREAM_GZIP;
+	}
+	if(n > 4 && filename.compare(n-4,4,".zst") == 0){
+		return STREAM_ZSTD;
+	}
+	return STREAM_PLAIN;
+}
+
+
+
+// ==== PROTECTED FUNCTIONS ====================================================
+
+void UnitStream::Fail(const std::string &msg)
+{
+	{
+		std::lock_guard<std::mutex> lock(errmutex);
+		if(errmsg.empty()){
+			errmsg = msg;
+		}
+	}
+	failed = true;
+	freeblocks->Close();
+	rawblocks->Close();
+	freechunks->Close();
+	workchunks->Close();
+	donechunks->Close();
+}
+
+
+void UnitStream::DecompressThread()
+{
+	const char *inbuf = 0;
+	size_t inpos = 0;
+	size_t inlen = 0;
+	ssize_t nread = ReadInput(inbuf,inpos,inlen);
+	if(nread < 0){
+		Fail("cannot read input");
+		return;
+	}
+
+
+	/*
+	 * DETECT COMPRESSION FROM THE FIRST BYTES
+	 */
+	StreamCodec codecin = STREAM_PLAIN;
+	const unsigned char *magic = (const unsigned char*)inbuf;
+	if(inlen >= 2 && magic[0] == 0x1f && magic[1] == 0x8b){
+		codecin = STREAM_GZIP;
+	} else if(inlen >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 &&
+			magic[2] == 0x2f && magic[3] == 0xfd){
+#ifdef UNITCONVERT_WITH_ZSTD
+		codecin = STREAM_ZSTD;
+#else
+		Fail("zstd support not compiled in");
+		return;
+#endif
+	}
+
+	z_stream zs;
+	std::memset(&zs,0,sizeof(zs));
+	if(codecin == STREAM_GZIP && inflateInit2(&zs,15 + 32) != Z_OK){
+		Fail("cannot initialize gzip decompression");
+		return;
+	}
+#ifdef UNITCONVERT_WITH_ZSTD
+	ZSTD_DStream *zds = (codecin == STREAM_ZSTD) ? ZSTD_createDStream() : 0;
+#endif
+
+
+	/*
+	 * FILL RAW BLOCKS UNTIL THE INPUT IS EXHAUSTED
+	 */
+	bool eof = (inlen == 0);
+	bool streamend = false;
+	Block *block = 0;
+	while(!eof && !failed && freeblocks->Pop(block)){
+		block->size = 0;
+		while(block->size < block->data.size() && !eof){
+			if(inpos == inlen){
+				nread = ReadInput(inbuf,inpos,inlen);
+				if(nread < 0){
+					Fail("cannot read input");
+					break;
+				}
+				if(nread == 0){
+					eof = true;
+					break;
+				}
+			}
+
+			size_t avail = block->data.size() - block->size;
+			if(codecin == STREAM_PLAIN){
+				size_t n = std::min(avail,inlen - inpos);
+				std::memcpy(&block->data[block->size],&inbuf[inpos],n);
+				block->size += n;
+				inpos += n;
+			} else if(codecin == STREAM_GZIP){
+				/* A NEW gzip MEMBER MAY FOLLOW THE END OF THE PREVIOUS ONE */
+				if(streamend){
+					inflateReset(&zs);
+					streamend = false;
+				}
+				zs.next_in = (Bytef*)&inbuf[inpos];
+				zs.avail_in = (uInt)(inlen - inpos);
+				zs.next_out = (Bytef*)&block->data[block->size];
+				zs.avail_out = (uInt)avail;
+				int ret = inflate(&zs,Z_NO_FLUSH);
+				if(ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR){
+					Fail("corrupt gzip input");
+					break;
+				}
+				streamend = (ret == Z_STREAM_END);
+				inpos = inlen - zs.avail_in;
+				block->size = block->data.size() - zs.avail_out;
+			} else {
+#ifdef UNITCONVERT_WITH_ZSTD
+				ZSTD_inBuffer zin = {&inbuf[inpos], inlen - inpos, 0};
+				ZSTD_outBuffer zout = {&block->data[block->size], avail, 0};
+				size_t ret = ZSTD_decompressStream(zds,&zout,&zin);
+				if(ZSTD_isError(ret)){
+					Fail(std::string("corrupt zstd input: ") + ZSTD_getErrorName(ret));
+					break;
+				}
+				inpos += zin.pos;
+				block->size += zout.pos;
+#endif
+			}
+		}
+
+		if(failed || !rawblocks->Push(block)){
+			break;
+		}
+	}
+	if(eof && codecin == STREAM_GZIP && !streamend && !failed){
+		Fail("truncated gzip input");
+	}
+
+	if(codecin == STREAM_GZIP){
+		inflateEnd(&zs);
+	}
+#ifdef UNITCONVERT_WITH_ZSTD
+	ZSTD_freeDStream(zds);
+#endif
+	rawblocks->Close();
+}
+
+
+void UnitStream::SplitThread()
+{
+	size_t seq = 0;
+	Chunk *chunk = 0;
+	if(!freechunks->Pop(chunk)){
+		workchunks->Close();
+		return;
+	}
+	chunk->in.clear();
+
+
+	/*
+	 * APPEND RAW BLOCKS TO THE CURRENT CHUNK.  ONCE IT IS LARGE ENOUGH, THE
+	 * PARTIAL LINE AFTER THE LAST NEWLINE IS MOVED TO THE NEXT CHUNK.
+	 */
+	Block *block = 0;
+	while(rawblocks->Pop(block)){
+		chunk->in.insert(chunk->in.end(),block->data.begin(),
+				block->data.begin() + block->size);
+		freeblocks->Push(block);
+		if(chunk->in.size() < STREAM_CHUNK_SIZE){
+			continue;
+		}
+
+		const char *base = chunk->in.data();
+		const char *nl = (const char*)memrchr(base,'\n',chunk->in.size());
+		if(!nl){
+			continue;
+		}
+		Chunk *next = 0;
+		if(!freechunks->Pop(next)){
+			break;
+		}
+		size_t keep = (size_t)(nl - base) + 1;
+		next->in.assign(chunk->in.begin() + keep,chunk->in.end());
+		chunk->in.resize(keep);
+		chunk->seq = seq++;
+		if(!workchunks->Push(chunk)){
+			break;
+		}
+		chunk = next;
+	}
+
+
+	/*
+	 * THE LAST CHUNK NEED NOT END WITH A NEWLINE
+	 */
+	if(!failed && !chunk->in.empty()){
+		chunk->seq = seq++;
+		workchunks->Push(chunk);
+	}
+	workchunks->Close();
+}
+
+
+void UnitStream::WorkThread()
+{
+	z_stream zs;
+	std::memset(&zs,0,sizeof(zs));
+	if(codecout == STREAM_GZIP && deflateInit2(&zs,Z_DEFAULT_COMPRESSION,Z_DEFLATED,
+			15 + 16,8,Z_DEFAULT_STRATEGY) != Z_OK){
+		Fail("cannot initialize gzip compression");
+	}
+#ifdef UNITCONVERT_WITH_ZSTD
+	ZSTD_CCtx *zcs = (codecout == STREAM_ZSTD) ? ZSTD_createCCtx() : 0;
+#endif
+
+
+	/*
+	 * EACH THREAD CONVERTS NDJSON WITH ITS OWN COPY, WHICH CACHES CONVERSIONS
+	 */
+	UnitJson *jsonconv = json ? new UnitJson(*json) : 0;
+
+	Chunk *chunk = 0;
+	while(!failed && workchunks->Pop(chunk)){
+		ConvertChunk(*chunk,jsonconv);
+
+		/*
+		 * COMPRESS EACH CHUNK INTO ITS OWN gzip MEMBER OR zstd FRAME.  THE
+		 * CONCATENATION IS A VALID STREAM.
+		 */
+		if(codecout == STREAM_GZIP){
+			deflateReset(&zs);
+			chunk->packed.resize(deflateBound(&zs,(uLong)chunk->out.size()));
+			zs.next_in = (Bytef*)chunk->out.data();
+			zs.avail_in = (uInt)chunk->out.size();
+			zs.next_out = (Bytef*)chunk->packed.data();
+			zs.avail_out = (uInt)chunk->packed.size();
+			if(deflate(&zs,Z_FINISH) != Z_STREAM_END){
+				Fail("gzip compression failed");
+				break;
+			}
+			chunk->packed.resize(chunk->packed.size() - zs.avail_out);
+		}
+#ifdef UNITCONVERT_WITH_ZSTD
+		if(codecout == STREAM_ZSTD){
+			chunk->packed.resize(ZSTD_compressBound(chunk->out.size()));
+			size_t ret = ZSTD_compressCCtx(zcs,chunk->packed.data(),chunk->packed.size(),
+					chunk->out.data(),chunk->out.size(),3);
+			if(ZSTD_isError(ret)){
+				Fail("zstd compression failed");
+				break;
+			}
+			chunk->packed.resize(ret);
+		}
+#endif
+
+		if(!donechunks->Push(chunk)){
+			break;
+		}
+	}
+
+	if(codecout == STREAM_GZIP){
+		deflateEnd(&zs);
+	}
+#ifdef UNITCONVERT_WITH_ZSTD
+	ZSTD_freeCCtx(zcs);
+#endif
+	if(jsonconv){
+		nerrors += jsonconv->NumErrors();
+		nmalformed += jsonconv->NumMalformed();
+		delete jsonconv;
+	}
+	if(--nworking == 0){
+		donechunks->Close();
+	}
+}
+
+
+void UnitStream::ConvertChunk(Chunk &chunk, UnitJson *jsonconv)
+{
+	if(jsonconv){
+		nvalues += jsonconv->Convert(chunk.in.data(),chunk.in.size(),chunk.out);
+		return;
+	}
+
+	const char *base = chunk.in.data();
+	const char *pend = base + chunk.in.size();
+	chunk.vals.clear();
+	chunk.starts.clear();
+	chunk.ends.clear();
+
+
+	/*
+	 * PARSE: RECORD THE POSITION AND VALUE OF EVERY FIELD TO BE CONVERTED
+	 */
+	const char *p = base;
+	while(p < pend){
+		const char *eol = (const char*)std::memchr(p,'\n',(size_t)(pend - p));
+		if(!eol){
+			eol = pend;
+		}
+		int field = 1;
+		while(p <= eol){
+			const char *fe = (const char*)std::memchr(p,',',(size_t)(eol - p));
+			if(!fe){
+				fe = eol;
+			}
+			if(column == 0 || field == column){
+				const char *s = p;
+				const char *e = fe;
+				while(s < e && (*s == ' ' || *s == '\t')){ s++; }
+				while(e > s && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '\r')){ e--; }
+				const char *num = (s < e && *s == '+') ? s + 1 : s;
+				double val = 0.0e0;
+				bool ok;
+				if(durationin){
+					ok = (UnitParseDuration(s,e,val) == UNIT_OK);
+				} else {
+					std::from_chars_result r = std::from_chars(num,e,val);
+					ok = (num < e && r.ec == std::errc() && r.ptr == e);
+				}
+				if(ok){
+					chunk.vals.push_back(val);
+					chunk.starts.push_back((size_t)(s - base));
+					chunk.ends.push_back((size_t)(e - base));
+				}
+			}
+			p = fe + 1;
+			field++;
+		}
+	}
+
+
+	/*
+	 * CONVERT ALL VALUES AS ONE ARRAY.  PIECES ARE KEPT BELOW
+	 * UNITPLAN_PARALLEL_MIN SO THAT THE PLAN DOES NOT START OpenMP THREADS
+	 * INSIDE THIS WORK THREAD.
+	 */
+	size_t n = chunk.vals.size();
+	for(size_t i=0; i<n; i+=UNITPLAN_PARALLEL_MIN){
+		size_t m = std::min((size_t)UNITPLAN_PARALLEL_MIN,n - i);
+		plan.Convert(&chunk.vals[i],&chunk.vals[i],m);
+	}
+	nvalues += n;
+
+
+	/*
+	 * FORMAT: COPY THE TEXT BETWEEN VALUES AND REPLACE EACH VALUE
+	 */
+	chunk.out.resize(chunk.in.size() + n*STREAM_MAX_VALUE_CHARS);
+	char *o = chunk.out.data();
+	char *oend = o + chunk.out.size();
+	size_t pos = 0;
+	for(size_t i=0; i<n; i++){
+		size_t len = chunk.starts[i] - pos;
+		std::memcpy(o,base + pos,len);
+		o += len;
+		if(durationout != UNITDURATION_NONE){
+			o = UnitFormatDuration(chunk.vals[i],durationout,o);
+		} else {
+			o = std::to_chars(o,oend,chunk.vals[i]).ptr;
+		}
+		pos = chunk.ends[i];
+	}
+	std::memcpy(o,base + pos,chunk.in.size() - pos);
+	o += chunk.in.size() - pos;
+	chunk.out.resize((size_t)(o - chunk.out.data()));
+}
+
+
+ssize_t UnitStream::ReadInput(const char *&buf, size_t &pos, size_t &len)
+{
+	ssize_t n = reader.Read(buf);
+	pos = 0;
+	len = (n > 0) ? (size_t)n : 0;
+	return n;
+}
+
+
+#endif /* UnitStream_ */
@@ -0,0 +1,1139 @@
+/**
+ * @file UnitVerify.h
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Self-checks for the unit registry, the unit-string parser, and the
+ * conversion plans.  These are run from the command line
+ * ("UnitConvert check") and return the number of failures so that a build
+ * script can stop on a non-zero exit status.  The checks are:
+ * 	-#	round trip: converting A->B->A returns the original value for every
+ * 		pair of registered units with matching dimensions,
+ * 	-#	transitivity: A->B->C equals A->C for every triple of registered
+ * 		units with matching dimensions,
+ * 	-#	dimensions: every registered unit compiles to its listed dimensions,
+ * 		units within a category agree, and mismatched dimensions are
+ * 		rejected,
+ * 	-#	quantities: the compile-time units of Quantity.h match the registry,
+ * 	-#	formulas: derived quantities of UnitFormula.h give the expected values
+ * 		and errors, including formulas without columns and deeply nested ones,
+ * 	-#	snapshots: threads converting with site units through UnitSnapshots
+ * 		always see a complete registry, unchanged for the life of a guard,
+ * 		while the site units are reloaded with LoadAsync(),
+ * 	-#	plan cache: a misused logarithmic or non-linear unit looked up
+ * 		through UnitPlanCache is rejected, and does not change the plan later
+ * 		found for the valid spelling it canonicalizes to,
+ * 	-#	NDJSON: a truncated or malformed record is copied unchanged and
+ * 		counted, and the records after it are still converted,
+ * 	-#	parser: randomly generated and mutated unit strings never crash the
+ * 		parser, valid strings survive a round trip through Text(), and the
+ * 		plain and canonical parsers agree on which strings are valid, and
+ * 	-#	throughput: scalar and bulk conversion rates compared against a
+ * 		baseline file, failing if either drops by more than a given percent.
+ *
+ * FuzzOne() checks a single input and is called by the libFuzzer target in
+ * check/FuzzUnits.cpp.  The random strings are generated from a fixed seed so
+ * that a failure can be reproduced.
+ *
+ * The baseline file contains one "name value" pair per line, with the rate in
+ * values per second.  Lines beginning with '#' are ignored.
+ *
+ * All functions contained within this class are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- Added CheckQuantities().
+ *
+ * @date 18 October 2026
+ *	- Round-trip and transitivity checks skip samples outside the domain of a
+ *	  logarithmic unit.
+ *
+ * @date 18 October 2026
+ *	- Added CheckFormulas().
+ *
+ * @date 18 October 2026
+ *	- Added CheckSnapshots().
+ *
+ * @date 18 October 2026
+ *	- Added CheckPlanCache().  FuzzOne() counts a misused logarithmic unit as
+ *	  invalid for the plain parser.
+ *
+ * @date 18 October 2026
+ *	- CheckPlanCache() and FuzzOne() cover misused non-linear units.
+ *
+ * @date 18 October 2026
+ *	- Added CheckJson().
+ *
+ * @date 18 October 2026
+ *	- CheckBaseline() fails on lines it cannot parse, unknown names, rates
+ *	  which are not positive, and missing rates.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#ifndef UnitVerify_
+#define UnitVerify_
+
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <omp.h>
+#include "UnitCanonical.h"
+#include "Quantity.h"
+#include "UnitFormula.h"
+#include "UnitSnapshots.h"
+#include "UnitJson.h"
+
+
+/** @brief Relative tolerance used when comparing converted values */
+#define VERIFY_TOLERANCE 1.0e-9
+
+/** @brief Number of values converted per throughput sample */
+#define VERIFY_BULK_VALUES 4194304
+
+/** @brief Number of values converted one at a time per throughput sample */
+#define VERIFY_SCALAR_VALUES 65536
+
+/** @brief Number of samples taken for each throughput measurement */
+#define VERIFY_SAMPLES 5
+
+/** @brief Number of reader threads in the snapshot check */
+#define VERIFY_SNAPSHOT_READERS 4
+
+/** @brief Number of reloads in the snapshot check */
+#define VERIFY_SNAPSHOT_RELOADS 50
+
+
+/**
+ * @brief Self-checks for the registry, parser, and conversion plans.
+ */
+class UnitVerify {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @pre Registry exists and outlives this object.
+	 * @param reg Registry to be checked.
+	 * @post UnitVerify object exists.
+	 * @return None.
+	 */
+	UnitVerify(const UnitRegistry &reg);
+
+
+	/**
+	 * @brief Check A->B->A for every pair of registered units with matching
+	 * 			dimensions.
+	 * @pre UnitVerify object exists.
+	 * @post Failures appended to the report.
+	 * @return Number of failures.
+	 */
+	int CheckRoundTrip();
+
+
+	/**
+	 * @brief Check A->B->C against A->C for every triple of registered units
+	 * 			with matching dimensions.
+	 * @pre UnitVerify object exists.
+	 * @post Failures appended to the report.
+	 * @return Number of failures.
+	 */
+	int CheckTransitivity();
+
+
+	/**
+	 * @brief Check the dimensions of every registered unit.
+	 * @pre UnitVerify object exists.
+	 * @post Failures appended to the report.
+	 * @return Number of failures.
+	 */
+	int CheckDimensions();
+
+
+	/**
+	 * @brief Check the factor and dimension of every unit type of Quantity.h
+	 * 			against the registry.
+	 * @pre UnitVerify object exists.
+	 * @post Failures appended to the report.
+	 * @return Number of failures.
+	 */
+	int CheckQuantities();
+
+
+	/**
+	 * @brief Compile and evaluate a set of formulas with known results.
+	 * @pre UnitVerify object exists.
+	 * @post Failures appended to the report.
+	 * @return Number of failures.
+	 */
+	int CheckFormulas();
+
+
+	/**
+	 * @brief Convert with site units on several threads while the site units
+	 * 			are reloaded, alternating between two definitions files.
+	 * @pre UnitVerify object exists.  Temporary files may be created.
+	 * @post Failures appended to the report.
+	 * @return Number of failures.
+	 */
+	int CheckSnapshots();
+
+
+	/**
+	 * @brief Look up invalid unit strings through UnitPlanCache before the
+	 * 			valid strings they canonicalize to, and compare the plans then
+	 * 			found against ConvertValue().
+	 * @pre UnitVerify object exists.
+	 * @post Failures appended to the report.
+	 * @return Number of failures.
+	 */
+	int CheckPlanCache();
+
+
+	/**
+	 * @brief Convert NDJSON text containing malformed records and compare the
+	 * 			output and the count of malformed records with known results.
+	 * @pre UnitVerify object exists.
+	 * @post Failures appended to the report.
+	 * @return Number of failures.
+	 */
+	int CheckJson();
+
+
+	/**
+	 * @brief Run the parser over randomly generated and mutated unit strings.
+	 * @pre UnitVerify object exists.
+	 * @param iterations Number of strings to generate.
+	 * @param seed Seed for the random generator.
+	 * @post Failures appended to the report.
+	 * @return Number of failures.
+	 */
+	int CheckParser(size_t iterations, uint64_t seed);
+
+
+	/**
+	 * @brief Check the parser invariants for a single input.
+	 * @pre UnitVerify object exists.
+	 * @param data Pointer to the input bytes.
+	 * @param size Number of bytes.
+	 * @post Failure appended to the report, if any.
+	 * @return Number of failures (0 or 1).
+	 */
+	int FuzzOne(const uint8_t *data, size_t size);
+
+
+	/**
+	 * @brief Measure scalar and bulk conversion rates.
+	 * @pre UnitVerify object exists.
+	 * @param scalar Reference to contain the rate of single-value conversions
+	 * 			from unit strings, in values per second.
+	 * @param bulk Reference to contain the rate of array conversions with a
+	 * 			compiled plan, in values per second.
+	 * @post Rates measured.
+	 * @return None.
+	 */
+	void MeasureThroughput(double &scalar, double &bulk);
+
+
+	/**
+	 * @brief Compare measured rates against a baseline file.
+	 * @pre UnitVerify object exists.
+	 * @param filename Baseline file.
+	 * @param tolerance Allowed drop, in percent.
+	 * @param scalar Measured scalar rate.
+	 * @param bulk Measured bulk rate.
+	 * @post Results appended to the report.
+	 * @return Number of failures.  An unreadable baseline, each line which is
+	 * 			not a known name and a positive rate, and a missing rate count
+	 * 			as one each.
+	 */
+	int CheckBaseline(const std::string &filename, double tolerance,
+			double scalar, double bulk);
+
+
+	/**
+	 * @brief Write measured rates to a baseline file.
+	 * @pre UnitVerify object exists.
+	 * @param filename Baseline file.
+	 * @param scalar Measured scalar rate.
+	 * @param bulk Measured bulk rate.
+	 * @post File written.
+	 * @return Boolean value indicating success or failure.
+	 */
+	bool WriteBaseline(const std::string &filename, double scalar, double bulk) const;
+
+
+	/**
+	 * @brief Text describing each failure and measurement.
+	 * @pre UnitVerify object exists.
+	 * @post No changes to object.
+	 * @return Report.
+	 */
+	std::string Report() const;
+
+
+
+protected:
+	/** @brief Registry being checked */
+	const UnitRegistry &registry;
+
+	/** @brief Report text */
+	std::stringstream report;
+
+	/** @brief Values converted by the round-trip and transitivity checks */
+	std::vector<double> samples;
+
+
+	/**
+	 * @brief Unit string for a single registered unit.
+	 * @pre i < registry.NumUnits().
+	 * @param i Unit index.
+	 * @return Unit string "-:symbol:1".
+	 */
+	std::string UnitString(size_t i) const;
+
+
+	/**
+	 * @brief Compare two values to within VERIFY_TOLERANCE.
+	 * @param a First value.
+	 * @param b Second value.
+	 * @return Boolean value indicating agreement.
+	 */
+	static bool Close(double a, double b);
+
+
+	/**
+	 * @brief Check whether two registered units have matching dimensions.
+	 * @param i First unit index.
+	 * @param j Second unit index.
+	 * @return Boolean value indicating matching dimensions.
+	 */
+	bool SameDimension(size_t i, size_t j) const;
+
+
+	/**
+	 * @brief Next value of a xorshift generator.
+	 * @param state Reference to the generator state.  Updated.
+	 * @return Random 64-bit value.
+	 */
+	static uint64_t Random(uint64_t &state);
+
+
+	/**
+	 * @brief Generate a unit string which is usually, but not always, valid.
+	 * @param state Reference to the generator state.  Updated.
+	 * @return Unit string.
+	 */
+	std::string RandomUnits(uint64_t &state) const;
+
+};
+
+
+
+// ==== PUBLIC FUNCTIONS =======================================================
+
+UnitVerify::UnitVerify(const UnitRegistry &reg) : registry(reg)
+{
+	samples.push_back(0.0e0);
+	samples.push_back(1.0e0);
+	samples.push_back(-40.0e0);
+	samples.push_back(123.456e0);
+	samples.push_back(6.02e23);
+	samples.push_back(-1.6e-19);
+}
+
+
+int UnitVerify::CheckRoundTrip()
+{
+	int nfail = 0;
+	size_t nunits = registry.NumUnits();
+	for(size_t i=0; i<nunits; i++){
+		for(size_t j=0; j<nunits; j++){
+			if(!SameDimension(i,j)){
+				continue;
+			}
+
+			UnitResult< UnitPlan<double> > ab =
+					UnitPlan<double>::Create(registry,UnitString(i),UnitString(j));
+			UnitResult< UnitPlan<double> > ba =
+					UnitPlan<double>::Create(registry,UnitString(j),UnitString(i));
+			if(!ab.Ok() || !ba.Ok()){
+				report << "round trip: " << registry.Unit(i).symbol << " <-> " <<
+						registry.Unit(j).symbol << ": plan not built" << std::endl;
+				nfail++;
+				continue;
+			}
+
+			for(size_t k=0; k<samples.size(); k++){
+				double there = ab.Value().Convert(samples[k]);
+				if(!std::isfinite(there)){
+					continue;		/* OUTSIDE THE DOMAIN OF A LOGARITHMIC UNIT */
+				}
+				double back = ba.Value().Convert(there);
+				if(!Close(back,samples[k])){
+					report << "round trip: " << samples[k] << " " <<
+							registry.Unit(i).symbol << " -> " << registry.Unit(j).symbol <<
+							" -> " << back << std::endl;
+					nfail++;
+					break;
+				}
+			}
+		}
+	}
+	return nfail;
+}
+
+
+int UnitVerify::CheckTransitivity()
+{
+	int nfail = 0;
+	size_t nunits = registry.NumUnits();
+
+	/*
+	 * BUILD EVERY PLAN ONCE, INDEXED [i*nunits + j]
+	 */
+	std::vector< UnitPlan<double> > plans(nunits*nunits);
+	std::vector<char> valid(nunits*nunits,0);
+	for(size_t i=0; i<nunits; i++){
+		for(size_t j=0; j<nunits; j++){
+			if(!SameDimension(i,j)){
+				continue;
+			}
+			UnitResult< UnitPlan<double> > plan =
+					UnitPlan<double>::Create(registry,UnitString(i),UnitString(j));
+			if(plan.Ok()){
+				plans[i*nunits + j] = plan.Value();
+				valid[i*nunits + j] = 1;
+			}
+		}
+	}
+
+	for(size_t i=0; i<nunits; i++){
+		for(size_t j=0; j<nunits; j++){
+			if(!valid[i*nunits + j]){
+				continue;
+			}
+			for(size_t k=0; k<nunits; k++){
+				if(!valid[j*nunits + k] || !valid[i*nunits + k]){
+					continue;
+				}
+				for(size_t s=0; s<samples.size(); s++){
+					double ij = plans[i*nunits + j].Convert(samples[s]);
+					double viaj = plans[j*nunits + k].Convert(ij);
+					double direct = plans[i*nunits + k].Convert(samples[s]);
+					if(!std::isfinite(ij) || !std::isfinite(direct)){
+						continue;
+					}
+					if(!Close(viaj,direct)){
+						report << "transitivity: " << samples[s] << " " <<
+								registry.Unit(i).symbol << " -> " <<
+								registry.Unit(j).symbol << " -> " <<
+								registry.Unit(k).symbol << " = " << viaj <<
+								", direct = " << direct << std::endl;
+						nfail++;
+						break;
+					}
+				}
+			}
+		}
+	}
+	return nfail;
+}
+
+
+int UnitVerify::CheckDimensions()
+{
+	int nfail = 0;
+	size_t nunits = registry.NumUnits();
+	for(size_t i=0; i<nunits; i++){
+		const UnitDefinition &def = registry.Unit(i);
+
+		/*
+		 * UNIT COMPILES TO ITS LISTED DIMENSIONS AND FACTOR
+		 */
+		CompiledUnits cu;
+		if(cu.Compile(registry,UnitString(i)) != UNIT_OK){
+			report << "dimensions: " << def.symbol << " does not compile" << std::endl;
+			nfail++;
+			continue;
+		}
+		if(std::memcmp(cu.Dimensions(),def.dims,sizeof(def.dims)) != 0 ||
+				cu.Factor() != def.factor){
+			report << "dimensions: " << def.symbol << " compiles to " <<
+					UnitRegistry::DimensionString(cu.Dimensions()) << ", listed as " <<
+					UnitRegistry::DimensionString(def.dims) << std::endl;
+			nfail++;
+		}
+
+		/*
+		 * UNIT DIVIDED BY ITSELF IS DIMENSIONLESS WITH A FACTOR OF 1
+		 */
+		CompiledUnits ratio;
+		int zero[UNIT_NDIMS] = {0};
+		if(ratio.Compile(registry,UnitString(i) + "|-:" + def.symbol + ":-1") != UNIT_OK ||
+				std::memcmp(ratio.Dimensions(),zero,sizeof(zero)) != 0 ||
+				!Close(ratio.Factor(),1.0e0)){
+			report << "dimensions: " << def.symbol << "/" << def.symbol <<
+					" is not dimensionless" << std::endl;
+			nfail++;
+		}
+
+		/*
+		 * UNITS IN THE SAME CATEGORY AGREE AND OTHER DIMENSIONS ARE REJECTED
+		 */
+		for(size_t j=i+1; j<nunits; j++){
+			const UnitDefinition &other = registry.Unit(j);
+			if(other.category == def.category && !SameDimension(i,j)){
+				report << "dimensions: " << def.symbol << " and " << other.symbol <<
+						" are both listed as " << def.category <<
+						" but have different dimensions" << std::endl;
+				nfail++;
+			}
+			if(!SameDimension(i,j)){
+				UnitResult< UnitPlan<double> > plan =
+						UnitPlan<double>::Create(registry,UnitString(i),UnitString(j));
+				if(plan.Error() != UNIT_ERR_DIMENSION_MISMATCH){
+					report << "dimensions: " << def.symbol << " -> " << other.symbol <<
+							" not rejected" << std::endl;
+					nfail++;
+				}
+			}
+		}
+	}
+	return nfail;
+}
+
+
+int UnitVerify::CheckQuantities()
+{
+	struct Entry {
+		const char *name;
+		const char *units;
+		double factor;
+		int dims[UNIT_NDIMS];
+	};
+#define VERIFY_QUANTITY_ENTRY(name, str, f, L, M, T, K, N, A, Q) \
+		{#name, str, Q_##name::factor, {L, M, T, K, N, A, Q}},
+	static const Entry entries[] = { QUANTITY_UNITS(VERIFY_QUANTITY_ENTRY) };
+#undef VERIFY_QUANTITY_ENTRY
+
+	int nfail = 0;
+	for(size_t i=0; i<sizeof(entries)/sizeof(entries[0]); i++){
+		const Entry &e = entries[i];
+		CompiledUnits cu;
+		if(cu.Compile(registry,e.units) != UNIT_OK){
+			report << "quantities: Q_" << e.name << " (" << e.units <<
+					") does not compile" << std::endl;
+			nfail++;
+			continue;
+		}
+		if(std::memcmp(cu.Dimensions(),e.dims,sizeof(e.dims)) != 0 ||
+				!Close(cu.Factor(),e.factor)){
+			report << "quantities: Q_" << e.name << " is " << e.factor << " " <<
+					UnitRegistry::DimensionString(e.dims) << ", registry gives " <<
+					cu.Factor() << " " << UnitRegistry::DimensionString(cu.Dimensions()) <<
+					std::endl;
+			nfail++;
+		}
+	}
+	return nfail;
+}
+
+
+int UnitVerify::CheckFormulas()
+{
+	struct Case {
+		const char *formula;
+		const char *units;
+		UnitErrorCode err;
+		double result;
+	};
+	static const Case cases[] = {
+		{"force[lbf] * distance[ft]",		"-:J:1",	UNIT_OK,	1.3558179483314004},
+		{"mass[lbm] * gee",					"-:N:1",	UNIT_OK,	4.4482216152605},
+		{"3[ft]",							"-:m:1",	UNIT_OK,	0.9144},
+		{"-(-(2[in] + 1[ft]))",				"-:ft:1",	UNIT_OK,	14.0/12.0},
+		{"length[m] / distance[ft]",		"-",		UNIT_OK,	1.0/0.3048},
+		{"length[m] * 2",					"-",		UNIT_ERR_DIMENSION_MISMATCH,	0.0},
+		{"length[m] + length[ft]",			"-:m:1",	UNIT_ERR_COLUMN_UNITS,	0.0},
+		{"level[dB] * 2",					"-",		UNIT_ERR_LOG_MISUSE,	0.0},
+		{"density[API] * 2",				"k:g:1|-:m:-3",	UNIT_ERR_CURVE_MISUSE,	0.0}
+	};
+
+	int nfail = 0;
+	UnitFormula<double> formula(registry);
+	std::vector<double> ones(4,1.0e0);
+	std::vector<double> out(4);
+	std::vector<const double*> cols(8,ones.data());
+	for(size_t i=0; i<sizeof(cases)/sizeof(cases[0]); i++){
+		const Case &c = cases[i];
+		UnitErrorCode err = formula.Compile(c.formula,c.units);
+		if(err != c.err){
+			report << "formulas: '" << c.formula << "' to " << c.units << " gives '" <<
+					UnitErrorString(err) << "', expected '" << UnitErrorString(c.err) <<
+					"'" << std::endl;
+			nfail++;
+			continue;
+		}
+		if(err != UNIT_OK){
+			continue;
+		}
+
+
+		/*
+		 * EVERY COLUMN IS 1.  A FORMULA WITHOUT COLUMNS GETS NO COLUMN POINTERS.
+		 */
+		formula.Evaluate(formula.NumColumns() > 0 ? cols.data() : 0,out.data(),out.size());
+		for(size_t j=0; j<out.size(); j++){
+			if(!Close(out[j],c.result)){
+				report << "formulas: '" << c.formula << "' to " << c.units << " gives " <<
+						out[j] << ", expected " << c.result << std::endl;
+				nfail++;
+				break;
+			}
+		}
+	}
+
+
+	/*
+	 * NESTING BEYOND FORMULA_MAX_DEPTH IS A SYNTAX ERROR, NOT A STACK OVERFLOW
+	 */
+	const size_t deep[] = {FORMULA_MAX_DEPTH, 100000};
+	for(size_t i=0; i<2; i++){
+		std::string text = std::string(deep[i],'(') + "x[m]" + std::string(deep[i],')');
+		UnitErrorCode expected = deep[i] > FORMULA_MAX_DEPTH ? UNIT_ERR_SYNTAX : UNIT_OK;
+		UnitErrorCode err = formula.Compile(text,"-:m:1");
+		if(err != expected){
+			report << "formulas: " << deep[i] << " nested parentheses give '" <<
+					UnitErrorString(err) << "', expected '" << UnitErrorString(expected) <<
+					"'" << std::endl;
+			nfail++;
+		}
+		text = std::string(deep[i],'-') + "x[m]";
+		err = formula.Compile(text,"-:m:1");
+		if(err != expected){
+			report << "formulas: " << deep[i] << " unary minus signs give '" <<
+					UnitErrorString(err) << "', expected '" << UnitErrorString(expected) <<
+					"'" << std::endl;
+			nfail++;
+		}
+	}
+	return nfail;
+}
+
+
+int UnitVerify::CheckSnapshots()
+{
+	/*
+	 * TWO DEFINITIONS FILES GIVING THE SAME SITE UNIT FACTORS OF 2 AND 3
+	 */
+	std::string filenames[2];
+	for(int i=0; i<2; i++){
+		char name[] = "/tmp/unitverifyXXXXXX";
+		int fd = mkstemp(name);
+		if(fd < 0){
+			report << "snapshots: cannot create a temporary file" << std::endl;
+			return 1;
+		}
+		close(fd);
+		filenames[i] = name;
+		std::ofstream file(name);
+		file << "verify_site | site unit of the snapshot check | Length | " << (i + 2) <<
+				" -:m:1" << std::endl;
+	}
+
+	int nfail = 0;
+	UnitSnapshots snapshots;
+	if(!snapshots.Load(filenames[0])){
+		report << "snapshots: " << snapshots.Error() << std::endl;
+		nfail++;
+	}
+
+
+	/*
+	 * READERS CONVERT UNTIL THE RELOADS ARE DONE.  WITHIN ONE GUARD, TWO
+	 * CONVERSIONS MUST AGREE; ACROSS GUARDS, EITHER FACTOR IS ALLOWED.
+	 */
+	std::atomic<bool> done(false);
+	std::atomic<int> nbad(0);
+	std::atomic<size_t> nconverted(0);
+	std::vector<std::thread> readers;
+	for(int t=0; t<VERIFY_SNAPSHOT_READERS; t++){
+		readers.push_back(std::thread([&]{
+			while(!done.load()){
+				UnitSnapshots::Reader reader(snapshots);
+				UnitResult<double> first = ConvertValue<double>(reader.Registry(),1.0e0,
+						"-:verify_site:1","-:m:1");
+				UnitResult<double> second = ConvertValue<double>(reader.Registry(),1.0e0,
+						"-:verify_site:1","-:m:1");
+				if(!first.Ok() || !second.Ok() || first.Value() != second.Value() ||
+						(first.Value() != 2.0e0 && first.Value() != 3.0e0)){
+					nbad.fetch_add(1);
+				}
+				nconverted.fetch_add(1);
+			}
+		}));
+	}
+	for(int k=1; k<=VERIFY_SNAPSHOT_RELOADS; k++){
+		snapshots.LoadAsync(filenames[k % 2]);
+		if(!snapshots.Wait()){
+			report << "snapshots: " << snapshots.Error() << std::endl;
+			nfail++;
+			break;
+		}
+	}
+	done.store(true);
+	for(size_t t=0; t<readers.size(); t++){
+		readers[t].join();
+	}
+	if(nbad.load() > 0){
+		report << "snapshots: " << nbad.load() << " of " << nconverted.load() <<
+				" conversions during reloads were wrong" << std::endl;
+		nfail++;
+	}
+
+
+	/*
+	 * ONCE A LOAD HAS FINISHED, NEW READERS SEE ITS UNITS
+	 */
+	{
+		UnitSnapshots::Reader reader(snapshots);
+		UnitResult<double> last = ConvertValue<double>(reader.Registry(),1.0e0,
+				"-:verify_site:1","-:m:1");
+		double expected = (VERIFY_SNAPSHOT_RELOADS % 2 == 0) ? 2.0e0 : 3.0e0;
+		if(!last.Ok() || last.Value() != expected){
+			report << "snapshots: last load not seen by new readers" << std::endl;
+			nfail++;
+		}
+	}
+	unlink(filenames[0].c_str());
+	unlink(filenames[1].c_str());
+	return nfail;
+}
+
+
+int UnitVerify::CheckPlanCache()
+{
+	struct Case {
+		const char *invalid;
+		const char *valid;
+		const char *unitsout;
+		double value;
+		UnitErrorCode err;
+	};
+	static const Case cases[] = {
+		{"-:dBm:1|-:m:1|-:m:-1",	"-:dBm:1",	"-:dBW:1",	30.0,	UNIT_ERR_LOG_MISUSE},
+		{"-:dB:2|-:dB:-1",			"-:dB:1",	"-:dB:1",	3.0,	UNIT_ERR_LOG_MISUSE},
+		{"k:dBm:1|m:m:1|-:m:-1",	"-:dBm:1",	"-:dBW:1",	30.0,	UNIT_ERR_LOG_MISUSE},
+		{"-:API:1|-:m:1|-:m:-1",	"-:API:1",	"k:g:1|-:m:-3",	35.0,	UNIT_ERR_CURVE_MISUSE},
+		{"-:ga:1|-:ga:1|-:ga:-1",	"-:ga:1",	"-:in:1",	16.0,	UNIT_ERR_CURVE_MISUSE},
+		{"k:Be:1|m:sec:1|-:sec:-1",	"-:Be:1",	"k:g:1|-:m:-3",	20.0,	UNIT_ERR_CURVE_MISUSE}
+	};
+	const size_t ncases = sizeof(cases)/sizeof(cases[0]);
+
+
+	/*
+	 * EACH CASE USES A NEW CACHE, SO THE INVALID SPELLING IS SEEN FIRST.  IT
+	 * IS LOOKED UP AS BOTH INPUT AND OUTPUT.
+	 */
+	int nfail = 0;
+	for(size_t i=0; i<ncases; i++){
+		const Case &c = cases[i];
+		UnitPlanCache<double> cache(registry);
+		UnitPlan<double> plan;
+		UnitErrorCode errin = cache.Find(c.invalid,c.unitsout,plan);
+		UnitErrorCode errout = cache.Find(c.unitsout,c.invalid,plan);
+		if(errin != c.err || errout != c.err){
+			report << "plan cache: '" << c.invalid << "' gave '" <<
+					UnitErrorString(errin) << "' and '" << UnitErrorString(errout) <<
+					"', expected '" << UnitErrorString(c.err) << "'" << std::endl;
+			nfail++;
+		}
+
+		UnitErrorCode err = cache.Find(c.valid,c.unitsout,plan);
+		UnitResult<double> expected = ConvertValue<double>(registry,c.value,c.valid,
+				c.unitsout);
+		if(err != UNIT_OK || !expected.Ok() ||
+				!Close(plan.Convert(c.value),expected.Value())){
+			report << "plan cache: '" << c.valid << "' to '" << c.unitsout <<
+					"' wrong after looking up '" << c.invalid << "'" << std::endl;
+			nfail++;
+		}
+	}
+	return nfail;
+}
+
+
+int UnitVerify::CheckJson()
+{
+	/*
+	 * FIELD "d" IS CONVERTED FROM km TO m.  THE LONG KEY PUTS THE END OF A
+	 * TRUNCATED RECORD IN A LATER 64-BYTE BLOCK THAN ITS OPEN STRING.
+	 */
+	struct Case {
+		const char *in;
+		const char *out;
+		size_t nmalformed;
+	};
+	static const Case cases[] = {
+		{"{\"d\": 1, \"d_unit\": \"f\n{\"d\": 2, \"d_unit\": \"k:m:1\"}\n",
+		 "{\"d\": 1, \"d_unit\": \"f\n{\"d\": 2000, \"d_unit\": \"m\"}\n",	1},
+		{"{\"d\": 1, \"d_unit\": \"k:m:1\"\n{\"d\": 2, \"d_unit\": \"k:m:1\"}\n",
+		 "{\"d\": 1, \"d_unit\": \"k:m:1\"\n{\"d\": 2000, \"d_unit\": \"m\"}\n",	1},
+		{"{\"s\": \"a\\\"\n{\"d\": 2, \"d_unit\": \"k:m:1\"}\n",
+		 "{\"s\": \"a\\\"\n{\"d\": 2000, \"d_unit\": \"m\"}\n",	1},
+		{"{\"d\": 1, \"a_very_long_key_that_runs_past_the_end_of_the_first_block\n"
+		 "{\"d\": 2, \"d_unit\": \"k:m:1\"}\n{\"d\": 3, \"d_unit\": \"k:m:1\"}",
+		 "{\"d\": 1, \"a_very_long_key_that_runs_past_the_end_of_the_first_block\n"
+		 "{\"d\": 2000, \"d_unit\": \"m\"}\n{\"d\": 3000, \"d_unit\": \"m\"}",	1},
+		{"{\"d\": 2, \"d_unit\": \"k:m:1\"}\n{\"d\": 3, \"d_un",
+		 "{\"d\": 2000, \"d_unit\": \"m\"}\n{\"d\": 3, \"d_un",	1}
+	};
+	const size_t ncases = sizeof(cases)/sizeof(cases[0]);
+
+	int nfail = 0;
+	for(size_t i=0; i<ncases; i++){
+		UnitJson json(registry);
+		json.AddField("d","m");
+		std::string in(cases[i].in);
+		std::vector<char> out;
+		json.Convert(in.data(),in.size(),out);
+		std::string result(out.begin(),out.end());
+		if(result != cases[i].out || json.NumMalformed() != cases[i].nmalformed){
+			report << "json: case " << i << " gave " << json.NumMalformed() <<
+					" malformed records and '" << result << "'" << std::endl;
+			nfail++;
+		}
+	}
+	return nfail;
+}
+
+
+int UnitVerify::CheckParser(size_t iterations, uint64_t seed)
+{
+	int nfail = 0;
+	uint64_t state = seed ? seed : 1;
+	for(size_t n=0; n<iterations; n++){
+		std::string units = RandomUnits(state);
+		nfail += FuzzOne((const uint8_t*)units.data(),units.size());
+	}
+	return nfail;
+}
+
+
+int UnitVerify::FuzzOne(const uint8_t *data, size_t size)
+{
+	std::string units((const char*)data,size);
+
+	/*
+	 * THE PLAIN AND CANONICAL PARSERS AGREE ON VALIDITY, COUNTING A MISUSED
+	 * LOGARITHMIC OR NON-LINEAR UNIT AS INVALID.  THE CANONICAL PARSER ALSO LIMITS THE
+	 * NUMBER OF DISTINCT UNITS.
+	 */
+	CompiledUnits cu;
+	CanonicalUnits canonical;
+	UnitErrorCode errplain = cu.Compile(registry,units);
+	if(errplain == UNIT_OK && cu.HasLogUnits() && !cu.IsLogarithmic()){
+		errplain = UNIT_ERR_LOG_MISUSE;
+	} else if(errplain == UNIT_OK && cu.HasCurveUnits() && !cu.IsCurve()){
+		errplain = UNIT_ERR_CURVE_MISUSE;
+	}
+	UnitErrorCode errcanonical = canonical.Canonicalize(registry,units);
+	if((errplain == UNIT_OK) != (errcanonical == UNIT_OK) &&
+			errcanonical != UNIT_ERR_TOO_MANY_TERMS){
+		report << "parser: '" << units << "' compiles with '" <<
+				UnitErrorString(errplain) << "' but canonicalizes with '" <<
+				UnitErrorString(errcanonical) << "'" << std::endl;
+		return 1;
+	}
+	if(errplain != UNIT_OK){
+		return 0;
+	}
+
+	/*
+	 * THE TEXT OF A VALID UNIT STRING COMPILES TO THE SAME UNITS
+	 */
+	CompiledUnits again;
+	if(again.Compile(registry,cu.Text()) != UNIT_OK ||
+			!again.SameDimension(cu) || !Close(again.Factor(),cu.Factor()) ||
+			again.Offset() != cu.Offset()){
+		report << "parser: '" << units << "' does not survive a round trip through '" <<
+				cu.Text() << "'" << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+
+void UnitVerify::MeasureThroughput(double &scalar, double &bulk)
+{
+	const char *unitsin = "k:m:1|-:sec:-1";
+	const char *unitsout = "-:mile:1|-:hr:-1";
+
+	/*
+	 * SCALAR: ONE VALUE AT A TIME FROM UNIT STRINGS, AS THE COMMAND LINE DOES.
+	 * THE SUM KEEPS THE COMPILER FROM DISCARDING THE CONVERSIONS.
+	 */
+	double best = 0.0e0;
+	double sum = 0.0e0;
+	for(int s=0; s<VERIFY_SAMPLES; s++){
+		double t0 = omp_get_wtime();
+		for(int i=0; i<VERIFY_SCALAR_VALUES; i++){
+			UnitResult<double> r = ConvertValue<double>(registry,(double)i,unitsin,unitsout);
+			sum += r.Value();
+		}
+		double rate = (double)VERIFY_SCALAR_VALUES/(omp_get_wtime() - t0);
+		best = std::max(best,rate);
+	}
+	scalar = best;
+
+
+	/*
+	 * BULK: ONE COMPILED PLAN APPLIED TO AN ARRAY
+	 */
+	UnitPlan<double> plan = UnitPlan<double>::Create(registry,unitsin,unitsout).Value();
+	std::vector<double> in(VERIFY_BULK_VALUES);
+	std::vector<double> out(VERIFY_BULK_VALUES);
+	for(size_t i=0; i<in.size(); i++){
+		in[i] = (double)i;
+	}
+	best = 0.0e0;
+	for(int s=0; s<VERIFY_SAMPLES; s++){
+		double t0 = omp_get_wtime();
+		plan.Convert(&in[0],&out[0],in.size());
+		double rate = (double)in.size()/(omp_get_wtime() - t0);
+		sum += out[s];
+		best = std::max(best,rate);
+	}
+	bulk = best;
+
+	volatile double sink = sum;
+	(void)sink;
+
+	report << "throughput: scalar " << scalar << " values/s, bulk " << bulk <<
+			" values/s" << std::endl;
+}
+
+
+int UnitVerify::CheckBaseline(const std::string &filename, double tolerance,
+		double scalar, double bulk)
+{
+	std::ifstream file(filename.c_str());
+	if(!file){
+		report << "baseline: cannot read " << filename << std::endl;
+		return 1;
+	}
+
+	/*
+	 * EVERY LINE MUST BE A KNOWN NAME AND A POSITIVE RATE, AND EVERY RATE MUST
+	 * BE GIVEN, SO THAT A DAMAGED FILE CANNOT PASS
+	 */
+	int nfail = 0;
+	bool havescalar = false;
+	bool havebulk = false;
+	size_t nline = 0;
+	std::string line;
+	while(std::getline(file,line)){
+		nline++;
+		if(line.empty() || line[0] == '#'){
+			continue;
+		}
+		std::stringstream sstmp(line);
+		std::string name;
+		std::string extra;
+		double expected = 0.0e0;
+		if(!(sstmp >> name >> expected) || (sstmp >> extra) ||
+				(name != "scalar" && name != "bulk") || !(expected > 0.0e0) ||
+				!std::isfinite(expected)){
+			report << "baseline: " << filename << ":" << nline << ": expected "
+					"'scalar' or 'bulk' and a positive rate" << std::endl;
+			nfail++;
+			continue;
+		}
+
+		double measured = 0.0e0;
+		if(name == "scalar"){
+			measured = scalar;
+			havescalar = true;
+		} else {
+			measured = bulk;
+			havebulk = true;
+		}
+
+		double change = 100.0e0*(measured - expected)/expected;
+		report << "baseline: " << name << " " << change << "% vs " << expected <<
+				" values/s";
+		if(change < -tolerance){
+			report << " (more than " << tolerance << "% slower)";
+			nfail++;
+		}
+		report << std::endl;
+	}
+	if(!havescalar){
+		report << "baseline: " << filename << " has no scalar rate" << std::endl;
+		nfail++;
+	}
+	if(!havebulk){
+		report << "baseline: " << filename << " has no bulk rate" << std::endl;
+		nfail++;
+	}
+	return nfail;
+}
+
+
+bool UnitVerify::WriteBaseline(const std::string &filename, double scalar, double bulk) const
+{
+	std::ofstream file(filename.c_str());
+	if(!file){
+		return false;
+	}
+	file << "# UnitConvert throughput baseline, values per second" << std::endl;
+	file << "scalar " << scalar << std::endl;
+	file << "bulk " << bulk << std::endl;
+	return (bool)file;
+}
+
+
+std::string UnitVerify::Report() const
+{
+	return report.str();
+}
+
+
+
+// ==== PROTECTED FUNCTIONS ====================================================
+
+std::string UnitVerify::UnitString(size_t i) const
+{
+	return "-:" + registry.Unit(i).symbol + ":1";
+}
+
+
+bool UnitVerify::Close(double a, double b)
+{
+	if(a == b){
+		return true;
+	}
+	double scale = std::max(1.0e0,std::max(std::fabs(a),std::fabs(b)));
+	return std::fabs(a - b) <= VERIFY_TOLERANCE*scale;
+}
+
+
+bool UnitVerify::SameDimension(size_t i, size_t j) const
+{
+	return std::memcmp(registry.Unit(i).dims,registry.Unit(j).dims,
+			sizeof(registry.Unit(i).dims)) == 0;
+}
+
+
+uint64_t UnitVerify::Random(uint64_t &state)
+{
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+
+std::string UnitVerify::RandomUnits(uint64_t &state) const
+{
+	static const char *prefixes[] = {"-", "", "k", "m", "M", "u", "G", "x", "kk"};
+	static const char *powers[] = {"1", "-1", "2", "0", "-3", "+1", "1.5", "",
+			"a", "99999999999"};
+	static const char noise[] = ":|-+ 0123456789abcXYZ\t.";
+
+	/*
+	 * BUILD A STRING FROM REGISTERED UNITS, PREFIXES, AND POWERS
+	 */
+	std::string units;
+	int nterms = (int)(Random(state) % 6);
+	for(int t=0; t<nterms; t++){
+		if(t > 0){
+			units += "|";
+		}
+		units += prefixes[Random(state) % (sizeof(prefixes)/sizeof(prefixes[0]))];
+		units += ":";
+		if(Random(state) % 8 == 0){
+			units += "nounit";
+		} else {
+			units += registry.Unit(Random(state) % registry.NumUnits()).symbol;
+		}
+		units += ":";
+		units += powers[Random(state) % (sizeof(powers)/sizeof(powers[0]))];
+	}
+
+
+	/*
+	 * MUTATE IT: INSERT, DELETE, OR OVERWRITE CHARACTERS
+	 */
+	int nmutations = (int)(Random(state) % 4);
+	for(int m=0; m<nmutations; m++){
+		size_t pos = units.empty() ? 0 : (size_t)(Random(state) % (units.size() + 1));
+		char c = noise[Random(state) % (sizeof(noise) - 1)];
+		switch(Random(state) % 3){
+		case 0:
+			units.insert(pos,1,c);
+			break;
+		case 1:
+			if(pos < units.size()){
+				units.erase(pos,1);
+			}
+			break;
+		default:
+			if(pos < units.size()){
+				units[pos] = c;
+			}
+			break;
+		}
+	}
+	return units;
+}
+
+
+#endif /* UnitVerify_ */
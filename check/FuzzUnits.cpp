@@ -0,0 +1,78 @@
+/**
+ * @file FuzzUnits.cpp
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * libFuzzer target for the unit-string parsers.  Each input is passed to
+ * UnitVerify::FuzzOne(), which checks that the plain and canonical parsers
+ * agree on validity and that valid strings survive a round trip through
+ * Text().  A failed check prints the report and aborts so that the fuzzer
+ * keeps the input.  Built with clang, e.g.
+ *
+ * 	clang++ -std=c++17 -O1 -g -fopenmp -fsanitize=fuzzer,address -I.. \
+ * 		FuzzUnits.cpp -o FuzzUnits
+ * 	./FuzzUnits -max_len=256 corpus/
+ *
+ * All functions contained within this file are intended for use with the
+ * clang C++ compiler, which provides libFuzzer.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+
+#include <cstdlib>
+#include <iostream>
+#include "../UnitVerify.h"
+
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	/*
+	 * ONE REGISTRY FOR THE WHOLE RUN; A NEW UnitVerify FOR EACH INPUT SO THAT
+	 * THE REPORT HOLDS ONLY THE FAILURE OF THIS INPUT
+	 */
+	static const UnitRegistry registry;
+	UnitVerify verify(registry);
+	if(verify.FuzzOne(data,size) != 0){
+		std::cerr << verify.Report();
+		std::abort();
+	}
+	return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file QuantityCodegen.cpp
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Kernels written once with Quantity.h and once with plain doubles.  The
+ * script quantity.sh compiles this file and checks that each pair
+ * disassembles to the same instructions, i.e. that the unit types cost
+ * nothing at run time.  Each Quantity kernel is named q_<kernel> and its
+ * double counterpart raw_<kernel>; the functions have C linkage so the names
+ * are not mangled.
+ *
+ * All functions contained within this file are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+
+#include "../Quantity.h"
+
+
+typedef QuantityOf<Q_kg> Mass;
+typedef QuantityOf<Q_m> Length;
+typedef QuantityOf<Q_sec> Time;
+typedef decltype(Length()/(Time()*Time())) Acceleration;
+
+
+
+// ==== KINETIC ENERGY =========================================================
+
+extern "C" double raw_kinetic_energy(double m, double v)
+{
+	return 0.5*m*v*v;
+}
+
+
+extern "C" double q_kinetic_energy(double m, double v)
+{
+	Mass mass(m);
+	decltype(Length()/Time()) speed(v);
+	QuantityOf<Q_J> energy = 0.5*mass*speed*speed;
+	return energy.Value();
+}
+
+
+
+// ==== PSI TO KPA =============================================================
+
+extern "C" double raw_psi_to_kpa(double p)
+{
+	return p*(6894.7572931683613/1000.0);
+}
+
+
+extern "C" double q_psi_to_kpa(double p)
+{
+	QuantityOf<Q_kPa> pressure = QuantityOf<Q_psi>(p);
+	return pressure.Value();
+}
+
+
+
+// ==== F = M*A OVER ARRAYS ====================================================
+
+extern "C" void raw_force(const double *m, const double *a, double *f, int n)
+{
+	for(int i=0; i<n; i++){
+		f[i] = m[i]*a[i];
+	}
+}
+
+
+extern "C" void q_force(const Mass *m, const Acceleration *a, QuantityOf<Q_N> *f, int n)
+{
+	for(int i=0; i<n; i++){
+		f[i] = m[i]*a[i];
+	}
+}
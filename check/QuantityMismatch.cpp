@@ -0,0 +1,87 @@
+/**
+ * @file QuantityMismatch.cpp
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Code which must not compile.  Each QUANTITY_MISMATCH_<n> mixes dimensions
+ * in one way; quantity.sh compiles the file once with no case selected (which
+ * must succeed) and once for each case (which must fail).
+ *
+ * All functions contained within this file are intended for use with the GNU
+ * C++ compiler (g++).  Use with other compilers may produce unexpected results
+ * and such use is at the users' own risk.
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+
+#include "../Quantity.h"
+
+
+double Mismatch(double x)
+{
+	QuantityOf<Q_ft> length(x);
+	QuantityOf<Q_sec> time(x);
+	QuantityOf<Q_lbf> force(x);
+	QuantityOf<Q_psi> pressure(x);
+	QuantityOf<Q_ft> sum = length + QuantityOf<Q_in>(x);
+
+#if defined(QUANTITY_MISMATCH_1)
+	/* LENGTH PLUS TIME */
+	sum = length + time;
+#elif defined(QUANTITY_MISMATCH_2)
+	/* FORCE ASSIGNED TO PRESSURE */
+	pressure = force;
+#elif defined(QUANTITY_MISMATCH_3)
+	/* LENGTH COMPARED WITH TIME */
+	if(length < time){ sum = length; }
+#elif defined(QUANTITY_MISMATCH_4)
+	/* FORCE PER LENGTH CONVERTED TO PRESSURE */
+	pressure = force/length;
+#elif defined(QUANTITY_MISMATCH_5)
+	/* PLAIN NUMBER CONVERTED IMPLICITLY */
+	length = x;
+#elif defined(QUANTITY_MISMATCH_6)
+	/* LENGTH VALUE READ AS TIME */
+	x = length.In<Q_sec>();
+#endif
+
+	return sum.Value() + time.Value() + force.Value() + pressure.Value();
+}
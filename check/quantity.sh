@@ -0,0 +1,72 @@
+#!/bin/bash
+#
+# THIS SCRIPT CHECKS THE TWO PROMISES OF QUANTITY.H WHICH THE "check" OPTION
+# OF THE PROGRAM CANNOT:
+#	1.	CODE WRITTEN WITH QUANTITY TYPES COMPILES TO THE SAME INSTRUCTIONS AS
+#		THE SAME CODE WRITTEN WITH DOUBLES (QuantityCodegen.cpp), AND
+#	2.	CODE WHICH MIXES DIMENSIONS DOES NOT COMPILE (QuantityMismatch.cpp).
+# RUN IT FROM ANY DIRECTORY, NEXT TO "UnitConvert check".  EXIT STATUS IS THE
+# NUMBER OF FAILURES.  THE COMPILER AND FLAGS MAY BE SET WITH CXX AND
+# CXXFLAGS.
+#
+#
+
+# DEFINE THE COMPILER, FLAGS, AND THE DIRECTORY HOLDING THE SOURCE FILES
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:-"-std=c++17 -O2"}
+SRCDIR=$(cd "$(dirname "$0")" && pwd)
+
+# DEFINE THE KERNELS IN QuantityCodegen.cpp AND THE NUMBER OF MISMATCH CASES
+KERNELS="kinetic_energy psi_to_kpa force"
+NMISMATCH=6
+
+# CREATE A TEMPORARY DIRECTORY, REMOVED ON EXIT
+TMPDIR=$(mktemp -d)
+trap 'rm -rf "$TMPDIR"' EXIT
+NFAIL=0
+
+# PRINT THE INSTRUCTIONS OF ONE FUNCTION WITHOUT ADDRESSES.  JUMP TARGETS ARE
+# WRITTEN RELATIVE TO THE FUNCTION NAME, WHICH IS REPLACED SO THAT THE TWO
+# VERSIONS COMPARE EQUAL.  ALIGNMENT PADDING AFTER THE LAST INSTRUCTION IS
+# DROPPED.
+disassemble()
+{
+	objdump -d --no-show-raw-insn --no-addresses "$TMPDIR/codegen.o" | \
+		awk -v fn="<$1>:" '$0 == fn {p = 1; next} p && /^$/ {exit} p' | \
+		sed -e "s/<$1\([+>]\)/<FN\1/g" -e 's/ *#.*$//' | \
+		grep -v -E '^\s*(nop|xchg +%ax,%ax|data16|cs nop)'
+}
+
+# 1. COMPARE THE DISASSEMBLY OF EACH PAIR OF KERNELS
+if ! $CXX $CXXFLAGS -c "$SRCDIR/QuantityCodegen.cpp" -o "$TMPDIR/codegen.o"; then
+	echo "codegen: QuantityCodegen.cpp does not compile"
+	exit 1
+fi
+for KERNEL in $KERNELS; do
+	disassemble "raw_$KERNEL" > "$TMPDIR/raw.s"
+	disassemble "q_$KERNEL" > "$TMPDIR/q.s"
+	if [ ! -s "$TMPDIR/raw.s" ]; then
+		echo "codegen: $KERNEL not found"
+		NFAIL=$((NFAIL + 1))
+	elif ! diff "$TMPDIR/raw.s" "$TMPDIR/q.s" > "$TMPDIR/diff.txt"; then
+		echo "codegen: $KERNEL differs (< double, > Quantity)"
+		cat "$TMPDIR/diff.txt"
+		NFAIL=$((NFAIL + 1))
+	fi
+done
+
+# 2. THE MISMATCH FILE COMPILES WITH NO CASE SELECTED, AND FAILS FOR EACH CASE
+if ! $CXX $CXXFLAGS -fsyntax-only "$SRCDIR/QuantityMismatch.cpp"; then
+	echo "mismatch: QuantityMismatch.cpp does not compile without a case"
+	NFAIL=$((NFAIL + 1))
+fi
+for ((N = 1; N <= NMISMATCH; N++)); do
+	if $CXX $CXXFLAGS -fsyntax-only -DQUANTITY_MISMATCH_$N \
+			"$SRCDIR/QuantityMismatch.cpp" 2> /dev/null; then
+		echo "mismatch: case $N compiles"
+		NFAIL=$((NFAIL + 1))
+	fi
+done
+
+echo "$NFAIL failures"
+exit $NFAIL
@@ -18,6 +18,35 @@
  * @date 23 June 2011
  *	- Creation date.
  *
+ * @date 18 October 2026
+ *	- Command-line conversion reports invalid values and unit strings and
+ *	  returns a non-zero exit status.
+ *	- Added "check" option to run the self-checks in UnitVerify.h.
+ *	- Added "arrow" option to convert columns of Arrow IPC files when compiled
+ *	  with UNITCONVERT_WITH_ARROW.
+ *	- Added "stream" option to convert delimited text, optionally compressed,
+ *	  with a multi-threaded pipeline.
+ *	- "stream" accepts "direct" to bypass the page cache for regular files.
+ *	- Added "json" option to convert fields of NDJSON records.
+ *	- Added "shard" option to convert a large file with worker processes.
+ *	- Added "bench" option to run the microbenchmarks in UnitBench.h.
+ *	- Added "shm" option to serve conversions through shared memory.
+ *	- "help" and command-line conversion include the site units of the file
+ *	  named by the UNITCONVERT_UNITS environment variable.
+ *	- "stream" accepts "--follow" to keep converting lines appended to the
+ *	  input.
+ *	- Command-line conversion accepts units in conventional notation (e.g.
+ *	  "km/h").
+ *	- "stream", "shard", and command-line conversion accept "duration" as the
+ *	  input units and "iso" or "clock" as the output units, to read and write
+ *	  ISO 8601 durations and clock times.
+ *	- "stream", "shard", and "json" include the site units, and
+ *	  "stream --follow" reloads them on SIGHUP.
+ *	- "json" reports malformed records and returns a non-zero exit status.
+ *	- "stream" and "shard" accept unit symbols as well as unit strings.
+ *	- "stream", "shard", and "json" accept units in conventional notation,
+ *	  through the same UnitNotation::Expand() as command-line conversion.
+ *
  *
  *
  *
@@ -70,6 +99,18 @@ using namespace std;
 #include <glibmm/exception.h>
 #include <gtkmm.h>
 #include "GUIUnitConvert.h"
+#include "UnitVerify.h"
+#include "UnitStream.h"
+#include "UnitShard.h"
+#include "UnitBench.h"
+#include "UnitShm.h"
+#include "UnitSnapshots.h"
+#include "UnitFollow.h"
+#include "UnitNotation.h"
+#include "UnitDuration.h"
+#ifdef UNITCONVERT_WITH_ARROW
+#include "UnitArrow.h"
+#endif
 
 /*
  * INCLUDE STRING-DEFINITION OF GUI.  THIS IS BASED ON THE GLADE-GENERATED FILE
@@ -81,6 +122,101 @@ using namespace std;
 #include "ui/interface.ui"
 
 
+/*
+ * SHARED-MEMORY SERVER AND FOLLOWER STOPPED BY SIGINT AND SIGTERM.  THE
+ * FOLLOWER RELOADS THE SITE UNITS ON SIGHUP.
+ */
+static UnitShmServer *shmserver = 0;
+static UnitFollow *follower = 0;
+
+static void StopShmServer(int)
+{
+	if(shmserver){
+		shmserver->Stop();
+	}
+}
+
+static void StopFollower(int)
+{
+	if(follower){
+		follower->Stop();
+	}
+}
+
+static void ReloadFollower(int)
+{
+	if(follower){
+		follower->Reload();
+	}
+}
+
+
+/*
+ * ADD THE SITE UNITS OF THE FILE NAMED BY UNITCONVERT_UNITS, IF SET
+ */
+static bool LoadSiteUnits(UnitRegistry &reg)
+{
+	std::string filename = SiteUnitsFile();
+	if(filename.empty()){
+		return true;
+	}
+	std::ifstream file(filename.c_str());
+	if(!file){
+		std::cerr << "ERROR: cannot open " << filename << std::endl;
+		return false;
+	}
+	size_t line = 0;
+	UnitErrorCode err = LoadUnitDefinitions(reg,file,line);
+	if(err != UNIT_OK){
+		std::cerr << "ERROR: " << filename << ":" << line << ": " << UnitErrorString(err) << std::endl;
+		return false;
+	}
+	return true;
+}
+
+
+/*
+ * SET THE UNITS OF A STREAM.  "duration" AS THE INPUT UNITS READS DURATIONS
+ * (PT1H30M12.5S, 01:23:45.678) AS SECONDS; "iso" OR "clock" AS THE OUTPUT
+ * UNITS WRITES SECONDS AS DURATIONS.  OTHER UNITS MAY BE UNIT STRINGS, UNIT
+ * SYMBOLS ("sec"), OR CONVENTIONAL NOTATION ("km/h"), SEE UnitNotation::Expand().
+ */
+static UnitDurationFormat DurationFormat(const std::string &units)
+{
+	if(units == "iso"){
+		return UNITDURATION_ISO;
+	}
+	if(units == "clock"){
+		return UNITDURATION_CLOCK;
+	}
+	return UNITDURATION_NONE;
+}
+
+static UnitErrorCode SetStreamUnits(UnitStream &stream, const UnitRegistry &reg,
+		const std::string &unitsin, const std::string &unitsout)
+{
+	bool durationin = (unitsin == "duration");
+	UnitDurationFormat durationout = DurationFormat(unitsout);
+	std::string expandedin("-:sec:1");
+	std::string expandedout("-:sec:1");
+	UnitNotation notation(reg);
+	UnitErrorCode err = UNIT_OK;
+	if(!durationin){
+		err = notation.Expand(unitsin,expandedin);
+	}
+	if(err == UNIT_OK && durationout == UNITDURATION_NONE){
+		err = notation.Expand(unitsout,expandedout);
+	}
+	if(err == UNIT_OK){
+		err = stream.SetUnits(expandedin,expandedout);
+	}
+	if(err == UNIT_OK){
+		stream.SetDurations(durationin,durationout);
+	}
+	return err;
+}
+
+
 int main(int argc, char *argv[])
 {
 	/*
@@ -89,6 +225,284 @@ int main(int argc, char *argv[])
 	if(!Glib::thread_supported()) Glib::thread_init();
 	//Glib::init();
 
+	/*
+	 * RUN SELF-CHECKS WITHOUT THE GUI.  EXIT STATUS IS NON-ZERO IF ANY CHECK
+	 * FAILS.  EXPECTED SYNTAX:
+	 *   ./program check
+	 *   ./program check baseline_file [tolerance_percent]
+	 *   ./program check baseline_file write
+	 */
+	if(argc >= 2 && argc <= 4 && std::string(argv[1]) == "check"){
+		UnitRegistry reg;
+		UnitVerify verify(reg);
+		int nfail = 0;
+		nfail += verify.CheckDimensions();
+		nfail += verify.CheckQuantities();
+		nfail += verify.CheckFormulas();
+		nfail += verify.CheckSnapshots();
+		nfail += verify.CheckPlanCache();
+		nfail += verify.CheckJson();
+		nfail += verify.CheckRoundTrip();
+		nfail += verify.CheckTransitivity();
+		nfail += verify.CheckParser(100000,1);
+
+		if(argc >= 3){
+			double scalar = 0.0e0;
+			double bulk = 0.0e0;
+			verify.MeasureThroughput(scalar,bulk);
+			if(argc == 4 && std::string(argv[3]) == "write"){
+				if(!verify.WriteBaseline(argv[2],scalar,bulk)){
+					std::cout << "ERROR: cannot write " << argv[2] << std::endl;
+					nfail++;
+				}
+			} else {
+				double tolerance = 10.0e0;
+				if(argc == 4){
+					char *end = 0;
+					tolerance = strtod(argv[3],&end);
+					if(end == argv[3] || *end != '\0'){
+						std::cout << "ERROR: tolerance must be a number" << std::endl;
+						return 1;
+					}
+				}
+				nfail += verify.CheckBaseline(argv[2],tolerance,scalar,bulk);
+			}
+		}
+
+		std::cout << verify.Report();
+		std::cout << nfail << " failures" << std::endl;
+		return nfail > 0 ? 1 : 0;
+	}
+
+	/*
+	 * RUN THE MICROBENCHMARKS WITHOUT THE GUI.  ALSO USED AS THE TRAINING RUN
+	 * OF A PROFILE-GUIDED BUILD.  EXPECTED SYNTAX:
+	 *   ./program bench [repeats]
+	 */
+	if(argc >= 2 && argc <= 3 && std::string(argv[1]) == "bench"){
+		UnitRegistry reg;
+		UnitBench bench(reg);
+		bench.Run(argc == 3 ? atoi(argv[2]) : 20);
+		std::cout << bench.Report();
+		return 0;
+	}
+
+	/*
+	 * CONVERT DELIMITED TEXT, OPTIONALLY gzip OR zstd COMPRESSED, WITHOUT THE
+	 * GUI.  'column' COUNTS FROM 1; 0 CONVERTS EVERY NUMERIC FIELD.  FILES
+	 * DEFAULT TO STANDARD INPUT AND OUTPUT.  "--follow" KEEPS CONVERTING LINES
+	 * APPENDED TO file_in UNTIL INTERRUPTED, APPENDING TO file_out AND SAVING
+	 * ITS POSITION IN state_file; SIGHUP THEN RELOADS THE SITE UNITS.  units_in
+	 * MAY BE "duration" AND units_out "iso" OR "clock" (SEE SetStreamUnits()).
+	 * EXPECTED SYNTAX:
+	 *   ./program stream units_in units_out [column [file_in [file_out [direct]]]]
+	 *   ./program stream units_in units_out column file_in file_out --follow [state_file]
+	 */
+	if(argc >= 4 && argc <= 9 && std::string(argv[1]) == "stream"){
+		UnitRegistry reg;
+		if(!LoadSiteUnits(reg)){
+			return 1;
+		}
+		UnitStream stream(reg);
+		UnitErrorCode err = SetStreamUnits(stream,reg,argv[2],argv[3]);
+		if(err != UNIT_OK){
+			std::cerr << "ERROR: " << UnitErrorString(err) << std::endl;
+			return 1;
+		}
+		if(argc >= 5){
+			stream.SetColumn(atoi(argv[4]));
+		}
+		if(argc >= 8 && std::string(argv[7]) == "--follow"){
+			UnitSnapshots snapshots;
+			UnitFollow follow(stream);
+			if(argc == 9){
+				follow.SetStateFile(argv[8]);
+			}
+			follow.SetReload(&snapshots,SiteUnitsFile());
+			follower = &follow;
+			signal(SIGINT,StopFollower);
+			signal(SIGTERM,StopFollower);
+			signal(SIGHUP,ReloadFollower);
+			bool ok = follow.Run(argv[5],argv[6]);
+			signal(SIGHUP,SIG_DFL);
+			follower = 0;
+			if(!ok){
+				std::cerr << "ERROR: " << follow.Error() << std::endl;
+				return 1;
+			}
+			return 0;
+		}
+		if(argc == 9){
+			std::cerr << "ERROR: unknown option " << argv[8] << std::endl;
+			return 1;
+		}
+		if(argc >= 8){
+			if(std::string(argv[7]) != "direct"){
+				std::cerr << "ERROR: unknown option " << argv[7] << std::endl;
+				return 1;
+			}
+			stream.SetDirect(true);
+		}
+
+		if(!stream.Run(argc >= 6 ? argv[5] : "-",argc >= 7 ? argv[6] : "-")){
+			std::cerr << "ERROR: " << stream.Error() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
+	/*
+	 * CONVERT A LARGE UNCOMPRESSED FILE OF DELIMITED TEXT WITH A POOL OF
+	 * WORKER PROCESSES.  'workers' OF 0 USES ONE PER PROCESSOR.  EXPECTED
+	 * SYNTAX:
+	 *   ./program shard workers units_in units_out column file_in file_out
+	 */
+	if(argc == 8 && std::string(argv[1]) == "shard"){
+		UnitRegistry reg;
+		if(!LoadSiteUnits(reg)){
+			return 1;
+		}
+		UnitStream stream(reg);
+		UnitErrorCode err = SetStreamUnits(stream,reg,argv[3],argv[4]);
+		if(err != UNIT_OK){
+			std::cerr << "ERROR: " << UnitErrorString(err) << std::endl;
+			return 1;
+		}
+		stream.SetColumn(atoi(argv[5]));
+
+		UnitShard shard(stream);
+		shard.SetWorkers(atoi(argv[2]));
+		if(!shard.Run(argv[6],argv[7])){
+			std::cerr << "ERROR: " << shard.Error() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
+	/*
+	 * CONVERT FIELDS OF NDJSON RECORDS, OPTIONALLY gzip OR zstd COMPRESSED.
+	 * EACH RECORD GIVES THE UNITS OF FIELD 'name' IN FIELD 'name_unit';
+	 * 'units_in' IS ASSUMED WHERE IT DOES NOT.  FILES MAY BE "-" FOR STANDARD
+	 * INPUT AND OUTPUT.  EXPECTED SYNTAX:
+	 *   ./program json file_in file_out name[units_in]=units_out [...]
+	 */
+	if(argc >= 5 && std::string(argv[1]) == "json"){
+		UnitRegistry reg;
+		if(!LoadSiteUnits(reg)){
+			return 1;
+		}
+		UnitJson jsonconvert(reg);
+		for(int i=4; i<argc; i++){
+			std::string arg(argv[i]);
+			size_t eq = arg.find('=');
+			if(eq == std::string::npos){
+				std::cerr << "ERROR: expected name=units, found '" << arg << "'" << std::endl;
+				return 1;
+			}
+			std::string name = arg.substr(0,eq);
+			std::string unitsin;
+			size_t br = name.find('[');
+			if(br != std::string::npos && name[name.size()-1] == ']'){
+				unitsin = name.substr(br+1,name.size()-br-2);
+				name = name.substr(0,br);
+			}
+			UnitErrorCode err = jsonconvert.AddField(name,arg.substr(eq+1),unitsin);
+			if(err != UNIT_OK){
+				std::cerr << "ERROR: " << arg << ": " << UnitErrorString(err) << std::endl;
+				return 1;
+			}
+		}
+
+		UnitStream stream(reg);
+		stream.SetJson(&jsonconvert);
+		if(!stream.Run(argv[2],argv[3])){
+			std::cerr << "ERROR: " << stream.Error() << std::endl;
+			return 1;
+		}
+		if(stream.NumErrors() > 0){
+			std::cerr << "WARNING: " << stream.NumErrors() << " values left unchanged" << std::endl;
+		}
+		if(stream.NumMalformed() > 0){
+			std::cerr << "ERROR: " << stream.NumMalformed() << " malformed records copied unchanged" << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
+	/*
+	 * SERVE CONVERSIONS TO OTHER PROCESSES THROUGH SHARED MEMORY UNTIL
+	 * INTERRUPTED.  PLAN IDS ARE NUMBERED FROM 0 IN THE ORDER GIVEN.  "busy"
+	 * SPINS RATHER THAN SLEEPS WHILE IDLE.  EXPECTED SYNTAX:
+	 *   ./program shm name [busy] units_in=units_out [...]
+	 */
+	if(argc >= 4 && std::string(argv[1]) == "shm"){
+		UnitRegistry reg;
+		UnitShmServer server(reg);
+		int first = 3;
+		if(std::string(argv[3]) == "busy"){
+			server.SetBusyPoll(true);
+			first = 4;
+		}
+		for(int i=first; i<argc; i++){
+			std::string arg(argv[i]);
+			size_t eq = arg.find('=');
+			if(eq == std::string::npos){
+				std::cerr << "ERROR: expected units_in=units_out, found '" << arg << "'" << std::endl;
+				return 1;
+			}
+			UnitErrorCode err = server.AddPlan(arg.substr(0,eq),arg.substr(eq+1));
+			if(err != UNIT_OK){
+				std::cerr << "ERROR: " << arg << ": " << UnitErrorString(err) << std::endl;
+				return 1;
+			}
+		}
+
+		if(!server.Create(argv[2],64,4096)){
+			std::cerr << "ERROR: " << server.Error() << std::endl;
+			return 1;
+		}
+		shmserver = &server;
+		signal(SIGINT,StopShmServer);
+		signal(SIGTERM,StopShmServer);
+		server.Run();
+		shmserver = 0;
+		std::cerr << server.NumBatches() << " batches converted" << std::endl;
+		return 0;
+	}
+
+#ifdef UNITCONVERT_WITH_ARROW
+	/*
+	 * CONVERT COLUMNS OF AN ARROW IPC FILE WITHOUT THE GUI.  INPUT UNITS ARE
+	 * READ FROM THE FIELD METADATA.  EXPECTED SYNTAX:
+	 *   ./program arrow file_in file_out column=units_out [column=units_out ...]
+	 */
+	if(argc >= 5 && std::string(argv[1]) == "arrow"){
+		UnitRegistry reg;
+		UnitArrow arrowconvert(reg);
+		for(int i=4; i<argc; i++){
+			std::string arg(argv[i]);
+			size_t eq = arg.find('=');
+			if(eq == std::string::npos){
+				std::cout << "ERROR: expected column=units, found '" << arg << "'" << std::endl;
+				return 1;
+			}
+			UnitErrorCode err = arrowconvert.AddColumn(arg.substr(0,eq),arg.substr(eq+1));
+			if(err != UNIT_OK){
+				std::cout << "ERROR: " << arg << ": " << UnitErrorString(err) << std::endl;
+				return 1;
+			}
+		}
+
+		arrow::Status status = arrowconvert.Convert(argv[2],argv[3]);
+		if(!status.ok()){
+			std::cout << "ERROR: " << status.ToString() << std::endl;
+			return 1;
+		}
+		std::cout << arrowconvert.NumRows() << " rows converted" << std::endl;
+		return 0;
+	}
+#endif
+
 	// PREPARE FOR THE GUI
 	Gtk::Main kit(argc,argv);
 
@@ -151,6 +565,16 @@ int main(int argc, char *argv[])
 			helpstr = uc.PrintUnits();
 			std::cout << std::endl;
 			std::cout << helpstr << std::endl;
+
+			// SITE UNITS
+			UnitRegistry reg;
+			if(!LoadSiteUnits(reg)){
+				return 1;
+			}
+			if(reg.NumUnits() > reg.NumBuiltinUnits()){
+				std::cout << "Site units (" << SiteUnitsFile() << ")" << std::endl;
+				std::cout << reg.PrintUnits(reg.NumBuiltinUnits()) << std::endl;
+			}
 		} else {
 			std::cout << std::endl;
 			std::cout << "ERROR: Unexpected syntax" << std::endl;
@@ -165,6 +589,11 @@ int main(int argc, char *argv[])
 	 * PERFORM UNIT CONVERSION SPECIFIED VIA THE COMMAND-LINE ARGUMENTS
 	 * EXPECTED SYNTAX: ./program value units_in units_out
 	 *
+	 * UNITS ARE UNIT STRINGS ("k:m:1|-:hr:-1") OR CONVENTIONAL NOTATION
+	 * ("km/h", SEE UnitNotation.h).  units_in "duration" READS THE VALUE AS A
+	 * DURATION (PT1H30M12.5S, 01:23:45.678) AND units_out "iso" OR "clock"
+	 * PRINTS THE RESULT AS ONE.
+	 *
 	 * NUMERICAL RESULT IS RETURNED
 	 */
 	if(argc == 4){
@@ -172,20 +601,59 @@ int main(int argc, char *argv[])
 		std::stringstream argss;
 		std::string unitsin;
 		std::string unitsout;
-		Tconvert valin;
-		Tconvert valout = 0.0e0;
-		UnitConvert<Tconvert> uc;
+		Tconvert valin = 0.0e0;
+		UnitRegistry reg;
+		if(!LoadSiteUnits(reg)){
+			return 1;
+		}
 
-		argss << argv[1];
-		argss >> valin; argss.str(""); argss.clear();
-		argss << argv[2];
-		argss >> unitsin; argss.str(""); argss.clear();
-		argss << argv[3];
-		argss >> unitsout; argss.str(""); argss.clear();
+		bool durationin = (std::string(argv[2]) == "duration");
+		UnitDurationFormat durationout = DurationFormat(argv[3]);
+		if(durationin){
+			double sec = 0.0e0;
+			if(UnitParseDuration(argv[1],argv[1] + strlen(argv[1]),sec) != UNIT_OK){
+				std::cout << "ERROR: " << UnitErrorString(UNIT_ERR_BAD_VALUE) << std::endl;
+				return 1;
+			}
+			valin = sec;
+		} else {
+			argss << argv[1];
+			argss >> valin;
+			if(argss.fail() || !argss.eof()){
+				std::cout << "ERROR: " << UnitErrorString(UNIT_ERR_BAD_VALUE) << std::endl;
+				return 1;
+			}
+			argss.str(""); argss.clear();
+		}
+		UnitNotation notation(reg);
+		UnitErrorCode err = notation.Expand(argv[2],unitsin);
+		if(err == UNIT_OK){
+			err = notation.Expand(argv[3],unitsout);
+		}
+		if(err != UNIT_OK){
+			std::cout << "ERROR: " << UnitErrorString(err) << std::endl;
+			return 1;
+		}
+		if(durationin){
+			unitsin = "-:sec:1";
+		}
+		if(durationout != UNITDURATION_NONE){
+			unitsout = "-:sec:1";
+		}
 
-		valout = uc.ConvertUnits(valin,unitsin,unitsout);
+		UnitResult<Tconvert> valout = ConvertValue<Tconvert>(reg,valin,unitsin,unitsout);
+		if(!valout.Ok()){
+			std::cout << "ERROR: " << UnitErrorString(valout.Error()) << std::endl;
+			return 1;
+		}
 
-		std::cout << valout << std::endl;
+		if(durationout != UNITDURATION_NONE){
+			char text[UNITDURATION_MAX_CHARS];
+			char *end = UnitFormatDuration((double)valout.Value(),durationout,text);
+			std::cout << std::string(text,end) << std::endl;
+		} else {
+			std::cout << valout.Value() << std::endl;
+		}
 		std::cout << std::endl;
 	}
 
@@ -206,6 +674,25 @@ int main(int argc, char *argv[])
 		std::cout << "     'value' - value to be converted" << std::endl;
 		std::cout << "     'units_in' - units of value to be converted" << std::endl;
 		std::cout << "     'units_out' - units of output value" << std::endl;
+		std::cout << "     units are unit strings (k:m:1|-:hr:-1) or notation (km/h)" << std::endl;
+		std::cout << "     'duration' in, 'iso' or 'clock' out: PT1H30M12.5S, 01:30:12.5" << std::endl;
+		std::cout << "  4. Self-checks run by specifying 'check'" << std::endl;
+		std::cout << "     ex: " << argv[0] << " check [baseline [tolerance|write]]" << std::endl;
+		std::cout << "     Microbenchmarks run by specifying 'bench'" << std::endl;
+		std::cout << "     ex: " << argv[0] << " bench [repeats]" << std::endl;
+		std::cout << "  5. Delimited text (.gz, .zst) converted by specifying 'stream'" << std::endl;
+		std::cout << "     ex: " << argv[0] << " stream units_in units_out [column [file_in [file_out [direct]]]]" << std::endl;
+		std::cout << "     ex: " << argv[0] << " stream units_in units_out column file_in file_out --follow [state_file]" << std::endl;
+		std::cout << "  6. Fields of NDJSON records converted by specifying 'json'" << std::endl;
+		std::cout << "     ex: " << argv[0] << " json file_in file_out name[units_in]=units_out ..." << std::endl;
+		std::cout << "  7. Large delimited text converted by worker processes by specifying 'shard'" << std::endl;
+		std::cout << "     ex: " << argv[0] << " shard workers units_in units_out column file_in file_out" << std::endl;
+		std::cout << "  8. Conversions served to other processes by specifying 'shm'" << std::endl;
+		std::cout << "     ex: " << argv[0] << " shm name [busy] units_in=units_out ..." << std::endl;
+#ifdef UNITCONVERT_WITH_ARROW
+		std::cout << "  9. Columns of an Arrow IPC file converted by specifying 'arrow'" << std::endl;
+		std::cout << "     ex: " << argv[0] << " arrow file_in file_out column=units_out ..." << std::endl;
+#endif
 		std::cout << std::endl;
 		std::cout << std::endl;
 	}
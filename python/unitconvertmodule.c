@@ -0,0 +1,314 @@
+/**
+ * @file unitconvertmodule.c
+ * @author 	Robert Grandin
+ * @date 18 October 2026
+ *
+ * @section Class Description & Notes
+ *
+ * Python module "unitconvert" built on the C interface in UnitConvertC.h.
+ * Arrays are passed through the buffer protocol, so NumPy arrays (and any
+ * other contiguous buffer of float64 or float32 values) are converted without
+ * copying.  The interpreter lock is released while values are converted.
+ *
+ * 	import numpy, unitconvert
+ * 	plan = unitconvert.Plan("k:m:1|-:sec:-1", "-:mile:1|-:hr:-1")
+ * 	a = numpy.linspace(0.0, 10.0, 1000000)
+ * 	plan.convert(a)			# in place
+ * 	b = numpy.empty_like(a)
+ * 	plan.convert(a, b)		# into b
+ * 	unitconvert.convert(1.0, "-:C:1", "-:F:1")
+ *
+ * Errors in unit strings raise ValueError; unsuitable buffers raise
+ * TypeError or ValueError.
+ *
+ * The module is compiled together with UnitConvertC.cpp, e.g.
+ *
+ * 	g++ -O2 -fopenmp -fPIC -c -I.. ../UnitConvertC.cpp
+ * 	gcc -O2 -fPIC -c -I.. $(python3-config --includes) unitconvertmodule.c
+ * 	g++ -shared -fopenmp UnitConvertC.o unitconvertmodule.o \
+ * 		-o unitconvert$(python3-config --extension-suffix)
+ *
+ *
+ * @section Revisions
+ *
+ * @date 18 October 2026
+ *	- Creation date.
+ *
+ * @date 18 October 2026
+ *	- Unused parameters marked with Py_UNUSED(), so -Wextra is quiet.
+ *
+ *
+ *
+ *
+ * @section License
+ *
+ * Copyright (c) 2011, Robert Grandin
+ * All rights reserved.
+ *
+ * Redistribution and use of this file is permitted provided that the following
+ * conditions are met:
+ * 	-# 	Redistributions must produce the above copyright notice, this list of
+ * 		conditions, and the following disclaimer in the documentation and/or
+ * 		other materials provided with the distribution.
+ * 	-#	Neither the name of the organization nor the names of its contributors
+ * 		may be used to endorse or promote products derived from this software
+ * 		without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDER "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING BUT NOT
+ * LIMITING TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "UnitConvertC.h"
+
+
+/**
+ * @brief Python object wrapping a compiled plan.
+ */
+typedef struct {
+	PyObject_HEAD
+	uc_plan *plan;
+} PlanObject;
+
+
+
+// ==== Plan TYPE ==============================================================
+
+static int Plan_init(PlanObject *self, PyObject *args, PyObject *kwds)
+{
+	static char *kwlist[] = {"units_in", "units_out", NULL};
+	const char *unitsin = NULL;
+	const char *unitsout = NULL;
+	if(!PyArg_ParseTupleAndKeywords(args,kwds,"ss",kwlist,&unitsin,&unitsout)){
+		return -1;
+	}
+
+	uc_plan *plan = NULL;
+	int err = uc_plan_create(unitsin,unitsout,&plan);
+	if(err != 0){
+		PyErr_Format(PyExc_ValueError,"cannot convert '%s' to '%s': %s",
+				unitsin,unitsout,uc_error_string(err));
+		return -1;
+	}
+
+	uc_plan_free(self->plan);
+	self->plan = plan;
+	return 0;
+}
+
+
+static void Plan_dealloc(PlanObject *self)
+{
+	uc_plan_free(self->plan);
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+
+static PyObject* Plan_convert(PlanObject *self, PyObject *args)
+{
+	PyObject *objin = NULL;
+	PyObject *objout = NULL;
+	if(!PyArg_ParseTuple(args,"O|O",&objin,&objout)){
+		return NULL;
+	}
+	if(!self->plan){
+		PyErr_SetString(PyExc_ValueError,"plan not initialized");
+		return NULL;
+	}
+
+
+	/*
+	 * GET THE BUFFERS.  WITHOUT AN OUTPUT BUFFER THE INPUT IS CONVERTED IN
+	 * PLACE AND MUST BE WRITABLE.
+	 */
+	Py_buffer bufin;
+	Py_buffer bufout;
+	int inplace = (objout == NULL || objout == Py_None || objout == objin);
+	int flagsin = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (inplace ? PyBUF_WRITABLE : 0);
+	if(PyObject_GetBuffer(objin,&bufin,flagsin) != 0){
+		return NULL;
+	}
+	if(inplace){
+		bufout = bufin;
+	} else if(PyObject_GetBuffer(objout,&bufout,
+			PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | PyBUF_WRITABLE) != 0){
+		PyBuffer_Release(&bufin);
+		return NULL;
+	}
+
+
+	/*
+	 * CHECK TYPES AND SIZES
+	 */
+	const char *fmt = bufin.format ? bufin.format : "B";
+	const char *fmtout = bufout.format ? bufout.format : "B";
+	int isf64 = (fmt[0] == 'd' && fmt[1] == '\0' && bufin.itemsize == sizeof(double));
+	int isf32 = (fmt[0] == 'f' && fmt[1] == '\0' && bufin.itemsize == sizeof(float));
+	const char *msg = NULL;
+	if(!isf64 && !isf32){
+		msg = "buffer must contain float64 or float32 values";
+	} else if(fmtout[0] != fmt[0] || fmtout[1] != '\0' ||
+			bufout.itemsize != bufin.itemsize){
+		msg = "input and output buffers must have the same type";
+	} else if(bufout.len != bufin.len){
+		msg = "input and output buffers must have the same size";
+	} else if(!inplace && bufin.buf != bufout.buf &&
+			(char*)bufin.buf < (char*)bufout.buf + bufout.len &&
+			(char*)bufout.buf < (char*)bufin.buf + bufin.len){
+		msg = "input and output buffers overlap";
+	}
+	if(msg){
+		if(!inplace){
+			PyBuffer_Release(&bufout);
+		}
+		PyBuffer_Release(&bufin);
+		PyErr_SetString(isf64 || isf32 ? PyExc_ValueError : PyExc_TypeError,msg);
+		return NULL;
+	}
+
+
+	/*
+	 * CONVERT WITHOUT HOLDING THE INTERPRETER LOCK
+	 */
+	size_t n = (size_t)(bufin.len/bufin.itemsize);
+	Py_BEGIN_ALLOW_THREADS
+	if(isf64){
+		uc_convert_f64(self->plan,(const double*)bufin.buf,(double*)bufout.buf,n);
+	} else {
+		uc_convert_f32(self->plan,(const float*)bufin.buf,(float*)bufout.buf,n);
+	}
+	Py_END_ALLOW_THREADS
+
+	if(!inplace){
+		PyBuffer_Release(&bufout);
+	}
+	PyBuffer_Release(&bufin);
+	Py_RETURN_NONE;
+}
+
+
+static PyObject* Plan_scale(PlanObject *self, void *Py_UNUSED(closure))
+{
+	double scale = 1.0;
+	if(self->plan){
+		uc_plan_coefficients(self->plan,&scale,NULL);
+	}
+	return PyFloat_FromDouble(scale);
+}
+
+
+static PyObject* Plan_offset(PlanObject *self, void *Py_UNUSED(closure))
+{
+	double offset = 0.0;
+	if(self->plan){
+		uc_plan_coefficients(self->plan,NULL,&offset);
+	}
+	return PyFloat_FromDouble(offset);
+}
+
+
+static PyMethodDef Plan_methods[] = {
+	{"convert", (PyCFunction)Plan_convert, METH_VARARGS,
+		"convert(values[, out]): convert a float64 or float32 buffer in place, "
+		"or into 'out'."},
+	{NULL, NULL, 0, NULL}
+};
+
+
+static PyGetSetDef Plan_getset[] = {
+	{"scale", (getter)Plan_scale, NULL, "out = in*scale + offset", NULL},
+	{"offset", (getter)Plan_offset, NULL, "out = in*scale + offset", NULL},
+	{NULL, NULL, NULL, NULL, NULL}
+};
+
+
+static PyTypeObject PlanType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "unitconvert.Plan",
+	.tp_basicsize = sizeof(PlanObject),
+	.tp_dealloc = (destructor)Plan_dealloc,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_doc = "Plan(units_in, units_out): compiled conversion between two unit "
+		"strings of the form 'si:unit:power|...'.",
+	.tp_methods = Plan_methods,
+	.tp_getset = Plan_getset,
+	.tp_init = (initproc)Plan_init,
+	.tp_new = PyType_GenericNew,
+};
+
+
+
+// ==== MODULE FUNCTIONS =======================================================
+
+static PyObject* unitconvert_convert(PyObject *Py_UNUSED(module), PyObject *args)
+{
+	double val = 0.0;
+	const char *unitsin = NULL;
+	const char *unitsout = NULL;
+	if(!PyArg_ParseTuple(args,"dss",&val,&unitsin,&unitsout)){
+		return NULL;
+	}
+
+	double result = 0.0;
+	int err = uc_convert_value(val,unitsin,unitsout,&result);
+	if(err != 0){
+		PyErr_Format(PyExc_ValueError,"cannot convert '%s' to '%s': %s",
+				unitsin,unitsout,uc_error_string(err));
+		return NULL;
+	}
+	return PyFloat_FromDouble(result);
+}
+
+
+static PyMethodDef unitconvert_methods[] = {
+	{"convert", unitconvert_convert, METH_VARARGS,
+		"convert(value, units_in, units_out): convert a single value."},
+	{NULL, NULL, 0, NULL}
+};
+
+
+static struct PyModuleDef unitconvertmodule = {
+	PyModuleDef_HEAD_INIT,
+	"unitconvert",
+	"Unit conversion of scalars and float64/float32 buffers.",
+	-1,
+	unitconvert_methods,
+	NULL,
+	NULL,
+	NULL,
+	NULL
+};
+
+
+PyMODINIT_FUNC PyInit_unitconvert(void)
+{
+	if(PyType_Ready(&PlanType) < 0){
+		return NULL;
+	}
+
+	PyObject *module = PyModule_Create(&unitconvertmodule);
+	if(!module){
+		return NULL;
+	}
+
+	Py_INCREF(&PlanType);
+	if(PyModule_AddObject(module,"Plan",(PyObject*)&PlanType) < 0){
+		Py_DECREF(&PlanType);
+		Py_DECREF(module);
+		return NULL;
+	}
+	PyModule_AddIntConstant(module,"ABI_VERSION",uc_abi_version());
+	return module;
+}